@@ -112,6 +112,12 @@ void _setup_gpio() {
     // register interrupt routine
     attachInterrupt(digitalPinToInterrupt(ENCODER_INA), checkPosition, CHANGE);
     attachInterrupt(digitalPinToInterrupt(ENCODER_INB), checkPosition, CHANGE);
+
+    // Encoder and buttons all interrupt, the input task sleeps while they're still
+    inputWatchPin(SEL_BTN);
+#ifdef T_EMBED_1101
+    inputWatchPin(BK_BTN);
+#endif
 }
 
 /***************************************************************************************
@@ -162,6 +168,7 @@ void _setBrightness(uint8_t brightval) {
 RotaryEncoder *encoder = nullptr;
 IRAM_ATTR void checkPosition() {
     encoder->tick(); // just call tick() to check the state.
+    inputWakeFromISR();
 }
 
 /*********************************************************************
@@ -259,6 +266,7 @@ void checkReboot() {
                     tft.fillScreen(bruceConfig.bgColor);
                     while (digitalRead(BK_BTN) == BTN_ACT);
                     delay(200);
+                    bruceConfig.flushFile();
                     powerDownNFC();
                     powerDownCC1101();
                     tft.sleep(true);
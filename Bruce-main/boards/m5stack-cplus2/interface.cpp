@@ -14,6 +14,9 @@ void _setup_gpio() {
     pinMode(UP_BTN, INPUT); // Sets the power btn as an INPUT
     pinMode(SEL_BTN, INPUT);
     pinMode(DW_BTN, INPUT);
+    inputWatchPin(UP_BTN);
+    inputWatchPin(SEL_BTN);
+    inputWatchPin(DW_BTN);
     pinMode(4, OUTPUT);    // Keeps the Stick alive after take off the USB cable
     digitalWrite(4, HIGH); // Keeps the Stick alive after take off the USB cable
     gpio_pulldown_dis(GPIO_NUM_36);
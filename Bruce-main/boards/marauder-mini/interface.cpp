@@ -12,6 +12,11 @@ void _setup_gpio() {
     pinMode(DW_BTN, INPUT);
     pinMode(R_BTN, INPUT);
     pinMode(L_BTN, INPUT);
+    inputWatchPin(UP_BTN);
+    inputWatchPin(SEL_BTN);
+    inputWatchPin(DW_BTN);
+    inputWatchPin(R_BTN);
+    inputWatchPin(L_BTN);
 
     bruceConfig.colorInverted = 0;
     bruceConfig.rotation = 0; // portrait mode for Phantom
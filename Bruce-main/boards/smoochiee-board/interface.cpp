@@ -20,6 +20,11 @@ void _setup_gpio() {
     pinMode(DW_BTN, INPUT);
     pinMode(R_BTN, INPUT);
     pinMode(L_BTN, INPUT);
+    inputWatchPin(UP_BTN);
+    inputWatchPin(SEL_BTN);
+    inputWatchPin(DW_BTN);
+    inputWatchPin(R_BTN);
+    inputWatchPin(L_BTN);
 
     pinMode(CC1101_SS_PIN, OUTPUT);
     pinMode(NRF24_SS_PIN, OUTPUT);
@@ -158,6 +163,7 @@ void checkReboot() {
                     tft.fillScreen(bruceConfig.bgColor);
                     while (digitalRead(L_BTN) == BTN_ACT || digitalRead(R_BTN) == BTN_ACT);
                     delay(200);
+                    bruceConfig.flushFile();
                     powerOff();
                 }
                 delay(10);
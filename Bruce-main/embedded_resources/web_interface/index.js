@@ -314,9 +314,12 @@ function renderFileRow(fileList) {
       e.querySelector(".col-size").textContent = size;
       e.querySelector(".col-action").classList.add("type-file");
 
-      let downloadUrl = `/file?fs=${currentDrive}&name=${encodeURIComponent(dPath)}&action=download`;
+      // GPS Tracker journals are downloaded as GPX, rendered by the device
+      let isTrack = name.endsWith(".trk");
+      let action = isTrack ? "gpx" : "download";
+      let downloadUrl = `/file?fs=${currentDrive}&name=${encodeURIComponent(dPath)}&action=${action}`;
       if (IS_DEV) downloadUrl = "/bruce" + downloadUrl;
-      e.querySelector(".act-download").setAttribute("download", name);
+      e.querySelector(".act-download").setAttribute("download", isTrack ? name.replace(/\.trk$/, ".gpx") : name);
       e.querySelector(".act-download").setAttribute("href", downloadUrl);
 
       let serialCmd = getSerialCommand(name);
@@ -395,7 +398,8 @@ function isModified(target) {
 
 async function openNavigator() {
   Dialog.show('navigator');
-  await reloadScreen();
+  connectScreenSocket();
+  await reloadScreen(true);
   autoReloadScreen();
 }
 
@@ -404,6 +408,12 @@ async function runNavigation(direction) {
   if (SCREEN_NAVIGATING) return;
   SCREEN_NAVIGATING = true;
   try {
+    screenStats.navigatedAt = performance.now();
+    if (isScreenPushed()) {
+      // the device pushes what changes
+      await requestPost("/cm", { cmnd: `nav ${direction.toLowerCase()}` });
+      return;
+    }
     drawCanvasLoading();
     await requestPost("/cm", { cmnd: `nav ${direction.toLowerCase()}` });
     await reloadScreen();
@@ -415,17 +425,82 @@ async function runNavigation(direction) {
   }
 }
 
+// Screen mirror. Every packet from the device starts with a LOG_SYNC: the screen epoch,
+// the sequence number it follows (0 for the whole screen) and the one it ends at, so
+// only what was drawn since the last one is sent. /screen/ws pushes them as the device
+// draws, /getscreen?epoch=&seq= is polled when the socket isn't there.
+const screenSync = { epoch: -1, seq: 0 };
+const screenStats = { navigatedAt: 0 };
+const eScreenStats = $("#navigator-stats");
+let screenSocket = null;
+let screenRendering = Promise.resolve();
+
+function isScreenPushed() {
+  return screenSocket !== null && screenSocket.readyState === WebSocket.OPEN;
+}
+
+function readScreenSync(data) {
+  // AA SS 98 EE EE FF FF FF FF TT TT TT TT
+  if (data.length < 13 || data[0] !== 0xAA || data[2] !== 98) return null;
+  const u32 = (i) => ((data[i] << 24) | (data[i + 1] << 16) | (data[i + 2] << 8) | data[i + 3]) >>> 0;
+  return { epoch: (data[3] << 8) | data[4], from: u32(5), to: u32(9) };
+}
+
+// false when data doesn't follow what is on the canvas
+function applyScreen(data) {
+  let sync = readScreenSync(data);
+  if (!sync) return false;
+  if (sync.from !== 0 && (sync.epoch !== screenSync.epoch || sync.from !== screenSync.seq)) return false;
+  screenSync.epoch = sync.epoch;
+  screenSync.seq = sync.to;
+
+  let stats = `${sync.from === 0 ? "full" : "delta"}: ${data.length} B`;
+  if (screenStats.navigatedAt) {
+    stats += `, ${Math.round(performance.now() - screenStats.navigatedAt)} ms after navigating`;
+    screenStats.navigatedAt = 0;
+  }
+  eScreenStats.textContent = (isScreenPushed() ? "push " : "poll ") + stats;
+
+  // one after the other, images are loaded asynchronously
+  screenRendering = screenRendering.then(() => renderTFT(data)).catch(console.error);
+  return true;
+}
+
+function connectScreenSocket() {
+  if (screenSocket || IS_DEV) return;
+  let protocol = window.location.protocol === "https:" ? "wss:" : "ws:";
+  let socket = new WebSocket(`${protocol}//${window.location.host}/screen/ws`);
+  socket.binaryType = "arraybuffer";
+  socket.onmessage = (e) => {
+    if (!$(".dialog.navigator:not(.hidden)")) {
+      socket.close();
+      return;
+    }
+    // missed a push, ask for the whole screen
+    if (!applyScreen(new Uint8Array(e.data))) socket.send("resync");
+  };
+  socket.onclose = () => {
+    if (screenSocket === socket) screenSocket = null;
+  };
+  screenSocket = socket;
+}
+
 const btnForceReload = $("#force-reload");
 let SCREEN_RELOAD = false;
-async function reloadScreen() {
+async function reloadScreen(full = false) {
   if (SCREEN_RELOAD) return;
   SCREEN_RELOAD = true;
   btnForceReload.classList.add("reloading");
   try {
-    let binResponse = await fetch((IS_DEV ? "/bruce" : "") + "/getscreen");
-    let arrayBuffer = await binResponse.arrayBuffer();
-    let screenData = new Uint8Array(arrayBuffer);
-    await renderTFT(screenData);
+    if (full) screenSync.seq = 0;
+    for (let i = 0; i < 2; i++) {
+      let query = screenSync.seq ? `?epoch=${screenSync.epoch}&seq=${screenSync.seq}` : "";
+      let binResponse = await fetch((IS_DEV ? "/bruce" : "") + "/getscreen" + query);
+      let arrayBuffer = await binResponse.arrayBuffer();
+      if (applyScreen(new Uint8Array(arrayBuffer))) break;
+      screenSync.seq = 0; // a push got in between, take the whole screen
+    }
+    await screenRendering;
   } catch (error) {
     console.error("Failed to reload screen:", error);
     alert("Failed to reload screen: " + error.message);
@@ -450,7 +525,7 @@ async function taskReloader() {
   }
 
 
-  await reloadScreen();
+  if (!isScreenPushed()) await reloadScreen();
   setTimeout(taskReloader, timer);
   // better use setTimeout instead of setInterval to avoid overlapping calls
 }
@@ -557,6 +632,7 @@ async function renderTFT(data) {
       18: ["x", "y", "center", "ms", "fs", "file"],                // DRAWIMAGE
       20: ["x", "y", "h", "fg"],                                  // DRAWFASTVLINE
       21: ["x", "y", "w", "fg"],                                   // DRAWFASTHLINE
+      98: ["epoch", "fromHi", "fromLo", "toHi", "toLo"],          // LOG_SYNC
       99: ["w", "h", "rotation"]                                  // SCREEN_INFO
     };
 
@@ -579,8 +655,9 @@ async function renderTFT(data) {
     return r;
   }
 
+  // the whole screen starts with SCREEN_INFO, which resets the canvas,
+  // anything else is drawn over what is there
   let offset = 0;
-  ctx.clearRect(0, 0, canvas.width, canvas.height);
   while (offset < data.length) {
     ctx.beginPath();
     if (data[offset] !== 0xAA) {
@@ -599,6 +676,9 @@ async function renderTFT(data) {
     ctx.fillStyle = "black";
     ctx.strokeStyle = "black";
     switch (fn) {
+      case 98: // LOG_SYNC
+        break;
+
       case 99: // SCREEN_INFO
         canvas.width = input.w;
         canvas.height = input.h;
@@ -777,7 +857,7 @@ eConfigAutoReload.addEventListener("change", async (e) => {
 btnForceReload.addEventListener("click", async (e) => {
   e.preventDefault();
   drawCanvasLoading();
-  await reloadScreen();
+  await reloadScreen(true);
 });
 
 window.ondragenter = () => $(".upload-area").classList.remove("hidden");
@@ -9,6 +9,7 @@
 
 #include "core/config.h"
 #include "core/configPins.h"
+#include "core/input_events.h"
 #include "core/serial_commands/cli.h"
 #include "core/startup_app.h"
 #include <Arduino.h>
@@ -214,12 +215,12 @@ extern inline bool check(volatile bool &btn) {
 
 #ifndef USE_TFT_eSPI_TOUCH
     if (!btn) return false;
-    vTaskSuspend(xHandle);
+    // The input task can't reset or set the flags while they're cleared here
+    inputLock();
     btn = false;
     AnyKeyPress = false;
     SerialCmdPress = false;
-    delay(10);
-    vTaskResume(xHandle);
+    inputUnlock();
     return true;
 #else
 
@@ -1,5 +1,7 @@
 #ifndef __DISPLAY_LOGER
 #define __DISPLAY_LOGER
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <precompiler_flags.h> //need to fetch the device Settings that are not in platformio.ini file
 #include <vector>
 #ifdef HAS_SCREEN
@@ -34,32 +36,78 @@ enum tftFuncs : uint8_t { // DO NOT CHANGE THE ORDER, ADD NEW FUNCTIONS TO THE E
     DRAWFASTHLINE,        // 21
     // Add new ones here
 
+    LOG_SYNC = 98,   // 98, not a draw command: epoch and sequence range of a getBinLog packet
     SCREEN_INFO = 99 // 99
 };
+// Log depth (draw commands kept), build flags can change them.
+// The log is only allocated while logging, in PSRAM when there is some.
+#ifndef MAX_LOG_ENTRIES
 #define MAX_LOG_ENTRIES 64
+#endif
+#ifndef MAX_LOG_ENTRIES_PSRAM
+#define MAX_LOG_ENTRIES_PSRAM 512
+#endif
+#define MAX_LOG_DEPTH 8192 // Largest depth setLogDepth() takes
 #define MAX_LOG_SIZE 128
 #define MAX_LOG_IMAGES 3
 #define MAX_LOG_IMG_PATH 512
 #define LOG_PACKET_HEADER 0xAA
+#define LOG_NO_ENTRY 0xFFFF
 struct tftLog {
+    uint32_t seq;  // Order the entry was logged in, starting at 1
+    uint32_t hash; // Of data, to find duplicates
+    uint16_t next; // Next entry with the same hash bucket
     uint8_t data[MAX_LOG_SIZE];
 };
+// Where a remote screen is: the log epoch (it changes when the screen is cleared)
+// and the last entry it has. seq 0 asks for the whole screen.
+struct tftLogCursor {
+    uint16_t epoch = 0;
+    uint32_t seq = 0;
+};
 class tft_logger : public BRUCE_TFT_DRIVER {
 private:
-    tftLog log[MAX_LOG_ENTRIES];
+    // Ring of draw commands, with a hash index so a command already on
+    // screen isn't logged twice. Every entry gets a sequence number, so a
+    // remote screen only gets what was drawn since its last update.
+    tftLog *log = nullptr;
+    uint16_t *logBuckets = nullptr;
+    uint16_t logDepth = 0;
+    uint16_t logDepthSetting = 0; // 0 for the default
+    uint16_t logCount = 0;        // Entries used in the ring
+    uint16_t logBucketMask = 0;
+    uint16_t logWriteIndex = 0;
+    uint16_t logEpoch = 0;
+    uint32_t logSeq = 0;  // Of the last entry logged
+    uint32_t logLost = 0; // Highest seq overwritten while still on screen
+    SemaphoreHandle_t logLock = nullptr;
     char images[MAX_LOG_IMAGES][MAX_LOG_IMG_PATH];
-    uint8_t logWriteIndex = 0;
     bool logging = false;
     bool _logging = false;
     void clearLog();
+    void resetLog();
+    void allocLog(uint16_t depth);
+    void freeLog();
+    void unlinkLogEntry(uint16_t index);
+    size_t writeLogEntry(const tftLog &entry, uint8_t *outBuffer, size_t maxLen);
 
 public:
     tft_logger(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
     virtual ~tft_logger();
     void setLogging(bool _log = true);
     bool inline getLogging(void) { return logging; };
+    // Entries kept, 0 for the default, up to MAX_LOG_DEPTH. Clears the log.
+    void setLogDepth(uint16_t depth);
+    uint16_t inline getLogDepth(void) { return logDepth; };
+    uint32_t inline getLogSeq(void) { return logSeq; };
+    uint16_t inline getLogEpoch(void) { return logEpoch; };
 
-    void getBinLog(uint8_t *outBuffer, size_t &outSize);
+    // Packets drawn since cursor, or the whole screen (starting with SCREEN_INFO) when the
+    // cursor is at 0, from another epoch or too far behind. A LOG_SYNC packet comes first.
+    // Stops at what fits in maxLen; cursor is moved to what was written.
+    size_t getBinLog(uint8_t *outBuffer, size_t maxLen, tftLogCursor *cursor = nullptr);
+    // Buffer size getBinLog may need
+    size_t getBinLogMaxSize();
     bool removeLogEntriesInsideRect(int rx, int ry, int rw, int rh);
     void removeOverlappedImages(int x, int y, int center, int ms);
 
@@ -121,10 +169,10 @@ public:
 protected:
     bool isLogEqual(const tftLog &a, const tftLog &b);
     void pushLogIfUnique(const tftLog &l);
+    uint32_t logHash(const uint8_t *data, uint8_t size);
     void checkAndLog(tftFuncs f, std::initializer_list<int32_t> values);
 
     void restoreLogger();
-    void addLogEntry(const uint8_t *buffer, uint8_t size);
     void logWriteHeader(uint8_t *buffer, uint8_t &pos, tftFuncs fn);
     void writeUint16(uint8_t *buffer, uint8_t &pos, uint16_t value);
 };
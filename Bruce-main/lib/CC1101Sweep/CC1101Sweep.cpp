@@ -0,0 +1,99 @@
+#include "CC1101Sweep.h"
+
+uint32_t CC1101Sweep::freqWord(float mhz) {
+    double word = (double)mhz * 1000000.0 * 65536.0 / XTAL_HZ + 0.5;
+    if (word < 0) return 0;
+    if (word > 0xFFFFFF) return 0xFFFFFF;
+    return (uint32_t)word;
+}
+
+float CC1101Sweep::wordToMHz(uint32_t word) { return (float)((double)word * XTAL_HZ / 65536.0 / 1000000.0); }
+
+uint8_t CC1101Sweep::band(float mhz) {
+    // T-Embed antenna switch in setMHZ(), 468-778 MHz keeps the last one
+    uint8_t antenna = mhz <= 350.0f ? 0 : mhz < 468.0f ? 1 : mhz > 778.0f ? 2 : 3;
+    return antenna << 4 | calibrationRange(mhz) << 1 | (test0(mhz) == TEST0_HIGH);
+}
+
+uint8_t CC1101Sweep::calibrationRange(float mhz) {
+    if (mhz >= 300.0f && mhz <= 348.0f) return 1;
+    if (mhz >= 378.0f && mhz <= 464.0f) return 2;
+    if (mhz >= 779.0f && mhz <= 899.99f) return 3;
+    if (mhz >= 900.0f && mhz <= 928.0f) return 4;
+    return 0;
+}
+
+uint8_t CC1101Sweep::test0(float mhz) {
+    switch (calibrationRange(mhz)) {
+        case 1: return mhz < 322.88f ? TEST0_LOW : TEST0_HIGH;
+        case 2: return mhz < 430.5f ? TEST0_LOW : TEST0_HIGH;
+        case 3: return mhz < 861.0f ? TEST0_LOW : TEST0_HIGH;
+        case 4: return TEST0_HIGH;
+        default: return 0;
+    }
+}
+
+uint8_t CC1101Sweep::fsctrl0(float mhz) const {
+    static const long limits[4][2] = {
+        {300, 348},
+        {378, 464},
+        {779, 899},
+        {900, 928}
+    };
+    uint8_t range = calibrationRange(mhz);
+    if (range == 0) return 0;
+    // Arduino's map() on the MHz truncated to a long, as the driver calls it
+    const long *in = limits[range - 1];
+    const uint8_t *out = _clb[range - 1];
+    return ((long)mhz - in[0]) * (out[1] - out[0]) / (in[1] - in[0]) + out[0];
+}
+
+void CC1101Sweep::setClb(uint8_t range, uint8_t start, uint8_t end) {
+    if (range < 1 || range > 4) return;
+    _clb[range - 1][0] = start;
+    _clb[range - 1][1] = end;
+}
+
+bool CC1101Sweep::plan(float startMHz, float endMHz, uint16_t columns, uint8_t pixelsPerPoint) {
+    _points.clear();
+    if (columns == 0) return false;
+    if (pixelsPerPoint == 0) pixelsPerPoint = 1;
+    if (startMHz > endMHz) {
+        float tmp = startMHz;
+        startMHz = endMHz;
+        endMHz = tmp;
+    }
+    if (startMHz < MIN_MHZ) startMHz = MIN_MHZ;
+    if (endMHz > MAX_MHZ) endMHz = MAX_MHZ;
+    if (startMHz > endMHz) return false;
+
+    _columns = columns;
+    _pixelsPerPoint = pixelsPerPoint;
+    uint16_t count = (columns + pixelsPerPoint - 1) / pixelsPerPoint;
+    _points.resize(count);
+
+    // Same spacing as one point per pixel, the points just skip pixels
+    float step = (endMHz - startMHz) / columns;
+    for (uint16_t i = 0; i < count; i++) {
+        uint32_t word = freqWord(startMHz + step * i * pixelsPerPoint);
+        Point &p = _points[i];
+        p.freq[0] = word >> 16;
+        p.freq[1] = word >> 8;
+        p.freq[2] = word;
+        p.mhz = wordToMHz(word);
+        p.band = band(p.mhz);
+        p.fsctrl0 = fsctrl0(p.mhz);
+        p.test0 = test0(p.mhz);
+    }
+    return true;
+}
+
+void CC1101Sweep::countSweep(uint32_t nowMs) {
+    if (_spsSweeps++ == 0) _spsStart = nowMs;
+    const uint32_t elapsed = nowMs - _spsStart;
+    if (elapsed >= 1000) {
+        _sps = (_spsSweeps - 1) * 1000.0f / elapsed;
+        _spsSweeps = 1;
+        _spsStart = nowMs;
+    }
+}
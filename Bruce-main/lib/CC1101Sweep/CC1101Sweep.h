@@ -0,0 +1,93 @@
+#ifndef __CC1101_SWEEP_H__
+#define __CC1101_SWEEP_H__
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Frequency plan for sweeping a CC1101 across a span, one point per screen
+ * column (or per 2 or 4 columns).
+ *
+ * The FREQ2/FREQ1/FREQ0 words of every point are worked out once, so retuning
+ * during the sweep is a single 3 byte burst write instead of the driver's
+ * setMHZ() loop. Points are grouped in bands: crossing into another band
+ * needs the driver's full setMHZ() (FSCAL2 and PA table fixes, and on T-Embed
+ * the antenna switch), tuning inside a band doesn't. Inside a band only the
+ * FSCTRL0 offset the driver's Calibrate() would write can change, each point
+ * carries it so it can be rewritten when it does.
+ *
+ * The band edges come from setMHZ() in src/modules/rf/rf_utils.cpp (antenna)
+ * and Calibrate() in SmartRC-CC1101-Driver-Lib (ELECHOUSE_CC1101_SRC_DRV.cpp):
+ *   - FSCTRL0 is map()ped from the clb offsets over 300-348, 378-464,
+ *     779-899 (applied up to 899.99) and 900-928 MHz, left alone elsewhere
+ *   - TEST0 is 0x0B below 322.88, 430.5 and 861 MHz in the first three
+ *     ranges, 0x09 above them and in the 900 MHz one, where FSCAL2 and the PA
+ *     table get fixed too
+ *
+ * No hardware access here, so the plan can be checked on the host.
+ */
+class CC1101Sweep {
+public:
+    static const uint32_t XTAL_HZ = 26000000;
+    static constexpr float MIN_MHZ = 280.0f;
+    static constexpr float MAX_MHZ = 928.0f;
+
+    static const uint8_t TEST0_LOW = 0x0B;
+    static const uint8_t TEST0_HIGH = 0x09;
+
+    struct Point {
+        float mhz;       // What the FREQ word actually tunes to
+        uint8_t freq[3]; // FREQ2, FREQ1, FREQ0, in register order
+        uint8_t band;
+        uint8_t fsctrl0; // What Calibrate() writes here, 0 where it writes nothing
+        uint8_t test0;   // Same, one value per band
+    };
+
+    // 24 bit FREQ register value, f_carrier = XTAL_HZ / 2^16 * word
+    static uint32_t freqWord(float mhz);
+    static float wordToMHz(uint32_t word);
+    // Antenna, calibration range and TEST0 value packed, the same number for
+    // frequencies setMHZ() treats alike
+    static uint8_t band(float mhz);
+    // Calibrate()'s range 1..4 for mhz, 0 outside them
+    static uint8_t calibrationRange(float mhz);
+    static uint8_t test0(float mhz);
+    uint8_t fsctrl0(float mhz) const;
+
+    // Same as the driver's setClb(), the offsets the radio was given. Call before plan().
+    void setClb(uint8_t range, uint8_t start, uint8_t end);
+
+    // Plans start..end (swapped if given backwards) over columns pixels, with
+    // one point every pixelsPerPoint pixels. The span is kept inside
+    // MIN_MHZ..MAX_MHZ.
+    bool plan(float startMHz, float endMHz, uint16_t columns, uint8_t pixelsPerPoint = 1);
+
+    uint16_t points() const { return _points.size(); }
+    const Point &point(uint16_t i) const { return _points[i]; }
+    uint16_t columns() const { return _columns; }
+    uint8_t pixelsPerPoint() const { return _pixelsPerPoint; }
+    // True when point i can be tuned from point i - 1 with just the FREQ words
+    bool sameBand(uint16_t i) const { return i > 0 && _points[i].band == _points[i - 1].band; }
+
+    // Sweeps per second, averaged over the last second
+    void countSweep(uint32_t nowMs);
+    float sweepsPerSecond() const { return _sps; }
+
+private:
+    // The driver's defaults
+    uint8_t _clb[4][2] = {
+        {24, 28},
+        {31, 38},
+        {65, 76},
+        {77, 79}
+    };
+    std::vector<Point> _points;
+    uint16_t _columns = 0;
+    uint8_t _pixelsPerPoint = 1;
+
+    uint32_t _spsSweeps = 0;
+    uint32_t _spsStart = 0;
+    float _sps = 0.0f;
+};
+
+#endif
@@ -80,6 +80,9 @@ public:
     uint64_t usedBytes();
     bool readRAW(uint8_t *buffer, uint32_t sector);
     bool writeRAW(uint8_t *buffer, uint32_t sector);
+    // count consecutive sectors in one multi-block command (CMD18/CMD25)
+    bool readRAW(uint8_t *buffer, uint32_t sector, uint32_t count);
+    bool writeRAW(const uint8_t *buffer, uint32_t sector, uint32_t count);
 };
 
 } // namespace fs
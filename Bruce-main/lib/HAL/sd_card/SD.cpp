@@ -16,6 +16,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "diskio_impl.h"
 #include "sd_diskio.h"
 #include "vfs_api.h"
 
@@ -109,5 +110,17 @@ bool SDFS::readRAW(uint8_t *buffer, uint32_t sector) { return sd_read_raw(_pdrv,
 
 bool SDFS::writeRAW(uint8_t *buffer, uint32_t sector) { return sd_write_raw(_pdrv, buffer, sector); }
 
+// Through the FatFs disk driver sd_diskio registered, it reads and writes runs of sectors
+// with one command instead of one command per sector
+bool SDFS::readRAW(uint8_t *buffer, uint32_t sector, uint32_t count) {
+    if (_pdrv == 0xFF || count == 0) return false;
+    return ff_disk_read(_pdrv, buffer, sector, count) == RES_OK;
+}
+
+bool SDFS::writeRAW(const uint8_t *buffer, uint32_t sector, uint32_t count) {
+    if (_pdrv == 0xFF || count == 0) return false;
+    return ff_disk_write(_pdrv, buffer, sector, count) == RES_OK;
+}
+
 SDFS SD = SDFS(FSImplPtr(new VFSImpl()));
 #endif
@@ -200,7 +200,7 @@ uint64_t SDFS::usedBytes() {
     return size;
 }
 
-// these next 4 functions need to be implemented, doesn't exist in Arduino-esp32 2.0.17
+// these next 6 functions need to be implemented, doesn't exist in Arduino-esp32 2.0.17
 size_t SDFS::numSectors() { return 0; }
 
 size_t SDFS::sectorSize() { return 0; }
@@ -209,6 +209,10 @@ bool SDFS::readRAW(uint8_t *buffer, uint32_t sector) { return false; }
 
 bool SDFS::writeRAW(uint8_t *buffer, uint32_t sector) { return false; }
 
+bool SDFS::readRAW(uint8_t *buffer, uint32_t sector, uint32_t count) { return false; }
+
+bool SDFS::writeRAW(const uint8_t *buffer, uint32_t sector, uint32_t count) { return false; }
+
 SDFS SD = SDFS(FSImplPtr(new VFSImpl()));
 #endif /* SOC_SDMMC_HOST_SUPPORTED */
 #endif
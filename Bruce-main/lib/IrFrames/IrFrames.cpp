@@ -0,0 +1,78 @@
+#include "IrFrames.h"
+
+void IrFrameClusters::clear() {
+    // The sums keep their memory for the next press
+    for (Cluster &cluster : _clusters) {
+        cluster.sum.clear();
+        cluster.members = 0;
+    }
+    _captures = 0;
+}
+
+static bool matches(const std::vector<uint32_t> &sum, uint16_t members, const uint16_t *durations) {
+    for (size_t i = 0; i < sum.size(); i++) {
+        uint32_t average = sum[i] / members;
+        uint32_t duration = durations[i];
+        uint32_t diff = average > duration ? average - duration : duration - average;
+        uint32_t larger = average > duration ? average : duration;
+        if (diff * 4 > larger + 400) return false;
+    }
+    return true;
+}
+
+void IrFrameClusters::add(const uint16_t *durations, uint16_t count) {
+    if (count == 0) return;
+    _captures++;
+
+    Cluster *empty = nullptr;
+    for (Cluster &cluster : _clusters) {
+        if (cluster.members == 0) {
+            if (!empty) empty = &cluster;
+        } else if (cluster.sum.size() == count && matches(cluster.sum, cluster.members, durations)) {
+            for (uint16_t i = 0; i < count; i++) cluster.sum[i] += durations[i];
+            cluster.members++;
+            return;
+        }
+    }
+    // A capture unlike all the others once every cluster is taken is dropped
+    if (!empty) return;
+    empty->sum.assign(durations, durations + count);
+    empty->members = 1;
+}
+
+uint16_t IrFrameClusters::canonical(uint16_t *out, uint16_t max) const {
+    const Cluster *best = nullptr;
+    for (const Cluster &cluster : _clusters) {
+        if (!cluster.members) continue;
+        if (!best || cluster.sum.size() > best->sum.size() ||
+            (cluster.sum.size() == best->sum.size() && cluster.members > best->members)) {
+            best = &cluster;
+        }
+    }
+    if (!best || best->sum.size() > max) return 0;
+
+    for (size_t i = 0; i < best->sum.size(); i++) {
+        out[i] = (best->sum[i] + best->members / 2) / best->members;
+    }
+    return best->sum.size();
+}
+
+size_t irFormatRaw(char *out, size_t size, const uint16_t *durations, uint16_t count) {
+    if (size == 0) return 0;
+    size_t len = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        char digits[5];
+        uint8_t n = 0;
+        uint16_t value = durations[i];
+        do {
+            digits[n++] = '0' + value % 10;
+            value /= 10;
+        } while (value);
+
+        if (len + n + (i ? 1 : 0) >= size) break;
+        if (i) out[len++] = ' ';
+        while (n) out[len++] = digits[--n];
+    }
+    out[len] = 0;
+    return len;
+}
@@ -0,0 +1,48 @@
+#ifndef __IR_FRAMES_H__
+#define __IR_FRAMES_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Groups the captures of a held IR button so it yields one clean capture.
+ *
+ * A remote keeps sending while a button is held: the same frame again, or a
+ * short repeat code after the first frame (NEC). Captures with the same
+ * number of durations, each within 25% + 100 us of the cluster average, are
+ * one cluster, and the canonical capture is that average, which also
+ * averages out the timing jitter of each capture.
+ *
+ * The cluster picked is the one with the longest captures, then the one
+ * with the most: the first frame often has a header or a repeat code
+ * appended the later ones don't have (NEC, JVC), and it's the one a
+ * decoder and a replay need.
+ * No Arduino dependencies, so tools/ir_replay.cpp builds it on a host.
+ */
+#define IR_FRAME_CLUSTERS 4
+
+class IrFrameClusters {
+public:
+    void clear();
+    // One capture in us, starting with a mark, alternating marks and spaces
+    void add(const uint16_t *durations, uint16_t count);
+    uint16_t captures() const { return _captures; }
+    // Average of the best cluster into out, its length, 0 if there is none or it's longer than max
+    uint16_t canonical(uint16_t *out, uint16_t max) const;
+
+private:
+    struct Cluster {
+        std::vector<uint32_t> sum; // Of each duration over the members
+        uint16_t members = 0;
+    };
+
+    Cluster _clusters[IR_FRAME_CLUSTERS];
+    uint16_t _captures = 0;
+};
+
+// Durations as decimal numbers separated by spaces, always null terminated.
+// Stops before a number that doesn't fit, returns the length written.
+size_t irFormatRaw(char *out, size_t size, const uint16_t *durations, uint16_t count);
+
+#endif
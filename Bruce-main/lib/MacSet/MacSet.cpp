@@ -0,0 +1,75 @@
+#include "MacSet.h"
+#include <stdlib.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+static uint64_t *allocSlots(uint32_t count) {
+#ifdef ARDUINO
+    if (psramFound()) return (uint64_t *)ps_malloc(count * sizeof(uint64_t));
+#endif
+    return (uint64_t *)malloc(count * sizeof(uint64_t));
+}
+
+// MACs of one vendor share the high bytes, so mix all of them into the low bits
+static uint32_t hashKey(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (uint32_t)key;
+}
+
+MacSet::~MacSet() { free(_slots); }
+
+uint64_t MacSet::key(const uint8_t mac[6]) {
+    uint64_t key = 0;
+    for (int i = 0; i < 6; i++) key = (key << 8) | mac[i];
+    return key;
+}
+
+uint32_t MacSet::slotOf(uint64_t key) const {
+    uint32_t mask = _capacity - 1;
+    uint32_t i = hashKey(key) & mask;
+    while (_slots[i] != EMPTY && _slots[i] != key) i = (i + 1) & mask;
+    return i;
+}
+
+bool MacSet::grow() {
+    uint32_t capacity = _capacity ? _capacity * 2 : INITIAL_CAPACITY;
+    uint64_t *slots = allocSlots(capacity);
+    if (!slots) return false;
+    for (uint32_t i = 0; i < capacity; i++) slots[i] = EMPTY;
+
+    uint64_t *old = _slots;
+    uint32_t oldCapacity = _capacity;
+    _slots = slots;
+    _capacity = capacity;
+    for (uint32_t i = 0; i < oldCapacity; i++)
+        if (old[i] != EMPTY) _slots[slotOf(old[i])] = old[i];
+    free(old);
+    return true;
+}
+
+bool MacSet::insert(uint64_t key) {
+    key &= 0xFFFFFFFFFFFFULL;
+    if (contains(key)) return false;
+    // Keep at least 1/4 of the slots free so probes stay short
+    if ((_size + 1) * 4 > _capacity * 3 && !grow()) {
+        if (_size + 1 >= _capacity) return true;
+    }
+    _slots[slotOf(key)] = key;
+    _size++;
+    return true;
+}
+
+bool MacSet::contains(uint64_t key) const {
+    if (!_slots) return false;
+    key &= 0xFFFFFFFFFFFFULL;
+    return _slots[slotOf(key)] == key;
+}
+
+void MacSet::clear() {
+    free(_slots);
+    _slots = nullptr;
+    _capacity = _size = 0;
+}
@@ -0,0 +1,46 @@
+#ifndef __MAC_SET_H__
+#define __MAC_SET_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Set of 48 bit MAC addresses (BSSIDs, BLE addresses) seen in a session.
+ *
+ * Open addressing with linear probing over one array of 64 bit keys, so an
+ * entry costs 8 bytes of table (about 11 with the free slots the load factor
+ * keeps) instead of a heap String plus a tree node per address. The table
+ * doubles when it's 3/4 full, in PSRAM when the board has it.
+ */
+class MacSet {
+public:
+    MacSet() {}
+    ~MacSet();
+    MacSet(const MacSet &) = delete;
+    MacSet &operator=(const MacSet &) = delete;
+
+    static uint64_t key(const uint8_t mac[6]);
+
+    // True if mac wasn't in the set yet. When the table can't grow (out of
+    // memory) new addresses are reported as new without being stored.
+    bool insert(const uint8_t mac[6]) { return insert(key(mac)); }
+    bool insert(uint64_t key);
+    bool contains(uint64_t key) const;
+    void clear();
+
+    uint32_t size() const { return _size; }
+    size_t memoryUsage() const { return _capacity * sizeof(uint64_t); }
+
+private:
+    static const uint32_t INITIAL_CAPACITY = 256;
+    static const uint64_t EMPTY = UINT64_MAX; // Not a 48 bit key
+
+    bool grow();
+    uint32_t slotOf(uint64_t key) const;
+
+    uint64_t *_slots = nullptr;
+    uint32_t _capacity = 0; // Power of 2
+    uint32_t _size = 0;
+};
+
+#endif
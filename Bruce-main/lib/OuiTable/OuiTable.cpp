@@ -0,0 +1,129 @@
+#include "OuiTable.h"
+#include <string.h>
+
+#define OUI_HEADER_SIZE 36
+#define OUI_POOL_OFFSET_SIZE 3
+
+static const uint8_t PREFIX_BYTES[3] = {3, 4, 5}; // 24, 28 and 36 bit prefixes
+
+static uint32_t readU32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static uint64_t readPrefix(const uint8_t *p, uint8_t bytes) {
+    uint64_t prefix = 0;
+    for (uint8_t i = 0; i < bytes; i++) prefix = (prefix << 8) | p[i];
+    return prefix;
+}
+
+uint64_t OuiTable::key36(const uint8_t mac[6]) {
+    uint64_t key = 0;
+    for (int i = 0; i < 5; i++) key = (key << 8) | mac[i];
+    return key >> 4;
+}
+
+bool OuiTable::begin(const uint8_t *data, size_t size) {
+    end();
+    _data = data;
+    _size = size;
+    return readHeader();
+}
+
+bool OuiTable::begin(ReadFn read, void *context, size_t size) {
+    end();
+    _read = read;
+    _context = context;
+    _size = size;
+    return readHeader();
+}
+
+void OuiTable::end() {
+    _data = nullptr;
+    _size = 0;
+    _read = nullptr;
+    _context = nullptr;
+    _ready = false;
+    memset(_count, 0, sizeof(_count));
+}
+
+bool OuiTable::read(uint32_t offset, uint8_t *out, uint32_t len) const {
+    if (_data) {
+        if (offset > _size || len > _size - offset) return false;
+        memcpy(out, _data + offset, len);
+        return true;
+    }
+    return _read && _read(_context, offset, out, len);
+}
+
+bool OuiTable::readHeader() {
+    uint8_t header[OUI_HEADER_SIZE];
+    if (!read(0, header, sizeof(header)) || memcmp(header, "OUI1", 4) != 0) return false;
+    for (int s = 0; s < 3; s++) {
+        _count[s] = readU32(header + 4 + 4 * s);
+        _offset[s] = readU32(header + 16 + 4 * s);
+    }
+    _poolOffset = readU32(header + 28);
+    _poolSize = readU32(header + 32);
+
+    // Everything must be inside the table, search() reads a mapped one without checks
+    for (int s = 0; s < 3; s++) {
+        uint64_t last = _offset[s] + (uint64_t)_count[s] * (PREFIX_BYTES[s] + OUI_POOL_OFFSET_SIZE);
+        if (_count[s] && (_offset[s] < OUI_HEADER_SIZE || last > _size)) return false;
+    }
+    if (_poolOffset < OUI_HEADER_SIZE || (uint64_t)_poolOffset + _poolSize > _size) return false;
+    _ready = true;
+    return true;
+}
+
+// Index of prefix in the section, or -(where it would go) - 1
+int64_t OuiTable::search(int section, uint64_t prefix, uint32_t low) const {
+    const uint8_t bytes = PREFIX_BYTES[section];
+    const uint8_t recordSize = bytes + OUI_POOL_OFFSET_SIZE;
+    uint32_t high = _count[section];
+    uint8_t record[8];
+
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const uint8_t *p;
+        if (_data) {
+            p = _data + _offset[section] + mid * recordSize;
+        } else {
+            if (!read(_offset[section] + mid * recordSize, record, bytes)) return -1;
+            p = record;
+        }
+        uint64_t value = readPrefix(p, bytes);
+        if (value == prefix) return mid;
+        if (value < prefix) low = mid + 1;
+        else high = mid;
+    }
+    return -(int64_t)low - 1;
+}
+
+bool OuiTable::lookup(const uint8_t mac[6], char *name, size_t size, Hint *hint) const {
+    if (!_ready || size == 0) return false;
+    const uint64_t key = key36(mac);
+    // Most specific first: MA-M and MA-S blocks are carved out of MA-L ones
+    const uint64_t prefixes[3] = {key >> 12, key >> 8, key};
+
+    for (int s = 2; s >= 0; s--) {
+        if (_count[s] == 0) continue;
+        uint32_t low = hint ? hint->low[s] : 0;
+        int64_t found = search(s, prefixes[s], low);
+        uint32_t at = found >= 0 ? found : -found - 1;
+        if (hint) hint->low[s] = at;
+        if (found < 0) continue;
+
+        const uint8_t bytes = PREFIX_BYTES[s];
+        uint8_t offset[OUI_POOL_OFFSET_SIZE];
+        if (!read(_offset[s] + at * (bytes + OUI_POOL_OFFSET_SIZE) + bytes, offset, sizeof(offset))) {
+            return false;
+        }
+        uint32_t nameOffset = offset[0] | (offset[1] << 8) | (offset[2] << 16);
+        if (nameOffset >= _poolSize) return false;
+        uint32_t len = _poolSize - nameOffset;
+        if (len > size - 1) len = size - 1;
+        if (len > OUI_NAME_MAX - 1) len = OUI_NAME_MAX - 1;
+        if (!read(_poolOffset + nameOffset, (uint8_t *)name, len)) return false;
+        name[len] = 0;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,67 @@
+#ifndef __OUI_TABLE_H__
+#define __OUI_TABLE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Offline MAC vendor lookup, over the table tools/oui_pack.py builds from the
+ * IEEE MA-L, MA-M and MA-S registries.
+ *
+ * Table layout, little endian:
+ *   header   "OUI1", u32 count[3], u32 offset[3], u32 poolOffset, u32 poolSize
+ *   records  one section per prefix length (24, 28 and 36 bits), sorted: the
+ *            prefix big endian in 3, 4 or 5 bytes, then the vendor offset in
+ *            the pool (u24)
+ *   pool     vendor names, null terminated, each name stored once
+ *
+ * A lookup is a binary search per section, most specific first. The table is
+ * either memory mapped (a flash partition, a file loaded on a host) or read
+ * through a callback (a file on SD), a few bytes per probe.
+ * No Arduino dependencies, so tools/oui_bench.cpp builds it on a host.
+ */
+#define OUI_NAME_MAX 48 // Names are cut to this, terminator included
+
+class OuiTable {
+public:
+    // Reads len bytes at offset of the table, false if it can't
+    typedef bool (*ReadFn)(void *context, uint32_t offset, uint8_t *out, uint32_t len);
+
+    // Where the last lookup ended in each section. Looking up MACs in
+    // ascending order with the same hint only searches past it.
+    struct Hint {
+        uint32_t low[3] = {0, 0, 0};
+    };
+
+    // False if the header isn't a table's or a section or the pool doesn't fit in size
+    bool begin(const uint8_t *data, size_t size);
+    bool begin(ReadFn read, void *context, size_t size);
+    void end();
+    bool ready() const { return _ready; }
+
+    // Vendor of mac into name, false if its prefix isn't registered
+    bool lookup(const uint8_t mac[6], char *name, size_t size, Hint *hint = nullptr) const;
+
+    uint32_t count() const { return _count[0] + _count[1] + _count[2]; }
+
+    // Key of the 36 bit prefix, every MAC with the same key has the same vendor
+    static uint64_t key36(const uint8_t mac[6]);
+
+private:
+    bool read(uint32_t offset, uint8_t *out, uint32_t len) const;
+    bool readHeader();
+    int64_t search(int section, uint64_t prefix, uint32_t low) const;
+
+    const uint8_t *_data = nullptr;
+    size_t _size = 0;
+    ReadFn _read = nullptr;
+    void *_context = nullptr;
+    bool _ready = false;
+
+    uint32_t _count[3] = {0, 0, 0};
+    uint32_t _offset[3] = {0, 0, 0};
+    uint32_t _poolOffset = 0;
+    uint32_t _poolSize = 0;
+};
+
+#endif
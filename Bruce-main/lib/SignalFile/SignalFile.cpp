@@ -0,0 +1,232 @@
+#include "SignalFile.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Only index files big enough for a second scan to hurt
+#define SIGNAL_INDEX_MIN_SIZE 8192
+
+static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+bool SignalSpan::equals(const char *text) const { return strncmp(str, text, len) == 0 && text[len] == '\0'; }
+
+long SignalSpan::toInt() const { return strtol(str, nullptr, 10); }
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Reader
+/////////////////////////////////////////////////////////////////////////////////////
+SignalReader::SignalReader(size_t bufferSize) : _capacity(bufferSize < 64 ? 64 : bufferSize) {}
+
+SignalReader::~SignalReader() { free(_buffer); }
+
+bool SignalReader::begin(SignalSource *source) {
+    _source = source;
+    if (!_buffer) _buffer = (char *)malloc(_capacity);
+    if (!_buffer) return false;
+    _skipped = 0;
+    _offset = _start = _end = 0;
+    _lineValid = false;
+    if (!_source || !_source->seek(0)) return false;
+    _eof = false;
+    return true;
+}
+
+bool SignalReader::seek(uint32_t offset) {
+    // Walking records in order usually lands on the line just read, or on one
+    // still in the buffer. Lines already parsed were modified, so they can't be
+    // scanned again.
+    _unread = _lineValid && offset == _lineOffset;
+    if (_unread) return true;
+    if (offset >= _offset + _start && offset <= _offset + _end) {
+        _start = offset - _offset;
+        return true;
+    }
+    if (!_source || !_source->seek(offset)) return false;
+    _offset = offset;
+    _start = _end = 0;
+    _eof = false;
+    _lineValid = false;
+    return true;
+}
+
+// Moves the unread data to the front and reads more after it.
+// False if the line doesn't fit even in a MAX_LINE buffer.
+bool SignalReader::fill() {
+    if (_start > 0) {
+        memmove(_buffer, _buffer + _start, _end - _start);
+        _offset += _start;
+        _end -= _start;
+        _start = 0;
+    }
+    // Keep a byte for the terminator of a last line without '\n'
+    if (_end + 1 >= _capacity) {
+        if (_capacity >= MAX_LINE) return false;
+        size_t capacity = _capacity * 2 > MAX_LINE ? MAX_LINE : _capacity * 2;
+        char *buffer = (char *)realloc(_buffer, capacity);
+        if (!buffer) return false;
+        _buffer = buffer;
+        _capacity = capacity;
+    }
+    size_t n = _source->read((uint8_t *)_buffer + _end, _capacity - 1 - _end);
+    if (n == 0) _eof = true;
+    _end += n;
+    return true;
+}
+
+void SignalReader::parse(char *line, char *end) {
+    _lineOffset = _offset + (line - _buffer);
+    _lineValid = true;
+    while (line < end && isBlank(*line)) line++;
+    while (end > line && isBlank(end[-1])) end--;
+    *end = '\0';
+
+    _comment = line < end && *line == '#';
+    char *colon = _comment ? nullptr : (char *)memchr(line, ':', end - line);
+    if (!colon) {
+        _key.str = end;
+        _key.len = 0;
+        _value.str = line;
+        _value.len = end - line;
+        return;
+    }
+
+    char *keyEnd = colon;
+    while (keyEnd > line && isBlank(keyEnd[-1])) keyEnd--;
+    _key.str = line;
+    _key.len = keyEnd - line;
+
+    char *value = colon + 1;
+    while (value < end && isBlank(*value)) value++;
+    _value.str = value;
+    _value.len = end - value;
+}
+
+bool SignalReader::next() {
+    if (_unread) {
+        _unread = false;
+        return true;
+    }
+    if (!_buffer) return false;
+    _lineValid = false; // fill() may move it
+
+    bool skipping = false; // In the middle of a line too long to keep
+    for (;;) {
+        char *line = _buffer + _start;
+        char *nl = (char *)memchr(line, '\n', _end - _start);
+        if (!nl) {
+            if (!_eof) {
+                if (!fill()) {
+                    // Drop what there is of the line and look for its end
+                    skipping = true;
+                    _start = _end;
+                    fill();
+                }
+                continue;
+            }
+            if (_start == _end) return false;
+            nl = _buffer + _end; // Last line, no '\n'
+        }
+        _start = nl - _buffer + (nl < _buffer + _end ? 1 : 0);
+        if (skipping) {
+            skipping = false;
+            _skipped++;
+            continue;
+        }
+        parse(line, nl);
+        if (_comment || _key.len > 0 || _value.len > 0) return true;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Index
+/////////////////////////////////////////////////////////////////////////////////////
+SignalIndex::SignalIndex(const char *const *keys) : _keys(keys) {
+    // FNV-1a over the key names, so an .idx built for other keys isn't used
+    _keysHash = 2166136261u;
+    for (const char *const *k = keys; *k; k++) {
+        for (const char *c = *k; *c; c++) _keysHash = (_keysHash ^ (uint8_t)*c) * 16777619u;
+        _keysHash = (_keysHash ^ 0) * 16777619u;
+    }
+}
+
+bool SignalIndex::isRecordStart(const SignalReader &reader) const {
+    for (const char *const *k = _keys; *k; k++)
+        if (reader.is(*k)) return true;
+    return false;
+}
+
+bool SignalIndex::build(SignalReader &reader, uint32_t fileSize, uint32_t fileTime) {
+    _offsets.clear();
+    _fileSize = fileSize;
+    _fileTime = fileTime;
+    if (!reader.seek(0)) return false;
+    while (reader.next())
+        if (isRecordStart(reader)) _offsets.push_back(reader.lineOffset());
+    return true;
+}
+
+bool SignalIndex::load(SignalSource &sidecar, uint32_t fileSize, uint32_t fileTime) {
+    Header h;
+    _offsets.clear();
+    if (!sidecar.seek(0) || sidecar.read((uint8_t *)&h, sizeof(h)) != sizeof(h)) return false;
+    if (h.magic != MAGIC || h.keysHash != _keysHash || h.fileSize != fileSize || h.fileTime != fileTime)
+        return false;
+    if (h.count > fileSize / 4) return false; // can't have more records than that
+
+    _offsets.resize(h.count);
+    size_t bytes = h.count * sizeof(uint32_t);
+    if (sidecar.read((uint8_t *)_offsets.data(), bytes) != bytes) {
+        _offsets.clear();
+        return false;
+    }
+    _fileSize = fileSize;
+    _fileTime = fileTime;
+    return true;
+}
+
+SignalIndex::Header SignalIndex::header() const {
+    Header h;
+    h.magic = MAGIC;
+    h.keysHash = _keysHash;
+    h.fileSize = _fileSize;
+    h.fileTime = _fileTime;
+    h.count = _offsets.size();
+    return h;
+}
+
+bool SignalIndex::seek(SignalReader &reader, uint32_t record) const {
+    if (record >= _offsets.size() || !reader.seek(_offsets[record]) || !reader.next()) return false;
+    if (!isRecordStart(reader) || reader.lineOffset() != _offsets[record]) return false;
+    reader.unread();
+    return true;
+}
+
+#ifdef ARDUINO
+bool openSignalIndex(fs::FS &fs, const String &path, fs::File &file, SignalReader &reader, SignalIndex &index) {
+    uint32_t fileSize = file.size();
+    uint32_t fileTime = file.getLastWrite();
+    String idxPath = path + ".idx";
+
+    if (fs.exists(idxPath)) {
+        File idxFile = fs.open(idxPath, FILE_READ);
+        if (idxFile) {
+            FileSignalSource sidecar(idxFile);
+            bool loaded = index.load(sidecar, fileSize, fileTime);
+            idxFile.close();
+            if (loaded) return true;
+        }
+    }
+
+    if (!index.build(reader, fileSize, fileTime)) return false;
+    if (fileSize < SIGNAL_INDEX_MIN_SIZE) return true;
+
+    // Saving is only a cache, it doesn't matter if it fails (read only or full storage)
+    File idxFile = fs.open(idxPath, FILE_WRITE);
+    if (idxFile) {
+        SignalIndex::Header h = index.header();
+        idxFile.write((const uint8_t *)&h, sizeof(h));
+        idxFile.write((const uint8_t *)index.offsets(), index.count() * sizeof(uint32_t));
+        idxFile.close();
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,141 @@
+#ifndef __SIGNAL_FILE_H__
+#define __SIGNAL_FILE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Readers for the Flipper style "key: value" files (.ir, .sub).
+ *
+ * SignalReader tokenizes the file line by line inside one read buffer. The
+ * key and value it returns point into that buffer (the value is trimmed and
+ * NUL terminated in place), so parsing allocates nothing. The buffer only
+ * grows when a line is longer than any line seen so far.
+ *
+ * SignalIndex keeps the offset of every record (a line with one of the given
+ * keys, e.g. "name" for IR databases), so the record count and seeking to
+ * record N don't need a scan. It can be saved next to the file as a .idx
+ * sidecar and is rebuilt when the file changes.
+ *
+ * The file is read through SignalSource, so all of this also runs on the host.
+ */
+
+class SignalSource {
+public:
+    virtual ~SignalSource() {}
+    virtual size_t read(uint8_t *buffer, size_t size) = 0;
+    virtual bool seek(uint32_t offset) = 0;
+};
+
+struct SignalSpan {
+    const char *str = "";
+    uint16_t len = 0;
+
+    bool equals(const char *text) const;
+    bool empty() const { return len == 0; }
+    long toInt() const;
+};
+
+class SignalReader {
+public:
+    static const size_t MAX_LINE = 16384; // Longer lines are skipped
+
+    explicit SignalReader(size_t bufferSize = 1024);
+    ~SignalReader();
+
+    // Reads from the start of the source
+    bool begin(SignalSource *source);
+    bool seek(uint32_t offset);
+
+    // Next line with something on it, false at the end of the file
+    bool next();
+    // Makes next() return the current line again
+    void unread() { _unread = true; }
+
+    // "key: value" lines. Lines without ':' have an empty key.
+    const SignalSpan &key() const { return _key; }
+    const SignalSpan &value() const { return _value; }
+    bool is(const char *key) const { return _key.equals(key); }
+    bool isComment() const { return _comment; }
+    // File offset where the current line starts
+    uint32_t lineOffset() const { return _lineOffset; }
+    uint32_t skippedLines() const { return _skipped; }
+
+private:
+    bool fill();
+    void parse(char *line, char *end);
+
+    SignalSource *_source = nullptr;
+    char *_buffer = nullptr;
+    size_t _capacity = 0;
+    size_t _start = 0;    // First unread byte
+    size_t _end = 0;      // End of the data read
+    uint32_t _offset = 0; // File offset of _buffer[0]
+    bool _eof = false;
+    bool _unread = false;
+    bool _lineValid = false;
+    bool _comment = false;
+    uint32_t _lineOffset = 0;
+    uint32_t _skipped = 0;
+    SignalSpan _key;
+    SignalSpan _value;
+};
+
+class SignalIndex {
+public:
+    struct Header {
+        uint32_t magic;
+        uint32_t keysHash; // Which keys start a record
+        uint32_t fileSize; // Of the indexed file, to tell when it's stale
+        uint32_t fileTime;
+        uint32_t count;
+    };
+    static const uint32_t MAGIC = 0x31584449; // "IDX1"
+
+    // keys is a nullptr terminated list, e.g. {"name", nullptr}
+    explicit SignalIndex(const char *const *keys);
+
+    // Scans the whole file
+    bool build(SignalReader &reader, uint32_t fileSize, uint32_t fileTime);
+    // Loads a sidecar, false if it's malformed or doesn't match the file
+    bool load(SignalSource &sidecar, uint32_t fileSize, uint32_t fileTime);
+    // What to write in the sidecar: the header, then offsets() as count() uint32_t
+    Header header() const;
+
+    uint32_t count() const { return _offsets.size(); }
+    uint32_t offset(uint32_t record) const { return _offsets[record]; }
+    const uint32_t *offsets() const { return _offsets.data(); }
+
+    // Positions the reader on the first line of record N. False if the index
+    // doesn't match the file after all.
+    bool seek(SignalReader &reader, uint32_t record) const;
+    bool isRecordStart(const SignalReader &reader) const;
+
+private:
+    const char *const *_keys;
+    uint32_t _keysHash;
+    uint32_t _fileSize = 0;
+    uint32_t _fileTime = 0;
+    std::vector<uint32_t> _offsets;
+};
+
+#ifdef ARDUINO
+#include <FS.h>
+
+class FileSignalSource : public SignalSource {
+public:
+    explicit FileSignalSource(fs::File &file) : _file(file) {}
+    size_t read(uint8_t *buffer, size_t size) override { return _file.read(buffer, size); }
+    bool seek(uint32_t offset) override { return _file.seek(offset); }
+
+private:
+    fs::File &_file;
+};
+
+// Loads path + ".idx", or builds the index with reader (already reading file)
+// and saves it when the file is large enough for that to pay off
+bool openSignalIndex(fs::FS &fs, const String &path, fs::File &file, SignalReader &reader, SignalIndex &index);
+#endif
+
+#endif
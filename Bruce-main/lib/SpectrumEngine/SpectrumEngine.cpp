@@ -0,0 +1,236 @@
+#include "SpectrumEngine.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include <esp_heap_caps.h>
+#if !defined(SPECTRUM_NO_ESP_DSP) && __has_include(<esp_dsp.h>)
+#include <esp_dsp.h>
+#define SPECTRUM_ESP_DSP 1
+#endif
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// 10 * log10(2), converts log2 power to dB
+static const float kDbPerLog2 = 3.0103f;
+
+// The FFT tables are hot, so prefer internal RAM and fall back to PSRAM.
+// ESP-DSP wants 16 byte aligned buffers on the S3.
+static void *spectrumAlloc(size_t bytes) {
+#if defined(ESP_PLATFORM)
+    void *p = heap_caps_aligned_alloc(16, bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!p) p = heap_caps_aligned_alloc(16, bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    return p;
+#else
+    return malloc(bytes);
+#endif
+}
+
+static void spectrumFree(void *p) {
+#if defined(ESP_PLATFORM)
+    heap_caps_free(p);
+#else
+    free(p);
+#endif
+}
+
+SpectrumEngine::SpectrumEngine(uint16_t fftSize) : _size(fftSize) {
+    // Round down to a power of two, minimum 16 samples
+    uint16_t size = 16;
+    while (size * 2 <= fftSize && size < 32768) size *= 2;
+    _size = size;
+    setRange(-100.0f, -30.0f);
+}
+
+SpectrumEngine::~SpectrumEngine() { end(); }
+
+bool SpectrumEngine::begin() {
+    if (ready()) return true;
+    const uint16_t half = _size / 2;
+
+    _window = (float *)spectrumAlloc(_size * sizeof(float));
+    _twiddle = (float *)spectrumAlloc(half * 2 * sizeof(float));
+    _work = (float *)spectrumAlloc(half * 2 * sizeof(float));
+    _power = (float *)spectrumAlloc(half * sizeof(float));
+    if (!_window || !_twiddle || !_work || !_power) {
+        end();
+        return false;
+    }
+
+    // Hann window, with the int16 -> float scaling folded in
+    float sum = 0;
+    for (uint16_t n = 0; n < _size; n++) {
+        float w = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * n / _size);
+        sum += w;
+        _window[n] = w / 32768.0f;
+    }
+    // A full scale sine peaks at sum / 2, report that as 1.0
+    _powerScale = 4.0f / (sum * sum);
+
+    for (uint16_t k = 0; k < half; k++) {
+        _twiddle[2 * k] = cosf(2.0f * (float)M_PI * k / _size);
+        _twiddle[2 * k + 1] = -sinf(2.0f * (float)M_PI * k / _size);
+    }
+
+    // log2(m) for the mantissa m in [0.5, 1], used by level()
+    for (uint8_t i = 0; i <= 64; i++) _log2Table[i] = log2f(0.5f + i / 128.0f);
+
+#ifdef SPECTRUM_ESP_DSP
+    _espDsp = dsps_fft2r_init_fc32(NULL, half) == ESP_OK;
+#endif
+    if (!_espDsp) {
+        _bitrev = (uint16_t *)spectrumAlloc(half * sizeof(uint16_t));
+        if (!_bitrev) {
+            end();
+            return false;
+        }
+        uint8_t bits = 0;
+        while ((1U << bits) < half) bits++;
+        for (uint16_t i = 0; i < half; i++) {
+            uint16_t r = 0;
+            for (uint8_t b = 0; b < bits; b++) r |= ((i >> b) & 1) << (bits - 1 - b);
+            _bitrev[i] = r;
+        }
+    }
+
+    reset();
+    return true;
+}
+
+void SpectrumEngine::end() {
+#ifdef SPECTRUM_ESP_DSP
+    if (_espDsp) dsps_fft2r_deinit_fc32();
+#endif
+    _espDsp = false;
+    spectrumFree(_window);
+    spectrumFree(_twiddle);
+    spectrumFree(_work);
+    spectrumFree(_power);
+    spectrumFree(_bitrev);
+    _window = _twiddle = _work = _power = nullptr;
+    _bitrev = nullptr;
+}
+
+// In-place complex FFT of size / 2 points, interleaved re/im
+void SpectrumEngine::fft(float *data) {
+    const uint16_t n = _size / 2;
+#ifdef SPECTRUM_ESP_DSP
+    if (_espDsp) {
+        dsps_fft2r_fc32(data, n);
+        dsps_bit_rev_fc32(data, n);
+        return;
+    }
+#endif
+    for (uint16_t i = 0; i < n; i++) {
+        uint16_t j = _bitrev[i];
+        if (j > i) {
+            float tr = data[2 * i], ti = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = tr;
+            data[2 * j + 1] = ti;
+        }
+    }
+    for (uint16_t len = 2; len <= n; len <<= 1) {
+        const uint16_t halfLen = len / 2;
+        const uint16_t step = _size / len; // W_len^k == W_size^(k * step)
+        for (uint16_t start = 0; start < n; start += len) {
+            for (uint16_t k = 0; k < halfLen; k++) {
+                const float wr = _twiddle[2 * k * step];
+                const float wi = _twiddle[2 * k * step + 1];
+                float *a = &data[2 * (start + k)];
+                float *b = &data[2 * (start + k + halfLen)];
+                const float tr = b[0] * wr - b[1] * wi;
+                const float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+
+void SpectrumEngine::process(const int16_t *samples) {
+    if (!ready()) return;
+    const uint16_t half = _size / 2;
+
+    // Even samples go in the real part, odd ones in the imaginary part
+    for (uint16_t n = 0; n < _size; n++) _work[n] = samples[n] * _window[n];
+
+    fft(_work);
+
+    // Split the packed result back into the spectrum of the real signal
+    _power[0] = (_work[0] + _work[1]) * (_work[0] + _work[1]) * _powerScale;
+    for (uint16_t k = 1; k < half; k++) {
+        const float ar = _work[2 * k], ai = _work[2 * k + 1];
+        const float br = _work[2 * (half - k)], bi = -_work[2 * (half - k) + 1];
+        const float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+        const float or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);
+        const float wr = _twiddle[2 * k], wi = _twiddle[2 * k + 1];
+        const float xr = er + or_ * wr - oi * wi;
+        const float xi = ei + or_ * wi + oi * wr;
+        _power[k] = (xr * xr + xi * xi) * _powerScale;
+    }
+}
+
+void SpectrumEngine::reset() {
+    if (_power) memset(_power, 0, bins() * sizeof(float));
+    _frames = _fpsFrames = _fpsStart = 0;
+    _fps = 0;
+}
+
+float SpectrumEngine::log2Power(float p) const {
+    if (!(p > 0.0f)) return -1000.0f;
+    int e;
+    const float m = frexpf(p, &e); // p = m * 2^e, m in [0.5, 1)
+    const float f = (m - 0.5f) * 128.0f;
+    const uint8_t i = (uint8_t)f;
+    return e + _log2Table[i] + (_log2Table[i + 1] - _log2Table[i]) * (f - i);
+}
+
+float SpectrumEngine::powerDb(uint16_t bin) const {
+    if (!ready() || bin >= bins()) return -1000.0f;
+    return log2Power(_power[bin]) * kDbPerLog2;
+}
+
+uint16_t SpectrumEngine::peakBin() const {
+    if (!ready()) return 0;
+    uint16_t peak = 1;
+    for (uint16_t k = 2; k < bins(); k++)
+        if (_power[k] > _power[peak]) peak = k;
+    return peak;
+}
+
+void SpectrumEngine::setRange(float floorDb, float ceilDb) {
+    if (ceilDb <= floorDb) ceilDb = floorDb + 1.0f;
+    _levelFloor = floorDb / kDbPerLog2;
+    _levelScale = 255.0f * kDbPerLog2 / (ceilDb - floorDb);
+}
+
+uint8_t SpectrumEngine::level(uint16_t bin) const {
+    if (!ready() || bin >= bins()) return 0;
+    const float v = (log2Power(_power[bin]) - _levelFloor) * _levelScale;
+    if (v <= 0.0f) return 0;
+    if (v >= 255.0f) return 255;
+    return (uint8_t)v;
+}
+
+void SpectrumEngine::levels(uint8_t *out, uint16_t firstBin, uint16_t count) const {
+    for (uint16_t i = 0; i < count; i++) out[i] = level(firstBin + i);
+}
+
+void SpectrumEngine::countFrame(uint32_t nowMs) {
+    _frames++;
+    if (_fpsFrames++ == 0) _fpsStart = nowMs;
+    const uint32_t elapsed = nowMs - _fpsStart;
+    if (elapsed >= 1000) {
+        _fps = (_fpsFrames - 1) * 1000.0f / elapsed;
+        _fpsFrames = 1;
+        _fpsStart = nowMs;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef __SPECTRUM_ENGINE_H__
+#define __SPECTRUM_ENGINE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Long-lived real FFT for 16-bit audio frames.
+ *
+ * Everything the transform needs (Hann window, twiddles, bit reversal and the
+ * log2 table used to turn power into display levels) is built once in begin()
+ * and reused for every frame, so process() does no allocation.
+ * The N real samples are packed into an N/2 point complex FFT and split
+ * afterwards. The complex FFT uses ESP-DSP when the framework ships it, and a
+ * portable radix-2 version otherwise (host builds, or -DSPECTRUM_NO_ESP_DSP).
+ */
+class SpectrumEngine {
+public:
+    explicit SpectrumEngine(uint16_t fftSize = 1024);
+    ~SpectrumEngine();
+
+    bool begin();
+    void end();
+    bool ready() const { return _window != nullptr; }
+
+    uint16_t size() const { return _size; }
+    uint16_t bins() const { return _size / 2; }
+
+    // Window and transform one frame of size() samples
+    void process(const int16_t *samples);
+    // Clear the last spectrum and the frame counters
+    void reset();
+
+    // Power of each bin from the last frame, 1.0 is a full scale sine
+    const float *power() const { return _power; }
+    float powerDb(uint16_t bin) const;
+    uint16_t peakBin() const;
+    float binFrequency(uint16_t bin, uint32_t sampleRate) const {
+        return (float)bin * sampleRate / _size;
+    }
+
+    // Levels map floorDb..ceilDb to 0..255
+    void setRange(float floorDb, float ceilDb);
+    uint8_t level(uint16_t bin) const;
+    void levels(uint8_t *out, uint16_t firstBin, uint16_t count) const;
+
+    // Frames per second, averaged over the last second
+    void countFrame(uint32_t nowMs);
+    float framesPerSecond() const { return _fps; }
+    uint32_t frames() const { return _frames; }
+
+private:
+    void fft(float *data);
+    float log2Power(float p) const;
+
+    uint16_t _size;
+    float *_window = nullptr;   // [size]
+    float *_twiddle = nullptr;  // [size / 2] complex, e^(-2*pi*i*k/size)
+    float *_work = nullptr;     // [size / 2] complex
+    float *_power = nullptr;    // [size / 2]
+    uint16_t *_bitrev = nullptr; // [size / 2], portable FFT only
+    float _log2Table[65];
+    float _powerScale = 1.0f;
+    float _levelFloor = 0.0f;   // log2 power at level 0
+    float _levelScale = 0.0f;   // levels per log2 step
+    bool _espDsp = false;
+
+    uint32_t _frames = 0;
+    uint32_t _fpsFrames = 0;
+    uint32_t _fpsStart = 0;
+    float _fps = 0.0f;
+};
+
+#endif
@@ -0,0 +1,287 @@
+#include "TrackJournal.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const uint16_t TRACK_VERSION = 1;
+
+static int32_t toE7(double degrees) { return (int32_t)lround(degrees * 1e7); }
+
+// "-12.3456789" from 1e-7 degrees, without going through floating point
+static int formatE7(char *out, size_t size, int32_t value) {
+    uint32_t abs = value < 0 ? -(int64_t)value : value;
+    return snprintf(
+        out, size, "%s%lu.%07lu", value < 0 ? "-" : "", (unsigned long)(abs / 10000000),
+        (unsigned long)(abs % 10000000)
+    );
+}
+
+// "2024-11-20T12:34:56Z"
+static void formatTime(char *out, size_t size, uint32_t time) {
+    // Civil date from days since 1970-01-01 (Howard Hinnant's algorithm)
+    int32_t days = time / 86400;
+    uint32_t secs = time % 86400;
+    days += 719468;
+    int32_t era = days / 146097;
+    uint32_t doe = days - era * 146097;
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int32_t year = yoe + era * 400;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    uint32_t day = doy - (153 * mp + 2) / 5 + 1;
+    uint32_t month = mp < 10 ? mp + 3 : mp - 9;
+    if (month <= 2) year++;
+    snprintf(
+        out, size, "%04ld-%02lu-%02luT%02lu:%02lu:%02luZ", (long)year, (unsigned long)month,
+        (unsigned long)day, (unsigned long)(secs / 3600), (unsigned long)(secs / 60 % 60),
+        (unsigned long)(secs % 60)
+    );
+}
+
+uint32_t trackUnixTime(int year, int month, int day, int hour, int minute, int second) {
+    // Days since 1970-01-01 from a civil date (Howard Hinnant's algorithm)
+    year -= month <= 2;
+    int32_t era = year / 400;
+    uint32_t yoe = year - era * 400;
+    uint32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int32_t days = era * 146097 + doe - 719468;
+    return days * 86400u + hour * 3600u + minute * 60u + second;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Point
+/////////////////////////////////////////////////////////////////////////////////////
+TrackPoint TrackPoint::make(double lat, double lng, double ele, double hdop, uint32_t sats, uint32_t time) {
+    TrackPoint p;
+    p.lat = toE7(lat);
+    p.lng = toE7(lng);
+    p.time = time;
+    p.ele = ele < -32768 ? -32768 : ele > 32767 ? 32767 : (int16_t)lround(ele);
+    p.hdop = hdop < 0 ? 255 : hdop >= 25.5 ? 255 : (uint8_t)lround(hdop * 10);
+    p.sats = sats > 255 ? 255 : sats;
+    return p;
+}
+
+bool TrackPoint::valid() const {
+    // Also rejects the zeros a cut write can leave
+    if (lat == 0 && lng == 0 && time == 0) return false;
+    return lat >= -900000000 && lat <= 900000000 && lng >= -1800000000 && lng <= 1800000000;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Writer
+/////////////////////////////////////////////////////////////////////////////////////
+void TrackWriter::begin(uint32_t created) {
+    TrackHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = TrackHeader::MAGIC;
+    h.version = TRACK_VERSION;
+    h.pointSize = sizeof(TrackPoint);
+    h.created = created;
+    memcpy(_block, &h, sizeof(h));
+    _used = sizeof(h);
+    _flushed = 0;
+    _count = _written = 0;
+}
+
+bool TrackWriter::add(const TrackPoint &point) {
+    if (_used == BLOCK_SIZE && !flush()) return false;
+    memcpy(_block + _used, &point, sizeof(point));
+    _used += sizeof(point);
+    _count++;
+    if (_used < BLOCK_SIZE) return true;
+    return flush();
+}
+
+bool TrackWriter::flush() {
+    if (_used == _flushed) return true;
+    // After a short write the next try resumes where it stopped, writing the
+    // block again would put the points after it out of step
+    _flushed += _sink.append(_block + _flushed, _used - _flushed);
+    if (_flushed < _used) return false;
+    _used = _flushed = 0;
+    _written = _count;
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Reader
+/////////////////////////////////////////////////////////////////////////////////////
+bool TrackReader::begin() {
+    _count = _read = 0;
+    uint32_t size = _source.size();
+    if (size < sizeof(TrackHeader)) return false;
+    if (_source.read((uint8_t *)&_header, sizeof(_header)) != sizeof(_header)) return false;
+    if (_header.magic != TrackHeader::MAGIC || _header.pointSize != sizeof(TrackPoint)) return false;
+    _count = (size - sizeof(TrackHeader)) / sizeof(TrackPoint);
+    return true;
+}
+
+bool TrackReader::next(TrackPoint &point) {
+    while (_read < _count) {
+        _read++;
+        if (_source.read((uint8_t *)&point, sizeof(point)) != sizeof(point)) {
+            _count = _read - 1;
+            return false;
+        }
+        if (point.valid()) return true;
+    }
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Export
+/////////////////////////////////////////////////////////////////////////////////////
+static const char GPX_HEADER[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+    "<gpx version=\"1.1\" creator=\"Bruce Firmware\" xmlns=\"http://www.topografix.com/GPX/1/1\"\n"
+    "  xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"\n"
+    "  xsi:schemaLocation=\"http://www.topografix.com/GPX/1/1 http://www.topografix.com/GPX/1/1/gpx.xsd\">\n"
+    "  <metadata>\n"
+    "    <name>Bruce GPS Tracker</name>\n"
+    "    <desc>GPS Tracker using Bruce Firmware</desc>\n"
+    "    <link href=\"https://bruce.computer\">\n"
+    "      <text>Bruce Website</text>\n"
+    "    </link>\n"
+    "  </metadata>\n"
+    "  <trk>\n"
+    "    <name>Bruce Route</name>\n"
+    "    <desc>GPS route captured by Bruce firmware</desc>\n"
+    "    <trkseg>\n";
+static const char GPX_FOOTER[] = "    </trkseg>\n  </trk>\n</gpx>\n";
+
+static const char GEOJSON_HEADER[] =
+    "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"properties\":"
+    "{\"name\":\"Bruce Route\"},\"geometry\":{\"type\":\"LineString\",\"coordinates\":[";
+static const char GEOJSON_FOOTER[] = "\n]}}]}\n";
+
+const char *TrackExport::contentType(Format format) {
+    return format == GPX ? "application/gpx+xml" : "application/geo+json";
+}
+
+const char *TrackExport::extension(Format format) { return format == GPX ? ".gpx" : ".geojson"; }
+
+bool TrackExport::begin() {
+    _state = DONE;
+    _pendingLength = 0;
+    if (!_reader.begin()) return false;
+    _state = HEADER;
+    _first = true;
+    return true;
+}
+
+void TrackExport::renderPoint(const TrackPoint &p) {
+    char lat[16], lng[16];
+    formatE7(lat, sizeof(lat), p.lat);
+    formatE7(lng, sizeof(lng), p.lng);
+
+    int n;
+    if (_format == GEOJSON) {
+        n = snprintf(_text, sizeof(_text), "%s\n[%s,%s,%d]", _first ? "" : ",", lng, lat, p.ele);
+    } else {
+        // Child elements in the order the GPX schema wants them
+        n = snprintf(_text, sizeof(_text), "      <trkpt lat=\"%s\" lon=\"%s\">\n", lat, lng);
+        n += snprintf(_text + n, sizeof(_text) - n, "        <ele>%d</ele>\n", p.ele);
+        if (p.time) {
+            char time[24];
+            formatTime(time, sizeof(time), p.time);
+            n += snprintf(_text + n, sizeof(_text) - n, "        <time>%s</time>\n", time);
+        }
+        n += snprintf(
+            _text + n, sizeof(_text) - n, "        <sym>Waypoint</sym>\n        <sat>%u</sat>\n", p.sats
+        );
+        if (p.hdop != 255) {
+            n += snprintf(
+                _text + n, sizeof(_text) - n, "        <hdop>%u.%u</hdop>\n", p.hdop / 10, p.hdop % 10
+            );
+        }
+        n += snprintf(_text + n, sizeof(_text) - n, "      </trkpt>\n");
+    }
+    _first = false;
+    _pending = _text;
+    _pendingLength = n < (int)sizeof(_text) ? n : sizeof(_text) - 1;
+}
+
+void TrackExport::render() {
+    switch (_state) {
+        case HEADER:
+            _pending = _format == GPX ? GPX_HEADER : GEOJSON_HEADER;
+            _pendingLength = strlen(_pending);
+            _state = POINTS;
+            break;
+        case POINTS: {
+            TrackPoint p;
+            if (_reader.next(p)) {
+                renderPoint(p);
+                break;
+            }
+            _state = FOOTER;
+        } // fall through
+        case FOOTER:
+            _pending = _format == GPX ? GPX_FOOTER : GEOJSON_FOOTER;
+            _pendingLength = strlen(_pending);
+            _state = DONE;
+            break;
+        case DONE: _pendingLength = 0; break;
+    }
+}
+
+size_t TrackExport::read(uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        if (_pendingLength == 0) {
+            if (_state == DONE) break;
+            render();
+            continue;
+        }
+        size_t n = _pendingLength < size - written ? _pendingLength : size - written;
+        memcpy(buffer + written, _pending, n);
+        _pending += n;
+        _pendingLength -= n;
+        written += n;
+    }
+    return written;
+}
+
+#ifdef ARDUINO
+size_t FileTrackSink::append(const uint8_t *data, size_t size) {
+    if (!_fs) return 0;
+    File file = _fs->open(_path, FILE_APPEND);
+    if (!file) return 0;
+    size_t written = file.write(data, size);
+    file.close();
+    return written;
+}
+
+String exportTrack(fs::FS &fs, const String &path, TrackExport::Format format) {
+    File in = fs.open(path, FILE_READ);
+    if (!in) return "";
+    FileTrackSource source(in);
+    TrackExport doc(source, format);
+    if (!doc.begin()) {
+        in.close();
+        return "";
+    }
+
+    int dot = path.lastIndexOf('.');
+    String outPath = dot > path.lastIndexOf('/') ? path.substring(0, dot) : path;
+    outPath += TrackExport::extension(format);
+    File out = fs.open(outPath, FILE_WRITE);
+    if (!out) {
+        in.close();
+        return "";
+    }
+    uint8_t buffer[TrackWriter::BLOCK_SIZE];
+    bool ok = true;
+    for (size_t n = doc.read(buffer, sizeof(buffer)); n > 0 && ok; n = doc.read(buffer, sizeof(buffer)))
+        ok = out.write(buffer, n) == n;
+    out.close();
+    in.close();
+    if (!ok) {
+        fs.remove(outPath);
+        return "";
+    }
+    return outPath;
+}
+#endif
@@ -0,0 +1,176 @@
+#ifndef __TRACK_JOURNAL_H__
+#define __TRACK_JOURNAL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Binary GPS track journal (.trk) and its GPX / GeoJSON export.
+ *
+ * The journal is a 16 byte header followed by fixed size 16 byte points,
+ * append only. Points are kept in a RAM block and written 32 at a time, so
+ * the file grows in whole 512 byte blocks instead of one small write (and one
+ * open) per fix. There's no footer: a journal cut by a reset or power loss
+ * is still valid up to its last whole point, losing at most one block of
+ * fixes.
+ *
+ * The export renders a journal chunk by chunk into a caller buffer, so a
+ * track of any length can be saved or sent over HTTP without holding the
+ * document in memory.
+ *
+ * Files are accessed through TrackSource/TrackSink, so all of this also runs
+ * on the host.
+ */
+
+struct TrackPoint {
+    int32_t lat;   // 1e-7 degrees
+    int32_t lng;   // 1e-7 degrees
+    uint32_t time; // Unix time (UTC), 0 when unknown
+    int16_t ele;   // meters
+    uint8_t hdop;  // tenths, 255 for 25.5 or worse
+    uint8_t sats;
+
+    static TrackPoint make(double lat, double lng, double ele, double hdop, uint32_t sats, uint32_t time);
+    bool valid() const;
+};
+
+struct TrackHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t pointSize; // sizeof(TrackPoint) when written
+    uint32_t created;   // Unix time of the first fix
+    uint32_t reserved;
+
+    static const uint32_t MAGIC = 0x314B5254; // "TRK1"
+};
+
+class TrackSource {
+public:
+    virtual ~TrackSource() {}
+    virtual size_t read(uint8_t *buffer, size_t size) = 0;
+    virtual uint32_t size() = 0;
+};
+
+class TrackSink {
+public:
+    virtual ~TrackSink() {}
+    // Appends the buffer, returns how much of it was written
+    virtual size_t append(const uint8_t *data, size_t size) = 0;
+};
+
+// Unix time from a UTC calendar date
+uint32_t trackUnixTime(int year, int month, int day, int hour, int minute, int second);
+
+class TrackWriter {
+public:
+    static const size_t BLOCK_SIZE = 512;
+    static const size_t BLOCK_POINTS = BLOCK_SIZE / sizeof(TrackPoint);
+
+    explicit TrackWriter(TrackSink &sink) : _sink(sink) {}
+
+    // Starts a new journal; the header goes out with the first block
+    void begin(uint32_t created);
+    // Writes the block when it's full. False if that write failed, or if the
+    // block was still full from a failed write and the point was dropped.
+    bool add(const TrackPoint &point);
+    // Writes what's buffered, for when the track ends
+    bool flush();
+
+    uint32_t count() const { return _count; }
+    // Points still in the RAM block
+    uint32_t pending() const { return _count - _written; }
+
+private:
+    TrackSink &_sink;
+    uint8_t _block[BLOCK_SIZE];
+    size_t _used = 0;
+    size_t _flushed = 0; // Bytes of the block already in the file, after a short write
+    uint32_t _count = 0;
+    uint32_t _written = 0;
+};
+
+// Reads the points of a journal, skipping invalid ones
+class TrackReader {
+public:
+    explicit TrackReader(TrackSource &source) : _source(source) {}
+
+    // False if it isn't a journal
+    bool begin();
+    bool next(TrackPoint &point);
+
+    const TrackHeader &header() const { return _header; }
+    // Points in the file (a cut last point excluded)
+    uint32_t count() const { return _count; }
+
+private:
+    TrackSource &_source;
+    TrackHeader _header;
+    uint32_t _count = 0;
+    uint32_t _read = 0;
+};
+
+class TrackExport {
+public:
+    enum Format { GPX, GEOJSON };
+
+    TrackExport(TrackSource &source, Format format) : _reader(source), _format(format) {}
+
+    // False if the source isn't a journal
+    bool begin();
+    // Next part of the document, 0 once it's all out
+    size_t read(uint8_t *buffer, size_t size);
+
+    static const char *contentType(Format format);
+    static const char *extension(Format format);
+
+private:
+    enum State { HEADER, POINTS, FOOTER, DONE };
+
+    // Renders the next piece into _text
+    void render();
+    void renderPoint(const TrackPoint &point);
+
+    TrackReader _reader;
+    Format _format;
+    State _state = DONE;
+    bool _first = true;
+    char _text[224];
+    const char *_pending = "";
+    size_t _pendingLength = 0;
+};
+
+#ifdef ARDUINO
+#include <FS.h>
+
+class FileTrackSource : public TrackSource {
+public:
+    explicit FileTrackSource(fs::File &file) : _file(file) {}
+    size_t read(uint8_t *buffer, size_t size) override { return _file.read(buffer, size); }
+    uint32_t size() override { return _file.size(); }
+
+private:
+    fs::File &_file;
+};
+
+// Appends each block with its own open and close, so a reset never leaves
+// the file open
+class FileTrackSink : public TrackSink {
+public:
+    void begin(fs::FS &fs, const String &path) {
+        _fs = &fs;
+        _path = path;
+    }
+    size_t append(const uint8_t *data, size_t size) override;
+    const String &path() const { return _path; }
+
+private:
+    fs::FS *_fs = nullptr;
+    String _path;
+};
+
+// Renders the journal at path next to it (same name, .gpx or .geojson).
+// Returns the new file path, or "" if it failed.
+String exportTrack(fs::FS &fs, const String &path, TrackExport::Format format);
+#endif
+
+#endif
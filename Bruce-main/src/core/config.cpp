@@ -1,5 +1,51 @@
 #include "config.h"
 #include "sd_functions.h"
+#include <esp_system.h>
+
+#define CONFIG_SAVE_DELAY_MS 2000      // Changes closer together than this are written once
+#define CONFIG_SAVE_MAX_DELAY_MS 10000 // but never later than this after the first one
+
+static uint32_t fnv1a(uint32_t hash, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) hash = (hash ^ data[i]) * 16777619u;
+    return hash;
+}
+
+// Hash of what is in the file, 0 if there is no file
+static uint32_t fileHash(FS &fs, const char *path) {
+    File file = fs.open(path, FILE_READ);
+    if (!file) return 0;
+    uint32_t hash = 2166136261u;
+    uint8_t buffer[128];
+    size_t n;
+    while ((n = file.read(buffer, sizeof(buffer))) > 0) hash = fnv1a(hash, buffer, n);
+    file.close();
+    return hash;
+}
+
+// Writes a temporary file and renames it over path, a reset midway leaves the old file
+static bool writeFileAtomic(FS &fs, const char *path, const String &content) {
+    String tmp = String(path) + ".tmp";
+    File file = fs.open(tmp, FILE_WRITE);
+    if (!file) return false;
+    size_t written = file.write((const uint8_t *)content.c_str(), content.length());
+    file.close();
+    if (written != content.length()) {
+        fs.remove(tmp);
+        return false;
+    }
+    // LittleFS replaces the old file, FAT needs it gone first
+    if (!fs.rename(tmp, path)) {
+        fs.remove(path);
+        if (!fs.rename(tmp, path)) return false;
+    }
+    return true;
+}
+
+// ESP.restart() from anywhere writes a pending save first
+static void flushOnRestart() { bruceConfig.flushFile(); }
+
+// Saves run from the UI and serial tasks and from the board power paths, one at a time
+static SemaphoreHandle_t saveLock = nullptr;
 
 JsonDocument BruceConfig::toJson() const {
     JsonDocument jsonDoc;
@@ -47,6 +93,7 @@ JsonDocument BruceConfig::toJson() const {
     setting["irTx"] = irTx;
     setting["irTxRepeats"] = irTxRepeats;
     setting["irRx"] = irRx;
+    setting["irRxRmt"] = irRxRmt;
 
     setting["rfTx"] = rfTx;
     setting["rfRx"] = rfRx;
@@ -94,9 +141,14 @@ void BruceConfig::fromFile(bool checkFS) {
         else return;
     }
 
+    // A reset between removing the old file and renaming the new one (FAT) left only the new one
+    String tmp = String(filepath) + ".tmp";
+    if (!fs->exists(filepath) && fs->exists(tmp)) fs->rename(tmp, filepath);
+
     if (!fs->exists(filepath)) {
         log_i("Config file not found. Creating default config");
-        return saveFile();
+        saveFile();
+        return flushFile();
     }
 
     File file;
@@ -307,6 +359,12 @@ void BruceConfig::fromFile(bool checkFS) {
         count++;
         log_e("Fail");
     }
+    if (!setting["irRxRmt"].isNull()) {
+        irRxRmt = setting["irRxRmt"].as<int>();
+    } else {
+        count++;
+        log_e("Fail");
+    }
 
     if (!setting["rfTx"].isNull()) {
         rfTx = setting["rfTx"].as<int>();
@@ -431,28 +489,68 @@ void BruceConfig::fromFile(bool checkFS) {
 }
 
 void BruceConfig::saveFile() {
-    FS *fs = &LittleFS;
-    JsonDocument jsonDoc = toJson();
+    uint32_t now = millis();
+    if (!_savePending) _firstChange = now;
+    _lastChange = now;
+    _savePending = true;
+    saveStats.requested++;
+    if (!_restartHook) _restartHook = esp_register_shutdown_handler(flushOnRestart) == ESP_OK;
+}
 
-    // Open file for writing
-    File file = fs->open(filepath, FILE_WRITE);
-    if (!file) {
-        log_e("Failed to open config file");
-        file.close();
-        return;
-    };
+void BruceConfig::saveIfDue() {
+    if (!_savePending) return;
+    uint32_t now = millis();
+    if (now - _lastChange >= CONFIG_SAVE_DELAY_MS || now - _firstChange >= CONFIG_SAVE_MAX_DELAY_MS) {
+        flushFile();
+    }
+}
 
-    // Serialize JSON to file
-    serializeJsonPretty(jsonDoc, Serial);
-    if (serializeJsonPretty(jsonDoc, file) < 5) log_e("Failed to write config file");
-    else log_i("config file written successfully");
+void BruceConfig::flushFile() {
+    if (!_savePending) return;
+    if (!saveLock) saveLock = xSemaphoreCreateMutex();
+    if (saveLock) xSemaphoreTake(saveLock, portMAX_DELAY);
+    if (_savePending) writeFiles();
+    if (saveLock) xSemaphoreGive(saveLock);
+}
 
-    file.close();
+void BruceConfig::writeFiles() {
+    _savePending = false;
+
+    String content;
+    serializeJson(toJson(), content);
+    uint32_t hash = fnv1a(2166136261u, (const uint8_t *)content.c_str(), content.length());
+
+    // What is on the files now, read once
+    if (!_hashesKnown) {
+        _fsHash = fileHash(LittleFS, filepath);
+        _sdHash = setupSdCard() ? fileHash(SD, filepath) : 0;
+        _hashesKnown = true;
+    }
 
-    if (setupSdCard()) copyToFs(LittleFS, SD, filepath, false);
+    if (hash == _fsHash) {
+        log_d("config unchanged, not written");
+    } else if (writeFileAtomic(LittleFS, filepath, content)) {
+        _fsHash = hash;
+        saveStats.written++;
+        log_i("config file written successfully");
+    } else {
+        log_e("Failed to write config file");
+    }
+
+    if (!setupSdCard()) {
+        _sdHash = 0; // A card put in later gets a copy
+    } else if (hash != _sdHash) {
+        if (writeFileAtomic(SD, filepath, content)) {
+            _sdHash = hash;
+            saveStats.mirrored++;
+        } else {
+            log_e("Failed to copy config file to SD");
+        }
+    }
 }
 
 void BruceConfig::factoryReset() {
+    _savePending = false; // The restart would write it back
     FS *fs = &LittleFS;
     fs->rename(String(filepath), "/bak." + String(filepath).substring(1));
     if (setupSdCard()) SD.rename(String(filepath), "/bak." + String(filepath).substring(1));
@@ -467,6 +565,7 @@ void BruceConfig::validateConfig() {
     validateSoundEnabledValue();
     validateSoundVolumeValue();
     validateWifiAtStartupValue();
+    validateIrRxRmtValue();
     validateLedBrightValue();
     validateLedColorValue();
     validateLedBlinkEnabledValue();
@@ -675,6 +774,16 @@ void BruceConfig::setIrRxPin(int value) {
     saveFile();
 }
 
+void BruceConfig::setIrRxRmt(int value) {
+    irRxRmt = value;
+    validateIrRxRmtValue();
+    saveFile();
+}
+
+void BruceConfig::validateIrRxRmtValue() {
+    if (irRxRmt > 1) irRxRmt = 1;
+}
+
 void BruceConfig::setRfTxPin(int value) {
     rfTx = value;
     saveFile();
@@ -76,6 +76,7 @@ public:
     int irTx = LED;
     uint8_t irTxRepeats = 0;
     int irRx = GROVE_SCL;
+    int irRxRmt = 0; // IR Read captures with the RMT peripheral instead of the edge interrupt
 
     // RF
     int rfTx = GROVE_SDA;
@@ -103,6 +104,14 @@ public:
 
     std::vector<String> disabledMenus = {};
 
+    // saveFile() calls, how many of them reached LittleFS and how many the SD copy
+    struct SaveStats {
+        uint32_t requested = 0;
+        uint32_t written = 0;
+        uint32_t mirrored = 0;
+    };
+    SaveStats saveStats;
+
     std::vector<QrCodeEntry> qrCodes = {
         {"Bruce AP",   "WIFI:T:WPA;S:BruceNet;P:brucenet;;"},
         {"Bruce Wiki", "https://github.com/pr3y/Bruce/wiki"},
@@ -119,7 +128,13 @@ public:
     /////////////////////////////////////////////////////////////////////////////////////
     // Operations
     /////////////////////////////////////////////////////////////////////////////////////
+    // Schedules a save: changes close together are written once, and only when the
+    // file would change. saveIfDue() writes it, from the UI loop and the serial
+    // commands task, which keeps running while an app has its own loop.
     void saveFile();
+    void saveIfDue();
+    // Writes a scheduled save now, before a power off or deep sleep
+    void flushFile();
     void fromFile(bool checkFS = true);
     void factoryReset();
     void validateConfig();
@@ -175,6 +190,8 @@ public:
     void setIrTxPin(int value);
     void setIrTxRepeats(uint8_t value);
     void setIrRxPin(int value);
+    void setIrRxRmt(int value);
+    void validateIrRxRmtValue();
 
     // RF
     void setRfTxPin(int value);
@@ -208,6 +225,18 @@ public:
     void validateColorInverted();
     void addDisabledMenu(String value);
     // TODO: removeDisabledMenu(String value);
+
+private:
+    void writeFiles(); // flushFile() with its lock held
+
+    volatile bool _savePending = false;
+    uint32_t _firstChange = 0; // millis() of the first change not written
+    uint32_t _lastChange = 0;
+    bool _restartHook = false;
+    // Hashes of the config on LittleFS and SD, to skip writes that change nothing
+    bool _hashesKnown = false;
+    uint32_t _fsHash = 0;
+    uint32_t _sdHash = 0;
 };
 
 #endif
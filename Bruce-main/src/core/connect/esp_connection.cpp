@@ -6,13 +6,18 @@
 EspConnection *EspConnection::instance = nullptr;
 std::vector<Option> peerOptions;
 
-EspConnection::EspConnection() { setInstance(this); }
+EspConnection::EspConnection() {
+    recvQueue = xQueueCreate(ESP_RECV_QUEUE_SIZE, sizeof(Message));
+    setInstance(this);
+}
 
 EspConnection::~EspConnection() {
     esp_now_unregister_send_cb();
     esp_now_unregister_recv_cb();
 
     esp_now_deinit();
+    setInstance(nullptr);
+    vQueueDelete(recvQueue);
 }
 
 bool EspConnection::beginSend() {
@@ -178,6 +183,11 @@ void EspConnection::appendPeerToList(const uint8_t *mac) {
 }
 
 void EspConnection::onDataSent(const uint8_t *mac_addr, esp_now_send_status_t status) {
+    sendDoneCount++;
+    if (status != ESP_NOW_SEND_SUCCESS) sendFailCount++;
+    // File transfers keep track of what was delivered on their own
+    if (sendStatus == STARTED) return;
+
     if (status == ESP_NOW_SEND_SUCCESS) {
         sendStatus = SUCCESS;
         Serial.println("ESPNOW send success");
@@ -194,10 +204,12 @@ void EspConnection::onDataRecv(const uint8_t *mac, const uint8_t *incomingData,
     const Message *incomingMessage = reinterpret_cast<const Message *>(incomingData);
     recvMessage = *incomingMessage; // Use copy assignment
 
-    printMessage(recvMessage);
+    // Printing every file chunk would slow the transfer down to a crawl
+    if (!recvMessage.isFile && !recvMessage.ack) printMessage(recvMessage);
 
     if (recvMessage.ping) return sendPong(mac);
     if (recvMessage.pong) return appendPeerToList(mac);
 
-    recvQueue.push_back(recvMessage);
+    memcpy(recvAddress, mac, 6);
+    xQueueSend(recvQueue, &recvMessage, 0); // if full, drop it, file transfers resend it
 }
@@ -5,6 +5,8 @@
 #include <globals.h>
 #include <vector>
 
+#define ESP_RECV_QUEUE_SIZE 32
+
 #define ESP_FILENAME_SIZE 30
 #define ESP_FILEPATH_SIZE 50
 #define ESP_DATA_SIZE 150
@@ -25,19 +27,22 @@ public:
         char filename[ESP_FILENAME_SIZE];
         char filepath[ESP_FILEPATH_SIZE];
         char data[ESP_DATA_SIZE];
-        size_t dataSize;
+        uint16_t seq; // File chunk number, low 16 bits (see file_transfer.h)
         size_t totalBytes;
         size_t bytesSent;
+        uint16_t dataSize;
         bool isFile;
         bool done;
         bool ping;
         bool pong;
+        bool ack; // data holds a TransferAck
 
         // Constructor to initialize defaults
         Message()
-            : dataSize(0), totalBytes(0), bytesSent(0), isFile(false), done(false), ping(false), pong(false) {
-        }
+            : seq(0), totalBytes(0), bytesSent(0), dataSize(0), isFile(false), done(false), ping(false),
+              pong(false), ack(false) {}
     };
+    static_assert(sizeof(Message) <= ESP_NOW_MAX_DATA_LEN, "Message doesn't fit in an ESP-NOW frame");
 
     EspConnection();
     ~EspConnection();
@@ -56,7 +61,12 @@ protected:
     Status sendStatus;
     uint8_t dstAddress[6];
     uint8_t broadcastAddress[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
-    std::vector<Message> recvQueue;
+    uint8_t recvAddress[6] = {0}; // Sender of the last message queued
+    // Filled by the ESP-NOW receive callback, messages are dropped when it's full
+    QueueHandle_t recvQueue;
+    // Updated by the ESP-NOW send callback
+    volatile uint32_t sendDoneCount = 0;
+    volatile uint32_t sendFailCount = 0;
 
     bool beginSend();
     bool beginEspnow();
@@ -66,6 +76,8 @@ protected:
     Message createPingMessage();
     Message createPongMessage();
 
+    bool popMessage(Message &message) { return xQueueReceive(recvQueue, &message, 0) == pdTRUE; }
+
     void sendPing();
     void sendPong(const uint8_t *mac);
 
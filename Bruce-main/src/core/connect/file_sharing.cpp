@@ -1,6 +1,13 @@
 #include "file_sharing.h"
 #include "core/display.h"
 #include <SD.h>
+
+#define ESP_TRANSFER_IN_FLIGHT 2    // frames handed to the radio before its send callback
+#define ESP_TRANSFER_ACK_EVERY 8    // chunks received before acking
+#define ESP_TRANSFER_ACK_DELAY 10   // ms, ack anyway after this
+#define ESP_TRANSFER_TIMEOUT 5000   // ms without progress before giving up
+#define ESP_TRANSFER_DONE_RETRIES 10
+
 FileSharing::FileSharing() {}
 
 void FileSharing::sendFile() {
@@ -16,18 +23,27 @@ void FileSharing::sendFile() {
     }
 
     Message message = createFileMessage(file);
-
-    esp_err_t response;
+    TransferSender sender;
+    uint32_t crc = 0;
     sendStatus = STARTED;
 
     drawMainBorderWithTitle("SEND FILE");
     padprintln("");
     padprintln("Sending...");
 
-    delay(100);
+    xQueueReset(recvQueue);
+    uint32_t startTime = millis();
+    uint32_t lastSend = startTime;
+    uint32_t lastDraw = 0;
+    uint32_t sendCalls = 0;
+    uint32_t sendDoneBase = sendDoneCount;
+    uint32_t sendFailSeen = sendFailCount;
+    sender.begin(message.totalBytes, ESP_DATA_SIZE, startTime);
 
-    while (file.available()) {
+    while (!sender.allAcked()) {
         if (check(EscPress)) sendStatus = ABORTED;
+        uint32_t now = millis();
+        if (sender.stalled(now, ESP_TRANSFER_TIMEOUT)) sendStatus = FAILED;
 
         if (sendStatus == ABORTED || sendStatus == FAILED) {
             message.done = true;
@@ -37,22 +53,68 @@ void FileSharing::sendFile() {
             break;
         }
 
-        size_t bytesRead = file.readBytes(message.data, ESP_DATA_SIZE);
-        message.dataSize = bytesRead;
-        message.bytesSent = min(message.bytesSent + bytesRead, message.totalBytes);
-        message.done = message.bytesSent == message.totalBytes;
+        Message recvMessage;
+        while (popMessage(recvMessage)) {
+            if (!recvMessage.ack) continue;
+            TransferAck ack;
+            memcpy(&ack, recvMessage.data, sizeof(ack));
+            sender.onAck(ack, now);
+        }
+        for (; sendFailSeen != sendFailCount; sendFailSeen++) sender.sendFailed();
+
+        // Pace on the send callback, the radio only ever has a couple of frames queued.
+        // If a callback went missing, don't wait for it forever.
+        uint32_t inFlight = sendCalls - (sendDoneCount - sendDoneBase);
+        if (inFlight >= ESP_TRANSFER_IN_FLIGHT && now - lastSend > 100) {
+            sendCalls = 0;
+            sendDoneBase = sendDoneCount;
+            inFlight = 0;
+        }
+        uint32_t chunk;
+        if (inFlight < ESP_TRANSFER_IN_FLIGHT && sender.next(now, chunk)) {
+            if (!readChunk(file, sender, chunk, message, crc)) {
+                Serial.println("Failed reading the file");
+                sendStatus = FAILED;
+                continue;
+            }
+            esp_err_t response = esp_now_send(dstAddress, (uint8_t *)&message, sizeof(message));
+            if (response == ESP_OK) {
+                sendCalls++;
+                lastSend = now;
+            } else {
+                // It will be resent once it times out
+                Serial.printf("Send file response: %s\n", esp_err_to_name(response));
+            }
+            continue;
+        }
 
-        response = esp_now_send(dstAddress, (uint8_t *)&message, sizeof(message));
-        if (response != ESP_OK) {
-            Serial.printf("Send file response: %s\n", esp_err_to_name(response));
-            sendStatus = FAILED;
+        if (now - lastDraw > 250) {
+            progressHandler(sender.acked(), sender.chunks(), "Sending...");
+            lastDraw = now;
         }
+        vTaskDelay(1 / portTICK_PERIOD_MS);
+    }
 
-        progressHandler(file.position(), file.size(), "Sending...");
-        delay(100);
+    if (sendStatus == STARTED) {
+        uint32_t timeout = sender.rto() > 200 ? sender.rto() : 200;
+        sendStatus = finishSend(message, crc, timeout) ? SUCCESS : FAILED;
+        if (sendStatus == FAILED) displayError("File not confirmed");
     }
 
-    if (message.bytesSent == message.totalBytes) displaySuccess("File sent");
+    if (sendStatus == SUCCESS) {
+        uint32_t elapsed = millis() - startTime + 1;
+        float kbps = message.totalBytes / (float)elapsed;
+        Serial.printf(
+            "File sent: %lu bytes in %lu ms, %.1f kB/s, %lu frames, %lu resent, window %u\n",
+            (unsigned long)message.totalBytes,
+            (unsigned long)elapsed,
+            kbps,
+            (unsigned long)sender.sent(),
+            (unsigned long)sender.retransmits(),
+            sender.window()
+        );
+        displaySuccess("File sent " + String(kbps, 1) + "kB/s");
+    }
 
     file.close();
     delay(1000);
@@ -64,44 +126,91 @@ void FileSharing::receiveFile() {
     padprintln("Waiting...");
 
     recvFileName = "";
-    recvQueue = {};
+    xQueueReset(recvQueue);
     recvStatus = CONNECTING;
 
     if (!beginEspnow()) return;
 
+    TransferReceiver receiver;
+    uint32_t startTime = 0;
+    uint32_t lastRecv = 0;
+    uint32_t lastAck = 0;
+    uint32_t lastDraw = 0;
+    uint16_t unacked = 0;
+    float kbps = 0;
+
     delay(100);
 
     while (1) {
         if (check(EscPress)) recvStatus = ABORTED;
+        uint32_t now = millis();
+        if (recvStatus == STARTED && now - lastRecv > ESP_TRANSFER_TIMEOUT) recvStatus = FAILED;
 
         if (recvStatus == ABORTED || recvStatus == FAILED) {
             displayError("Error receiving file");
             break;
         }
         if (recvStatus == SUCCESS) {
-            displaySuccess("File received");
+            displaySuccess("File received " + String(kbps, 1) + "kB/s");
             break;
         }
 
-        if (!recvQueue.empty()) {
-            Message recvFileMessage = recvQueue.front();
-            recvQueue.erase(recvQueue.begin());
-
-            progressHandler(recvFileMessage.bytesSent, recvFileMessage.totalBytes, "Receiving...");
-
-            if (!appendToFile(recvFileMessage)) {
-                recvStatus = FAILED;
-                Serial.println("Failed appending to file");
+        Message recvFileMessage;
+        while (recvStatus != FAILED && popMessage(recvFileMessage)) {
+            if (!recvFileMessage.isFile) continue;
+            lastRecv = now;
+
+            if (recvStatus != STARTED) {
+                // Left over from an earlier transfer, unless it's an empty file
+                if (recvFileMessage.done && recvFileMessage.totalBytes > 0) continue;
+                if (!openRecvFile(recvFileMessage)) {
+                    Serial.println("Failed creating the file");
+                    recvStatus = FAILED;
+                    break;
+                }
+                setDstAddress(recvAddress);
+                setupPeer(dstAddress);
+                receiver.begin(recvFileMessage.totalBytes, ESP_DATA_SIZE);
+                startTime = now;
+                recvStatus = STARTED;
             }
+
             if (recvFileMessage.done) {
                 Serial.println("Recv done");
-                recvStatus = recvFileMessage.bytesSent == recvFileMessage.totalBytes ? SUCCESS : FAILED;
+                recvStatus = finishRecv(recvFileMessage, receiver) ? SUCCESS : FAILED;
+                kbps = recvFileMessage.totalBytes / (float)(now - startTime + 1);
+                Serial.printf(
+                    "File received: %lu bytes, %.1f kB/s\n", (unsigned long)recvFileMessage.totalBytes, kbps
+                );
+                break;
+            }
+
+            uint32_t chunk;
+            if (receiver.accept(recvFileMessage.seq, chunk) &&
+                !writeChunk(receiver.chunkOffset(chunk), recvFileMessage)) {
+                Serial.println("Failed writing to file");
+                recvStatus = FAILED;
             }
+            unacked++;
+        }
+        if (recvStatus != STARTED) {
+            vTaskDelay(10 / portTICK_PERIOD_MS);
+            continue;
         }
 
-        delay(100);
+        if (unacked >= ESP_TRANSFER_ACK_EVERY || (unacked > 0 && now - lastAck >= ESP_TRANSFER_ACK_DELAY)) {
+            sendAck(receiver);
+            unacked = 0;
+            lastAck = now;
+        }
+        if (now - lastDraw > 250) {
+            progressHandler(receiver.received(), receiver.chunks(), "Receiving...");
+            lastDraw = now;
+        }
+        vTaskDelay(1 / portTICK_PERIOD_MS);
     }
 
+    if (recvFile) recvFile.close();
     delay(1000);
 
     if (recvStatus == SUCCESS) {
@@ -111,7 +220,7 @@ void FileSharing::receiveFile() {
         padprintln(recvFileName);
         padprintln("\n");
         padprintln("Press any key to leave");
-        while (!check(AnyKeyPress)) vTaskDelay(50 / portTICK_PERIOD_MS);
+        waitAnyKeyPress();
         ;
     }
 }
@@ -133,19 +242,114 @@ File FileSharing::selectFile() {
     return file;
 }
 
-bool FileSharing::appendToFile(FileSharing::Message fileMessage) {
-    FS *fs;
-    if (!getFsStorage(fs)) return false;
+bool FileSharing::readChunk(
+    File &file, TransferSender &sender, uint32_t chunk, Message &message, uint32_t &crc
+) {
+    uint32_t offset = sender.chunkOffset(chunk);
+    uint16_t length = sender.chunkLength(chunk);
+
+    if (file.position() != offset && !file.seek(offset)) return false;
+    if (file.read((uint8_t *)message.data, length) != length) return false;
+
+    // New chunks go out in order, so the CRC only needs to see each one the first time
+    if (offset + length > message.bytesSent) {
+        crc = transferCrc32(crc, (const uint8_t *)message.data, length);
+        message.bytesSent = offset + length;
+    }
+    message.seq = (uint16_t)chunk;
+    message.dataSize = length;
+    message.done = false;
+    return true;
+}
+
+bool FileSharing::finishSend(Message &message, uint32_t crc, uint32_t timeout) {
+    // The done message carries the CRC of the whole file
+    message.done = true;
+    message.dataSize = sizeof(crc);
+    message.bytesSent = message.totalBytes;
+    memcpy(message.data, &crc, sizeof(crc));
+
+    for (int i = 0; i < ESP_TRANSFER_DONE_RETRIES; i++) {
+        esp_now_send(dstAddress, (uint8_t *)&message, sizeof(message));
+
+        uint32_t sentAt = millis();
+        while (millis() - sentAt < timeout) {
+            Message recvMessage;
+            TransferAck ack;
+            if (!popMessage(recvMessage)) {
+                vTaskDelay(5 / portTICK_PERIOD_MS);
+                continue;
+            }
+            if (!recvMessage.ack) continue;
+            memcpy(&ack, recvMessage.data, sizeof(ack));
+            if (ack.flags & TransferAck::COMPLETE) return ack.flags & TransferAck::CRC_OK;
+        }
+    }
+    return false;
+}
 
-    if (recvFileName == "") createFilename(fs, fileMessage);
+bool FileSharing::openRecvFile(FileSharing::Message fileMessage) {
+    if (!getFsStorage(recvFs)) return false;
+
+    createFilename(recvFs, fileMessage);
+
+    recvFile = (*recvFs).open(recvFileName, FILE_WRITE);
+    if (!recvFile) return false;
+
+    // Chunks arrive out of order, allocate the whole file up front.
+    // Also fails early if there is no room for it.
+    if (fileMessage.totalBytes > 0) {
+        if (!recvFile.seek(fileMessage.totalBytes - 1) || recvFile.write((uint8_t)0) != 1) return false;
+    }
+    return true;
+}
 
-    File file = (*fs).open(recvFileName, FILE_APPEND);
+bool FileSharing::writeChunk(uint32_t offset, const FileSharing::Message &fileMessage) {
+    if (recvFile.position() != offset && !recvFile.seek(offset)) return false;
+    return recvFile.write((const uint8_t *)fileMessage.data, fileMessage.dataSize) == fileMessage.dataSize;
+}
+
+bool FileSharing::finishRecv(const FileSharing::Message &doneMessage, TransferReceiver &receiver) {
+    // A done message without the CRC means the sender gave up
+    if (doneMessage.dataSize != sizeof(uint32_t) || !receiver.complete()) return false;
+
+    uint32_t expected;
+    memcpy(&expected, doneMessage.data, sizeof(expected));
+
+    recvFile.close();
+    File file = (*recvFs).open(recvFileName, FILE_READ);
     if (!file) return false;
 
-    file.write((const uint8_t *)fileMessage.data, fileMessage.dataSize);
+    uint8_t buffer[512];
+    uint32_t crc = 0;
+    size_t bytesRead;
+    while ((bytesRead = file.read(buffer, sizeof(buffer))) > 0) crc = transferCrc32(crc, buffer, bytesRead);
     file.close();
 
-    return true;
+    bool crcOk = crc == expected;
+    if (!crcOk) {
+        Serial.printf("CRC mismatch: %08lX, expected %08lX\n", (unsigned long)crc, (unsigned long)expected);
+    }
+
+    // No one acks the ack, send it a few times
+    for (int i = 0; i < 3; i++) {
+        sendAck(receiver, TransferAck::COMPLETE | (crcOk ? TransferAck::CRC_OK : 0));
+        delay(20);
+    }
+    return crcOk;
+}
+
+void FileSharing::sendAck(TransferReceiver &receiver, uint8_t flags) {
+    Message message;
+    TransferAck ack;
+
+    receiver.fillAck(ack);
+    ack.flags |= flags;
+    message.ack = true;
+    message.dataSize = sizeof(ack);
+    memcpy(message.data, &ack, sizeof(ack));
+
+    esp_now_send(dstAddress, (uint8_t *)&message, sizeof(message));
 }
 
 void FileSharing::createFilename(FS *fs, FileSharing::Message fileMessage) {
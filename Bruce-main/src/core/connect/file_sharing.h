@@ -2,6 +2,7 @@
 #define __ESP_FILE_SHARING_H__
 
 #include "esp_connection.h"
+#include "file_transfer.h"
 
 class FileSharing : public EspConnection {
 public:
@@ -18,12 +19,19 @@ public:
 
 private:
     String recvFileName;
+    FS *recvFs = nullptr;
+    File recvFile;
 
     /////////////////////////////////////////////////////////////////////////////////////
     // Helpers
     /////////////////////////////////////////////////////////////////////////////////////
     File selectFile();
-    bool appendToFile(Message fileMessage);
+    bool readChunk(File &file, TransferSender &sender, uint32_t chunk, Message &message, uint32_t &crc);
+    bool finishSend(Message &message, uint32_t crc, uint32_t timeout);
+    bool openRecvFile(Message fileMessage);
+    bool writeChunk(uint32_t offset, const Message &fileMessage);
+    bool finishRecv(const Message &doneMessage, TransferReceiver &receiver);
+    void sendAck(TransferReceiver &receiver, uint8_t flags = 0);
     void createFilename(FS *fs, Message fileMessage);
 };
 
@@ -0,0 +1,183 @@
+#include "file_transfer.h"
+#include <string.h>
+
+#define TRANSFER_INITIAL_WINDOW 8
+#define TRANSFER_MIN_WINDOW 2
+#define TRANSFER_INITIAL_RTO 200 // ms, until there is an RTT sample
+#define TRANSFER_MIN_RTO 30
+#define TRANSFER_MAX_RTO 2000
+
+uint32_t transferCrc32(uint32_t crc, const uint8_t *data, size_t len) {
+    // Half byte table, small enough to not bother with a 1 kB one
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = table[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Sender
+/////////////////////////////////////////////////////////////////////////////////////
+void TransferSender::begin(uint32_t totalBytes, uint16_t chunkSize, uint32_t nowMs) {
+    _total = totalBytes;
+    _chunkSize = chunkSize ? chunkSize : 1;
+    _chunks = (totalBytes + _chunkSize - 1) / _chunkSize;
+    _base = _next = 0;
+    memset(_acked, 0, sizeof(_acked));
+    memset(_resent, 0, sizeof(_resent));
+    memset(_due, 0, sizeof(_due));
+    _cwnd = TRANSFER_INITIAL_WINDOW;
+    _cwndCount = 0;
+    _srtt = 0;
+    _rttvar = 0;
+    _rto = TRANSFER_INITIAL_RTO;
+    _lastCut = _lastProgress = _lastAck = nowMs;
+    _sent = _retransmits = 0;
+}
+
+uint16_t TransferSender::chunkLength(uint32_t chunk) const {
+    if (chunk >= _chunks) return 0;
+    uint32_t left = _total - chunkOffset(chunk);
+    return left < _chunkSize ? left : _chunkSize;
+}
+
+bool TransferSender::next(uint32_t nowMs, uint32_t &chunk) {
+    // Holes the receiver reported first, then anything that timed out
+    for (uint32_t c = _base; c < _next; c++) {
+        uint16_t slot = c % WINDOW;
+        if (_acked[slot]) continue;
+        // A hole the receiver reported can still be a reordered chunk on its way, resend it
+        // once it's been out for longer than the RTO without the timer's minimum
+        uint32_t age = nowMs - _sentAt[slot];
+        bool timedOut = age >= _rto;
+        if (!timedOut && !(_due[slot] && age > (_srtt + 4 * _rttvar) / 8)) continue;
+
+        // Acks still coming in after it was sent: that one frame was lost, not the whole window
+        bool acksSince = (int32_t)(_lastAck - _sentAt[slot]) >= 0;
+        if (timedOut && !_due[slot] && !acksSince && nowMs - _lastCut >= _rto) {
+            // Whole window lost, back off
+            _cwnd = _cwnd / 2 > TRANSFER_MIN_WINDOW ? _cwnd / 2 : TRANSFER_MIN_WINDOW;
+            _lastCut = nowMs;
+        }
+        _due[slot] = false;
+        _resent[slot] = true;
+        _sentAt[slot] = nowMs;
+        _retransmits++;
+        _sent++;
+        chunk = c;
+        return true;
+    }
+
+    if (_next >= _chunks || _next - _base >= _cwnd) return false;
+    uint16_t slot = _next % WINDOW;
+    _acked[slot] = false;
+    _resent[slot] = false;
+    _due[slot] = false;
+    _sentAt[slot] = nowMs;
+    _sent++;
+    chunk = _next++;
+    return true;
+}
+
+void TransferSender::sendFailed() {
+    uint16_t cwnd = _cwnd - _cwnd / 4;
+    _cwnd = cwnd > TRANSFER_MIN_WINDOW ? cwnd : TRANSFER_MIN_WINDOW;
+}
+
+void TransferSender::markAcked(uint32_t chunk, uint32_t nowMs) {
+    uint16_t slot = chunk % WINDOW;
+    if (_acked[slot]) return;
+    _acked[slot] = true;
+    _lastAck = nowMs;
+    if (_resent[slot]) return;
+
+    // RFC 6298, both kept in 1/8 ms so the variation doesn't round down to nothing
+    uint32_t rtt = (nowMs - _sentAt[slot]) * 8;
+    if (_srtt == 0) {
+        _srtt = rtt ? rtt : 1;
+        _rttvar = rtt / 2;
+    } else {
+        uint32_t err = rtt > _srtt ? rtt - _srtt : _srtt - rtt;
+        _rttvar = (3 * _rttvar + err) / 4;
+        _srtt = (7 * _srtt + rtt) / 8;
+    }
+    _rto = (_srtt + 4 * _rttvar) / 8;
+    if (_rto < TRANSFER_MIN_RTO) _rto = TRANSFER_MIN_RTO;
+    if (_rto > TRANSFER_MAX_RTO) _rto = TRANSFER_MAX_RTO;
+}
+
+void TransferSender::onAck(const TransferAck &ack, uint32_t nowMs) {
+    // Acks can't go past what was sent, anything else is stale
+    uint32_t ackBase = _base + (uint16_t)(ack.base - (uint16_t)_base);
+    if (ackBase > _next) return;
+
+    for (uint32_t c = _base; c < ackBase; c++) markAcked(c, nowMs);
+
+    uint32_t highest = 0;
+    for (uint16_t i = 0; i < WINDOW - 1; i++) {
+        if (!(ack.bits[i / 32] & (1UL << (i % 32)))) continue;
+        uint32_t c = ackBase + 1 + i;
+        if (c >= _next) break;
+        markAcked(c, nowMs);
+        highest = c;
+    }
+
+    // Chunks the receiver is missing below one it got were most likely lost,
+    // next() gives them the time a reordered chunk could take to still arrive
+    for (uint32_t c = ackBase; c < highest; c++) {
+        uint16_t slot = c % WINDOW;
+        if (!_acked[slot]) _due[slot] = true;
+    }
+
+    while (_base < _next && _acked[_base % WINDOW]) {
+        _base++;
+        _lastProgress = nowMs;
+        if (++_cwndCount >= _cwnd) {
+            _cwndCount = 0;
+            if (_cwnd < WINDOW) _cwnd++;
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Receiver
+/////////////////////////////////////////////////////////////////////////////////////
+void TransferReceiver::begin(uint32_t totalBytes, uint16_t chunkSize) {
+    _chunkSize = chunkSize ? chunkSize : 1;
+    _chunks = (totalBytes + _chunkSize - 1) / _chunkSize;
+    _base = 0;
+    _received = 0;
+    memset(_have, 0, sizeof(_have));
+}
+
+bool TransferReceiver::accept(uint16_t seq, uint32_t &chunk) {
+    int16_t ahead = (int16_t)(seq - (uint16_t)_base);
+    if (ahead < 0 || ahead >= WINDOW) return false;
+    chunk = _base + ahead;
+    if (chunk >= _chunks || _have[chunk % WINDOW]) return false;
+
+    _have[chunk % WINDOW] = true;
+    _received++;
+    while (_base < _chunks && _have[_base % WINDOW]) {
+        _have[_base % WINDOW] = false;
+        _base++;
+    }
+    return true;
+}
+
+void TransferReceiver::fillAck(TransferAck &ack) const {
+    memset(&ack, 0, sizeof(ack));
+    ack.base = (uint16_t)_base;
+    for (uint16_t i = 0; i < WINDOW - 1; i++) {
+        uint32_t c = _base + 1 + i;
+        if (c >= _chunks) break;
+        if (_have[c % WINDOW]) ack.bits[i / 32] |= 1UL << (i % 32);
+    }
+    if (complete()) ack.flags |= TransferAck::COMPLETE;
+}
@@ -0,0 +1,108 @@
+#ifndef __ESP_FILE_TRANSFER_H__
+#define __ESP_FILE_TRANSFER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Sliding window protocol used by FileSharing.
+ *
+ * The file is split in fixed size chunks numbered from 0, frames carry the low
+ * 16 bits of the chunk number and both ends resolve it against their window
+ * base. The receiver acks with the first chunk it's missing plus a bitmap of
+ * what it already has after it. The sender retransmits a hole once it's been
+ * out for longer than a reordered chunk could take, and anything that times
+ * out (RFC 6298 RTO), and sizes its window with additive increase /
+ * multiplicative decrease. No Arduino or ESP-NOW code here, so it runs on the
+ * host too.
+ */
+
+// CRC-32 (IEEE), start with crc = 0 and feed the data in order
+uint32_t transferCrc32(uint32_t crc, const uint8_t *data, size_t len);
+
+struct TransferAck {
+    enum Flags : uint8_t {
+        COMPLETE = 1, // Receiver got the whole file
+        CRC_OK = 2,   // and its CRC matched
+    };
+    uint16_t base;    // Every chunk before this one was received
+    uint8_t flags;
+    uint8_t reserved;
+    uint32_t bits[2]; // Bit i set: chunk base + 1 + i was received
+};
+
+class TransferSender {
+public:
+    static const uint16_t WINDOW = 64; // Max chunks in flight
+
+    void begin(uint32_t totalBytes, uint16_t chunkSize, uint32_t nowMs);
+
+    // Chunk to send now, a retransmission or the next new one. False when the
+    // window is full and nothing timed out.
+    bool next(uint32_t nowMs, uint32_t &chunk);
+    // The radio reported a frame as not delivered
+    void sendFailed();
+    void onAck(const TransferAck &ack, uint32_t nowMs);
+
+    bool allAcked() const { return _base >= _chunks; }
+    bool stalled(uint32_t nowMs, uint32_t timeoutMs) const { return nowMs - _lastProgress > timeoutMs; }
+
+    uint32_t chunks() const { return _chunks; }
+    uint32_t acked() const { return _base; }
+    uint32_t chunkOffset(uint32_t chunk) const { return chunk * _chunkSize; }
+    uint16_t chunkLength(uint32_t chunk) const;
+    uint32_t sent() const { return _sent; }
+    uint32_t retransmits() const { return _retransmits; }
+    uint16_t window() const { return _cwnd; }
+    uint32_t rto() const { return _rto; }
+
+private:
+    void markAcked(uint32_t chunk, uint32_t nowMs);
+
+    uint32_t _total = 0;
+    uint32_t _chunks = 0;
+    uint16_t _chunkSize = 1;
+    uint32_t _base = 0; // Oldest chunk not acked
+    uint32_t _next = 0; // Next chunk never sent
+    uint32_t _sentAt[WINDOW];
+    bool _acked[WINDOW];
+    bool _resent[WINDOW]; // No RTT samples from retransmitted chunks
+    bool _due[WINDOW];    // Reported missing, resend without waiting for the timeout
+
+    uint16_t _cwnd = 0;
+    uint16_t _cwndCount = 0;
+    uint32_t _srtt = 0; // 1/8 ms
+    uint32_t _rttvar = 0;
+    uint32_t _rto = 0;
+    uint32_t _lastCut = 0;
+    uint32_t _lastProgress = 0;
+    uint32_t _lastAck = 0;
+    uint32_t _sent = 0;
+    uint32_t _retransmits = 0;
+};
+
+class TransferReceiver {
+public:
+    static const uint16_t WINDOW = TransferSender::WINDOW;
+
+    void begin(uint32_t totalBytes, uint16_t chunkSize);
+
+    // Resolves a received sequence number. False for duplicates and chunks
+    // outside the window, which still deserve an ack.
+    bool accept(uint16_t seq, uint32_t &chunk);
+    void fillAck(TransferAck &ack) const;
+
+    bool complete() const { return _base >= _chunks; }
+    uint32_t chunks() const { return _chunks; }
+    uint32_t received() const { return _received; }
+    uint32_t chunkOffset(uint32_t chunk) const { return chunk * _chunkSize; }
+
+private:
+    uint32_t _chunks = 0;
+    uint16_t _chunkSize = 1;
+    uint32_t _base = 0; // First chunk missing
+    uint32_t _received = 0;
+    bool _have[WINDOW];
+};
+
+#endif
@@ -0,0 +1,289 @@
+#include "dir_index.h"
+#include <LittleFS.h>
+#include <SD.h>
+#include <algorithm>
+
+#define DIR_INDEX_SLOTS 3         // Folders kept in memory
+#define DIR_INDEX_SAVE_MIN 64     // Smaller folders scan fast enough
+#define DIR_INDEX_CACHE "/.dircache"
+#define DIR_INDEX_MAGIC 0x31584944 // "DIX1"
+
+struct DirIndexHeader {
+    uint32_t magic;
+    uint32_t mtime;
+    uint32_t fingerprint;
+    uint32_t count;
+    uint32_t namesSize;
+    uint16_t folderLength; // The folder path follows the header
+};
+
+static DirIndex slots[DIR_INDEX_SLOTS];
+static uint32_t useCounter = 0;
+
+static uint32_t fnv1a(uint32_t hash, const char *str) {
+    for (; *str; str++) hash = (hash ^ (uint8_t)*str) * 16777619u;
+    return hash;
+}
+
+static uint32_t fingerprintEntry(uint32_t hash, const char *name, bool folder) {
+    hash = fnv1a(hash, name);
+    return (hash ^ (folder ? 1 : 2)) * 16777619u;
+}
+
+static const char *baseName(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static bool isCacheFolder(const String &folder, const char *name) {
+    return folder == "/" && strcmp(name, DIR_INDEX_CACHE + 1) == 0;
+}
+
+static int compareUpper(const char *a, const char *b) {
+    // Same order as comparing toUpperCase() copies, without making them
+    for (;; a++, b++) {
+        int ca = toupper((uint8_t)*a);
+        int cb = toupper((uint8_t)*b);
+        if (ca != cb || ca == 0) return ca - cb;
+    }
+}
+
+static uint32_t sortKey(const char *name) {
+    uint32_t key = 0;
+    for (int i = 0; i < 4; i++) {
+        key <<= 8;
+        if (*name) key |= (uint8_t)toupper((uint8_t)*name++);
+    }
+    return key;
+}
+
+// Entries as readdir() returns them: one pass over the folder, no entry opened or stat()ed
+// (on FAT each stat() searches the folder again)
+static bool readFingerprint(FS &fs, const String &folder, uint32_t &mtime, uint32_t &fingerprint) {
+    File root = fs.open(folder);
+    if (!root || !root.isDirectory()) return false;
+    mtime = root.getLastWrite();
+    fingerprint = 2166136261u;
+    bool isDir = false;
+    for (String path = root.getNextFileName(&isDir); path.length() > 0; path = root.getNextFileName(&isDir)) {
+        const char *name = baseName(path.c_str());
+        if (!isCacheFolder(folder, name)) fingerprint = fingerprintEntry(fingerprint, name, isDir);
+    }
+    root.close();
+    return true;
+}
+
+static String cachePath(const String &folder) {
+    char name[sizeof(DIR_INDEX_CACHE) + 16];
+    uint32_t hash = fnv1a(2166136261u, folder.c_str());
+    snprintf(name, sizeof(name), DIR_INDEX_CACHE "/%08lx.idx", (unsigned long)hash);
+    return String(name);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// DirIndex
+/////////////////////////////////////////////////////////////////////////////////////
+void DirIndex::clear() {
+    _fs = nullptr;
+    _folder = "";
+    _prefix = "";
+    std::vector<Entry>().swap(_entries);
+    std::vector<char>().swap(_names);
+    std::vector<uint32_t>().swap(_matches);
+}
+
+bool DirIndex::scan(FS &fs) {
+    _entries.clear();
+    _names.clear();
+    _prefix = "";
+    _matches.clear();
+
+    File root = fs.open(_folder);
+    if (!root || !root.isDirectory()) return false;
+    _mtime = root.getLastWrite();
+    _fingerprint = 2166136261u;
+
+    File file = root.openNextFile();
+    while (file) {
+        const char *name = baseName(file.name());
+        if (!isCacheFolder(_folder, name)) {
+            Entry entry = {};
+            entry.name = _names.size();
+            entry.size = file.isDirectory() ? 0 : file.size();
+            entry.key = sortKey(name);
+            entry.folder = file.isDirectory();
+            _entries.push_back(entry);
+            _names.insert(_names.end(), name, name + strlen(name) + 1);
+
+            _fingerprint = fingerprintEntry(_fingerprint, name, entry.folder);
+        }
+        file.close();
+        file = root.openNextFile();
+    }
+    root.close();
+
+    sort();
+    return true;
+}
+
+void DirIndex::sort() {
+    const char *names = _names.data();
+    std::sort(_entries.begin(), _entries.end(), [names](const Entry &a, const Entry &b) {
+        if (a.folder != b.folder) return a.folder > b.folder; // Folders first
+        if (a.key != b.key) return a.key < b.key;
+        return compareUpper(names + a.name, names + b.name) < 0;
+    });
+}
+
+bool DirIndex::load(FS &fs) {
+    _prefix = "";
+    _matches.clear();
+    String path = cachePath(_folder);
+    if (!fs.exists(path)) return false;
+    File file = fs.open(path, FILE_READ);
+    if (!file) return false;
+
+    DirIndexHeader h;
+    bool ok = file.read((uint8_t *)&h, sizeof(h)) == sizeof(h) && h.magic == DIR_INDEX_MAGIC &&
+              h.mtime == _mtime && h.fingerprint == _fingerprint && h.folderLength == _folder.length();
+    // In 64 bits, a corrupt count can't wrap around and pass
+    ok = ok && (uint64_t)h.count * sizeof(Entry) + h.namesSize + sizeof(h) + h.folderLength <= file.size();
+    if (ok) {
+        // Another folder with the same path hash
+        char folder[h.folderLength + 1];
+        ok = file.read((uint8_t *)folder, h.folderLength) == h.folderLength &&
+             memcmp(folder, _folder.c_str(), h.folderLength) == 0;
+    }
+    if (ok) {
+        _entries.resize(h.count);
+        _names.resize(h.namesSize);
+        ok = file.read((uint8_t *)_entries.data(), h.count * sizeof(Entry)) == h.count * sizeof(Entry) &&
+             file.read((uint8_t *)_names.data(), h.namesSize) == h.namesSize;
+    }
+    file.close();
+    if (!ok) {
+        _entries.clear();
+        _names.clear();
+    }
+    return ok;
+}
+
+void DirIndex::save(FS &fs) const {
+    // Only a cache, it doesn't matter if this fails (read only or full storage)
+    if (!fs.exists(DIR_INDEX_CACHE) && !fs.mkdir(DIR_INDEX_CACHE)) return;
+    File file = fs.open(cachePath(_folder), FILE_WRITE);
+    if (!file) return;
+
+    DirIndexHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = DIR_INDEX_MAGIC;
+    h.mtime = _mtime;
+    h.fingerprint = _fingerprint;
+    h.count = _entries.size();
+    h.namesSize = _names.size();
+    h.folderLength = _folder.length();
+    file.write((const uint8_t *)&h, sizeof(h));
+    file.write((const uint8_t *)_folder.c_str(), h.folderLength);
+    file.write((const uint8_t *)_entries.data(), h.count * sizeof(Entry));
+    file.write((const uint8_t *)_names.data(), h.namesSize);
+    file.close();
+}
+
+bool DirIndex::scanFolder(FS &fs, const String &folder) {
+    clear();
+    _fs = &fs;
+    _folder = folder;
+    if (scan(fs)) return true;
+    clear();
+    return false;
+}
+
+const std::vector<uint32_t> &DirIndex::matchPrefix(const String &prefix) {
+    bool narrowing = _prefix.length() > 0 && prefix.length() >= _prefix.length() &&
+                     strncasecmp(prefix.c_str(), _prefix.c_str(), _prefix.length()) == 0;
+    if (!narrowing) {
+        _matches.resize(_entries.size());
+        for (uint32_t i = 0; i < _entries.size(); i++) _matches[i] = i;
+    }
+    std::vector<uint32_t> matches;
+    matches.reserve(_matches.size());
+    for (uint32_t i : _matches)
+        if (strncasecmp(name(i), prefix.c_str(), prefix.length()) == 0) matches.push_back(i);
+    _matches.swap(matches);
+    _prefix = prefix;
+    return _matches;
+}
+
+void DirIndex::filter(const String &allowedExt, std::vector<uint32_t> &out) const {
+    out.clear();
+    out.reserve(_entries.size());
+    bool all = allowedExt == "*";
+    for (uint32_t i = 0; i < _entries.size(); i++) {
+        if (_entries[i].folder || all) {
+            out.push_back(i);
+            continue;
+        }
+        // Extension after the last '.', the whole name when there is none
+        const char *n = name(i);
+        const char *dot = strrchr(n, '.');
+        const char *ext = dot ? dot + 1 : n;
+        size_t extLength = strlen(ext);
+
+        const char *pattern = allowedExt.c_str();
+        for (;;) {
+            const char *bar = strchr(pattern, '|');
+            size_t length = bar ? bar - pattern : strlen(pattern);
+            if (length == extLength && strncasecmp(pattern, ext, length) == 0) {
+                out.push_back(i);
+                break;
+            }
+            if (!bar) break;
+            pattern = bar + 1;
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Cache
+/////////////////////////////////////////////////////////////////////////////////////
+DirIndex *openDirIndex(FS &fs, const String &folder, bool rescan) {
+    uint32_t mtime = 0, fingerprint = 0;
+    // Without a fingerprint nothing cached can be trusted
+    if (!rescan && !readFingerprint(fs, folder, mtime, fingerprint)) rescan = true;
+
+    DirIndex *slot = nullptr;
+    for (DirIndex &s : slots) {
+        if (s._fs == &fs && s._folder == folder) {
+            slot = &s;
+            break;
+        }
+    }
+    if (!slot) {
+        // Least recently used one
+        slot = &slots[0];
+        for (DirIndex &s : slots)
+            if (s._lastUse < slot->_lastUse) slot = &s;
+        slot->clear();
+        slot->_fs = &fs;
+        slot->_folder = folder;
+    } else if (!rescan && slot->_mtime == mtime && slot->_fingerprint == fingerprint) {
+        slot->_lastUse = ++useCounter;
+        return slot;
+    }
+    slot->_lastUse = ++useCounter;
+
+    slot->_mtime = mtime;
+    slot->_fingerprint = fingerprint;
+    if (!rescan && slot->load(fs)) return slot;
+
+    if (!slot->scan(fs)) {
+        slot->clear();
+        return nullptr;
+    }
+    if (slot->count() >= DIR_INDEX_SAVE_MIN) slot->save(fs);
+    return slot;
+}
+
+void releaseDirIndexes() {
+    for (DirIndex &s : slots) s.clear();
+}
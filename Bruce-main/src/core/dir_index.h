@@ -0,0 +1,84 @@
+#ifndef __DIR_INDEX_H__
+#define __DIR_INDEX_H__
+
+#include <FS.h>
+#include <vector>
+
+/**
+ * Sorted listing of one folder, shared by the file browser and the web file
+ * manager.
+ *
+ * The folder is scanned once: names go in one buffer, entries are sorted with
+ * a precomputed key, and nothing is allocated per entry. The last few folders
+ * stay in memory, and big ones are also saved in /.dircache so they open fast
+ * after a reboot.
+ *
+ * A saved listing is used while the folder mtime and a fingerprint of its
+ * entry names still match. The fingerprint is one readdir() pass, without
+ * opening every entry like openNextFile() does. It's needed because FAT
+ * doesn't update the mtime of a folder when files are added to it. File sizes
+ * are the ones of the scan: a file rewritten in place keeps its old size in a
+ * cached listing until a rescan.
+ *
+ * The shared listings belong to the UI task. Other tasks (the web server)
+ * scan a DirIndex of their own with scanFolder().
+ */
+class DirIndex {
+public:
+    struct Entry {
+        uint32_t name; // Offset in the name buffer
+        uint32_t size;
+        uint32_t key;  // First 4 characters in upper case, compared before the names
+        uint8_t folder;
+        uint8_t reserved[3]; // Zero, no padding goes to /.dircache
+    };
+
+    // Scans folder into this listing, outside the shared ones
+    bool scanFolder(FS &fs, const String &folder);
+
+    // Sorted positions (folders first) of the entries whose name starts with
+    // prefix, ignoring case. When prefix extends the last one, only the last
+    // matches are checked again.
+    const std::vector<uint32_t> &matchPrefix(const String &prefix);
+    // Sorted positions of the folders and of the files with an allowed
+    // extension ("*" or a list like "SUB|IR")
+    void filter(const String &allowedExt, std::vector<uint32_t> &out) const;
+
+    const String &folder() const { return _folder; }
+    uint32_t count() const { return _entries.size(); }
+    const char *name(uint32_t i) const { return &_names[_entries[i].name]; }
+    bool isFolder(uint32_t i) const { return _entries[i].folder; }
+    uint32_t fileSize(uint32_t i) const { return _entries[i].size; } // As of the scan
+
+private:
+    friend DirIndex *openDirIndex(FS &fs, const String &folder, bool rescan);
+    friend void releaseDirIndexes();
+
+    bool scan(FS &fs);
+    void sort();
+    bool load(FS &fs);
+    void save(FS &fs) const;
+    void clear();
+
+    FS *_fs = nullptr;
+    String _folder;
+    uint32_t _mtime = 0;
+    uint32_t _fingerprint = 0;
+    uint32_t _lastUse = 0;
+    std::vector<Entry> _entries;
+    std::vector<char> _names;
+
+    String _prefix;
+    std::vector<uint32_t> _matches;
+};
+
+// Listing of folder (e.g. "/BruceRF"), from memory, /.dircache or a scan.
+// rescan skips the cached listings, for when the file sizes must be current.
+// The pointer stays valid until releaseDirIndexes() or a few other folders
+// were opened. UI task only, the listings aren't locked.
+DirIndex *openDirIndex(FS &fs, const String &folder, bool rescan = false);
+
+// Frees the listings kept in memory
+void releaseDirIndexes();
+
+#endif
@@ -249,7 +249,7 @@ void displayError(String txt, bool waitKeyPress) {
     return;
 #endif
     delay(200);
-    while (waitKeyPress && !check(AnyKeyPress)) vTaskDelay(10 / portTICK_PERIOD_MS);
+    if (waitKeyPress) waitAnyKeyPress();
 }
 
 void displayWarning(String txt, bool waitKeyPress) {
@@ -259,7 +259,7 @@ void displayWarning(String txt, bool waitKeyPress) {
     return;
 #endif
     delay(200);
-    while (waitKeyPress && !check(AnyKeyPress)) vTaskDelay(10 / portTICK_PERIOD_MS);
+    if (waitKeyPress) waitAnyKeyPress();
 }
 
 void displayInfo(String txt, bool waitKeyPress) {
@@ -271,7 +271,7 @@ void displayInfo(String txt, bool waitKeyPress) {
 #endif
 
     delay(200);
-    while (waitKeyPress && !check(AnyKeyPress)) vTaskDelay(10 / portTICK_PERIOD_MS);
+    if (waitKeyPress) waitAnyKeyPress();
 }
 
 void displaySuccess(String txt, bool waitKeyPress) {
@@ -282,7 +282,7 @@ void displaySuccess(String txt, bool waitKeyPress) {
     return;
 #endif
     delay(200);
-    while (waitKeyPress && !check(AnyKeyPress)) vTaskDelay(10 / portTICK_PERIOD_MS);
+    if (waitKeyPress) waitAnyKeyPress();
 }
 
 void displayTextLine(String txt, bool waitKeyPress) {
@@ -293,7 +293,7 @@ void displayTextLine(String txt, bool waitKeyPress) {
     return;
 #endif
     delay(200);
-    while (waitKeyPress && !check(AnyKeyPress)) vTaskDelay(10 / portTICK_PERIOD_MS);
+    if (waitKeyPress) waitAnyKeyPress();
 }
 
 void setPadCursor(int16_t padx, int16_t pady) {
@@ -468,6 +468,7 @@ int loopOptions(
     while (1) {
         // Check for shutdown before drawing menu to avoid drawing a black bar on the screen
         if (exit) break;
+        bruceConfig.saveIfDue();
         if (menuType == MENU_TYPE_MAIN) {
             checkReboot();
             if (millis() - _clock_bat_timer > 30000) {
@@ -929,13 +930,11 @@ void drawWireguardStatus(int x, int y) {
 ** Description:   Função para desenhar e mostrar o menu principal
 ***************************************************************************************/
 #define MAX_ITEMS (int)(tftHeight - 20) / (LH * FM)
-Opt_Coord listFiles(int index, std::vector<FileList> fileList) {
+Opt_Coord listFiles(int index, int count, FileList (*fileAt)(int)) {
     Opt_Coord coord;
     if (index == 0) { tft.fillScreen(bruceConfig.bgColor); }
     tft.setCursor(10, 10);
     tft.setTextSize(FM);
-    int i = 0;
-    int arraySize = fileList.size();
     int start = 0;
     if (index >= MAX_ITEMS) {
         start = index - MAX_ITEMS + 1;
@@ -943,28 +942,25 @@ Opt_Coord listFiles(int index, std::vector<FileList> fileList) {
     }
     int nchars = (tftWidth - 20) / (6 * tft.textsize);
     String txt = ">";
-    while (i < arraySize) {
-        if (i >= start) {
-            tft.setCursor(10, tft.getCursorY());
-            if (fileList[i].folder == true)
-                tft.setTextColor(getColorVariation(bruceConfig.priColor), bruceConfig.bgColor);
-            else if (fileList[i].operation == true) tft.setTextColor(ALCOLOR, bruceConfig.bgColor);
-            else { tft.setTextColor(bruceConfig.priColor, bruceConfig.bgColor); }
-
-            if (index == i) {
-                txt = ">";
-                coord.x = 10 + FM * LW;
-                coord.y = tft.getCursorY();
-                coord.size = nchars;
-                coord.fgcolor =
-                    fileList[i].folder ? getColorVariation(bruceConfig.priColor) : bruceConfig.priColor;
-                coord.bgcolor = bruceConfig.bgColor;
-            } else txt = " ";
-            txt += fileList[i].filename + "                 ";
-            tft.println(txt.substring(0, nchars));
-        }
-        i++;
-        if (i == (start + MAX_ITEMS) || i == arraySize) break;
+    // Only the visible rows are fetched
+    for (int i = start; i < count && i < start + MAX_ITEMS; i++) {
+        FileList file = fileAt(i);
+        tft.setCursor(10, tft.getCursorY());
+        if (file.folder == true)
+            tft.setTextColor(getColorVariation(bruceConfig.priColor), bruceConfig.bgColor);
+        else if (file.operation == true) tft.setTextColor(ALCOLOR, bruceConfig.bgColor);
+        else { tft.setTextColor(bruceConfig.priColor, bruceConfig.bgColor); }
+
+        if (index == i) {
+            txt = ">";
+            coord.x = 10 + FM * LW;
+            coord.y = tft.getCursorY();
+            coord.size = nchars;
+            coord.fgcolor = file.folder ? getColorVariation(bruceConfig.priColor) : bruceConfig.priColor;
+            coord.bgcolor = bruceConfig.bgColor;
+        } else txt = " ";
+        txt += file.filename + "                 ";
+        tft.println(txt.substring(0, nchars));
     }
     tft.drawRoundRect(5, 5, tftWidth - 10, tftHeight - 10, 5, bruceConfig.priColor);
     tft.drawRoundRect(5, 5, tftWidth - 10, tftHeight - 10, 5, bruceConfig.priColor);
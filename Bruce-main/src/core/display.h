@@ -179,7 +179,7 @@ void printSubtitle(String subtitle, bool withLine = true);
 void printFootnote(String text);
 void printCenterFootnote(String text);
 
-Opt_Coord listFiles(int index, std::vector<FileList> fileList);
+Opt_Coord listFiles(int index, int count, FileList (*fileAt)(int));
 
 void drawWireguardStatus(int x, int y);
 
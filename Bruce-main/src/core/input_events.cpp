@@ -0,0 +1,106 @@
+#include "input_events.h"
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <globals.h>
+
+#define INPUT_QUEUE_LENGTH 8
+
+static QueueHandle_t inputQueue = xQueueCreate(INPUT_QUEUE_LENGTH, sizeof(InputEvent));
+static SemaphoreHandle_t inputMutex = xSemaphoreCreateRecursiveMutex();
+
+static uint8_t watchedPins = 0;
+static volatile uint32_t lastActivityMs = 0;
+static volatile uint32_t lastEdgeMs = 0;
+static volatile bool edgePending = false;
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Wakeups
+/////////////////////////////////////////////////////////////////////////////////////
+void IRAM_ATTR inputWakeFromISR() {
+    uint32_t now = millis();
+    lastActivityMs = now;
+    if (edgePending && now - lastEdgeMs < INPUT_DEBOUNCE_MS) return; // Still bouncing
+    lastEdgeMs = now;
+    edgePending = true;
+    if (!xHandle) return; // Before the input task exists
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(xHandle, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+static void IRAM_ATTR inputPinISR() { inputWakeFromISR(); }
+
+void inputWatchPin(uint8_t pin) {
+    attachInterrupt(digitalPinToInterrupt(pin), inputPinISR, CHANGE);
+    watchedPins++;
+}
+
+void inputWake() {
+    lastActivityMs = millis();
+    if (xHandle) xTaskNotifyGive(xHandle);
+}
+
+void inputIdle(bool pressed) {
+    uint32_t now = millis();
+    if (pressed) lastActivityMs = now;
+    uint32_t waitMs = INPUT_POLL_MS;
+    // Only sleeps longer when an edge is sure to wake it
+    if (watchedPins > 0 && now - lastActivityMs > INPUT_ACTIVE_MS) waitMs = INPUT_IDLE_MS;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Events
+/////////////////////////////////////////////////////////////////////////////////////
+void inputPublish() {
+    InputEvent event;
+    event.keys = (NextPress ? INPUT_EV_NEXT : 0) | (PrevPress ? INPUT_EV_PREV : 0) |
+                 (UpPress ? INPUT_EV_UP : 0) | (DownPress ? INPUT_EV_DOWN : 0) |
+                 (SelPress ? INPUT_EV_SEL : 0) | (EscPress ? INPUT_EV_ESC : 0) |
+                 (NextPagePress ? INPUT_EV_NEXT_PAGE : 0) | (PrevPagePress ? INPUT_EV_PREV_PAGE : 0) |
+                 (SerialCmdPress ? INPUT_EV_SERIAL : 0) | (touchPoint.pressed ? INPUT_EV_TOUCH : 0) |
+                 (KeyStroke.pressed ? INPUT_EV_KEYBOARD : 0);
+    if (event.keys == 0 && !AnyKeyPress) return;
+    event.ms = millis();
+    if (edgePending) {
+        event.ms = lastEdgeMs;
+        edgePending = false;
+    }
+    lastActivityMs = millis();
+    // A full queue means nobody is waiting: the oldest press is the one to lose
+    if (xQueueSend(inputQueue, &event, 0) != pdTRUE) {
+        InputEvent oldest;
+        xQueueReceive(inputQueue, &oldest, 0);
+        xQueueSend(inputQueue, &event, 0);
+    }
+}
+
+bool waitInputEvent(InputEvent &event, uint32_t timeoutMs) {
+    TickType_t ticks = timeoutMs == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+    return xQueueReceive(inputQueue, &event, ticks) == pdTRUE;
+}
+
+bool waitAnyKeyPress(uint32_t timeoutMs) {
+    uint32_t start = millis();
+    InputEvent event;
+    for (;;) {
+        if (check(AnyKeyPress)) return true;
+        uint32_t waitMs = timeoutMs;
+        if (timeoutMs != portMAX_DELAY) {
+            uint32_t elapsed = millis() - start;
+            if (elapsed >= timeoutMs) return false;
+            waitMs = timeoutMs - elapsed;
+        }
+#ifdef USE_TFT_eSPI_TOUCH
+        // check() reads the touch screen itself, nothing else would publish it
+        if (waitMs > INPUT_POLL_MS) waitMs = INPUT_POLL_MS;
+#endif
+        // A press is published after its flags are set, so one that lands
+        // between check() and here is still in the queue
+        waitInputEvent(event, waitMs);
+    }
+}
+
+void inputLock() { xSemaphoreTakeRecursive(inputMutex, portMAX_DELAY); }
+
+void inputUnlock() { xSemaphoreGiveRecursive(inputMutex); }
@@ -0,0 +1,68 @@
+#ifndef __INPUT_EVENTS_H__
+#define __INPUT_EVENTS_H__
+
+#include <Arduino.h>
+
+/**
+ * Wakeups and events for the input task.
+ *
+ * Buttons and encoders wired to GPIOs are watched with interrupts: an edge
+ * wakes the input task right away, so it doesn't have to poll them every
+ * 10ms. Once nothing moved for INPUT_ACTIVE_MS it sleeps until the next edge
+ * (or INPUT_IDLE_MS, for the dimmer). Boards with inputs that can't interrupt
+ * (I2C keyboards, touch, M5 buttons) don't watch any pin and keep polling.
+ *
+ * Every press InputHandler() reports is also queued as an InputEvent, so code
+ * waiting for a key can block on waitInputEvent() instead of looping on
+ * check() with a delay. The navigation flags stay what check() reads.
+ */
+
+#define INPUT_POLL_MS 10      // While active, or when not every input is watched
+#define INPUT_ACTIVE_MS 1000  // Polling continues this long after the last press or edge
+#define INPUT_IDLE_MS 250     // Longest sleep when idle, for checkPowerSaveTime()
+#define INPUT_DEBOUNCE_MS 5   // Edges closer than this only wake the task once
+
+enum InputKey : uint16_t {
+    INPUT_EV_NEXT = 1 << 0,
+    INPUT_EV_PREV = 1 << 1,
+    INPUT_EV_UP = 1 << 2,
+    INPUT_EV_DOWN = 1 << 3,
+    INPUT_EV_SEL = 1 << 4,
+    INPUT_EV_ESC = 1 << 5,
+    INPUT_EV_NEXT_PAGE = 1 << 6,
+    INPUT_EV_PREV_PAGE = 1 << 7,
+    INPUT_EV_SERIAL = 1 << 8, // Sent by the serial or web remote
+    INPUT_EV_TOUCH = 1 << 9,
+    INPUT_EV_KEYBOARD = 1 << 10,
+};
+
+struct InputEvent {
+    uint16_t keys; // InputKey bits
+    uint32_t ms;   // When it happened: the interrupt edge if there was one
+};
+
+// Wakes the input task on every edge of pin. Call it from _setup_gpio(), after
+// pinMode(), and only when all of the board inputs are watched this way.
+void inputWatchPin(uint8_t pin);
+// For a board's own input ISR (an encoder), so it also wakes the input task
+void IRAM_ATTR inputWakeFromISR();
+// For tasks that set the navigation flags themselves (the remote commands)
+void inputWake();
+
+// Blocks the input task until an input wakes it or the next poll is due
+void inputIdle(bool pressed);
+// Queues the keys set in the navigation flags, if any
+void inputPublish();
+
+// Next press, false after timeoutMs without one. Only one task should wait at
+// a time; events queued before the wait started are kept.
+bool waitInputEvent(InputEvent &event, uint32_t timeoutMs = portMAX_DELAY);
+// Blocks until check(AnyKeyPress) would be true, then consumes it like check()
+bool waitAnyKeyPress(uint32_t timeoutMs = portMAX_DELAY);
+
+// Held by the input task while it resets and reads the flags, and by check()
+// while it clears them
+void inputLock();
+void inputUnlock();
+
+#endif
@@ -4,13 +4,94 @@
 #include "core/display.h"
 #include <USB.h>
 
+#define MSC_CACHE_SECTORS 32  // 16 kB window
+#define MSC_FLUSH_IDLE_MS 200 // Gathered writes reach the card this long after the host stops writing
+
 bool MassStorage::shouldStop = false;
 int32_t MassStorage::status = -1;
 
+/////////////////////////////////////////////////////////////////////////////////////
+// Sector cache
+/////////////////////////////////////////////////////////////////////////////////////
+// TinyUSB hands the host transfers over a few sectors at a time. One window of
+// consecutive sectors turns them into multi-block commands: sequential reads fill
+// it ahead of the host, consecutive writes gather in it and go to the card in one
+// command when the host writes elsewhere, goes idle or ejects.
+// The callbacks run in the TinyUSB task, the idle flush in the UI task.
+static uint8_t *cacheData = nullptr;
+static uint32_t cacheLba = 0;
+static uint32_t cacheCount = 0; // Sectors in the window, 0 when empty
+static bool cacheDirty = false;
+static uint32_t cacheWriteTime = 0; // millis() of the last write gathered
+static uint32_t nextReadLba = UINT32_MAX;
+static uint32_t secSize = 0;
+static uint32_t numSectors = 0;
+static SemaphoreHandle_t cacheLock = nullptr;
+
+// Bytes moved over USB, for the transfer rate
+static volatile uint32_t bytesRead = 0;
+static volatile uint32_t bytesWritten = 0;
+
+class CacheLock {
+public:
+    CacheLock() {
+        if (cacheLock) xSemaphoreTake(cacheLock, portMAX_DELAY);
+    }
+    ~CacheLock() {
+        if (cacheLock) xSemaphoreGive(cacheLock);
+    }
+};
+
+static void cacheBegin() {
+    secSize = SD.sectorSize();
+    numSectors = SD.numSectors();
+    cacheCount = 0;
+    cacheDirty = false;
+    nextReadLba = UINT32_MAX;
+    bytesRead = bytesWritten = 0;
+    if (!cacheLock) cacheLock = xSemaphoreCreateMutex();
+    // Without it every request still goes to the card as one multi-block command
+    if (!cacheData && secSize) {
+        cacheData = (uint8_t *)heap_caps_malloc(MSC_CACHE_SECTORS * secSize, MALLOC_CAP_DMA);
+    }
+}
+
+// Called with the lock held. The host was already told these sectors were
+// written: when the card refuses them the window stays dirty, every request
+// that needs it flushed fails until a retry goes through.
+static bool cacheFlush() {
+    if (!cacheDirty) return true;
+    if (!SD.writeRAW(cacheData, cacheLba, cacheCount)) {
+        log_e("MSC: write of %u sectors at %u failed", cacheCount, cacheLba);
+        return false;
+    }
+    cacheDirty = false;
+    return true;
+}
+
+static void cacheFlushIdle() {
+    if (!cacheDirty) return;
+    CacheLock lock;
+    if (cacheDirty && millis() - cacheWriteTime >= MSC_FLUSH_IDLE_MS && !cacheFlush()) {
+        cacheWriteTime = millis(); // Retried after another idle period
+    }
+}
+
+static void cacheEnd() {
+    CacheLock lock;
+    if (cacheData) {
+        if (!cacheFlush()) log_e("MSC: %u sectors at %u lost", cacheCount, cacheLba);
+        free(cacheData);
+        cacheData = nullptr;
+    }
+    cacheCount = 0;
+}
+
 MassStorage::MassStorage() { setup(); }
 
 MassStorage::~MassStorage() {
     msc.end();
+    cacheEnd();
     USB.~ESPUSB();
 
     // Hack to make USB back to flash mode
@@ -36,6 +117,12 @@ void MassStorage::setup() {
 
 void MassStorage::loop() {
     int32_t prev_status = -1;
+    uint32_t rateTime = millis();
+    uint32_t prevRead = 0;
+    uint32_t prevWritten = 0;
+    uint64_t totalRead = 0;
+    uint64_t totalWritten = 0;
+
     while (!check(EscPress) && !shouldStop) {
         if (prev_status != status) {
             vTaskDelay(100 / portTICK_PERIOD_MS);
@@ -48,6 +135,25 @@ void MassStorage::loop() {
             }
             prev_status = status;
         } else vTaskDelay(20 / portTICK_PERIOD_MS);
+
+        cacheFlushIdle();
+
+        uint32_t now = millis();
+        if (now - rateTime >= 1000) {
+            uint32_t read = bytesRead;
+            uint32_t written = bytesWritten;
+            totalRead += read - prevRead;
+            totalWritten += written - prevWritten;
+            drawTransferRate(
+                totalRead,
+                (uint64_t)(read - prevRead) * 1000 / (now - rateTime),
+                totalWritten,
+                (uint64_t)(written - prevWritten) * 1000 / (now - rateTime)
+            );
+            prevRead = read;
+            prevWritten = written;
+            rateTime = now;
+        }
     }
 }
 
@@ -59,8 +165,7 @@ void MassStorage::beginUsb() {
 }
 
 void MassStorage::setupUsbCallback() {
-    uint32_t secSize = SD.sectorSize();
-    uint32_t numSectors = SD.numSectors();
+    cacheBegin();
 
     msc.vendorID("ESP32");
     msc.productID("BRUCE");
@@ -87,42 +192,75 @@ void MassStorage::displayMessage(String message) {
 }
 
 int32_t usbWriteCallback(uint32_t lba, uint32_t offset, uint8_t *buffer, uint32_t bufsize) {
-    // Verify freespace
-    uint64_t freeSpace = SD.totalBytes() - SD.usedBytes();
-    if (bufsize > freeSpace) {
-        return -1; // no space available
-    }
-
-    // Verify sector size
-    const uint32_t secSize = SD.sectorSize();
     if (secSize == 0) return -1; // disk error
+    const uint32_t count = bufsize / secSize;
+    if (count == 0) return bufsize;
+
+    CacheLock lock;
+    cacheWriteTime = millis();
+    bytesWritten += bufsize;
+
+    // Continues or rewrites the run being gathered
+    if (cacheDirty && lba >= cacheLba && lba <= cacheLba + cacheCount &&
+        lba + count <= cacheLba + MSC_CACHE_SECTORS) {
+        memcpy(cacheData + (lba - cacheLba) * secSize, buffer, count * secSize);
+        if (lba + count > cacheLba + cacheCount) cacheCount = lba + count - cacheLba;
+        return bufsize;
+    }
 
-    // Write blocs
-    for (uint32_t x = 0; x < bufsize / secSize; ++x) {
-        uint8_t blkBuffer[secSize];
-        memcpy(blkBuffer, buffer + secSize * x, secSize);
-        if (!SD.writeRAW(blkBuffer, lba + x)) {
-            return -1; // write error
-        }
+    // Nothing new is taken while the window can't reach the card
+    if (!cacheFlush()) return -1; // write error
+    cacheCount = 0; // A read ahead may hold these sectors
+    bool ok = true;
+    if (!cacheData || count >= MSC_CACHE_SECTORS) {
+        ok = SD.writeRAW(buffer, lba, count);
+    } else {
+        memcpy(cacheData, buffer, count * secSize);
+        cacheLba = lba;
+        cacheCount = count;
+        cacheDirty = true;
     }
-    return bufsize;
+    return ok ? bufsize : -1; // write error
 }
 
 int32_t usbReadCallback(uint32_t lba, uint32_t offset, void *buffer, uint32_t bufsize) {
-    // Verify sector size
-    const uint32_t secSize = SD.sectorSize();
     if (secSize == 0) return -1; // disk error
+    const uint32_t count = bufsize / secSize;
+    if (count == 0) return bufsize;
+    uint8_t *out = reinterpret_cast<uint8_t *>(buffer);
+
+    CacheLock lock;
+    bytesRead += bufsize;
+    const bool sequential = lba == nextReadLba;
+    nextReadLba = lba + count;
+
+    // Also while a failed window is kept dirty: it holds the newest sectors
+    if (cacheCount && lba >= cacheLba && lba + count <= cacheLba + cacheCount) {
+        memcpy(out, cacheData + (lba - cacheLba) * secSize, count * secSize);
+        return bufsize;
+    }
 
-    // Read blocs
-    for (uint32_t x = 0; x < bufsize / secSize; ++x) {
-        if (!SD.readRAW(reinterpret_cast<uint8_t *>(buffer) + (x * secSize), lba + x)) {
-            return -1; // read error
-        }
+    // The window may hold newer sectors than the card
+    if (!cacheFlush()) return -1;
+    // Random reads (FAT, directories) only read what was asked
+    if (!cacheData || !sequential || count >= MSC_CACHE_SECTORS) {
+        return SD.readRAW(out, lba, count) ? bufsize : -1;
     }
+
+    uint32_t ahead = numSectors - lba < MSC_CACHE_SECTORS ? numSectors - lba : MSC_CACHE_SECTORS;
+    cacheCount = 0;
+    if (!SD.readRAW(cacheData, lba, ahead)) return -1; // read error
+    cacheLba = lba;
+    cacheCount = ahead;
+    memcpy(out, cacheData, count * secSize);
     return bufsize;
 }
 
 bool usbStartStopCallback(uint8_t power_condition, bool start, bool load_eject) {
+    if (!start) {
+        CacheLock lock;
+        cacheFlush();
+    }
     if (!start && load_eject) {
         MassStorage::setShouldStop(true);
         return false;
@@ -182,4 +320,23 @@ void drawUSBStickIcon(bool plugged) {
     tft.fillRoundRect(ledX, ledY, ledW, ledH, radius, plugged ? TFT_GREEN : TFT_RED);
 }
 
+// Like dd: how much went each way, and how fast over the last second
+void drawTransferRate(uint64_t readBytes, uint32_t readRate, uint64_t writeBytes, uint32_t writeRate) {
+    tft.setTextSize(FP);
+    tft.setTextColor(bruceConfig.priColor, bruceConfig.bgColor);
+    tft.fillRect(10, tftHeight - 28, tftWidth - 20, 20, bruceConfig.bgColor);
+    tft.drawCentreString(
+        "Read " + String(readBytes / 1e6, 1) + " MB, " + String(readRate / 1e6, 2) + " MB/s",
+        tftWidth / 2,
+        tftHeight - 28,
+        1
+    );
+    tft.drawCentreString(
+        "Written " + String(writeBytes / 1e6, 1) + " MB, " + String(writeRate / 1e6, 2) + " MB/s",
+        tftWidth / 2,
+        tftHeight - 18,
+        1
+    );
+}
+
 #endif // ARDUINO_USB_MODE
@@ -49,6 +49,7 @@ int32_t usbReadCallback(uint32_t lba, uint32_t offset, void *buffer, uint32_t bu
 bool usbStartStopCallback(uint8_t power_condition, bool start, bool load_eject);
 
 void drawUSBStickIcon(bool plugged);
+void drawTransferRate(uint64_t readBytes, uint32_t readRate, uint64_t writeBytes, uint32_t writeRate);
 
 #endif // MASS_STORAGE_H
 #endif // ARDUINO_USB_MODE
@@ -53,8 +53,14 @@ void ConfigMenu::optionsMenu() {
         {"Restart", [=]() { ESP.restart(); }},
     };
 
-    options.push_back({"Turn-off", powerOff});
-    options.push_back({"Deep Sleep", goToDeepSleep});
+    options.push_back({"Turn-off", []() {
+                           bruceConfig.flushFile();
+                           powerOff();
+                       }});
+    options.push_back({"Deep Sleep", []() {
+                           bruceConfig.flushFile();
+                           goToDeepSleep();
+                       }});
 
     if (bruceConfig.devMode) options.push_back({"Device Pin setting", [=]() { devMenu(); }});
 
@@ -28,6 +28,7 @@ void IRMenu::configMenu() {
         {"Ir TX Pin", lambdaHelper(gsetIrTxPin, true)},
         {"Ir RX Pin", lambdaHelper(gsetIrRxPin, true)},
         {"Ir TX Repeats", setIrTxRepeats},
+        {"Ir RX Capture", setIrRxCapture},
         {"Back", [=]() { optionsMenu(); }},
     };
 
@@ -118,11 +118,10 @@ struct box_t {
 // This function is used in loopTask to get the latest key press.
 keyStroke _getKeyPress() {
 #ifndef USE_TFT_eSPI_TOUCH
-    vTaskSuspend(xHandle);
+    inputLock();
     keyStroke key = KeyStroke;
     KeyStroke.Clear();
-    delay(10);
-    vTaskResume(xHandle);
+    inputUnlock();
     return key;
 #else
     keyStroke key = KeyStroke;
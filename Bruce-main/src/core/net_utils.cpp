@@ -2,12 +2,103 @@
 
 #include <ESPping.h>
 #include <HTTPClient.h>
+#include <LittleFS.h>
+#include <OuiTable.h>
+#include <SD.h>
 #include <WiFi.h>
+#include <algorithm>
+#include <esp_partition.h>
+#include <globals.h>
 #include <sstream>
 
 bool internetConnection() { return Ping.ping(IPAddress(8, 8, 8, 8)); }
 
-String getManufacturer(const String &mac) {
+/////////////////////////////////////////////////////////////////////////////////////
+// Vendor lookup
+/////////////////////////////////////////////////////////////////////////////////////
+#define OUI_FILE "/oui.bin"
+#define OUI_CACHE_SIZE 16
+
+struct OuiCacheEntry {
+    uint64_t key; // OuiTable::key36() + 1, 0 when unused
+    uint32_t used;
+    char name[OUI_NAME_MAX]; // "" if not registered
+};
+static OuiCacheEntry ouiCache[OUI_CACHE_SIZE];
+static uint32_t ouiCacheClock = 0;
+
+static const uint8_t *ouiMapped = nullptr;
+static size_t ouiMappedSize = 0;
+static bool ouiPartitionChecked = false;
+
+static bool ouiReadFile(void *context, uint32_t offset, uint8_t *out, uint32_t len) {
+    File *file = (File *)context;
+    return (file->position() == offset || file->seek(offset)) && file->read(out, len) == len;
+}
+
+// The table from a data partition labelled "oui", memory mapped, else /oui.bin on SD or LittleFS
+static bool ouiOpen(OuiTable &table, File &file) {
+    if (!ouiPartitionChecked) {
+        ouiPartitionChecked = true;
+        const esp_partition_t *partition =
+            esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "oui");
+        const void *data;
+        spi_flash_mmap_handle_t handle;
+        esp_err_t err = ESP_FAIL;
+        if (partition) {
+            err = esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA, &data, &handle);
+        }
+        if (err == ESP_OK) {
+            ouiMapped = (const uint8_t *)data;
+            ouiMappedSize = partition->size;
+        }
+    }
+    if (ouiMapped && table.begin(ouiMapped, ouiMappedSize)) return true;
+
+    if (sdcardMounted && SD.exists(OUI_FILE)) file = SD.open(OUI_FILE, FILE_READ);
+    else if (LittleFS.exists(OUI_FILE)) file = LittleFS.open(OUI_FILE, FILE_READ);
+    return file && table.begin(ouiReadFile, &file, file.size());
+}
+
+// Vendor of mac, "" if not registered. Recent prefixes are cached, SD reads are slow.
+static String ouiVendor(OuiTable &table, const uint8_t mac[6], OuiTable::Hint *hint) {
+    // Locally administered (random, private) addresses have no vendor
+    if (mac[0] & 0x02) return "";
+
+    uint64_t key = OuiTable::key36(mac) + 1;
+    OuiCacheEntry *entry = &ouiCache[0];
+    for (auto &cached : ouiCache) {
+        if (cached.key == key) {
+            cached.used = ++ouiCacheClock;
+            return cached.name;
+        }
+        if (cached.used < entry->used) entry = &cached;
+    }
+
+    if (!table.lookup(mac, entry->name, sizeof(entry->name), hint)) entry->name[0] = 0;
+    entry->key = key;
+    entry->used = ++ouiCacheClock;
+    return entry->name;
+}
+
+bool getManufacturers(const uint8_t *macs, size_t count, std::vector<String> &vendors) {
+    vendors.assign(count, String());
+    OuiTable table;
+    File file;
+    if (!ouiOpen(table, file)) return false;
+
+    // In ascending order, each search starts where the previous one ended
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [macs](size_t a, size_t b) {
+        return memcmp(macs + 6 * a, macs + 6 * b, 6) < 0;
+    });
+    OuiTable::Hint hint;
+    for (size_t i : order) vendors[i] = ouiVendor(table, macs + 6 * i, &hint);
+    return true;
+}
+
+static String getManufacturerOnline(const String &mac) {
     if (!internetConnection()) { return "NO_INTERNET_ACCESS"; }
 
     // there is an official(IEEE) doc that contains all registered mac prefixes
@@ -34,6 +125,16 @@ String getManufacturer(const String &mac) {
     return manufacturer;
 }
 
+String getManufacturer(const String &mac) {
+    uint8_t bytes[6];
+    stringToMAC(mac.c_str(), bytes);
+    if (bytes[0] & 0x02) return "Locally administered";
+
+    std::vector<String> vendors;
+    if (!getManufacturers(bytes, 1, vendors)) return getManufacturerOnline(mac);
+    return vendors[0].isEmpty() ? "UNKNOWN" : vendors[0];
+}
+
 String MAC(uint8_t *data) {
     char macStr[18];
     snprintf(
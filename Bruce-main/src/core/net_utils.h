@@ -1,10 +1,15 @@
 #include <ESPping.h>
 #include <HTTPClient.h>
 #include <WiFi.h>
+#include <vector>
 
 bool internetConnection();
 
+// Vendor of a MAC, from the offline table (tools/oui_pack.py) when there is one, else from an online API
 String getManufacturer(const String &mac);
+// Vendors of count MACs (6 bytes each, back to back), "" when unknown, with one table open for all.
+// False if there's no offline table.
+bool getManufacturers(const uint8_t *macs, size_t count, std::vector<String> &vendors);
 
 String MAC(uint8_t *data);
 
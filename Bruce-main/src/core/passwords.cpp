@@ -1,6 +1,9 @@
 
 #include <Arduino.h>
 #include <MD5Builder.h>
+#include <esp_system.h>
+#include <mbedtls/md.h>
+#include <mbedtls/pkcs5.h>
 
 #include "mykeyboard.h"
 #include "passwords.h"
@@ -8,8 +11,7 @@
 #include "type_convertion.h"
 #include <globals.h>
 
-String xorEncryptDecryptMD5(const String &input, const String &password, const int MD5_PASSES) {
-
+static void xorKeyMD5(const String &password, const int MD5_PASSES, uint8_t md5Hash[16]) {
     MD5Builder md5;
     String hash = password;
 
@@ -19,8 +21,12 @@ String xorEncryptDecryptMD5(const String &input, const String &password, const i
         md5.calculate();
     }
 
-    uint8_t md5Hash[16];
     md5.getBytes(md5Hash); // Store MD5 hash in the output array
+}
+
+String xorEncryptDecryptMD5(const String &input, const String &password, const int MD5_PASSES) {
+    uint8_t md5Hash[16];
+    xorKeyMD5(password, MD5_PASSES, md5Hash);
 
     String output = input; // Copy input to output for modification
     for (size_t i = 0; i < input.length(); i++) {
@@ -71,19 +77,261 @@ String readDecryptedFileOLD(FS &fs, String filepath) {
 }
 */
 
-String readDecryptedFile(FS &fs, String filepath) {
+#define ENCRYPT_MAGIC "BRUCEENC"
+#define ENCRYPT_VERSION 2
+#define ENCRYPT_KDF_PBKDF2_SHA256 1
+#define ENCRYPT_CIPHER_AES256_CTR 1
+#define ENCRYPT_ITERATIONS 10000
+#define ENCRYPT_CHUNK 512
+#define KEY_CACHE_SIZE 4
+
+struct EncryptHeader {
+    char magic[8];
+    uint8_t version;
+    uint8_t kdf;
+    uint8_t cipher;
+    uint8_t reserved;
+    uint32_t iterations;
+    uint8_t salt[16];
+    uint8_t nonce[16];
+    uint8_t check[16]; // Derived with the key, tells a wrong password
+};
+static_assert(sizeof(EncryptHeader) == ENCRYPT_HEADER_SIZE, "EncryptHeader layout");
+
+struct DerivedKey {
+    uint32_t iterations;
+    uint8_t salt[16];
+    uint8_t key[32];
+    uint8_t check[16];
+};
+
+struct CachedKey {
+    String password;
+    uint32_t lastUse = 0; // 0: empty
+    DerivedKey key;
+};
+// Used from the UI, serial and web server tasks: only touched with keyLock held,
+// callers get a copy of the key
+static CachedKey keyCache[KEY_CACHE_SIZE];
+static uint32_t keyCacheUses = 0;
+static SemaphoreHandle_t keyLock = nullptr;
+static TaskHandle_t deriveTask = nullptr;
+static String derivePassword; // For deriveTask
+
+static void lockKeys() {
+    if (!keyLock) keyLock = xSemaphoreCreateMutex();
+    xSemaphoreTake(keyLock, portMAX_DELAY);
+}
 
-    if (cachedPassword.length() == 0) {
-        cachedPassword = keyboard("", 32, "password");
-        if (cachedPassword.length() == 0) return ""; // cancelled
+static void unlockKeys() { xSemaphoreGive(keyLock); }
+
+// Appends whatever is written to it to a String
+class StringPrint : public Print {
+public:
+    StringPrint(String &s) : _s(s) {}
+    size_t write(uint8_t c) override { return _s.concat((char)c) ? 1 : 0; }
+    size_t write(const uint8_t *buffer, size_t size) override {
+        return _s.concat((const char *)buffer, size) ? size : 0;
+    }
+
+private:
+    String &_s;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Version 2
+/////////////////////////////////////////////////////////////////////////////////////
+// A cached key of password, with any salt when salt is NULL
+static bool cachedKey(const String &password, const uint8_t *salt, uint32_t iterations, DerivedKey &out) {
+    bool found = false;
+    lockKeys();
+    for (CachedKey &k : keyCache) {
+        if (k.lastUse && k.key.iterations == iterations && k.password == password &&
+            (!salt || memcmp(k.key.salt, salt, 16) == 0)) {
+            k.lastUse = ++keyCacheUses;
+            out = k.key;
+            found = true;
+            break;
+        }
+    }
+    unlockKeys();
+    return found;
+}
+
+static void cacheKey(const String &password, const DerivedKey &key) {
+    lockKeys();
+    CachedKey *slot = &keyCache[0];
+    for (CachedKey &k : keyCache) {
+        if (k.lastUse < slot->lastUse) slot = &k;
+    }
+    slot->password = password;
+    slot->lastUse = ++keyCacheUses;
+    slot->key = key;
+    unlockKeys();
+}
+
+// PBKDF2 takes most of a second, it runs without the lock held
+static bool deriveKey(const String &password, const uint8_t *salt, uint32_t iterations, DerivedKey &out) {
+    if (cachedKey(password, salt, iterations, out)) return true;
+
+    // Key and password check in one go
+    uint8_t derived[48];
+    mbedtls_md_context_t md;
+    mbedtls_md_init(&md);
+    int err = mbedtls_md_setup(&md, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    if (err == 0) {
+        err = mbedtls_pkcs5_pbkdf2_hmac(
+            &md,
+            (const uint8_t *)password.c_str(),
+            password.length(),
+            salt,
+            16,
+            iterations,
+            sizeof(derived),
+            derived
+        );
+    }
+    mbedtls_md_free(&md);
+    if (err != 0) return false;
+
+    out.iterations = iterations;
+    memcpy(out.salt, salt, 16);
+    memcpy(out.key, derived, 32);
+    memcpy(out.check, derived + 32, 16);
+    memset(derived, 0, sizeof(derived));
+    cacheKey(password, out);
+    return true;
+}
+
+// New files reuse the salt of a key already derived for the password
+static bool keyForNewFile(const String &password, bool derive, DerivedKey &out) {
+    if (cachedKey(password, NULL, ENCRYPT_ITERATIONS, out)) return true;
+    if (!derive) return false;
+    uint8_t salt[16];
+    esp_fill_random(salt, sizeof(salt));
+    return deriveKey(password, salt, ENCRYPT_ITERATIONS, out);
+}
+
+static void deriveLoop(void *parameter) {
+    lockKeys();
+    String password = derivePassword;
+    unlockKeys();
+
+    DerivedKey key;
+    keyForNewFile(password, true, key);
+    memset(&key, 0, sizeof(key));
+
+    lockKeys();
+    derivePassword = "";
+    deriveTask = nullptr;
+    unlockKeys();
+    vTaskDelete(NULL);
+}
+
+bool encryptKeyPrepare(const String &password) {
+    DerivedKey key;
+    if (keyForNewFile(password, false, key)) {
+        memset(&key, 0, sizeof(key));
+        return true;
+    }
+    // One at a time, a second password gets its turn on a retry
+    lockKeys();
+    if (!deriveTask) {
+        derivePassword = password;
+        if (xTaskCreate(deriveLoop, "DeriveKey", 4096, NULL, 1, &deriveTask) != pdPASS) {
+            derivePassword = "";
+            deriveTask = nullptr;
+        }
+    }
+    unlockKeys();
+    return false;
+}
+
+static void startCtr(EncryptStream &stream, const DerivedKey &key, const uint8_t *nonce) {
+    mbedtls_aes_init(&stream.aes);
+    mbedtls_aes_setkey_enc(&stream.aes, key.key, 256);
+    memcpy(stream.counter, nonce, 16);
+    memset(stream.block, 0, 16);
+    stream.blockOffset = 0;
+}
+
+bool isEncryptedFileV2(const uint8_t *header, size_t len) {
+    return len >= ENCRYPT_HEADER_SIZE && memcmp(header, ENCRYPT_MAGIC, 8) == 0;
+}
+
+bool encryptStreamBegin(EncryptStream &stream, const String &password, uint8_t *header, bool derive) {
+    DerivedKey key;
+    if (!keyForNewFile(password, derive, key)) return false;
+
+    EncryptHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, ENCRYPT_MAGIC, 8);
+    h.version = ENCRYPT_VERSION;
+    h.kdf = ENCRYPT_KDF_PBKDF2_SHA256;
+    h.cipher = ENCRYPT_CIPHER_AES256_CTR;
+    h.iterations = key.iterations;
+    memcpy(h.salt, key.salt, 16);
+    // Files of the same password share the key, the nonce must never repeat
+    esp_fill_random(h.nonce, sizeof(h.nonce));
+    memcpy(h.check, key.check, 16);
+    memcpy(header, &h, sizeof(h));
+
+    startCtr(stream, key, h.nonce);
+    memset(&key, 0, sizeof(key));
+    return true;
+}
+
+bool decryptStreamBegin(EncryptStream &stream, const String &password, const uint8_t *header) {
+    EncryptHeader h;
+    memcpy(&h, header, sizeof(h));
+    if (memcmp(h.magic, ENCRYPT_MAGIC, 8) != 0 || h.version != ENCRYPT_VERSION ||
+        h.kdf != ENCRYPT_KDF_PBKDF2_SHA256 || h.cipher != ENCRYPT_CIPHER_AES256_CTR || h.iterations == 0) {
+        return false;
     }
 
-    File cyphertextFile = fs.open(filepath, FILE_READ);
-    if (!cyphertextFile) return "";
+    DerivedKey key;
+    if (!deriveKey(password, h.salt, h.iterations, key)) return false;
+    uint8_t diff = 0;
+    for (int i = 0; i < 16; i++) diff |= key.check[i] ^ h.check[i];
+    if (diff == 0) startCtr(stream, key, h.nonce);
+    memset(&key, 0, sizeof(key));
+    return diff == 0;
+}
+
+void encryptStreamUpdate(EncryptStream &stream, const uint8_t *in, uint8_t *out, size_t len) {
+    mbedtls_aes_crypt_ctr(&stream.aes, len, &stream.blockOffset, stream.counter, stream.block, in, out);
+}
 
+void encryptStreamEnd(EncryptStream &stream) {
+    mbedtls_aes_free(&stream.aes);
+    memset(stream.block, 0, sizeof(stream.block));
+}
+
+bool writeEncryptedFile(
+    FS &fs, const String &filepath, const uint8_t *data, size_t len, const String &password
+) {
+    EncryptStream stream;
+    uint8_t buffer[ENCRYPT_CHUNK];
+    if (!encryptStreamBegin(stream, password, buffer)) return false;
+
+    File file = fs.open(filepath, FILE_WRITE);
+    bool ok = file && file.write(buffer, ENCRYPT_HEADER_SIZE) == ENCRYPT_HEADER_SIZE;
+    for (size_t i = 0; ok && i < len; i += ENCRYPT_CHUNK) {
+        size_t n = len - i < ENCRYPT_CHUNK ? len - i : ENCRYPT_CHUNK;
+        encryptStreamUpdate(stream, data + i, buffer, n);
+        ok = file.write(buffer, n) == n;
+    }
+    encryptStreamEnd(stream);
+    if (file) file.close();
+    return ok;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Version 1
+/////////////////////////////////////////////////////////////////////////////////////
+static bool decryptFileV1(File &cyphertextFile, const String &password, String &plaintext) {
     String line;
     String cypertextData = "";
-    String plaintext = "";
     bool unsupported_params = false;
 
     while (cyphertextFile.available()) {
@@ -96,80 +344,145 @@ String readDecryptedFile(FS &fs, String filepath) {
         if (line.startsWith("Data:")) cypertextData = line.substring(strlen("Data:"));
     }
 
-    cyphertextFile.close();
-
     if (unsupported_params || cypertextData.length() == 0) {
         Serial.println("err: invalid Encrypted file (altered?)");
-        return "";
+        return false;
     }
 
     // else try decrypting
     cypertextData.trim();
     String cypertextDataDec = "";
-    cypertextDataDec.reserve(cypertextData.length());
+    cypertextDataDec.reserve(cypertextData.length() / 3 + 1);
 
-    uint8_t decimal = 0;
-    char temp[3]; // Temporary storage for each hex pair
-
-    for (int i = 0; i < cypertextData.length(); i += 3) {
+    for (int i = 0; i + 1 < cypertextData.length(); i += 3) {
         // Converts two characters hex to a single byte
-
         uint8_t highNibble = hexCharToDecimal(cypertextData[i]);
         uint8_t lowNibble = hexCharToDecimal(cypertextData[i + 1]);
-        decimal = (highNibble << 4) | lowNibble;
+        cypertextDataDec += (char)((highNibble << 4) | lowNibble);
+    }
 
-        // Serial.println((char) decimal);
+    plaintext = xorEncryptDecryptMD5(cypertextDataDec, password, 10);
 
-        // cypertextDataDec += decimal;
-        // cypertextDataDec_index += 1;
+    // No password check in version 1, a wrong one gives garbage
+    return isValidAscii(plaintext);
+}
 
-        // temp[0] = cypertextData[i];        // First hex nibble
-        // temp[1] = cypertextData[i + 1];    // Second hex nibble
-        // temp[2] = '\0';                // Null-terminate the string
+bool decryptFile(FS &fs, const String &filepath, const String &password, Print &out) {
+    File file = fs.open(filepath, FILE_READ);
+    if (!file) return false;
+
+    uint8_t buffer[ENCRYPT_CHUNK];
+    size_t n = file.read(buffer, ENCRYPT_HEADER_SIZE);
+    if (!isEncryptedFileV2(buffer, n)) {
+        file.seek(0);
+        String plaintext;
+        bool ok = decryptFileV1(file, password, plaintext);
+        file.close();
+        if (ok) out.print(plaintext);
+        return ok;
+    }
 
-        // Convert the hex pair to a byte (char)
-        // char decimal = (char) strtol(temp, NULL, 16);
-        /*
-        cypertextDataDec[i/3] = decimal;
-        */
-        cypertextDataDec += (char)decimal;
-        // Serial.println(decimal);
+    EncryptStream stream;
+    if (!decryptStreamBegin(stream, password, buffer)) {
+        file.close();
+        return false;
+    }
+    while ((n = file.read(buffer, sizeof(buffer))) > 0) {
+        encryptStreamUpdate(stream, buffer, buffer, n);
+        out.write(buffer, n);
     }
+    encryptStreamEnd(stream);
+    file.close();
+    return true;
+}
 
-    // Serial.println(cachedPassword);
-    // Serial.println(cypertextData);
-    // Serial.println(cypertextDataDec);
+String readDecryptedFile(FS &fs, String filepath) {
 
-    plaintext = xorEncryptDecryptMD5(cypertextDataDec, cachedPassword, 10);
+    if (cachedPassword.length() == 0) {
+        cachedPassword = keyboard("", 32, "password");
+        if (cachedPassword.length() == 0) return ""; // cancelled
+    }
 
-    if (!isValidAscii(plaintext)) {
+    String plaintext = "";
+    File file = fs.open(filepath, FILE_READ);
+    if (file) {
+        // Version 2 is as big as the plaintext
+        plaintext.reserve(file.size());
+        file.close();
+    }
+    StringPrint out(plaintext);
+    if (!decryptFile(fs, filepath, cachedPassword, out)) {
         // invalidate cached password -> will ask again on the next try
         cachedPassword = "";
         displayError("decryption failed (invalid password?)");
-        // Serial.println(plaintext);
         return "";
     }
     // else
     return (plaintext);
 }
 
-// void writeEncryptedFile(FS &fs, String filepath, String& plaintext)
-
-String encryptString(String &plaintext, const String &password_str) {
-    String dataStr = xorEncryptDecryptMD5(plaintext, password_str, 10);
-    String dataStrHex = "";
-
-    for (size_t i = 0; i < dataStr.length(); i++) dataStrHex += String(dataStr[i], HEX) + " ";
-    dataStrHex.toUpperCase();
-    dataStrHex.trim();
-
-    String out = "Filetype: Bruce Encrypted File\nVersion: 1\n";
-    out += "Algo: XOR\n"; // TODO: add AES
-    out += "KeyDerivationAlgo: MD5\n";
-    out += "KeyDerivationPasses: 10\n";
-    out += "Data: " + dataStrHex + "\n";
+/////////////////////////////////////////////////////////////////////////////////////
+// Benchmark
+/////////////////////////////////////////////////////////////////////////////////////
+void encryptBenchmark(size_t len) {
+    if (len == 0 || len > ENCRYPT_BENCHMARK_MAX) {
+        Serial.printf("Size must be 1 to %u bytes\n", (unsigned)ENCRYPT_BENCHMARK_MAX);
+        return;
+    }
+    // The data, then room for the version 1 output, three times bigger
+    uint8_t *data = (uint8_t *)(psramFound() ? ps_malloc(len * 4) : malloc(len * 4));
+    if (!data) {
+        Serial.printf("Could not allocate %u\n", (unsigned)(len * 4));
+        return;
+    }
+    esp_fill_random(data, len);
+    uint8_t *out = data + len;
+    String password = "benchmark";
+
+    // Version 1: XOR, then hex with a space per byte
+    static const char digits[] = "0123456789ABCDEF";
+    uint8_t key[16];
+    uint32_t start = micros();
+    xorKeyMD5(password, 10, key);
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = data[i] ^ key[i % 16];
+        out[3 * i] = digits[c >> 4];
+        out[3 * i + 1] = digits[c & 0x0F];
+        out[3 * i + 2] = ' ';
+    }
+    uint32_t v1Us = micros() - start;
 
-    return out;
+    // Version 2, deriving the key apart from encrypting with it
+    lockKeys();
+    for (CachedKey &k : keyCache) {
+        if (k.password == password) k = CachedKey();
+    }
+    unlockKeys();
+    EncryptStream stream;
+    uint8_t header[ENCRYPT_HEADER_SIZE];
+    start = micros();
+    bool ok = encryptStreamBegin(stream, password, header);
+    uint32_t deriveUs = micros() - start;
+    if (ok) encryptStreamEnd(stream);
+
+    start = micros();
+    ok = ok && encryptStreamBegin(stream, password, header);
+    for (size_t i = 0; ok && i < len; i += ENCRYPT_CHUNK) {
+        size_t n = len - i < ENCRYPT_CHUNK ? len - i : ENCRYPT_CHUNK;
+        encryptStreamUpdate(stream, data + i, out + i, n);
+    }
+    if (ok) encryptStreamEnd(stream);
+    uint32_t v2Us = micros() - start;
+    free(data);
+
+    Serial.printf("%u bytes\n", len);
+    Serial.printf("v1 XOR+hex: %.2f MB/s, %u bytes out\n", len / (float)(v1Us ? v1Us : 1), len * 3);
+    if (!ok) {
+        Serial.println("v2 AES-CTR: key derivation failed");
+        return;
+    }
+    Serial.printf("v2 AES-CTR: %.2f MB/s, %u bytes out\n", len / (float)(v2Us ? v2Us : 1), len);
+    Serial.printf("v2 key derivation: %lu ms, once per password\n", deriveUs / 1000);
 }
 
 /* OLD:
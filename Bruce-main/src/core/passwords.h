@@ -1,11 +1,58 @@
-
 #include <Arduino.h>
 #include <FS.h>
 #include <LittleFS.h>
 #include <SD.h>
+#include <mbedtls/aes.h>
+
+/*
+ * Encrypted files (.enc)
+ *
+ * Version 2 is binary: a 64 byte header, then the data AES-256-CTR encrypted,
+ * same size as the plaintext. The key comes from the password with
+ * PBKDF2-HMAC-SHA256 and a random salt; the header keeps the salt, the CTR
+ * nonce and a password check, so a wrong password is told right away instead
+ * of by looking at the output. Deriving the key is the slow part, so the key
+ * of each password is cached and new files reuse its salt, with a fresh nonce.
+ * AES runs on the ESP32 AES engine (mbedtls is built with it).
+ *
+ * Version 1 (text header, hex of the data XORed with an MD5 of the password)
+ * is still read.
+ */
+#define ENCRYPT_HEADER_SIZE 64
+
+struct EncryptStream {
+    mbedtls_aes_context aes;
+    uint8_t counter[16];
+    uint8_t block[16]; // Key stream of the current counter
+    size_t blockOffset;
+};
+
+// Starts a new file, filling its header (ENCRYPT_HEADER_SIZE bytes). With derive
+// false it fails instead of deriving a key that isn't cached.
+bool encryptStreamBegin(EncryptStream &stream, const String &password, uint8_t *header, bool derive = true);
+// True if the key for new files of password is cached, else starts deriving it on
+// a task of its own and returns false. For the web server, which mustn't block on it.
+bool encryptKeyPrepare(const String &password);
+// Checks the header of a version 2 file, false if it isn't one or the password is wrong
+bool decryptStreamBegin(EncryptStream &stream, const String &password, const uint8_t *header);
+// Encrypts or decrypts the next len bytes, in and out can be the same buffer
+void encryptStreamUpdate(EncryptStream &stream, const uint8_t *in, uint8_t *out, size_t len);
+void encryptStreamEnd(EncryptStream &stream);
 
-String encryptString(String &plaintext, const String &password_str);
+bool isEncryptedFileV2(const uint8_t *header, size_t len);
 
-String decryptString(String &cypertext, const String &password_str);
+bool writeEncryptedFile(
+    FS &fs, const String &filepath, const uint8_t *data, size_t len, const String &password
+);
 
+// Decrypts a version 1 or 2 file into out, a chunk at a time for version 2.
+// False if the file isn't one or the password is wrong.
+bool decryptFile(FS &fs, const String &filepath, const String &password, Print &out);
+
+// Asks for the password if there's none cached
 String readDecryptedFile(FS &fs, String filepath);
+
+#define ENCRYPT_BENCHMARK_MAX (1024 * 1024) // Needs 4 times this in RAM
+
+// Prints MB/s of the version 1 and version 2 encryption, on len bytes (up to ENCRYPT_BENCHMARK_MAX)
+void encryptBenchmark(size_t len);
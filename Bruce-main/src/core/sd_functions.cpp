@@ -1,4 +1,5 @@
 #include "sd_functions.h"
+#include "dir_index.h"
 #include "display.h" // using displayRedStripe as error msg
 #include "modules/badusb_ble/ducky_typer.h"
 #include "modules/bjs_interpreter/interpreter.h"
@@ -11,15 +12,17 @@
 #include "mykeyboard.h" // using keyboard when calling rename
 #include "passwords.h"
 #include "scrollableTextArea.h"
+#include <TrackJournal.h>
 #include <globals.h>
 
 #include <MD5Builder.h>
-#include <algorithm>       // for std::sort
+#include <algorithm>       // for std::lower_bound
 #include <esp32/rom/crc.h> // for CRC32
 
 // SPIClass sdcardSPI;
 String fileToCopy;
-std::vector<FileList> fileList;
+static DirIndex *dirIndex = nullptr; // Folder shown by loopSD
+static std::vector<uint32_t> dirView; // Its entries with an allowed extension, in dirIndex order
 
 /***************************************************************************************
 ** Function name: setupSdCard
@@ -439,89 +442,45 @@ String crc32File(FS &fs, String filepath) {
 }
 
 /***************************************************************************************
-** Function name: sortList
-** Description:   sort files for name
+** Function name: readFs
+** Description:   list the folders and the files with an allowed extension
 ***************************************************************************************/
-bool sortList(const FileList &a, const FileList &b) {
-    if (a.folder != b.folder) {
-        return a.folder > b.folder; // true if a is a folder and b is not
-    }
-    // Order items alfabetically
-    String fa = a.filename.c_str();
-    fa.toUpperCase();
-    String fb = b.filename.c_str();
-    fb.toUpperCase();
-    return fa < fb;
+void readFs(FS &fs, String folder, String allowed_ext) {
+    dirView.clear();
+    dirIndex = openDirIndex(fs, folder);
+    if (!dirIndex) return;
+    dirIndex->filter(allowed_ext, dirView);
+    Serial.println("Files listed with: " + String(dirView.size()) + " files/folders found");
 }
 
 /***************************************************************************************
-** Function name: checkExt
-** Description:   check file extension
+** Function name: fileListAt
+** Description:   row i of the folder read by readFs, with "> Back" after the last one
 ***************************************************************************************/
-bool checkExt(String ext, String pattern) {
-    ext.toUpperCase();
-    pattern.toUpperCase();
-    if (ext == pattern) return true;
-
-    // If the pattern is a list of extensions (e.g., "TXT|JPG|PNG"), split and check
-    int start = 0;
-    int end = pattern.indexOf('|');
-    while (end != -1) {
-        String currentExt = pattern.substring(start, end);
-        if (ext == currentExt) { return true; }
-        start = end + 1;
-        end = pattern.indexOf('|', start);
-    }
-
-    // Check the last extension in the list
-    String lastExt = pattern.substring(start);
-    return ext == lastExt;
+static FileList fileListAt(int i) {
+    FileList object;
+    if (dirIndex && i < (int)dirView.size()) {
+        object.filename = dirIndex->name(dirView[i]);
+        object.folder = dirIndex->isFolder(dirView[i]);
+        object.operation = false;
+    } else {
+        // Adds Operational btn at the botton
+        object.filename = "> Back";
+        object.folder = false;
+        object.operation = true;
+    }
+    return object;
 }
 
 /***************************************************************************************
-** Function name: sortList
-** Description:   sort files for name
+** Function name: exportTrackFile
+** Description:   renders a GPS Tracker journal (.trk) next to it as GPX or GeoJSON
 ***************************************************************************************/
-void readFs(FS fs, String folder, String allowed_ext) {
-    int allFilesCount = 0;
-    fileList.clear();
-    FileList object;
-
-    File root = fs.open(folder);
-    if (!root || !root.isDirectory()) { return; }
-    File file = root.openNextFile();
-    while (file && fileList.size() < 250) {
-        String fileName = file.name();
-        if (file.isDirectory()) {
-            object.filename = fileName.substring(fileName.lastIndexOf("/") + 1);
-            object.folder = true;
-            object.operation = false;
-            fileList.push_back(object);
-        } else {
-            String ext = fileName.substring(fileName.lastIndexOf(".") + 1);
-            if (allowed_ext == "*" || checkExt(ext, allowed_ext)) {
-                object.filename = fileName.substring(fileName.lastIndexOf("/") + 1);
-                object.folder = false;
-                object.operation = false;
-                fileList.push_back(object);
-            }
-        }
-        file = root.openNextFile();
-    }
-    file.close();
-    root.close();
-
-    // Sort folders/files
-    std::sort(fileList.begin(), fileList.end(), sortList);
-
-    Serial.println("Files listed with: " + String(fileList.size()) + " files/folders found");
-
-    // Adds Operational btn at the botton
-    object.filename = "> Back";
-    object.folder = false;
-    object.operation = true;
-
-    fileList.push_back(object);
+static void exportTrackFile(FS &fs, const String &filepath, TrackExport::Format format) {
+    displayTextLine("Exporting...");
+    String out = exportTrack(fs, filepath, format);
+    if (out == "") displayError("Export failed", true);
+    else displaySuccess("Saved " + out.substring(out.lastIndexOf('/') + 1), true);
 }
 
 /*********************************************************************
@@ -547,6 +506,11 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
     bool redraw = true;
     int index = 0;
     int maxFiles = 0;
+    FileList selected;
+#ifdef HAS_KEYBOARD
+    String typedPrefix = "";
+    unsigned long lastLetterTime = 0;
+#endif
     String Folder = rootPath;
     String PreFolder = rootPath;
     tft.drawPixel(0, 0, 0);
@@ -563,7 +527,7 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
 
     readFs(fs, Folder, allowed_ext);
 
-    maxFiles = fileList.size() - 1; // discount the >back operator
+    maxFiles = dirView.size(); // the >back operator comes after the last entry
     LongPress = false;
     unsigned long LongPressTmp = millis();
     while (1) {
@@ -579,43 +543,45 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
                 Serial.println("reload to read: " + Folder);
                 readFs(fs, Folder, allowed_ext);
                 PreFolder = Folder;
-                maxFiles = fileList.size() - 1;
+                maxFiles = dirView.size();
                 if (strcmp(PreFolder.c_str(), Folder.c_str()) != 0 || index > maxFiles) index = 0;
                 reload = false;
             }
-            if (fileList.size() < 2) readFs(fs, Folder, allowed_ext);
-
-            coord = listFiles(index, fileList);
+            coord = listFiles(index, maxFiles + 1, fileListAt);
 #if defined(HAS_TOUCH)
             TouchFooter();
 #endif
             redraw = false;
         }
-        displayScrollingText(fileList[index].filename, coord);
+        displayScrollingText(fileListAt(index).filename, coord);
 
 #ifdef HAS_KEYBOARD
         char pressed_letter = checkLetterShortcutPress();
         if (check(EscPress)) goto BACK_FOLDER; // quit
 
-        // check letter shortcuts
-        if (pressed_letter > 0) {
-            // Serial.println(pressed_letter);
-            if (tolower(fileList[index].filename.c_str()[0]) == pressed_letter) {
-                // already selected, go to the next
-                index += 1;
-                // check if index is still valid
-                if (index <= maxFiles && tolower(fileList[index].filename.c_str()[0]) == pressed_letter) {
-                    redraw = true;
-                    continue;
+        // check letter shortcuts, letters typed in a row go to the first name they start
+        if (pressed_letter > 0 && dirIndex) {
+            pressed_letter = tolower(pressed_letter);
+            if (millis() - lastLetterTime > 1000) typedPrefix = "";
+            lastLetterTime = millis();
+            // the same letter again goes to the next name starting with it
+            bool next = typedPrefix.length() == 1 && typedPrefix[0] == pressed_letter;
+            if (!next) typedPrefix += pressed_letter;
+
+            int found = -1;
+            for (uint32_t match : dirIndex->matchPrefix(typedPrefix)) {
+                auto it = std::lower_bound(dirView.begin(), dirView.end(), match);
+                if (it == dirView.end() || *it != match) continue; // extension not allowed
+                int i = it - dirView.begin();
+                if (found < 0) found = i; // look again from the start if there's none after index
+                if (!next || i > index) {
+                    found = i;
+                    break;
                 }
             }
-            // else look again from the start
-            for (int i = 0; i < maxFiles; i++) {
-                if (tolower(fileList[i].filename.c_str()[0]) == pressed_letter) { // check if 1st char matches
-                    index = i;
-                    redraw = true;
-                    break; // quit on 1st match
-                }
+            if (found >= 0) {
+                index = found;
+                redraw = true;
             }
         }
 #elif defined(T_EMBED) || defined(HAS_TOUCH) || !defined(HAS_SCREEN)
@@ -653,16 +619,17 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
             }
             if (LongPress && millis() - LongPressTmp < 500) goto WAITING;
             LongPress = false;
+            selected = fileListAt(index);
 
             if (check(SelPress)) {
-                if (fileList[index].folder == true && fileList[index].operation == false) {
+                if (selected.folder == true && selected.operation == false) {
                     options = {
                         {"New Folder", [=]() { createFolder(fs, Folder); }                                 },
                         {"Rename",
                          [=]() {
-                             renameFile(fs, Folder + fileList[index].filename, fileList[index].filename);
+                             renameFile(fs, Folder + selected.filename, selected.filename);
                          }                                                                                 },
-                        {"Delete",     [=]() { deleteFromSd(fs, Folder + "/" + fileList[index].filename); }},
+                        {"Delete",     [=]() { deleteFromSd(fs, Folder + "/" + selected.filename); }},
                         {"Close Menu", [&]() { yield(); }                                                  },
                         {"Main Menu",  [&]() { exit = true; }                                              },
                     };
@@ -670,7 +637,7 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
                     tft.drawRoundRect(5, 5, tftWidth - 10, tftHeight - 10, 5, bruceConfig.priColor);
                     reload = true;
                     redraw = true;
-                } else if (fileList[index].folder == false && fileList[index].operation == false) {
+                } else if (selected.folder == false && selected.operation == false) {
                     goto Files;
                 } else {
                     options = {
@@ -686,19 +653,22 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
                 }
             } else {
             Files:
-                if (fileList[index].folder == true && fileList[index].operation == false) {
-                    Folder = Folder + (Folder == "/" ? "" : "/") +
-                             fileList[index].filename; // Folder=="/"? "":"/" +
+                if (selected.folder == true && selected.operation == false) {
+                    Folder = Folder + (Folder == "/" ? "" : "/") + selected.filename; // Folder=="/"? "":"/" +
                     // Debug viewer
                     Serial.println(Folder);
                     redraw = true;
-                } else if (fileList[index].folder == false && fileList[index].operation == false) {
+                } else if (selected.folder == false && selected.operation == false) {
                     // Save the file/folder info to Clear memory to allow other functions to work better
-                    String filepath = Folder + (Folder == "/" ? "" : "/") + fileList[index].filename; //
-                    String filename = fileList[index].filename;
+                    String filepath = Folder + (Folder == "/" ? "" : "/") + selected.filename; //
+                    String filename = selected.filename;
                     // Debug viewer
                     Serial.println(filepath + " --> " + filename);
-                    fileList.clear(); // Clear memory to allow other functions to work better
+                    // Clear memory to allow other functions to work better, big folders are saved
+                    // in /.dircache so they reload fast
+                    releaseDirIndexes();
+                    dirIndex = nullptr;
+                    dirView.clear();
 
                     options = {
                         {"View File",  [=]() { viewFile(fs, filepath); }            },
@@ -733,6 +703,14 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
                                                              delay(200);
                                                              txSubFile(&fs, filepath);
                                                          }});
+                    if (filepath.endsWith(".trk")) {
+                        options.insert(options.begin(), {"Export GeoJSON", [&]() {
+                                                             exportTrackFile(fs, filepath, TrackExport::GEOJSON);
+                                                         }});
+                        options.insert(options.begin(), {"Export GPX", [&]() {
+                                                             exportTrackFile(fs, filepath, TrackExport::GPX);
+                                                         }});
+                    }
                     if (filepath.endsWith(".csv")) {
                         options.insert(options.begin(), {"Wigle Upload", [&]() {
                                                              delay(200);
@@ -851,7 +829,9 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
             delay(10);
         }
     }
-    fileList.clear();
+    releaseDirIndexes();
+    dirIndex = nullptr;
+    dirView.clear();
     return result;
 }
 
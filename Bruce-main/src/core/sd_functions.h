@@ -42,9 +42,7 @@ String md5File(FS &fs, String filepath);
 
 String crc32File(FS &fs, String filepath);
 
-void readFs(FS fs, String folder, String allowed_ext = "*");
-
-bool sortList(const FileList &a, const FileList &b);
+void readFs(FS &fs, String folder, String allowed_ext = "*");
 
 String loopSD(FS &fs, bool filePicker = false, String allowed_ext = "*", String rootPath = "/");
 
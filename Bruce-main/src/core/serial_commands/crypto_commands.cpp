@@ -29,10 +29,13 @@ uint32_t decryptFileCallback(cmd *c) {
         return false;
     }
 
-    String plaintext = readDecryptedFile(*fs, filepath);
-    if (plaintext == "") return false;
-
-    Serial.println(plaintext);
+    // Printed as it's decrypted, the file can be bigger than the free memory
+    if (!decryptFile(*fs, filepath, password, Serial)) {
+        cachedPassword = "";
+        Serial.println("decryption failed (invalid password?)");
+        return false;
+    }
+    Serial.println();
     return true;
 }
 
@@ -52,25 +55,34 @@ uint32_t encryptFileCallback(cmd *c) {
 
     cachedPassword = password;
 
-    char *txt = _readFileFromSerial();
-    if (strlen(txt) == 0) return false;
-    String txtString = String(txt);
-
     FS *fs;
     if (!getFsStorage(fs)) return false;
 
-    File f = fs->open(filepath, FILE_WRITE);
-    if (!f) return false;
-
-    String cyphertxt = encryptString(txtString, cachedPassword);
-    if (cyphertxt == "") return false;
+    char *txt = _readFileFromSerial();
+    if (txt == NULL) return false;
+    size_t len = strlen(txt);
+    bool ok = len > 0 && writeEncryptedFile(*fs, filepath, (const uint8_t *)txt, len, password);
+    free(txt);
+    if (!ok) return false;
 
-    f.write((const uint8_t *)cyphertxt.c_str(), cyphertxt.length());
-    f.close();
     Serial.println("File written: " + filepath);
     return true;
 }
 
+uint32_t benchmarkCallback(cmd *c) {
+    // crypto benchmark 65536
+    Command cmd(c);
+
+    int size = cmd.getArgument("size").getValue().toInt();
+    if (size <= 0 || size > ENCRYPT_BENCHMARK_MAX) {
+        Serial.printf("Size must be 1 to %u bytes\n", (unsigned)ENCRYPT_BENCHMARK_MAX);
+        return false;
+    }
+
+    encryptBenchmark(size);
+    return true;
+}
+
 uint32_t typeFileCallback(cmd *c) {
     Command cmd(c);
 
@@ -121,6 +133,9 @@ void createCryptoCommands(SimpleCLI *cli) {
     encryptFileCmd.addPosArg("filepath");
     encryptFileCmd.addPosArg("password");
 
+    Command benchmarkCmd = cryptoCmd.addCommand("benchmark", benchmarkCallback);
+    benchmarkCmd.addPosArg("size", "65536");
+
 #ifdef USB_as_HID
     Command typeFileCmd = cryptoCmd.addCommand("type_from_file", typeFileCallback);
     typeFileCmd.addPosArg("filepath");
@@ -0,0 +1,310 @@
+#include "serial_transfer.h"
+#include "core/connect/file_transfer.h"
+#include <Arduino.h>
+
+#define SERIAL_TRANSFER_CHUNK 512
+#define SERIAL_TRANSFER_ACK_EVERY 4  // chunks received before acking
+#define SERIAL_TRANSFER_ACK_DELAY 10 // ms, ack anyway after this
+#define SERIAL_TRANSFER_TIMEOUT 5000 // ms without progress before giving up
+#define SERIAL_TRANSFER_END_RETRIES 10
+#if ARDUINO_USB_CDC_ON_BOOT
+// USB has flow control, the host can't overrun the receive buffer
+#define SERIAL_TRANSFER_HOST_WINDOW 8
+#else
+// What fits in the UART receive buffer set in setup()
+#define SERIAL_TRANSFER_HOST_WINDOW 2
+#endif
+
+#define FRAME_SYNC1 0xA5
+#define FRAME_SYNC2 0x5A
+#define FRAME_HEADER 7 // sync, type, seq, length
+#define FRAME_MAX_PAYLOAD SERIAL_TRANSFER_CHUNK
+
+enum FrameType : uint8_t {
+    FRAME_START = 'S',
+    FRAME_DATA = 'D',
+    FRAME_ACK = 'A',
+    FRAME_END = 'E',
+    FRAME_ABORT = 'X',
+};
+
+struct SerialFrame {
+    uint8_t type;
+    uint16_t seq;
+    uint16_t length;
+    uint8_t payload[FRAME_MAX_PAYLOAD];
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Framing
+/////////////////////////////////////////////////////////////////////////////////////
+static void sendFrame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t length) {
+    uint8_t header[FRAME_HEADER] = {
+        FRAME_SYNC1,
+        FRAME_SYNC2,
+        type,
+        (uint8_t)seq,
+        (uint8_t)(seq >> 8),
+        (uint8_t)length,
+        (uint8_t)(length >> 8),
+    };
+    uint32_t crc = transferCrc32(0, header + 2, FRAME_HEADER - 2);
+    crc = transferCrc32(crc, payload, length);
+
+    Serial.write(header, FRAME_HEADER);
+    if (length) Serial.write(payload, length);
+    Serial.write((const uint8_t *)&crc, sizeof(crc));
+}
+
+static void sendAbort(const char *reason) {
+    sendFrame(FRAME_ABORT, 0, (const uint8_t *)reason, strlen(reason));
+}
+
+// Parses frames out of the bytes waiting on the port, without blocking.
+// Anything that doesn't check out is dropped, the sender resends it.
+class FrameReader {
+public:
+    bool poll(SerialFrame &frame) {
+        while (Serial.available()) {
+            uint8_t c = Serial.read();
+            switch (_state) {
+                case WAIT_SYNC1: _state = c == FRAME_SYNC1 ? WAIT_SYNC2 : WAIT_SYNC1; break;
+                case WAIT_SYNC2:
+                    if (c == FRAME_SYNC2) _state = READ_HEADER;
+                    else if (c != FRAME_SYNC1) _state = WAIT_SYNC1;
+                    break;
+                case READ_HEADER:
+                    _header[_pos++] = c;
+                    if (_pos < FRAME_HEADER - 2) break;
+                    frame.type = _header[0];
+                    frame.seq = _header[1] | (_header[2] << 8);
+                    frame.length = _header[3] | (_header[4] << 8);
+                    _pos = 0;
+                    if (frame.length > FRAME_MAX_PAYLOAD) _state = WAIT_SYNC1;
+                    else _state = frame.length ? READ_PAYLOAD : READ_CRC;
+                    break;
+                case READ_PAYLOAD:
+                    frame.payload[_pos++] = c;
+                    if (_pos < frame.length) break;
+                    _pos = 0;
+                    _state = READ_CRC;
+                    break;
+                case READ_CRC: {
+                    _crc[_pos++] = c;
+                    if (_pos < sizeof(_crc)) break;
+                    _pos = 0;
+                    _state = WAIT_SYNC1;
+                    uint32_t expected;
+                    memcpy(&expected, _crc, sizeof(expected));
+                    uint32_t crc = transferCrc32(0, _header, FRAME_HEADER - 2);
+                    if (transferCrc32(crc, frame.payload, frame.length) == expected) return true;
+                    break;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    enum State : uint8_t { WAIT_SYNC1, WAIT_SYNC2, READ_HEADER, READ_PAYLOAD, READ_CRC };
+    State _state = WAIT_SYNC1;
+    uint16_t _pos = 0;
+    uint8_t _header[FRAME_HEADER - 2];
+    uint8_t _crc[4];
+};
+
+static void sendStart(uint32_t size, uint32_t offset, uint16_t window) {
+    uint8_t payload[12];
+    uint16_t chunk = SERIAL_TRANSFER_CHUNK;
+    memcpy(payload, &size, 4);
+    memcpy(payload + 4, &offset, 4);
+    memcpy(payload + 8, &chunk, 2);
+    memcpy(payload + 10, &window, 2);
+    sendFrame(FRAME_START, 0, payload, sizeof(payload));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Host to device
+/////////////////////////////////////////////////////////////////////////////////////
+static void sendAck(const TransferReceiver &receiver, uint8_t flags = 0) {
+    TransferAck ack;
+    receiver.fillAck(ack);
+    ack.flags |= flags;
+    sendFrame(FRAME_ACK, 0, (const uint8_t *)&ack, sizeof(ack));
+}
+
+bool serialReceiveFile(FS &fs, const String &path, uint32_t size, bool resume) {
+    File file;
+    uint32_t offset = 0;
+    if (resume && fs.exists(path)) {
+        file = fs.open(path, FILE_APPEND);
+        if (file) offset = file.size();
+    } else {
+        file = fs.open(path, FILE_WRITE, true);
+    }
+    if (!file) {
+        sendAbort("can't open file");
+        return false;
+    }
+    if (offset > size) {
+        file.close();
+        sendAbort("file is bigger than size");
+        return false;
+    }
+
+    // Chunks are only taken in order: the file is always a prefix of the
+    // upload, which is what makes -resume possible. Serial doesn't reorder,
+    // a chunk is only out of order after one got lost.
+    TransferReceiver receiver;
+    receiver.begin(size - offset, SERIAL_TRANSFER_CHUNK);
+    FrameReader reader;
+    SerialFrame frame;
+    uint32_t crc = 0;
+    uint32_t lastRecv = millis();
+    uint32_t lastAck = lastRecv;
+    uint16_t unacked = 0;
+    bool ok = false;
+
+    sendStart(size, offset, SERIAL_TRANSFER_HOST_WINDOW);
+    while (true) {
+        uint32_t now = millis();
+        if (now - lastRecv > SERIAL_TRANSFER_TIMEOUT) {
+            sendAbort("timeout");
+            break;
+        }
+
+        if (reader.poll(frame)) {
+            lastRecv = now;
+            if (frame.type == FRAME_ABORT) break;
+
+            if (frame.type == FRAME_END) {
+                uint32_t expected = 0;
+                if (frame.length == sizeof(expected)) memcpy(&expected, frame.payload, sizeof(expected));
+                if (!receiver.complete()) {
+                    sendAck(receiver);
+                    continue;
+                }
+                ok = expected == crc;
+                sendAck(receiver, ok ? TransferAck::CRC_OK : 0);
+                break;
+            }
+
+            if (frame.type != FRAME_DATA) continue;
+            uint32_t chunk;
+            if ((uint16_t)receiver.received() != frame.seq || !receiver.accept(frame.seq, chunk)) {
+                // Something before it got lost, tell the host right away
+                unacked = SERIAL_TRANSFER_ACK_EVERY;
+            } else {
+                uint32_t left = size - offset - receiver.chunkOffset(chunk);
+                uint16_t length = left < SERIAL_TRANSFER_CHUNK ? left : SERIAL_TRANSFER_CHUNK;
+                if (frame.length != length || file.write(frame.payload, length) != length) {
+                    sendAbort("write failed");
+                    break;
+                }
+                crc = transferCrc32(crc, frame.payload, length);
+                unacked++;
+            }
+        }
+
+        if (unacked >= SERIAL_TRANSFER_ACK_EVERY ||
+            (unacked > 0 && now - lastAck >= SERIAL_TRANSFER_ACK_DELAY)) {
+            sendAck(receiver);
+            unacked = 0;
+            lastAck = now;
+        }
+        if (!Serial.available()) vTaskDelay(1);
+    }
+
+    file.close();
+    return ok;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Device to host
+/////////////////////////////////////////////////////////////////////////////////////
+// Waits for the host to confirm the CRC, resending the end frame
+static bool finishSend(FrameReader &reader, SerialFrame &frame, uint32_t crc, uint32_t timeout) {
+    for (int i = 0; i < SERIAL_TRANSFER_END_RETRIES; i++) {
+        sendFrame(FRAME_END, 0, (const uint8_t *)&crc, sizeof(crc));
+
+        uint32_t sentAt = millis();
+        while (millis() - sentAt < timeout) {
+            if (!reader.poll(frame)) {
+                vTaskDelay(1);
+                continue;
+            }
+            if (frame.type == FRAME_ABORT) return false;
+            if (frame.type != FRAME_ACK || frame.length != sizeof(TransferAck)) continue;
+            TransferAck ack;
+            memcpy(&ack, frame.payload, sizeof(ack));
+            if (ack.flags & TransferAck::COMPLETE) return ack.flags & TransferAck::CRC_OK;
+        }
+    }
+    return false;
+}
+
+bool serialSendFile(FS &fs, const String &path, uint32_t offset) {
+    File file = fs.open(path, FILE_READ);
+    if (!file || file.isDirectory()) {
+        sendAbort("can't open file");
+        return false;
+    }
+    uint32_t size = file.size();
+    if (offset > size) {
+        file.close();
+        sendAbort("offset past the end");
+        return false;
+    }
+
+    TransferSender sender;
+    FrameReader reader;
+    SerialFrame frame;
+    uint32_t crc = 0;
+    uint32_t crcEnd = 0; // Bytes the CRC has seen, chunks can be sent twice
+    bool ok = false;
+
+    sendStart(size, offset, 0);
+    sender.begin(size - offset, SERIAL_TRANSFER_CHUNK, millis());
+    while (true) {
+        uint32_t now = millis();
+        if (sender.allAcked()) {
+            ok = finishSend(reader, frame, crc, sender.rto() + 100);
+            break;
+        }
+        if (sender.stalled(now, SERIAL_TRANSFER_TIMEOUT)) {
+            sendAbort("timeout");
+            break;
+        }
+
+        bool aborted = false;
+        while (reader.poll(frame)) {
+            if (frame.type == FRAME_ABORT) aborted = true;
+            if (frame.type != FRAME_ACK || frame.length != sizeof(TransferAck)) continue;
+            TransferAck ack;
+            memcpy(&ack, frame.payload, sizeof(ack));
+            sender.onAck(ack, now);
+        }
+        if (aborted) break;
+
+        uint32_t chunk;
+        if (!sender.next(now, chunk)) {
+            vTaskDelay(1);
+            continue;
+        }
+        uint32_t chunkOffset = sender.chunkOffset(chunk);
+        uint16_t length = sender.chunkLength(chunk);
+        if ((file.position() != offset + chunkOffset && !file.seek(offset + chunkOffset)) ||
+            file.read(frame.payload, length) != length) {
+            sendAbort("read failed");
+            break;
+        }
+        if (chunkOffset + length > crcEnd) {
+            crc = transferCrc32(crc, frame.payload, length);
+            crcEnd = chunkOffset + length;
+        }
+        sendFrame(FRAME_DATA, (uint16_t)chunk, frame.payload, length);
+    }
+
+    file.close();
+    return ok;
+}
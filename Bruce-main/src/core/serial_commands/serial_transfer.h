@@ -0,0 +1,28 @@
+#ifndef __SERIAL_TRANSFER_H__
+#define __SERIAL_TRANSFER_H__
+
+#include <FS.h>
+
+/*
+ * Binary file transfer over the serial CLI (storage write/read -binary).
+ *
+ * Frames are  A5 5A | type | seq (u16) | length (u16) | payload | CRC-32 (u32),
+ * little endian, the CRC covering type to payload. The windowing and acks are
+ * the ones of the ESP-NOW file sharing (core/connect/file_transfer.h): 'D'
+ * frames carry a chunk, 'A' frames a TransferAck, 'E' ends with the CRC-32 of
+ * the data sent, 'X' aborts with a message.
+ *
+ * The device answers the command with an 'S' frame: total size (u32), start
+ * offset (u32), chunk size (u16) and, for a write, how many chunks the host
+ * may send ahead (u16). Data goes straight between the port and the file
+ * through one chunk buffer, whatever the file size. A write keeps what was
+ * received in order, so -resume picks up from the size of the file already
+ * there; a read starts at the offset asked for. tools/serial_transfer.py is the host side.
+ */
+
+// Receives size bytes from the host into path
+bool serialReceiveFile(FS &fs, const String &path, uint32_t size, bool resume);
+// Sends path to the host, from offset
+bool serialSendFile(FS &fs, const String &path, uint32_t offset);
+
+#endif
@@ -78,6 +78,18 @@ uint32_t settingsCallback(cmd *c) {
     return true;
 }
 
+uint32_t saveStatsCallback(cmd *c) {
+    const BruceConfig::SaveStats &stats = bruceConfig.saveStats;
+    Serial.printf(
+        "Config saves: %u requested, %u written, %u avoided, %u copied to SD\n",
+        stats.requested,
+        stats.written,
+        stats.requested - stats.written,
+        stats.mirrored
+    );
+    return true;
+}
+
 uint32_t factoryResetCallback(cmd *c) {
     bruceConfig.factoryReset();
     Serial.println("Factory reset done");
@@ -86,6 +98,7 @@ uint32_t factoryResetCallback(cmd *c) {
 
 void createSettingsCommands(SimpleCLI *cli) {
     cli->addCommand("factory_reset", factoryResetCallback);
+    cli->addCommand("settings_stats", saveStatsCallback);
 
     Command cmd = cli->addCommand("set/tings", settingsCallback);
     cmd.addPosArg("setting_name", "");
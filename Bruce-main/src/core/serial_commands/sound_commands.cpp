@@ -29,6 +29,23 @@ uint32_t toneCallback(cmd *c) {
     return true;
 }
 
+// Starts a file in the background, or queues it after what's playing
+static bool startSong(String song, bool queue) {
+    if (!song.startsWith("/")) song = "/" + song;
+
+    FS *fs;
+    if (!getFsStorage(fs)) return false;
+
+    if (!(*fs).exists(song)) {
+        Serial.println("Song file does not exist");
+        return false;
+    }
+
+    bool r = queue ? audioQueue(fs, song) : audioPlay(fs, song);
+    if (!r) Serial.println("Can't play this file");
+    return r;
+}
+
 uint32_t playCallback(cmd *c) {
     // RTTTL player
     // music_player
@@ -46,25 +63,50 @@ uint32_t playCallback(cmd *c) {
     bool soundEnabled = bruceConfig.soundEnabled;
     bruceConfig.soundEnabled = true;
 
-    if (song.indexOf(":") != -1) return playAudioRTTTLString(song);
+    bool r = false;
+    if (song.indexOf(":") != -1) r = playAudioRTTTLString(song);
+    else if (song.indexOf(".") != -1) r = startSong(song, false);
 
-    if (song.indexOf(".") != -1) {
-        if (!song.startsWith("/")) song = "/" + song;
+    bruceConfig.soundEnabled = soundEnabled;
+    return r;
+}
+
+#ifdef HAS_NS4168_SPKR
+static uint32_t soundPlayCallback(cmd *c, bool queue) {
+    Command cmd(c);
+    String song = cmd.getArgument("song").getValue();
+    song.trim();
 
-        FS *fs;
-        if (!getFsStorage(fs)) return false;
+    bool soundEnabled = bruceConfig.soundEnabled;
+    bruceConfig.soundEnabled = true;
+    bool r = startSong(song, queue);
+    bruceConfig.soundEnabled = soundEnabled;
+    return r;
+}
 
-        if (!(*fs).exists(song)) {
-            Serial.println("Song file does not exist");
-            return false;
-        }
+uint32_t soundQueueCallback(cmd *c) { return soundPlayCallback(c, true); }
 
-        return playAudioFile(fs, song);
-    }
+uint32_t soundStopCallback(cmd *c) {
+    audioStop();
+    return true;
+}
 
-    bruceConfig.soundEnabled = soundEnabled;
-    return false;
+uint32_t soundStatusCallback(cmd *c) {
+    AudioStats stats = audioStats();
+    Serial.printf(
+        "Playing: %s, queued: %u, tracks played: %lu\n", stats.playing ? "yes" : "no", stats.queued,
+        (unsigned long)stats.tracks
+    );
+    Serial.printf(
+        "Buffer: %lu/%lu bytes, lowest %lu this track\n", (unsigned long)stats.bufferFill,
+        (unsigned long)stats.bufferSize, (unsigned long)stats.minFill
+    );
+    Serial.printf(
+        "Read: %lu bytes, underruns: %lu\n", (unsigned long)stats.bytesRead, (unsigned long)stats.underruns
+    );
+    return true;
 }
+#endif
 
 uint32_t ttsCallback(cmd *c) {
     // tts hello world
@@ -94,6 +136,14 @@ void createSoundCommands(SimpleCLI *cli) {
     playCmd.addPosArg("song");
 
     Command ttsCmd = cli->addSingleArgCmd("tts,say", ttsCallback);
+
+    Command soundCmd = cli->addCompositeCmd("sound");
+    Command soundPlayCmd = soundCmd.addCommand("play", playCallback);
+    soundPlayCmd.addPosArg("song");
+    Command soundQueueCmd = soundCmd.addCommand("queue", soundQueueCallback);
+    soundQueueCmd.addPosArg("song");
+    Command soundStopCmd = soundCmd.addCommand("stop", soundStopCallback);
+    Command soundStatusCmd = soundCmd.addCommand("status", soundStatusCallback);
 #endif
 
     // TODO: webradio
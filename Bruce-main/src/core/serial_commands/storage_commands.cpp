@@ -1,6 +1,7 @@
 #include "storage_commands.h"
 #include "core/sd_functions.h"
 #include "helpers.h"
+#include "serial_transfer.h"
 #include <globals.h>
 
 uint32_t listCallback(cmd *c) {
@@ -51,6 +52,11 @@ uint32_t readCallback(cmd *c) {
     FS *fs;
     if (!getFsStorage(fs) || !(*fs).exists(filepath)) return false;
 
+    // cat has no binary flag, it's never set there
+    if (cmd.getArgument("binary").isSet()) {
+        return serialSendFile(*fs, filepath, cmd.getArgument("offset").getValue().toInt());
+    }
+
     Serial.println(readSmallFile(*fs, filepath));
     return true;
 }
@@ -124,7 +130,7 @@ uint32_t writeCallback(cmd *c) {
     Argument arg = cmd.getArgument("filepath");
     Argument sizeArg = cmd.getArgument("size");
     String filepath = arg.getValue();
-    String sizeStr = arg.getValue();
+    String sizeStr = sizeArg.getValue();
     filepath.trim();
     int fileSize = sizeStr.toInt();
 
@@ -132,11 +138,17 @@ uint32_t writeCallback(cmd *c) {
 
     if (!filepath.startsWith("/")) filepath = "/" + filepath;
 
-    if (fileSize < SAFE_STACK_BUFFER_SIZE) fileSize = SAFE_STACK_BUFFER_SIZE;
-
     FS *fs;
     if (!getFsStorage(fs)) return false;
 
+    // Any file, any size, streamed to the file (see serial_transfer.h)
+    if (cmd.getArgument("binary").isSet()) {
+        if (fileSize < 0) return false;
+        return serialReceiveFile(*fs, filepath, fileSize, cmd.getArgument("resume").isSet());
+    }
+
+    if (fileSize < SAFE_STACK_BUFFER_SIZE) fileSize = SAFE_STACK_BUFFER_SIZE;
+
     char *txt = _readFileFromSerial(fileSize + 2);
     if (strlen(txt) == 0) return false;
 
@@ -383,6 +395,8 @@ void createStorageCommand(SimpleCLI *cli) {
 
     Command cmdRead = cmd.addCommand("read", readCallback);
     cmdRead.addPosArg("filepath");
+    cmdRead.addPosArg("offset", "0");
+    cmdRead.addFlagArg("binary");
 
     Command cmdRemove = cmd.addCommand("remove", removeCallback);
     cmdRemove.addPosArg("filepath");
@@ -390,6 +404,8 @@ void createStorageCommand(SimpleCLI *cli) {
     Command cmdWrite = cmd.addCommand("write", writeCallback);
     cmdWrite.addPosArg("filepath");
     cmdWrite.addPosArg("size", "0");
+    cmdWrite.addFlagArg("binary");
+    cmdWrite.addFlagArg("resume");
 
     Command cmdRename = cmd.addCommand("rename", renameCallback);
     cmdRename.addPosArg("filepath");
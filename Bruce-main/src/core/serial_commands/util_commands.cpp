@@ -253,6 +253,7 @@ uint32_t navCallback(cmd *c) {
             AnyKeyPress = true;
             SerialCmdPress = true;
             *var = true;
+            inputWake();
             if (!LongPress) vTaskDelay(190 / portTICK_PERIOD_MS);
         }
         vTaskDelay(10 / portTICK_PERIOD_MS);
@@ -282,8 +283,9 @@ uint32_t optionsCallback(cmd *c) {
     return true;
 }
 uint32_t optionsJsonCallback(cmd *c) {
-    String response = getOptionsJSON(); // core/utils.h
-    Serial.println(response);
+    auto writeJson = optionsJsonWriter(); // core/utils.h
+    while (writeJson(Serial)) {}
+    Serial.println();
     return true;
 }
 
@@ -300,11 +302,31 @@ uint32_t displayCallback(cmd *c) {
     } else if (opt == "status") {
         if (tft.getLogging()) Serial.println("Display: Logging tft is ACTIVATED");
         else Serial.println("Display: Logging tft is DEACTIVATED");
+        Serial.printf(
+            "Display: log depth %u, last entry %lu\n", tft.getLogDepth(), (unsigned long)tft.getLogSeq()
+        );
+    } else if (opt == "depth") {
+        long depth = cmd.getArgument("value").getValue().toInt();
+        if (depth < 0) depth = 0;
+        if (depth > MAX_LOG_DEPTH) depth = MAX_LOG_DEPTH;
+        tft.setLogDepth(depth);
+        // What was allocated, the log only exists while logging
+        if (!tft.getLogging()) {
+            if (depth) Serial.printf("Display: log depth %ld, applied when logging starts\n", depth);
+            else Serial.println("Display: default log depth, applied when logging starts");
+        } else if (tft.getLogDepth()) {
+            Serial.printf("Display: log depth set to %u entries\n", tft.getLogDepth());
+        } else {
+            Serial.println("Display: not enough memory for the log");
+        }
     } else if (opt == "dump") {
-        uint8_t binData[MAX_LOG_ENTRIES * MAX_LOG_SIZE];
-        size_t binSize = 0;
-
-        tft.getBinLog(binData, binSize);
+        size_t maxSize = tft.getBinLogMaxSize();
+        uint8_t *binData = (uint8_t *)(psramFound() ? ps_malloc(maxSize) : malloc(maxSize));
+        if (!binData) {
+            Serial.println("Display: not enough memory");
+            return false;
+        }
+        size_t binSize = tft.getBinLog(binData, maxSize);
 
         Serial.println("Binary Dump:");
         for (size_t i = 0; i < binSize; i++) {
@@ -313,12 +335,14 @@ uint32_t displayCallback(cmd *c) {
             Serial.printf("%02X ", binData[i]);
         }
         Serial.println("\n[End of Dump]");
+        free(binData);
     } else {
         Serial.println(
             "Display command accept:\n"
             "display start : Start Logging\n"
             "display stop  : Stop Logging\n"
             "display status: Get Logging state\n"
+            "display depth <entries>: Log depth, 0 for the default, up to 8192\n"
             "display dump  : Dumps binary log"
         );
         return false;
@@ -391,6 +415,7 @@ void createUtilCommands(SimpleCLI *cli) {
     cli->addCommand("optionsJSON", optionsJsonCallback);
     Command display = cli->addCommand("display", displayCallback);
     display.addPosArg("option", "dump");
+    display.addPosArg("value", "0");
 
     Command navigation = cli->addCommand("nav,navigate,navigation", navCallback);
     navigation.addPosArg("command");
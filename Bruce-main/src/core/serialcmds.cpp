@@ -16,6 +16,8 @@ void _serialCmdsTaskLoop(void *pvParameters) {
 
     while (1) {
         handleSerialCommands();
+        // Apps with a loop of their own never get back to loopOptions()
+        bruceConfig.saveIfDue();
         vTaskDelay(500);
     }
 }
@@ -558,7 +558,7 @@ void setRFModuleMenu() {
             qrcode_display(
                 "https://github.com/pr3y/Bruce/blob/main/media/connections/cc1101_stick_SDCard.jpg"
             );
-        while (!check(AnyKeyPress)) vTaskDelay(50 / portTICK_PERIOD_MS);
+        waitAnyKeyPress();
     }
     // fallback to "M5 RF433T/R" on errors
     bruceConfig.setRfModule(M5_RF_MODULE);
@@ -899,6 +899,18 @@ int gsetIrRxPin(bool set) {
     return bruceConfig.irRx;
 }
 
+/*********************************************************************
+**  Function: setIrRxCapture
+**  How IR Read captures: an interrupt per edge, or the RMT peripheral
+**********************************************************************/
+void setIrRxCapture() {
+    options = {
+        {"Interrupt", [=]() { bruceConfig.setIrRxRmt(0); }, bruceConfig.irRxRmt == 0},
+        {"RMT",       [=]() { bruceConfig.setIrRxRmt(1); }, bruceConfig.irRxRmt == 1},
+    };
+    loopOptions(options, bruceConfig.irRxRmt);
+}
+
 /*********************************************************************
 **  Function: gsetRfTxPin
 **  get or set RF Tx Pin
@@ -57,6 +57,8 @@ void setIrTxRepeats();
 
 int gsetIrRxPin(bool set = false);
 
+void setIrRxCapture();
+
 int gsetRfTxPin(bool set = false);
 
 int gsetRfRxPin(bool set = false);
@@ -5,18 +5,74 @@ AUXILIARY FUNCTIONS TO CREATE THE JSONS
 */
 
 /* TFT LOGGER FUNCTIONS */
+// The web server reads the log from its own task while the UI draws
+class LogLock {
+public:
+    LogLock(SemaphoreHandle_t lock) : _lock(lock) {
+        if (_lock) xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+    }
+    ~LogLock() {
+        if (_lock) xSemaphoreGiveRecursive(_lock);
+    }
+
+private:
+    SemaphoreHandle_t _lock;
+};
+
 tft_logger::tft_logger(int16_t w, int16_t h) : BRUCE_TFT_DRIVER(w, h) {}
-tft_logger::~tft_logger() { clearLog(); }
+tft_logger::~tft_logger() {
+    LogLock lock(logLock);
+    freeLog();
+}
 
 void tft_logger::clearLog() {
-    memset(log, 0, sizeof(log));
+    LogLock lock(logLock);
+    resetLog();
+}
+
+// Called with the lock held
+void tft_logger::resetLog() {
     memset(images, 0, sizeof(images));
     logWriteIndex = 0;
+    logEpoch++;
+    if (!log) return;
+    // Only the entries used since the last reset, this runs on every fillScreen
+    for (uint16_t i = 0; i < logCount; i++) {
+        log[i].seq = 0;
+        log[i].data[0] = 0;
+    }
+    logCount = 0;
+    memset(logBuckets, 0xFF, (logBucketMask + 1) * sizeof(uint16_t));
+}
+
+void tft_logger::allocLog(uint16_t depth) {
+    freeLog();
+    if (depth == 0) depth = psramFound() ? MAX_LOG_ENTRIES_PSRAM : MAX_LOG_ENTRIES;
+    if (depth > MAX_LOG_DEPTH) depth = MAX_LOG_DEPTH;
+
+    uint32_t buckets = 1;
+    while (buckets < depth * 2u) buckets <<= 1;
+    size_t logSize = depth * sizeof(tftLog);
+    log = (tftLog *)(psramFound() ? ps_malloc(logSize) : malloc(logSize));
+    logBuckets = (uint16_t *)malloc(buckets * sizeof(uint16_t)); // Small, keep it in internal RAM
+    if (!log || !logBuckets) {
+        log_e("No memory for a tft log of %u entries", depth);
+        freeLog();
+        return;
+    }
+    logDepth = depth;
+    logBucketMask = buckets - 1;
+    logCount = depth; // clear everything
+    resetLog();
 }
 
-void tft_logger::addLogEntry(const uint8_t *buffer, uint8_t size) {
-    memcpy(log[logWriteIndex].data, buffer, size);
-    logWriteIndex = (logWriteIndex + 1) % MAX_LOG_ENTRIES;
+void tft_logger::freeLog() {
+    free(log);
+    free(logBuckets);
+    log = nullptr;
+    logBuckets = nullptr;
+    logDepth = logCount = logWriteIndex = 0;
+    logBucketMask = 0;
 }
 
 void tft_logger::logWriteHeader(uint8_t *buffer, uint8_t &pos, tftFuncs fn) {
@@ -31,51 +87,102 @@ void tft_logger::writeUint16(uint8_t *buffer, uint8_t &pos, uint16_t value) {
 }
 
 void tft_logger::setLogging(bool _log) {
+    if (!logLock) logLock = xSemaphoreCreateRecursiveMutex();
+    LogLock lock(logLock);
     logging = _logging = _log;
-    logWriteIndex = 0;
-    memset(log, 0, sizeof(log));
+    if (_log && !log) allocLog(logDepthSetting);
+    else if (!_log) freeLog();
+    resetLog();
 };
 
-void tft_logger::getBinLog(uint8_t *outBuffer, size_t &outSize) {
-    outSize = 0;
-    // add Screen Info at the beginning of the Bin packet
+void tft_logger::setLogDepth(uint16_t depth) {
+    LogLock lock(logLock);
+    logDepthSetting = depth;
+    if (log) allocLog(depth);
+}
+
+size_t tft_logger::getBinLogMaxSize() { return 32 + (logDepth ? logDepth : 1) * MAX_LOG_SIZE; }
+
+// Writes one entry as a packet, 0 if it doesn't fit
+size_t tft_logger::writeLogEntry(const tftLog &entry, uint8_t *outBuffer, size_t maxLen) {
+    const uint8_t *data = entry.data;
+    if (data[2] != DRAWIMAGE) {
+        uint8_t size = data[1];
+        if (size > maxLen) return 0;
+        memcpy(outBuffer, data, size);
+        return size;
+    }
+
+    uint8_t imageSlot = data[12]; // AA SS FN XX XX YY YY Ce Ce Ms Ms FS SLOT
+                                  // 0  1  2  3  4  5  6  7  8  9  10 11 12
+    const char *imgPath = images[imageSlot];
+    size_t baseLen = 12; // AA SS FN XX XX YY YY Ce Ce Ms Ms FS + PATH
+    size_t imgLen = strlen(imgPath);
+    if (baseLen + imgLen > 0xFF) imgLen = 0xFF - baseLen; // the packet size is one byte
+    if (baseLen + imgLen > maxLen) return 0;
+
+    memcpy(outBuffer, data, baseLen);
+    memcpy(outBuffer + baseLen, imgPath, imgLen);
+    outBuffer[1] = baseLen + imgLen; // update packet size
+    return baseLen + imgLen;
+}
+
+size_t tft_logger::getBinLog(uint8_t *outBuffer, size_t maxLen, tftLogCursor *cursor) {
+    LogLock lock(logLock);
+    uint32_t since = cursor ? cursor->seq : 0;
+    bool full = since == 0 || cursor->epoch != logEpoch || since < logLost || since > logSeq;
+    if (full) since = 0;
+
+    // LOG_SYNC: epoch, seq the packet follows (0 for the whole screen) and seq it ends at
     uint8_t buffer[16];
     uint8_t pos = 0;
-    logWriteHeader(buffer, pos, SCREEN_INFO);
-    writeUint16(buffer, pos, width());
-    writeUint16(buffer, pos, height());
-    buffer[pos++] = rotation;
+    logWriteHeader(buffer, pos, LOG_SYNC);
+    writeUint16(buffer, pos, logEpoch);
+    writeUint16(buffer, pos, since >> 16);
+    writeUint16(buffer, pos, since);
+    uint8_t lastPos = pos;
+    writeUint16(buffer, pos, 0);
+    writeUint16(buffer, pos, 0);
     buffer[1] = pos;
+    if (maxLen < 2 * sizeof(buffer)) return 0;
+
+    memcpy(outBuffer, buffer, pos);
+    size_t outSize = pos;
+
+    if (full) {
+        // add Screen Info at the beginning of the screen
+        pos = 0;
+        logWriteHeader(buffer, pos, SCREEN_INFO);
+        writeUint16(buffer, pos, width());
+        writeUint16(buffer, pos, height());
+        buffer[pos++] = rotation;
+        buffer[1] = pos;
+        memcpy(outBuffer + outSize, buffer, pos);
+        outSize += pos;
+    }
 
-    memcpy(outBuffer + outSize, buffer, pos);
-    outSize += pos;
-
-    for (int i = 0; i < MAX_LOG_ENTRIES; i++) {
-        if (log[i].data[0] != LOG_PACKET_HEADER) continue;
-        uint8_t *entry = log[i].data;
-        uint8_t fn = entry[2];
-
-        if (fn == DRAWIMAGE) {
-            uint8_t imageSlot = entry[12]; // AA SS FN XX XX YY YY Ce Ce Ms Ms FS SLOT
-                                           // 0  1  2  3  4  5  6  7  8  9  10 11 12
-            const char *imgPath = images[imageSlot];
-            size_t baseLen = 12; // AA SS FN XX XX YY YY Ce Ce Ms Ms FS + PATH
-            size_t imgLen = strlen(imgPath);
-            if (outSize + baseLen + imgLen > MAX_LOG_SIZE * MAX_LOG_ENTRIES) continue;
-
-            memcpy(outBuffer + outSize, entry, baseLen);
-            outSize += baseLen;
-            memcpy(outBuffer + outSize, imgPath, imgLen);
-            outSize += imgLen;
-
-            outBuffer[outSize - imgLen - baseLen + 1] = baseLen + imgLen; // update packet size
-        } else {
-            uint8_t size = entry[1];
-            if (outSize + size > MAX_LOG_SIZE * MAX_LOG_ENTRIES) continue;
-            memcpy(outBuffer + outSize, entry, size);
-            outSize += size;
+    // Oldest first, the order they were drawn in
+    uint32_t last = logSeq;
+    for (uint16_t n = 0; n < logCount; n++) {
+        const tftLog &entry = log[(logWriteIndex + logDepth - logCount + n) % logDepth];
+        if (entry.seq <= since || entry.data[0] != LOG_PACKET_HEADER) continue;
+        size_t size = writeLogEntry(entry, outBuffer + outSize, maxLen - outSize);
+        if (size == 0) {
+            // The rest comes with the next call
+            last = entry.seq - 1;
+            break;
         }
+        outSize += size;
+    }
+
+    pos = lastPos;
+    writeUint16(outBuffer, pos, last >> 16);
+    writeUint16(outBuffer, pos, last);
+    if (cursor) {
+        cursor->epoch = logEpoch;
+        cursor->seq = last;
     }
+    return outSize;
 }
 
 void tft_logger::restoreLogger() {
@@ -89,24 +196,63 @@ bool tft_logger::isLogEqual(const tftLog &a, const tftLog &b) {
     return memcmp(a.data, b.data, sizeA) == 0;
 }
 
+// FNV-1a
+uint32_t tft_logger::logHash(const uint8_t *data, uint8_t size) {
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < size; i++) hash = (hash ^ data[i]) * 16777619u;
+    return hash;
+}
+
+// Called with the lock held, before an entry is overwritten
+void tft_logger::unlinkLogEntry(uint16_t index) {
+    uint16_t *link = &logBuckets[log[index].hash & logBucketMask];
+    while (*link != LOG_NO_ENTRY) {
+        if (*link == index) {
+            *link = log[index].next;
+            return;
+        }
+        link = &log[*link].next;
+    }
+}
+
 void tft_logger::pushLogIfUnique(const tftLog &l) {
-    for (int i = 0; i < MAX_LOG_ENTRIES; i++) {
-        if (isLogEqual(log[i], l)) {
+    LogLock lock(logLock);
+    if (!log) return;
+
+    uint32_t hash = logHash(l.data, l.data[1]);
+    uint16_t &bucket = logBuckets[hash & logBucketMask];
+    for (uint16_t i = bucket; i != LOG_NO_ENTRY; i = log[i].next) {
+        if (log[i].hash == hash && isLogEqual(log[i], l)) {
             return; // Entry already exists
         }
     }
-    memcpy(log[logWriteIndex].data, l.data, l.data[1]);
-    logWriteIndex = (logWriteIndex + 1) % MAX_LOG_ENTRIES;
+
+    uint16_t index = logWriteIndex;
+    tftLog &entry = log[index];
+    if (logCount == logDepth) {
+        unlinkLogEntry(index);
+        // Still on screen: a remote screen that doesn't have it needs a full copy
+        if (entry.data[0] == LOG_PACKET_HEADER) logLost = entry.seq;
+    } else {
+        logCount++;
+    }
+    memcpy(entry.data, l.data, l.data[1]);
+    entry.seq = ++logSeq;
+    entry.hash = hash;
+    entry.next = bucket;
+    bucket = index;
+    logWriteIndex = (index + 1) % logDepth;
 }
 
 bool tft_logger::removeLogEntriesInsideRect(int rx, int ry, int rw, int rh) {
+    LogLock lock(logLock);
     bool r = false;
     int rx1 = rx;
     int ry1 = ry;
     int rx2 = rx + rw;
     int ry2 = ry + rh;
 
-    for (int i = 0; i < MAX_LOG_ENTRIES; i++) {
+    for (int i = 0; i < logCount; i++) {
         uint8_t *data = log[i].data;
         if (data[0] != LOG_PACKET_HEADER) continue;
         int px = (data[3] << 8) | data[4];
@@ -120,7 +266,8 @@ bool tft_logger::removeLogEntriesInsideRect(int rx, int ry, int rw, int rh) {
 }
 
 void tft_logger::removeOverlappedImages(int x, int y, int center, int ms) {
-    for (int i = 0; i < MAX_LOG_ENTRIES; i++) {
+    LogLock lock(logLock);
+    for (int i = 0; i < logCount; i++) {
         uint8_t *data = log[i].data;
         if (data[0] != LOG_PACKET_HEADER) continue;
         uint8_t fn = data[2];
@@ -159,18 +306,19 @@ void tft_logger::fillScreen(int32_t color) {
 void tft_logger::imageToBin(uint8_t fs, String file, int x, int y, bool center, int Ms) {
     if (!logging) return;
 
+    LogLock lock(logLock);
     removeOverlappedImages(x, y, center, Ms);
 
     // Try to find or store in images[MAX_LOG_IMAGES][MAX_LOG_IMG_PATH];
     uint8_t imageSlot = 0xFF;
-    for (int i = 0; i < MAX_LOG_IMG_PATH; ++i) {
+    for (int i = 0; i < MAX_LOG_IMAGES; ++i) {
         if (strcmp(images[i], file.c_str()) == 0) {
             imageSlot = i;
             break;
         }
     }
     if (imageSlot == 0xFF) {
-        for (int i = 0; i < MAX_LOG_IMG_PATH; ++i) {
+        for (int i = 0; i < MAX_LOG_IMAGES; ++i) {
             if (images[i][0] == 0) {
                 strncpy(images[i], file.c_str(), sizeof(images[i]) - 1);
                 images[i][sizeof(images[i]) - 1] = 0;
@@ -179,6 +327,7 @@ void tft_logger::imageToBin(uint8_t fs, String file, int x, int y, bool center,
             }
         }
     }
+    if (imageSlot == 0xFF) return; // No slot left until the next fillScreen
 
     // Use image path as identifier in log.data
     uint8_t buffer[MAX_LOG_SIZE];
@@ -2,6 +2,7 @@
 #include "core/wifi/wifi_common.h" //to return MAC addr
 #include "scrollableTextArea.h"
 #include <globals.h>
+#include <memory>
 
 /*********************************************************************
 **  Function: backToMenu
@@ -150,22 +151,76 @@ void touchHeatMap(struct TouchPoint t) {
 
 #endif
 
-String getOptionsJSON() {
-    String menutype = "regular_menu";
-    if (menuOptionType == 0) menutype = "main_menu";
-    else if (menuOptionType == 1) menutype = "sub_menu";
-
-    String response = "{\"width\":" + String(tftWidth) + ", \"height\":" + String(tftHeight) +
-                      ",\"menu\":\"" + menutype + "\",\"menu_title\":\"" + menuOptionLabel +
-                      "\", \"options\":[";
-    int i = 0;
-    int sel = 0;
-    for (auto opt : options) {
-        response += "{\"n\":" + String(i) + ",\"label\":\"" + opt.label + "\"}";
-        if (opt.hovered) sel = i;
-        i++;
-        if (i < options.size()) response += ",";
+/*********************************************************************
+** Function: printJsonString
+** Writes s as a JSON string, quotes and control characters escaped
+**********************************************************************/
+void printJsonString(Print &out, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    out.write('"');
+    const char *run = s; // Characters that go out as they are, written together
+    for (; *s; s++) {
+        uint8_t c = *s;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out.write((const uint8_t *)run, s - run);
+        if (c == '"' || c == '\\') {
+            out.write('\\');
+            out.write(c);
+        } else if (c == '\n') {
+            out.print("\\n");
+        } else {
+            char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15], 0};
+            out.print(escaped);
+        }
+        run = s + 1;
+    }
+    out.write((const uint8_t *)run, s - run);
+    out.write('"');
+}
+
+/*********************************************************************
+** Function: optionsJsonWriter
+** Menu options as JSON for the remote controls (WebUI, serial), written
+** straight to the output a piece at a time instead of built in a String.
+** The menu is copied when it's called: the pieces go out later on the
+** web server's task while the UI task changes the menu.
+**********************************************************************/
+std::function<bool(Print &)> optionsJsonWriter() {
+    struct Menu {
+        const char *type;
+        String title;
+        size_t active;
+        std::vector<String> labels;
+    };
+    auto menu = std::make_shared<Menu>();
+    menu->type = "regular_menu";
+    if (menuOptionType == 0) menu->type = "main_menu";
+    else if (menuOptionType == 1) menu->type = "sub_menu";
+    menu->title = menuOptionLabel;
+    menu->active = 0;
+    menu->labels.reserve(options.size());
+    for (size_t i = 0; i < options.size(); i++) {
+        if (options[i].hovered) menu->active = i;
+        menu->labels.push_back(options[i].label);
     }
-    response += "], \"active\":" + String(sel) + "}";
-    return response;
+
+    size_t piece = 0;
+    return [menu, piece](Print &out) mutable -> bool {
+        if (piece++ == 0) {
+            out.printf("{\"width\":%d,\"height\":%d,\"menu\":\"%s\"", tftWidth, tftHeight, menu->type);
+            out.print(",\"menu_title\":");
+            printJsonString(out, menu->title.c_str());
+            out.printf(",\"active\":%u,\"options\":[", menu->active);
+            return true;
+        }
+        size_t i = piece - 2;
+        if (i >= menu->labels.size()) {
+            out.print("]}");
+            return false;
+        }
+        out.printf("%s{\"n\":%u,\"label\":", i ? "," : "", i);
+        printJsonString(out, menu->labels[i].c_str());
+        out.write('}');
+        return true;
+    };
 }
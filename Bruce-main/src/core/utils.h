@@ -1,12 +1,17 @@
 #ifndef __UTILS_H__
 #define __UTILS_H__
 #include <Arduino.h>
+#include <functional>
 void backToMenu();
 void addOptionToMainMenu();
 void updateClockTimezone();
 void updateTimeStr(struct tm timeInfo);
 void showDeviceInfo();
-String getOptionsJSON();
+// Writes s quoted and escaped as a JSON string
+void printJsonString(Print &out, const char *s);
+// The menu on screen as JSON, written a piece (one option) per call of the
+// returned function, which returns false after the last one
+std::function<bool(Print &)> optionsJsonWriter();
 void touchHeatMap(struct TouchPoint t);
 
 #endif
@@ -1,4 +1,5 @@
 #include "webInterface.h"
+#include "core/dir_index.h"
 #include "core/display.h"    // using displayRedStripe as error msg
 #include "core/mykeyboard.h" // using keyboard when calling rename
 #include "core/passwords.h"
@@ -8,8 +9,11 @@
 #include "core/utils.h"
 #include "core/wifi/wifi_common.h" // using common wifisetup
 #include "esp_task_wdt.h"
+#include "modules/NRF24/nrf_spectrum.h"
 #include "webFiles.h"
+#include <TrackJournal.h>
 #include <globals.h>
+#include <memory>
 
 File uploadFile;
 FS _webFS = LittleFS;
@@ -20,20 +24,30 @@ const int default_webserverporthttp = 80;
 IPAddress AP_GATEWAY(172, 0, 0, 1); // Gateway
 
 AsyncWebServer *server = nullptr; // initialise webserver
+AsyncWebSocket *screenSocket = nullptr;
 const char *host = "bruce";
 String uploadFolder = "";
 
+#define SCREEN_PUSH_INTERVAL 30 // ms between two pushes of the screen to the navigator
+static TaskHandle_t screenPushTaskHandle = nullptr;
+static volatile bool screenPushStop = false;
+static volatile bool screenResync = true;
+
 /**********************************************************************
 **  Function: stopWebUi
 **  Turn off the WebUI
 **********************************************************************/
 void stopWebUi() {
+    // Let the push task finish with the log before it goes away
+    screenPushStop = true;
+    while (screenPushTaskHandle) vTaskDelay(pdMS_TO_TICKS(10));
     tft.setLogging(false);
     isWebUIActive = false;
     server->end();
-    server->~AsyncWebServer();
+    server->~AsyncWebServer(); // deletes the handlers, screenSocket too
     free(server);
     server = nullptr;
+    screenSocket = nullptr;
     MDNS.end();
 }
 /**********************************************************************
@@ -74,51 +88,93 @@ String humanReadableSize(uint64_t bytes) {
 
 /**********************************************************************
 **  Function: listFiles
-**  list all of the files, if ishtml=true, return html rather than simple text
+**  list all of the files, one line per call of the returned function,
+**  which returns false after the last one
 **********************************************************************/
-String listFiles(FS fs, String folder) {
-    // log_i("Listfiles Start");
-    String returnText = "pa:" + folder + ":0\n";
+std::function<bool(Print &)> listFiles(FS &fs, String folder) {
     Serial.println("Listing files stored on SD");
+    String header = "pa:" + folder + ":0\n";
 
     _webFS = fs;
 
-    File root = fs.open(folder);
-    File foundfile = root.openNextFile();
     if (folder == "//") folder = "/";
     uploadFolder = folder;
-    String PreFolder = folder;
-    PreFolder = PreFolder.substring(0, PreFolder.lastIndexOf("/"));
-    if (PreFolder == "") PreFolder = "/";
-
-    if (folder == "/") folder = "";
-    while (foundfile) {
-        if (esp_get_free_heap_size() > (String("Fo:" + String(foundfile.name()) + ":0\n").length()) + 1024) {
-            if (foundfile.isDirectory()) returnText += "Fo:" + String(foundfile.name()) + ":0\n";
-        } else break;
-        foundfile = root.openNextFile();
-        esp_task_wdt_reset();
+
+    // A listing of its own, scanned so the sizes are current: the file browser's are only used by
+    // the UI task. Folders come first in the index, as they are listed here.
+    std::shared_ptr<DirIndex> dir(new DirIndex());
+    if (!dir->scanFolder(fs, folder)) dir.reset();
+    uint32_t i = 0;
+    return [header, dir, i](Print &out) mutable -> bool {
+        if (header.length()) {
+            out.print(header);
+            header = "";
+            return dir != nullptr;
+        }
+        if (i >= dir->count()) return false;
+        out.print(dir->isFolder(i) ? "Fo:" : "Fi:");
+        out.print(dir->name(i));
+        out.write(':');
+        out.print(dir->isFolder(i) ? String("0") : humanReadableSize(dir->fileSize(i)));
+        out.write('\n');
+        i++;
+        return true;
+    };
+}
+
+// The piece of a response being sent
+class PieceBuffer : public Print {
+public:
+    size_t write(uint8_t c) override {
+        data.push_back(c);
+        return 1;
     }
-    root.close();
-    foundfile.close();
-
-    if (folder == "") folder = "/";
-    root = fs.open(folder);
-    foundfile = root.openNextFile();
-    while (foundfile) {
-        if (esp_get_free_heap_size() > (String("Fo:" + String(foundfile.name()) + ":0\n").length()) + 1024) {
-            if (!(foundfile.isDirectory()))
-                returnText +=
-                    "Fi:" + String(foundfile.name()) + ":" + humanReadableSize(foundfile.size()) + "\n";
-        } else break;
-        foundfile = root.openNextFile();
-        esp_task_wdt_reset();
+    size_t write(const uint8_t *buffer, size_t size) override {
+        data.insert(data.end(), buffer, buffer + size);
+        return size;
     }
-    root.close();
-    foundfile.close();
 
-    // log_i("ListFiles End");
-    return returnText;
+    std::vector<uint8_t> data;
+    size_t sent = 0;
+};
+
+/**********************************************************************
+**  Function: sendPieces
+**  Sends a chunked response written a piece at a time as the connection
+**  takes it, so only one piece is in memory instead of the whole body.
+**  next() writes the next piece and returns false after the last one.
+**********************************************************************/
+static void sendPieces(AsyncWebServerRequest *request, const char *type, std::function<bool(Print &)> next) {
+    struct State {
+        std::function<bool(Print &)> next;
+        PieceBuffer piece;
+        bool done = false;
+    };
+    auto state = std::make_shared<State>();
+    state->next = std::move(next);
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        type,
+        [state](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            PieceBuffer &piece = state->piece;
+            size_t len = 0;
+            while (len < maxLen) {
+                if (piece.sent == piece.data.size()) {
+                    if (state->done) break;
+                    piece.data.clear();
+                    piece.sent = 0;
+                    state->done = !state->next(piece);
+                    continue;
+                }
+                size_t n = std::min(maxLen - len, piece.data.size() - piece.sent);
+                memcpy(buffer + len, piece.data.data() + piece.sent, n);
+                piece.sent += n;
+                len += n;
+            }
+            return len;
+        }
+    );
+    request->send(response);
 }
 
 /**********************************************************************
@@ -161,6 +217,146 @@ void createDirRecursive(String path, FS fs) {
         startIndex = endIndex + 1;
     }
 }
+#define UPLOAD_RETRIES 10    // for open() and write(), 5ms apart
+#define UPLOAD_ENC_CHUNK 512 // plaintext bytes encrypted at a time
+
+// Kept in request->_tempObject, which the request frees with free() when it ends
+struct UploadContext {
+    // Kept over the files of the request, for its response
+    bool anyFailed;
+    bool keyPending; // Key still being derived, the client should retry
+    // The file being received
+    bool encrypted;
+    bool failed;
+    uint32_t startMs;
+    uint32_t bytes;
+    uint32_t writeUs; // total time spent in write()
+    uint32_t maxWriteUs;
+    uint32_t writes;
+    uint16_t retries;
+    EncryptStream stream;
+    uint8_t buffer[UPLOAD_ENC_CHUNK];
+};
+
+/**********************************************************************
+**  Function: uploadWrite
+** writes everything or gives up after UPLOAD_RETRIES. Waiting here
+** holds the next chunks back in TCP while the card is busy.
+**********************************************************************/
+static bool uploadWrite(File &file, UploadContext *ctx, const uint8_t *data, size_t len) {
+    uint32_t start = micros();
+    size_t done = 0;
+    for (int attempt = 0; done < len; attempt++) {
+        size_t n = file.write(data + done, len - done);
+        done += n;
+        if (done >= len) break;
+        if (attempt >= UPLOAD_RETRIES) return false;
+        ctx->retries++;
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    uint32_t elapsed = micros() - start;
+    ctx->writeUs += elapsed;
+    if (elapsed > ctx->maxWriteUs) ctx->maxWriteUs = elapsed;
+    ctx->writes++;
+    return true;
+}
+
+// A GPS Tracker journal, rendered while it's sent
+struct TrackExportContext {
+    File file;
+    FileTrackSource source;
+    TrackExport doc;
+
+    TrackExportContext(File f, TrackExport::Format format) : file(f), source(file), doc(source, format) {}
+    ~TrackExportContext() { file.close(); }
+};
+
+/**********************************************************************
+**  Function: sendTrackExport
+** sends a .trk journal as GPX or GeoJSON, rendered chunk by chunk
+**********************************************************************/
+static void sendTrackExport(
+    AsyncWebServerRequest *request, FS &fs, const String &path, TrackExport::Format format
+) {
+    auto ctx = std::make_shared<TrackExportContext>(fs.open(path, FILE_READ), format);
+    if (!ctx->file || !ctx->doc.begin()) {
+        request->send(400, "text/plain", "ERROR: not a GPS track");
+        return;
+    }
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        TrackExport::contentType(format),
+        [ctx](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            return ctx->doc.read(buffer, maxLen);
+        }
+    );
+    String name = path.substring(path.lastIndexOf('/') + 1);
+    if (name.lastIndexOf('.') > 0) name = name.substring(0, name.lastIndexOf('.'));
+    name += TrackExport::extension(format);
+    response->addHeader("Content-Disposition", "attachment; filename=\"" + name + "\"");
+    request->send(response);
+}
+
+/**********************************************************************
+**  Function: screenPushTask
+** pushes what gets drawn to the navigators connected on /screen/ws.
+** Every client gets the same getBinLog deltas, and the whole screen
+** when one connects or tells it missed something.
+**********************************************************************/
+static void screenPushTask(void *param) {
+    uint8_t *buffer = nullptr;
+    size_t bufferSize = 0;
+    tftLogCursor cursor;
+    unsigned long pushes = 0;
+    unsigned long bytes = 0;
+    unsigned long statsAt = millis();
+
+    while (!screenPushStop) {
+        vTaskDelay(pdMS_TO_TICKS(SCREEN_PUSH_INTERVAL));
+        screenSocket->cleanupClients();
+        if (screenSocket->count() == 0) {
+            screenResync = true;
+            continue;
+        }
+        if (!screenResync && cursor.epoch == tft.getLogEpoch() && cursor.seq == tft.getLogSeq()) continue;
+        // Someone hasn't got the last push yet, send more once it has
+        if (!screenSocket->availableForWriteAll()) continue;
+
+        size_t maxSize = tft.getBinLogMaxSize();
+        if (maxSize != bufferSize) {
+            free(buffer);
+            buffer = (uint8_t *)(psramFound() ? ps_malloc(maxSize) : malloc(maxSize));
+            bufferSize = buffer ? maxSize : 0;
+            if (!buffer) continue;
+        }
+        if (screenResync) {
+            screenResync = false;
+            cursor.seq = 0;
+        }
+        size_t size = tft.getBinLog(buffer, bufferSize, &cursor);
+        screenSocket->binaryAll(buffer, size);
+
+        pushes++;
+        bytes += size;
+        if (millis() - statsAt > 10000) {
+            log_d("Screen push: %lu updates, %lu bytes in 10s", pushes, bytes);
+            pushes = bytes = 0;
+            statsAt = millis();
+        }
+    }
+
+    free(buffer);
+    screenPushTaskHandle = nullptr;
+    vTaskDelete(NULL);
+}
+
+static void onScreenSocketEvent(
+    AsyncWebSocket *socket, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data,
+    size_t len
+) {
+    // A new navigator, or one asking for the whole screen
+    if (type == WS_EVT_CONNECT || type == WS_EVT_DATA) screenResync = true;
+}
+
 /**********************************************************************
 **  Function: handleUpload
 ** handles uploads to the filserver
@@ -172,46 +368,89 @@ void handleUpload(
     // Serial.println("Folder: " + uploadFolder);
     if (uploadFolder == "/") uploadFolder = "";
 
-    if (checkUserWebAuth(request)) {
-        if (!index) {
-            if (request->hasArg("password")) filename = filename + ".enc";
-            Serial.println("File: " + uploadFolder + "/" + filename);
-            String relativePath = filename;
-            String fullPath = uploadFolder + "/" + relativePath;
-            String dirPath = fullPath.substring(0, fullPath.lastIndexOf("/"));
-            if (dirPath.length() > 0) { createDirRecursive(dirPath, _webFS); }
-        RETRY:
+    if (!checkUserWebAuth(request)) return;
+
+    UploadContext *ctx = (UploadContext *)request->_tempObject;
+    if (!index) {
+        if (!ctx) ctx = (UploadContext *)calloc(1, sizeof(UploadContext));
+        if (!ctx) {
+            Serial.println("Upload: out of memory");
+            return;
+        }
+        // Several files can come in one request, only the file's state starts over
+        bool anyFailed = ctx->anyFailed || ctx->failed;
+        bool keyPending = ctx->keyPending;
+        memset(ctx, 0, sizeof(UploadContext));
+        ctx->anyFailed = anyFailed;
+        ctx->keyPending = keyPending;
+        request->_tempObject = ctx;
+        ctx->startMs = millis();
+        ctx->encrypted = request->hasArg("password");
+        // PBKDF2 would hold this task for most of a second, it runs on its own and the client retries
+        if (ctx->encrypted && !encryptKeyPrepare(request->arg("password"))) {
+            ctx->failed = ctx->keyPending = true;
+            return;
+        }
+
+        if (ctx->encrypted) filename = filename + ".enc";
+        Serial.println("File: " + uploadFolder + "/" + filename);
+        String relativePath = filename;
+        String fullPath = uploadFolder + "/" + relativePath;
+        String dirPath = fullPath.substring(0, fullPath.lastIndexOf("/"));
+        if (dirPath.length() > 0) { createDirRecursive(dirPath, _webFS); }
+
+        for (int attempt = 0; attempt <= UPLOAD_RETRIES; attempt++) {
             request->_tempFile = _webFS.open(uploadFolder + "/" + filename, "w");
-            if (!request->_tempFile) {
-                Serial.println("Failed to open file for writing: " + uploadFolder + "/" + filename);
-                vTaskDelay(pdMS_TO_TICKS(5));
-                goto RETRY;
-            }
+            if (request->_tempFile) break;
+            Serial.println("Failed to open file for writing: " + uploadFolder + "/" + filename);
+            ctx->retries++;
+            vTaskDelay(pdMS_TO_TICKS(5));
+        }
+        if (!request->_tempFile) {
+            ctx->failed = true;
+            return;
         }
 
-        if (len) {
-            if (request->hasArg("password")) {
-                // encryption requested
-                static int chunck_no = 0;
-                if (chunck_no != 0) {
-                    // TODO: handle multiple chunks
-                    request->send(404, "text/html", "file is too big");
-                    return;
-                } else chunck_no += 1;
-                String enc_password = request->arg("password");
-                String plaintext = String((char *)data).substring(0, len);
-                String cyphertxt = encryptString(plaintext, enc_password);
-                if (cyphertxt == "") { return; }
-                if (request->_tempFile)
-                    request->_tempFile.write((const uint8_t *)cyphertxt.c_str(), cyphertxt.length());
-            } else {
-                if (request->_tempFile) request->_tempFile.write(data, len);
-            }
+        if (ctx->encrypted) {
+            // The header comes out of encryptStreamBegin() in the buffer
+            if (!encryptStreamBegin(ctx->stream, request->arg("password"), ctx->buffer, false) ||
+                !uploadWrite(request->_tempFile, ctx, ctx->buffer, ENCRYPT_HEADER_SIZE))
+                ctx->failed = true;
         }
-        if (final) {
-            // close the file handle as the upload is now done
-            if (request->_tempFile) request->_tempFile.close();
+    }
+    if (!ctx || ctx->failed || !request->_tempFile) return;
+
+    ctx->bytes += len;
+    if (ctx->encrypted) {
+        // encrypted a piece at a time into the same buffer, however big the file is
+        for (size_t i = 0; i < len && !ctx->failed; i += UPLOAD_ENC_CHUNK) {
+            size_t n = len - i < UPLOAD_ENC_CHUNK ? len - i : UPLOAD_ENC_CHUNK;
+            encryptStreamUpdate(ctx->stream, data + i, ctx->buffer, n);
+            if (!uploadWrite(request->_tempFile, ctx, ctx->buffer, n)) ctx->failed = true;
         }
+        if (final || ctx->failed) encryptStreamEnd(ctx->stream);
+    } else if (len && !uploadWrite(request->_tempFile, ctx, data, len)) {
+        ctx->failed = true;
+    }
+
+    if (ctx->failed) {
+        Serial.println("Upload failed writing: " + uploadFolder + "/" + filename);
+        request->_tempFile.close();
+        return;
+    }
+    if (final) {
+        // close the file handle as the upload is now done
+        request->_tempFile.close();
+        uint32_t ms = millis() - ctx->startMs;
+        Serial.printf(
+            "Upload: %lu bytes in %lu ms (%.1f kB/s), write avg %lu us max %lu us, %u retries\n",
+            (unsigned long)ctx->bytes,
+            (unsigned long)ms,
+            ms ? ctx->bytes / (float)ms : 0.0f,
+            (unsigned long)(ctx->writes ? ctx->writeUs / ctx->writes : 0),
+            (unsigned long)ctx->maxWriteUs,
+            ctx->retries
+        );
     }
 }
 
@@ -291,7 +530,19 @@ void configureWebServer() {
     server->on(
         "/upload",
         HTTP_POST,
-        [](AsyncWebServerRequest *request) { request->send(200, "text/plain", "File upload completed"); },
+        [](AsyncWebServerRequest *request) {
+            UploadContext *ctx = (UploadContext *)request->_tempObject;
+            if (ctx && ctx->keyPending) {
+                AsyncWebServerResponse *response =
+                    request->beginResponse(503, "text/plain", "Deriving the encryption key, retry");
+                response->addHeader("Retry-After", "1");
+                request->send(response);
+            } else if (ctx && (ctx->anyFailed || ctx->failed)) {
+                request->send(500, "text/plain", "File upload failed");
+            } else {
+                request->send(200, "text/plain", "File upload completed");
+            }
+        },
         handleUpload
     );
 
@@ -367,7 +618,7 @@ void configureWebServer() {
         }
     });
     server->on("/systeminfo", HTTP_GET, [](AsyncWebServerRequest *request) {
-        char response_body[300];
+        char response_body[400];
         uint64_t LittleFSTotalBytes = LittleFS.totalBytes();
         uint64_t LittleFSUsedBytes = LittleFS.usedBytes();
         uint64_t SDTotalBytes = SD.totalBytes();
@@ -375,7 +626,8 @@ void configureWebServer() {
         sprintf(
             response_body,
             "{\"%s\":\"%s\",\"SD\":{\"%s\":\"%s\",\"%s\":\"%s\",\"%s\":\"%s\"},"
-            "\"LittleFS\":{\"%s\":\"%s\",\"%s\":\"%s\",\"%s\":\"%s\"}}",
+            "\"LittleFS\":{\"%s\":\"%s\",\"%s\":\"%s\",\"%s\":\"%s\"},"
+            "\"heap\":{\"free\":%u,\"min\":%u,\"largest\":%u}}",
             "BRUCE_VERSION",
             BRUCE_VERSION,
             "free",
@@ -389,17 +641,58 @@ void configureWebServer() {
             "used",
             humanReadableSize(LittleFSUsedBytes).c_str(),
             "total",
-            humanReadableSize(LittleFSTotalBytes).c_str()
+            humanReadableSize(LittleFSTotalBytes).c_str(),
+            heap_caps_get_free_size(MALLOC_CAP_8BIT),
+            heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT),
+            heap_caps_get_largest_free_block(MALLOC_CAP_8BIT)
         );
         request->send(200, "application/json", response_body);
     });
 
+    // Screen draw commands, only the ones since ?epoch=&seq= when the log still has them
     server->on("/getscreen", HTTP_GET, [](AsyncWebServerRequest *request) {
-        uint8_t binData[MAX_LOG_ENTRIES * MAX_LOG_SIZE];
-        size_t binSize = 0;
+        tftLogCursor cursor;
+        if (request->hasParam("epoch") && request->hasParam("seq")) {
+            cursor.epoch = request->getParam("epoch")->value().toInt();
+            cursor.seq = strtoul(request->getParam("seq")->value().c_str(), nullptr, 10);
+        }
+        size_t maxSize = tft.getBinLogMaxSize();
+        std::shared_ptr<uint8_t> binData(
+            (uint8_t *)(psramFound() ? ps_malloc(maxSize) : malloc(maxSize)), free
+        );
+        if (!binData) {
+            request->send(500, "text/plain", "Not enough memory");
+            return;
+        }
+        size_t binSize = tft.getBinLog(binData.get(), maxSize, &cursor);
+        AsyncWebServerResponse *response = request->beginResponse(
+            "application/octet-stream",
+            binSize,
+            [binData, binSize](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                size_t len = binSize - index < maxLen ? binSize - index : maxLen;
+                memcpy(buffer, binData.get() + index, len);
+                return len;
+            }
+        );
+        request->send(response);
+    });
 
-        tft.getBinLog(binData, binSize);
-        request->send(200, "application/octet-stream", (const uint8_t *)binData, binSize);
+    // Same as /getscreen, pushed as it gets drawn
+    screenSocket = new AsyncWebSocket("/screen/ws");
+    screenSocket->onEvent(onScreenSocketEvent);
+    screenSocket->setFilter([](AsyncWebServerRequest *request) { return checkUserWebAuth(request); });
+    server->addHandler(screenSocket);
+
+    // Last NRF24 spectrum sweep while the survey runs, see nrf_spectrum.h for the frame layout
+    server->on("/nrf24/spectrum", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (checkUserWebAuth(request)) {
+            uint8_t frame[NRF_SURVEY_FRAME_SIZE];
+            size_t size = nrfSurveyFrame(frame, sizeof(frame));
+            if (size == 0) request->send(503, "text/plain", "NRF24 spectrum not running");
+            else request->send(200, "application/octet-stream", frame, size);
+        } else {
+            request->requestAuthentication();
+        }
     });
 
     // WIP: Serve a folder to a custom WEBUI..
@@ -453,8 +746,7 @@ void configureWebServer() {
                 int sep = cmnd.indexOf(" ");
                 String firstParam = (sep >= 0) ? cmnd.substring(0, sep) : cmnd;
                 if (firstParam == "nav") {
-                    String response = getOptionsJSON();
-                    request->send(200, "application/json", response.c_str());
+                    sendPieces(request, "application/json", optionsJsonWriter());
                 } else {
                     request->send(200, "text/plain", "command " + cmnd + " success");
                 }
@@ -480,11 +772,10 @@ void configureWebServer() {
         if (checkUserWebAuth(request)) {
             String folder = "/";
             if (request->hasArg("folder")) { folder = request->arg("folder"); }
-            bool useSD = false;
             if (strcmp(request->arg("fs").c_str(), "SD") == 0) {
-                request->send(200, "text/plain", listFiles(SD, folder));
+                sendPieces(request, "text/plain", listFiles(SD, folder));
             } else {
-                request->send(200, "text/plain", listFiles(LittleFS, folder));
+                sendPieces(request, "text/plain", listFiles(LittleFS, folder));
             }
 
         } else {
@@ -529,6 +820,10 @@ void configureWebServer() {
                 } else {
                     if (strcmp(fileAction.c_str(), "download") == 0) {
                         request->send(*fs, fileName, "application/octet-stream", true);
+                    } else if (strcmp(fileAction.c_str(), "gpx") == 0) {
+                        sendTrackExport(request, *fs, fileName, TrackExport::GPX);
+                    } else if (strcmp(fileAction.c_str(), "geojson") == 0) {
+                        sendTrackExport(request, *fs, fileName, TrackExport::GEOJSON);
                     } else if (strcmp(fileAction.c_str(), "image") == 0) {
                         String extension = fileName.substring(fileName.lastIndexOf('.') + 1);
                         // https://www.iana.org/assignments/media-types/media-types.xhtml#image
@@ -629,6 +924,10 @@ void configureWebServer() {
         }
     });
     server->begin();
+
+    screenPushStop = false;
+    screenResync = true;
+    xTaskCreate(screenPushTask, "screenPush", 4096, NULL, 1, &screenPushTaskHandle);
 }
 
 /**********************************************************************
@@ -50,13 +50,22 @@ keyStroke KeyStroke;
 TaskHandle_t xHandle;
 void __attribute__((weak)) taskInputHandler(void *parameter) {
     auto timer = millis();
+    bool pressSeen = false;
     while (true) {
         checkPowerSaveTime();
+        // A press set by another task (serial or web remote) counts from when
+        // it's first seen here, the task may have been asleep for a while
+        if (AnyKeyPress && !pressSeen) {
+            pressSeen = true;
+            timer = millis();
+            inputPublish();
+        }
         // Sometimes this task run 2 or more times before looptask,
         // and navigation gets stuck, the idea here is run the input detection
         // if AnyKeyPress is false, or rerun if it was not renewed within 75ms (arbitrary)
         // because AnyKeyPress will be true if didn´t passed through a check(bool var)
         if (!AnyKeyPress || millis() - timer > 75) {
+            inputLock();
             NextPress = false;
             PrevPress = false;
             UpPress = false;
@@ -72,9 +81,13 @@ void __attribute__((weak)) taskInputHandler(void *parameter) {
 #ifndef USE_TFT_eSPI_TOUCH
             InputHandler();
 #endif
+            inputUnlock();
             timer = millis();
+            pressSeen = AnyKeyPress;
+            if (AnyKeyPress) inputPublish();
         }
-        vTaskDelay(pdMS_TO_TICKS(10));
+        // Polls every 10ms, or sleeps until an interrupt on boards that have them
+        inputIdle(AnyKeyPress || LongPress);
     }
 }
 // Public Globals Variables
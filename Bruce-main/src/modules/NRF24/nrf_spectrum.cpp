@@ -3,56 +3,152 @@
 #include "../../core/mykeyboard.h"
 #include "nrf_common.h"
 
-#define CHANNELS 80
 #define RGB565(r, g, b) ((((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)))
-uint8_t channel[CHANNELS];
+#define NRF_DWELL_US 170     // RX settling (130us) plus the 40us the RPD needs
+#define NRF_PEAK_HOLD 64     // Sweeps a peak stays before falling
+#define NRF_PEAK_DECAY 2     // Per sweep, once it falls
+#define NRF_FRAME_MS 40      // Screen refresh
+
+static TaskHandle_t surveyTask = nullptr;
+static volatile bool surveyStop = false;
+static SemaphoreHandle_t surveyBus = nullptr;
+static portMUX_TYPE surveyMux = portMUX_INITIALIZER_UNLOCKED;
+static NRFSpectrumFrame published; // Last finished sweep, copied under surveyMux
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Survey
+/////////////////////////////////////////////////////////////////////////////////////
+// One pass over every channel, smoothing into level
+static void sweep(uint8_t *level) {
+    gpio_num_t ce = bruceConfigPins.NRF24_bus.io0;
+    for (int i = 0; i < NRF_CHANNELS; i++) {
+        digitalWrite(ce, LOW);
+        NRFradio.setChannel(i);
+        digitalWrite(ce, HIGH);
+        delayMicroseconds(NRF_DWELL_US);
+        int rpd = NRFradio.testRPD() ? 1 : 0;
+        level[i] = (level[i] * 3 + rpd * 125) / 4;
+    }
+    digitalWrite(ce, LOW);
+}
 
-// Register Access Functions
-inline byte getRegister(SPIClass &SSPI, byte r) {
+static void updatePeaks(const uint8_t *level, uint8_t *peak, uint8_t *peakAge) {
+    for (int i = 0; i < NRF_CHANNELS; i++) {
+        if (level[i] >= peak[i]) {
+            peak[i] = level[i];
+            peakAge[i] = 0;
+        } else if (peakAge[i] < NRF_PEAK_HOLD) {
+            peakAge[i]++;
+        } else {
+            peak[i] = peak[i] > level[i] + NRF_PEAK_DECAY ? peak[i] - NRF_PEAK_DECAY : level[i];
+        }
+    }
+}
 
-    digitalWrite(NRF24_SS_PIN, LOW);
-    byte c = SSPI.transfer(r & 0x1F);
-    c = SSPI.transfer(0);
-    digitalWrite(NRF24_SS_PIN, HIGH);
+static void surveyLoop(void *parameter) {
+    // Working copies: the task only touches these, readers get the published one
+    uint8_t level[NRF_CHANNELS] = {0};
+    uint8_t peak[NRF_CHANNELS] = {0};
+    uint8_t peakAge[NRF_CHANNELS] = {0};
+    uint32_t sweeps = 0;
+    uint16_t sweepRate = 0;
+    uint32_t rateStart = millis();
+    uint32_t rateSweeps = 0;
+
+    NRFradio.startListening();
+    while (!surveyStop) {
+        xSemaphoreTake(surveyBus, portMAX_DELAY);
+        sweep(level);
+        xSemaphoreGive(surveyBus);
+        updatePeaks(level, peak, peakAge);
+        sweeps++;
+
+        uint32_t now = millis();
+        if (now - rateStart >= 1000) {
+            sweepRate = (sweeps - rateSweeps) * 1000 / (now - rateStart);
+            rateStart = now;
+            rateSweeps = sweeps;
+        }
 
-    return c;
-}
+        portENTER_CRITICAL(&surveyMux);
+        memcpy(published.level, level, NRF_CHANNELS);
+        memcpy(published.peak, peak, NRF_CHANNELS);
+        published.sweeps = sweeps;
+        published.sweepRate = sweepRate;
+        portEXIT_CRITICAL(&surveyMux);
 
-inline void setRegister(SPIClass &SSPI, byte r, byte v) {
+        // Lets the idle task (watchdog) and whoever waits for the bus run
+        vTaskDelay(1);
+    }
+    NRFradio.stopListening();
+    surveyTask = nullptr;
+    vTaskDelete(NULL);
+}
 
-    digitalWrite(NRF24_SS_PIN, LOW);
-    SSPI.transfer((r & 0x1F) | 0x20);
-    SSPI.transfer(v);
-    digitalWrite(NRF24_SS_PIN, HIGH);
+bool nrfSurveyStart() {
+    if (surveyTask) return true;
+    if (!surveyBus) surveyBus = xSemaphoreCreateMutex();
+    memset(&published, 0, sizeof(published));
+    surveyStop = false;
+    BaseType_t ok = xTaskCreate(
+        surveyLoop,   // Task function
+        "NRFSurvey",  // Task Name
+        3072,         // Stack size
+        NULL,         // Task parameters
+        1,            // Task priority, below the loop and input tasks
+        &surveyTask   // Task handle
+    );
+    if (ok != pdPASS) surveyTask = nullptr;
+    return surveyTask != nullptr;
 }
 
-inline void powerDown(SPIClass &SSPI) { setRegister(SSPI, 0x00, getRegister(SSPI, 0x00) & ~0x02); }
+void nrfSurveyStop() {
+    if (!surveyTask) return;
+    surveyStop = true;
+    while (surveyTask) vTaskDelay(pdMS_TO_TICKS(5));
+}
 
-// scanning channels
-#define _BW tftWidth / CHANNELS
-String scanChannels(SPIClass *SSPI, bool web) {
-    String result = "{";
+bool nrfSurveyRunning() { return surveyTask != nullptr; }
 
-    uint8_t rpdValues[CHANNELS] = {0};
-    digitalWrite(NRF24_CE_PIN, LOW);
+bool nrfSurveySnapshot(NRFSpectrumFrame &frame) {
+    if (!surveyTask) return false;
+    portENTER_CRITICAL(&surveyMux);
+    frame = published;
+    portEXIT_CRITICAL(&surveyMux);
+    return true;
+}
 
-    for (int i = 0; i < CHANNELS; i++) {
-        NRFradio.setChannel(i);
-        NRFradio.startListening();
-        delayMicroseconds(128);
-        NRFradio.stopListening();
+size_t nrfSurveyFrame(uint8_t *buffer, size_t size) {
+    NRFSpectrumFrame frame;
+    if (size < NRF_SURVEY_FRAME_SIZE || !nrfSurveySnapshot(frame)) return 0;
+    memset(buffer, 0, NRF_SURVEY_FRAME_HEADER);
+    buffer[0] = 'S';
+    buffer[1] = 1;
+    buffer[2] = NRF_CHANNELS;
+    for (int i = 0; i < 4; i++) buffer[4 + i] = frame.sweeps >> (8 * i);
+    buffer[8] = frame.sweepRate;
+    buffer[9] = frame.sweepRate >> 8;
+    memcpy(buffer + NRF_SURVEY_FRAME_HEADER, frame.level, NRF_CHANNELS);
+    memcpy(buffer + NRF_SURVEY_FRAME_HEADER + NRF_CHANNELS, frame.peak, NRF_CHANNELS);
+    return NRF_SURVEY_FRAME_SIZE;
+}
 
-        int rpd = NRFradio.testRPD() ? 1 : 0;
-        channel[i] = (channel[i] * 3 + rpd * 125) / 4;
-        rpdValues[i] = channel[i];
-    }
+void nrfSurveyLock() {
+    if (surveyBus) xSemaphoreTake(surveyBus, portMAX_DELAY);
+}
 
-    digitalWrite(NRF24_CE_PIN, HIGH);
+void nrfSurveyUnlock() {
+    if (surveyBus) xSemaphoreGive(surveyBus);
+}
 
-    for (int i = 0; i < CHANNELS; i++) {
-        int level = rpdValues[i];
+/////////////////////////////////////////////////////////////////////////////////////
+// Screen
+/////////////////////////////////////////////////////////////////////////////////////
+#define _BW tftWidth / NRF_CHANNELS
+static void drawSpectrum(const NRFSpectrumFrame &frame) {
+    for (int i = 0; i < NRF_CHANNELS; i++) {
+        int level = frame.level[i];
         int x = i * _BW;
-        int c = i;
 
         tft.drawFastVLine(
             x, tftHeight - (10 + level), level, (i % 2 == 0) ? bruceConfig.priColor : TFT_DARKGREY
@@ -62,18 +158,11 @@ String scanChannels(SPIClass *SSPI, bool web) {
             x, 0, tftHeight - (9 + level), (i % 8) ? TFT_BLACK : RGB565(25, 25, 25)
         );                                                    /// for clearing
         tft.drawFastVLine(x, 0, level, bruceConfig.secColor); /// for top display
+        if (frame.peak[i] > level) tft.drawPixel(x, tftHeight - (10 + frame.peak[i]), TFT_WHITE);
         // show 5 channel gap only
-        if (c % 5 == 0 && c != 0) { tft.drawCentreString(String(c).c_str(), x, tftHeight / 2, 1); }
-
-        if (web) {
-            if (i > 0) result += ",";
-            result += String(level);
-        }
+        if (i % 5 == 0 && i != 0) { tft.drawCentreString(String(i).c_str(), x, tftHeight / 2, 1); }
     }
-
-    if (web) result += "}";
-    return result; // return a string in this format "{1,32,45,32,84,32 .... 12,54,65}" with 80 values to be
-                   // used in the WebUI (Future)
+    tft.drawRightString(String(frame.sweepRate) + " sweeps/s", tftWidth, 0, 1);
 }
 
 void nrf_spectrum(SPIClass *SSPI) {
@@ -98,9 +187,30 @@ void nrf_spectrum(SPIClass *SSPI) {
         for (uint8_t i = 0; i < 6; ++i) { NRFradio.openReadingPipe(i, noiseAddress[i]); }
         NRFradio.setDataRate(RF24_1MBPS);
 
-        while (!check(EscPress)) { scanChannels(SSPI); }
-        NRFradio.stopListening();
-        powerDown(*SSPI);
+        if (!nrfSurveyStart()) {
+            displayError("Not enough memory", true);
+            NRFradio.powerDown();
+            return;
+        }
+
+        // The display can't draw while the radio uses its bus
+        bool sharedBus = false;
+#if TFT_MOSI > 0
+        sharedBus = bruceConfigPins.NRF24_bus.mosi == (gpio_num_t)TFT_MOSI;
+#endif
+        NRFSpectrumFrame frame;
+        uint32_t drawn = 0;
+        while (!check(EscPress)) {
+            if (nrfSurveySnapshot(frame) && frame.sweeps != drawn) {
+                drawn = frame.sweeps;
+                if (sharedBus) nrfSurveyLock();
+                drawSpectrum(frame);
+                if (sharedBus) nrfSurveyUnlock();
+            }
+            vTaskDelay(pdMS_TO_TICKS(NRF_FRAME_MS));
+        }
+        nrfSurveyStop();
+        NRFradio.powerDown();
         delay(250);
         return;
 
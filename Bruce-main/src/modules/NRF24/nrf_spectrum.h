@@ -1,6 +1,45 @@
 #pragma once
 #include <RF24.h>
 
-void nrf_spectrum(SPIClass *SSPI);
+#define NRF_CHANNELS 80
+
+/**
+ * 2.4GHz channel survey.
+ *
+ * A task of its own sweeps the 80 channels back to back, reading the RPD
+ * (received power above -64dBm) of each one. Only the channel register is
+ * written between reads: the radio stays in RX with CE pulsed, instead of a
+ * full startListening()/stopListening() per channel. A sweep takes about
+ * 80 x 170us = 14ms, so it runs at ~65 sweeps/s whatever the screen does;
+ * before, sweeping and drawing alternated and each got in the way of the other.
+ *
+ * Levels (0-125) are smoothed with the last sweeps. Peaks are held for about
+ * a second, then fall back to the level. The screen and the web UI read a copy
+ * of the last finished sweep.
+ */
+struct NRFSpectrumFrame {
+    uint32_t sweeps;     // Since the survey started
+    uint16_t sweepRate;  // Sweeps in the last second
+    uint8_t level[NRF_CHANNELS];
+    uint8_t peak[NRF_CHANNELS];
+};
+
+// Binary frame for the web UI (little endian):
+// 'S', version 1, channel count, 0, uint32 sweeps, uint16 sweep rate, 0, 0,
+// then the levels and the peaks, one byte per channel
+#define NRF_SURVEY_FRAME_HEADER 12
+#define NRF_SURVEY_FRAME_SIZE (NRF_SURVEY_FRAME_HEADER + 2 * NRF_CHANNELS)
 
-String scanChannels(SPIClass *SSPI, bool web = false);
+// Starts sweeping with the radio already set up by nrf_start()
+bool nrfSurveyStart();
+void nrfSurveyStop();
+bool nrfSurveyRunning();
+// Copy of the last sweep, false if the survey isn't running
+bool nrfSurveySnapshot(NRFSpectrumFrame &frame);
+// Last sweep as a binary frame, 0 if the survey isn't running
+size_t nrfSurveyFrame(uint8_t *buffer, size_t size);
+// Held by the survey during each sweep; hold it to use a bus the radio shares
+void nrfSurveyLock();
+void nrfSurveyUnlock();
+
+void nrf_spectrum(SPIClass *SSPI);
@@ -11,6 +11,7 @@
 #include "display_js.h"
 #include "gui_js.h"
 #include "helpers_js.h"
+#include "js_cache.h"
 #include "wifi_js.h"
 
 // #define DUK_USE_DEBUG
@@ -23,6 +24,9 @@
 static char *script = NULL;
 static char *scriptDirpath = NULL;
 static char *scriptName = NULL;
+// Where script was read from, for the compiled code cache
+static FS scriptFs(nullptr);
+static String scriptPath = "";
 
 static duk_ret_t native_noop(duk_context *ctx) { return 0; }
 
@@ -33,6 +37,7 @@ static duk_ret_t native_load(duk_context *ctx) {
     script = strdup(duk_to_string(ctx, 0));
     scriptDirpath = NULL;
     scriptName = NULL;
+    scriptPath = "";
     return 0;
 }
 
@@ -1085,22 +1090,58 @@ static duk_ret_t native_require(duk_context *ctx) {
         else if (LittleFS.exists(filepath)) fs = &LittleFS;
         if (fs == NULL) { return 1; }
 
-        const char *requiredScript = readBigFile(*fs, filepath);
-        if (requiredScript == NULL) { return 1; }
-
-        duk_push_string(ctx, "(function(){exports={};module={exports:exports};\n");
-        duk_push_string(ctx, requiredScript);
-        duk_push_string(ctx, "\n})");
-        duk_concat(ctx, 3);
+        // Each file is loaded once per script, later requires get the same exports
+        String key = jsCacheKey(*fs, filepath);
+        duk_push_global_stash(ctx);
+        if (!duk_get_prop_string(ctx, -1, "modules")) {
+            duk_pop(ctx);
+            duk_push_object(ctx);
+            duk_dup_top(ctx);
+            duk_put_prop_string(ctx, -3, "modules");
+        }
+        duk_idx_t modules_idx = duk_get_top_index(ctx);
+        if (duk_get_prop_string(ctx, modules_idx, key.c_str())) { return 1; }
+        duk_pop(ctx);
 
-        duk_int_t pcall_rc = duk_pcompile(ctx, DUK_COMPILE_EVAL);
-        if (pcall_rc != DUK_EXEC_SUCCESS) { return 1; }
+        JsLoadStats stats;
+        if (jsLoadModule(ctx, *fs, filepath, stats) != DUK_EXEC_SUCCESS) {
+            Serial.printf("require %s failed: %s\n", filepath.c_str(), duk_safe_to_string(ctx, -1));
+            duk_set_top(ctx, obj_idx + 1);
+            return 1;
+        }
 
-        pcall_rc = duk_pcall(ctx, 1);
-        if (pcall_rc == DUK_EXEC_SUCCESS) {
-            duk_get_prop_string(ctx, -1, "exports");
-            duk_compact(ctx, -1);
+        // [ ... exports stash modules fn ]: a circular require gets the exports so far
+        duk_idx_t fn_idx = duk_get_top_index(ctx);
+        duk_dup(ctx, obj_idx);
+        duk_put_prop_string(ctx, modules_idx, key.c_str());
+        duk_idx_t module_idx = duk_push_object(ctx);
+        duk_dup(ctx, obj_idx);
+        duk_put_prop_string(ctx, module_idx, "exports");
+
+        unsigned long start = millis();
+        duk_dup(ctx, fn_idx);
+        duk_dup(ctx, obj_idx);
+        duk_dup(ctx, module_idx);
+        if (duk_pcall(ctx, 2) != DUK_EXEC_SUCCESS) {
+            Serial.printf("require %s failed: %s\n", filepath.c_str(), duk_safe_to_string(ctx, -1));
+            duk_del_prop_string(ctx, modules_idx, key.c_str());
+            duk_set_top(ctx, obj_idx + 1);
+            return 1;
         }
+        duk_pop(ctx);
+        log_d(
+            "require %s: %s %lums, build %lums, run %lums",
+            filepath.c_str(),
+            stats.cached ? "cache" : "read",
+            stats.readMs,
+            stats.buildMs,
+            millis() - start
+        );
+
+        duk_get_prop_string(ctx, module_idx, "exports");
+        duk_compact(ctx, -1);
+        duk_dup_top(ctx);
+        duk_put_prop_string(ctx, modules_idx, key.c_str());
     }
 
     return 1;
@@ -1161,7 +1202,7 @@ static void js_fatal_error_handler(void *udata, const char *msg) {
     Serial.flush();
 
     delay(500);
-    while (!check(AnyKeyPress)) vTaskDelay(50 / portTICK_PERIOD_MS);
+    waitAnyKeyPress();
     // We need to restart esp32 after fatal error
     abort();
 }
@@ -1194,9 +1235,12 @@ void interpreterHandler(void *pvParameters) {
 
     /// TODO: Add DUK_USE_NATIVE_STACK_CHECK check with
     /// uxTaskGetStackHighWaterMark
+    unsigned long start = millis();
     duk_context *ctx =
         duk_create_heap(alloc_function, realloc_function, free_function, NULL, js_fatal_error_handler);
 
+    unsigned long heapMs = millis() - start;
+
     // Init containers
     clearDisplayModuleData();
 
@@ -1352,6 +1396,7 @@ void interpreterHandler(void *pvParameters) {
     bduk_register_c_lightfunc(ctx, "storageWrite", native_storageWrite, 4);
     bduk_register_c_lightfunc(ctx, "storageRename", native_storageRename, 2);
     bduk_register_c_lightfunc(ctx, "storageRemove", native_storageRemove, 1);
+    unsigned long globalsMs = millis() - start - heapMs;
 
     log_d(
         "global populated:\nPSRAM: [Free: %d, max alloc: %d],\nRAM: [Free: %d, "
@@ -1369,7 +1414,18 @@ void interpreterHandler(void *pvParameters) {
 
     Serial.printf("Script length: %d\n", strlen(script));
 
-    if (duk_peval_string(ctx, script) != DUK_EXEC_SUCCESS) {
+    JsLoadStats stats;
+    duk_int_t rc = jsLoadScript(ctx, scriptPath.length() ? &scriptFs : NULL, scriptPath, script, stats);
+    log_d(
+        "startup: heap %lums, globals %lums, %s %lums",
+        heapMs,
+        globalsMs,
+        stats.cached ? "cache" : "compile",
+        stats.buildMs
+    );
+    if (rc == DUK_EXEC_SUCCESS) rc = duk_pcall(ctx, 0);
+
+    if (rc != DUK_EXEC_SUCCESS) {
         tft.fillScreen(bruceConfig.bgColor);
         tft.setTextSize(FM);
         tft.setTextColor(TFT_RED, bruceConfig.bgColor);
@@ -1429,6 +1485,7 @@ void interpreterHandler(void *pvParameters) {
     scriptDirpath = NULL;
     free((char *)scriptName);
     scriptName = NULL;
+    scriptPath = "";
     duk_pop(ctx);
 
     // Clean up.
@@ -1458,6 +1515,8 @@ void run_bjs_script() {
     filename = loopSD(*fs, true, "BJS|JS");
     script = readBigFile(*fs, filename);
     if (script == NULL) { return; }
+    scriptFs = *fs;
+    scriptPath = filename;
 
     returnToMenu = true;
     interpreter_start = true;
@@ -1470,6 +1529,7 @@ bool run_bjs_script_headless(char *code) {
     if (script == NULL) { return false; }
     scriptDirpath = NULL;
     scriptName = NULL;
+    scriptPath = "";
     returnToMenu = true;
     interpreter_start = true;
     return true;
@@ -1478,6 +1538,8 @@ bool run_bjs_script_headless(char *code) {
 bool run_bjs_script_headless(FS fs, String filename) {
     script = readBigFile(fs, filename);
     if (script == NULL) { return false; }
+    scriptFs = fs;
+    scriptPath = filename;
     const char *sName = filename.substring(0, filename.lastIndexOf('/')).c_str();
     const char *sDirpath = filename.substring(filename.lastIndexOf('/') + 1).c_str();
     scriptDirpath = strdup(sDirpath);
@@ -0,0 +1,187 @@
+#include "js_cache.h"
+#include "core/sd_functions.h"
+#include <globals.h>
+
+#define JS_CACHE_FOLDER "/.jscache"
+#define JS_CACHE_MAGIC 0x3143534A // "JSC1"
+
+struct JsCacheHeader {
+    uint32_t magic;
+    uint32_t version; // DUK_VERSION, bytecode isn't portable across versions
+    uint32_t size;    // Of the source
+    uint32_t mtime;   // Of the source
+    uint32_t codeSize;
+    uint32_t codeHash;
+    uint16_t keyLength; // The key follows the header, then the bytecode
+    uint16_t reserved;
+};
+
+struct JsSource {
+    String key;
+    uint32_t size = 0;
+    uint32_t mtime = 0;
+};
+
+static uint32_t fnv1a(uint32_t hash, const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; i++) hash = (hash ^ data[i]) * 16777619u;
+    return hash;
+}
+
+String jsCacheKey(FS &fs, const String &path) {
+    // A copy of SD or LittleFS can't be told apart, size and mtime still have to match
+    if (&fs == &SD) return "SD:" + path;
+    if (&fs == &LittleFS) return "LittleFS:" + path;
+    return ":" + path;
+}
+
+static bool statSource(FS &fs, const String &path, JsSource &source) {
+    File file = fs.open(path, FILE_READ);
+    if (!file) return false;
+    source.key = jsCacheKey(fs, path);
+    source.size = file.size();
+    source.mtime = file.getLastWrite();
+    file.close();
+    // Without a modification time an edited file could pass for the cached one
+    return source.mtime != 0;
+}
+
+static String cachePath(const JsSource &source) {
+    char name[sizeof(JS_CACHE_FOLDER) + 16];
+    uint32_t hash = fnv1a(2166136261u, (const uint8_t *)source.key.c_str(), source.key.length());
+    snprintf(name, sizeof(name), JS_CACHE_FOLDER "/%08lx.jsc", (unsigned long)hash);
+    return String(name);
+}
+
+#if defined(DUK_USE_BYTECODE_DUMP_SUPPORT)
+// Pushes the cached function, false (and nothing pushed) if there's no valid one
+static bool loadCached(duk_context *ctx, const JsSource &source) {
+    if (!sdcardMounted) return false;
+    File file = SD.open(cachePath(source), FILE_READ);
+    if (!file) return false;
+
+    JsCacheHeader h;
+    bool ok = file.read((uint8_t *)&h, sizeof(h)) == sizeof(h) && h.magic == JS_CACHE_MAGIC &&
+              h.version == DUK_VERSION && h.size == source.size && h.mtime == source.mtime &&
+              h.keyLength == source.key.length() && sizeof(h) + h.keyLength + h.codeSize <= file.size();
+    if (ok) {
+        // Another file with the same key hash
+        char key[h.keyLength + 1];
+        ok = file.read((uint8_t *)key, h.keyLength) == h.keyLength &&
+             memcmp(key, source.key.c_str(), h.keyLength) == 0;
+    }
+    if (!ok) {
+        file.close();
+        return false;
+    }
+
+    uint8_t *code = (uint8_t *)duk_push_fixed_buffer(ctx, h.codeSize);
+    ok = file.read(code, h.codeSize) == h.codeSize && fnv1a(2166136261u, code, h.codeSize) == h.codeHash;
+    file.close();
+    if (!ok) {
+        duk_pop(ctx);
+        return false;
+    }
+    duk_load_function(ctx);
+    return true;
+}
+
+// Dumps the function on the top of the stack, leaving it there
+static void saveCached(duk_context *ctx, const JsSource &source) {
+    // Only a cache, it doesn't matter if this fails (no card, read only or full)
+    if (!sdcardMounted) return;
+    if (!SD.exists(JS_CACHE_FOLDER) && !SD.mkdir(JS_CACHE_FOLDER)) return;
+
+    duk_dup_top(ctx);
+    duk_dump_function(ctx);
+    duk_size_t codeSize = 0;
+    const uint8_t *code = (const uint8_t *)duk_get_buffer(ctx, -1, &codeSize);
+
+    JsCacheHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = JS_CACHE_MAGIC;
+    h.version = DUK_VERSION;
+    h.size = source.size;
+    h.mtime = source.mtime;
+    h.codeSize = codeSize;
+    h.codeHash = fnv1a(2166136261u, code, codeSize);
+    h.keyLength = source.key.length();
+
+    String path = cachePath(source);
+    File file = SD.open(path, FILE_WRITE);
+    if (file) {
+        bool ok = file.write((const uint8_t *)&h, sizeof(h)) == sizeof(h) &&
+                  file.write((const uint8_t *)source.key.c_str(), h.keyLength) == h.keyLength &&
+                  file.write(code, codeSize) == codeSize;
+        file.close();
+        if (!ok) SD.remove(path);
+    }
+    duk_pop(ctx);
+}
+#else
+static bool loadCached(duk_context *ctx, const JsSource &source) { return false; }
+static void saveCached(duk_context *ctx, const JsSource &source) {}
+#endif
+
+duk_int_t jsLoadScript(duk_context *ctx, FS *fs, const String &path, const char *source, JsLoadStats &stats) {
+    JsSource info;
+    bool cacheable = fs && path.length() > 0 && statSource(*fs, path, info);
+
+    unsigned long start = millis();
+    if (cacheable && loadCached(ctx, info)) {
+        stats.cached = true;
+        stats.buildMs = millis() - start;
+        return DUK_EXEC_SUCCESS;
+    }
+
+    start = millis();
+    duk_push_string(ctx, source);
+    // Compiled as duk_peval_string() did, the error line parsing counts on the "eval" name
+    duk_push_string(ctx, "eval");
+    duk_int_t rc = duk_pcompile(ctx, DUK_COMPILE_EVAL);
+    stats.buildMs = millis() - start;
+    if (rc == DUK_EXEC_SUCCESS && cacheable) saveCached(ctx, info);
+    return rc;
+}
+
+// Compiles the module source into its function(exports, module)
+static duk_int_t safeCompileModule(duk_context *ctx, void *udata) {
+    // [ source filename ]
+    duk_push_string(ctx, "(function(exports,module){");
+    duk_dup(ctx, -3);
+    duk_push_string(ctx, "\n})");
+    duk_concat(ctx, 3);
+    duk_dup(ctx, -2);
+    duk_compile(ctx, DUK_COMPILE_EVAL);
+    // Running the eval code gives the function
+    duk_call(ctx, 0);
+    return 1;
+}
+
+duk_int_t jsLoadModule(duk_context *ctx, FS &fs, const String &path, JsLoadStats &stats) {
+    JsSource info;
+    bool cacheable = statSource(fs, path, info);
+
+    unsigned long start = millis();
+    if (cacheable && loadCached(ctx, info)) {
+        stats.cached = true;
+        stats.readMs = millis() - start;
+        return DUK_EXEC_SUCCESS;
+    }
+
+    start = millis();
+    char *source = readBigFile(fs, path);
+    stats.readMs = millis() - start;
+    if (source == NULL) {
+        duk_push_error_object(ctx, DUK_ERR_ERROR, "can't read %s", path.c_str());
+        return DUK_EXEC_ERROR;
+    }
+
+    start = millis();
+    duk_push_string(ctx, source);
+    free(source);
+    duk_push_string(ctx, path.c_str());
+    duk_int_t rc = duk_safe_call(ctx, safeCompileModule, NULL, 2, 1);
+    stats.buildMs = millis() - start;
+    if (rc == DUK_EXEC_SUCCESS && cacheable) saveCached(ctx, info);
+    return rc;
+}
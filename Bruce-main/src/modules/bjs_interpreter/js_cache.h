@@ -0,0 +1,35 @@
+#ifndef __JS_CACHE_H__
+#define __JS_CACHE_H__
+#include <FS.h>
+#include <duktape.h>
+
+/**
+ * Compiled function cache for scripts and required modules.
+ *
+ * Compiling a big script (a TypeScript bundle) takes seconds, loading its
+ * bytecode takes a fraction of that. The first run dumps the compiled function
+ * to /.jscache on the SD card; later runs load it back while the source file
+ * keeps the same path, size and mtime. A cache file is checked against a hash
+ * of its bytecode before Duktape sees it, since loading broken bytecode isn't
+ * safe. Firmwares whose Duktape was built without bytecode dump support just
+ * compile every time.
+ */
+struct JsLoadStats {
+    bool cached = false;       // Loaded from the cache
+    unsigned long readMs = 0;  // Reading the source or the cache file
+    unsigned long buildMs = 0; // Compiling, or loading the bytecode
+};
+
+// Leaves the compiled script on the stack, to be called without arguments.
+// fs and path locate the source for the cache, fs can be NULL (no cache).
+// On failure the error is left on the stack instead.
+duk_int_t jsLoadScript(duk_context *ctx, FS *fs, const String &path, const char *source, JsLoadStats &stats);
+
+// Leaves the module on the stack, a function(exports, module) to be called
+// once. The source is only read when the cache can't be used.
+duk_int_t jsLoadModule(duk_context *ctx, FS &fs, const String &path, JsLoadStats &stats);
+
+// Identifies a source file across file systems
+String jsCacheKey(FS &fs, const String &path);
+
+#endif
@@ -1,5 +1,7 @@
 #include "ble_common.h"
+#include "ble_device_table.h"
 #include "core/mykeyboard.h"
+#include "core/net_utils.h"
 #include "core/utils.h"
 
 #define SERVICE_UUID "1bc68b2a-f3e3-11e9-81b4-2a2ae2dbcce4"
@@ -10,6 +12,7 @@
 #define SCANTYPE ACTIVE
 #define SCAN_INT 100
 #define SCAN_WINDOW 99
+#define SCAN_PAGE 30 // Devices in one menu, the others wait in the table
 
 #define ENDIAN_CHANGE_U16(x) ((((x) & 0xFF00) >> 8) + (((x) & 0xFF) << 8))
 
@@ -57,34 +60,47 @@ void ble_info(String name, String address, String signal) {
     }
 }
 
+static BleScanQueue scanQueue;
+static BleDeviceTable scanDevices;
+
+// Name in an advertisement payload, without going through a std::string
+static uint8_t advertisedName(const uint8_t *payload, size_t length, char *name) {
+    uint8_t found = 0;
+    for (size_t i = 0; i + 1 < length;) {
+        uint8_t size = payload[i];
+        if (size == 0 || i + 1 + size > length) break;
+        uint8_t type = payload[i + 1];
+        if (type == BLE_HS_ADV_TYPE_COMP_NAME || (type == BLE_HS_ADV_TYPE_INCOMP_NAME && !found)) {
+            found = size - 1 > BLE_NAME_MAX ? BLE_NAME_MAX : size - 1;
+            memcpy(name, payload + i + 2, found);
+            if (type == BLE_HS_ADV_TYPE_COMP_NAME) break;
+        }
+        i += 1 + size;
+    }
+    return found;
+}
+
 class AdvertisedDeviceCallbacks : public NimBLEAdvertisedDeviceCallbacks {
+    // Runs on the NimBLE host task: copies what the device table needs, the UI task does the rest
     void onResult(NimBLEAdvertisedDevice *advertisedDevice) {
-        String bt_title;
-        String bt_name;
-        String bt_address;
-        String bt_signal;
-
-        bt_name = advertisedDevice->getName().c_str();
-        bt_title = advertisedDevice->getName().c_str();
-        bt_address = advertisedDevice->getAddress().toString().c_str();
-        bt_signal = String(advertisedDevice->getRSSI());
-        // Serial.println("\n\nAddress - " + bt_address + "Name-"+ bt_name +"\n\n");
-        if (bt_title.isEmpty()) bt_title = bt_address;
-        if (bt_name.isEmpty()) bt_name = "<no name>";
-        // If BT name is empty, set NONAME
-        if (options.size() < 250)
-            options.emplace_back(bt_title.c_str(), [=]() { ble_info(bt_name, bt_address, bt_signal); });
-        else {
-            Serial.println("Memory low, stopping BLE scan...");
-            pBLEScan->stop();
-        }
+        BleScanRecord record;
+        NimBLEAddress address = advertisedDevice->getAddress();
+        const uint8_t *native = address.getNative(); // Least significant byte first
+        for (int i = 0; i < 6; i++) record.address[i] = native[5 - i];
+        record.addressType = address.getType();
+        record.rssi = advertisedDevice->getRSSI();
+        record.nameLength = advertisedName(
+            advertisedDevice->getPayload(), advertisedDevice->getPayloadLength(), record.name
+        );
+        scanQueue.push(record);
     }
 };
+static AdvertisedDeviceCallbacks scanCallbacks;
 
 void ble_scan_setup() {
     BLEDevice::init("");
     pBLEScan = BLEDevice::getScan();
-    pBLEScan->setAdvertisedDeviceCallbacks(new AdvertisedDeviceCallbacks());
+    pBLEScan->setAdvertisedDeviceCallbacks(&scanCallbacks);
     // Active scan uses more power, but get results faster
     pBLEScan->setActiveScan(true);
     pBLEScan->setInterval(SCAN_INT);
@@ -106,20 +122,137 @@ void ble_scan_setup() {
     vTaskDelay(100 / portTICK_PERIOD_MS);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////
+// Scan
+/////////////////////////////////////////////////////////////////////////////////////
+static void drainScanQueue() {
+    BleScanRecord record;
+    uint32_t now = millis();
+    while (scanQueue.pop(record)) scanDevices.update(record, now);
+}
+
+static void collectScan(uint32_t ms) {
+    uint32_t start = millis();
+    uint32_t shown = 0;
+    while (millis() - start < ms) {
+        drainScanQueue();
+        if (millis() - shown > 500) {
+            displayTextLine("Scanning.. " + String(scanDevices.size()) + " devices");
+            shown = millis();
+        }
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+}
+
+static String deviceAddress(const BleDevice &device) {
+    uint8_t address[6];
+    char text[18];
+    device.address(address);
+    snprintf(
+        text,
+        sizeof(text),
+        "%02x:%02x:%02x:%02x:%02x:%02x",
+        address[0],
+        address[1],
+        address[2],
+        address[3],
+        address[4],
+        address[5]
+    );
+    return text;
+}
+
+static void deviceInfo(uint64_t key) {
+    drainScanQueue();
+    int index = scanDevices.find(key);
+    if (index < 0) {
+        displayError("Device not seen for too long", true);
+        return;
+    }
+    const BleDevice &device = scanDevices.at(index);
+    String name = scanDevices.name(device);
+    if (name.isEmpty()) name = "<no name>";
+    ble_info(name, deviceAddress(device), String(device.rssi));
+}
+
 void ble_scan() {
     displayTextLine("Scanning..");
+    if (!scanDevices.begin()) {
+        displayError("Not enough memory", true);
+        return;
+    }
+    scanQueue.reset();
 
     options = {};
     ble_scan_setup();
-    BLEScanResults foundDevices = pBLEScan->start(scanTime, false);
-
-    addOptionToMainMenu();
-
-    loopOptions(options);
+    // Results only go through the callback, NimBLE keeps none of them,
+    // and every advertisement comes so RSSI stays current
+    pBLEScan->setMaxResults(0);
+    pBLEScan->setDuplicateFilter(false);
+    pBLEScan->start(0, nullptr, false); // Until stopped
+    collectScan(scanTime * 1000);
+
+    // Options are only made for the devices of the page shown
+    enum { NONE, PREV, NEXT, MORE } action;
+    int page = 0;
+    int index = 0;
+    while (!returnToMenu) {
+        drainScanQueue();
+        int size = scanDevices.size();
+        int first = page * SCAN_PAGE;
+        int last = first + SCAN_PAGE < size ? first + SCAN_PAGE : size;
+
+        // Vendors of the page, for the devices with a public address
+        std::vector<uint8_t> macs((last - first) * 6);
+        for (int i = first; i < last; i++) scanDevices.at(i).address(&macs[(i - first) * 6]);
+        std::vector<String> vendors;
+        getManufacturers(macs.data(), last - first, vendors);
+
+        action = NONE;
+        options = {};
+        for (int i = first; i < last; i++) {
+            const BleDevice &device = scanDevices.at(i);
+            String title = scanDevices.name(device);
+            if (title.isEmpty()) title = deviceAddress(device);
+            if (device.addressType() == BLE_ADDR_PUBLIC && !vendors[i - first].isEmpty()) {
+                title += " " + vendors[i - first];
+            }
+            uint64_t key = device.key;
+            options.emplace_back(title, [key]() { deviceInfo(key); });
+        }
+        if (page > 0) options.emplace_back("Previous page", [&action]() { action = PREV; });
+        if (last < size) {
+            String label = "Next page (" + String(last + 1) + "-" + String(size) + ")";
+            options.emplace_back(label, [&action]() { action = NEXT; });
+        }
+        options.emplace_back("Scan more", [&action]() { action = MORE; });
+        addOptionToMainMenu();
+
+        index = loopOptions(options, index);
+        if (index < 0) break;
+        if (action == PREV) page--;
+        if (action == NEXT) page++;
+        if (action == MORE) collectScan(scanTime * 1000);
+        if (action != NONE) index = 0;
+    }
     options.clear();
 
+    pBLEScan->stop();
+    drainScanQueue();
+    log_d(
+        "BLE scan: %u devices, %lu evicted, %lu advertisements dropped",
+        scanDevices.size(),
+        (unsigned long)scanDevices.evicted(),
+        (unsigned long)scanQueue.dropped()
+    );
+    scanDevices.end();
     // Delete results fromBLEScan buffer to release memory
     pBLEScan->clearResults();
+    // The scan object is shared: back to NimBLE's defaults for the next user (Ninebot reads its
+    // results), and no more pushes to scanQueue
+    pBLEScan->setAdvertisedDeviceCallbacks(nullptr);
+    pBLEScan->setMaxResults(0xFF);
+    pBLEScan->setDuplicateFilter(true);
 }
 
 bool initBLEServer() {
@@ -0,0 +1,190 @@
+#include "ble_device_table.h"
+#include <Arduino.h>
+
+#define BLE_TABLE_DEVICES 256
+#define BLE_TABLE_DEVICES_PSRAM 2048
+#define BLE_TABLE_NAME_BYTES 12 // Pool per device, most devices don't advertise a name
+
+static void *allocTable(size_t size) { return psramFound() ? ps_malloc(size) : malloc(size); }
+
+// Addresses of one vendor share the high bytes, so mix all of them into the low bits
+static uint32_t hashKey(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (uint32_t)key;
+}
+
+// FNV-1a
+static uint32_t hashName(const char *name, uint8_t length) {
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < length; i++) hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+    return hash;
+}
+
+static uint32_t slotCount(uint32_t entries) {
+    uint32_t count = 1;
+    while (count < entries * 2) count <<= 1; // At most half full
+    return count;
+}
+
+bool BleDeviceTable::begin(uint16_t capacity) {
+    end();
+    if (capacity == 0) capacity = psramFound() ? BLE_TABLE_DEVICES_PSRAM : BLE_TABLE_DEVICES;
+    if (capacity > EMPTY - 1) capacity = EMPTY - 1;
+
+    uint32_t slots = slotCount(capacity);
+    uint32_t namesSize = capacity * BLE_TABLE_NAME_BYTES;
+    if (namesSize > BLE_NO_NAME) namesSize = BLE_NO_NAME;
+    uint32_t nameSlots = slotCount(namesSize / 8);
+
+    _devices = (BleDevice *)allocTable(capacity * sizeof(BleDevice));
+    _slots = (uint16_t *)allocTable(slots * sizeof(uint16_t));
+    _names = (char *)allocTable(namesSize);
+    _nameSlots = (uint16_t *)allocTable(nameSlots * sizeof(uint16_t));
+    if (!_devices || !_slots || !_names || !_nameSlots) {
+        end();
+        return false;
+    }
+    _capacity = capacity;
+    _slotMask = slots - 1;
+    _namesSize = namesSize;
+    _nameSlotMask = nameSlots - 1;
+    clear();
+    return true;
+}
+
+void BleDeviceTable::end() {
+    free(_devices);
+    free(_slots);
+    free(_names);
+    free(_nameSlots);
+    _devices = nullptr;
+    _slots = _nameSlots = nullptr;
+    _names = nullptr;
+    _capacity = _size = _namesSize = _namesUsed = _nameCount = 0;
+    _slotMask = _nameSlotMask = 0;
+    _evicted = _evictedAtCompact = 0;
+}
+
+void BleDeviceTable::clear() {
+    if (!_devices) return;
+    memset(_slots, 0xFF, (_slotMask + 1) * sizeof(uint16_t));
+    memset(_nameSlots, 0xFF, (_nameSlotMask + 1) * sizeof(uint16_t));
+    _size = _namesUsed = _nameCount = 0;
+    _evicted = _evictedAtCompact = 0;
+}
+
+uint64_t BleDeviceTable::key(const uint8_t address[6], uint8_t addressType) {
+    uint64_t key = addressType;
+    for (int i = 0; i < 6; i++) key = (key << 8) | address[i];
+    return key;
+}
+
+uint32_t BleDeviceTable::slotOf(uint64_t key) const {
+    uint32_t i = hashKey(key) & _slotMask;
+    while (_slots[i] != EMPTY && _devices[_slots[i]].key != key) i = (i + 1) & _slotMask;
+    return i;
+}
+
+int BleDeviceTable::find(uint64_t key) const {
+    if (!_devices) return -1;
+    uint16_t index = _slots[slotOf(key)];
+    return index == EMPTY ? -1 : index;
+}
+
+// Linear probing delete: moves back the entries that probed past the slot
+void BleDeviceTable::removeSlot(uint32_t slot) {
+    uint32_t hole = slot;
+    uint32_t i = slot;
+    while (true) {
+        i = (i + 1) & _slotMask;
+        if (_slots[i] == EMPTY) break;
+        uint32_t home = hashKey(_devices[_slots[i]].key) & _slotMask;
+        // Stays if its home is cyclically in (hole, i]
+        if (((i - home) & _slotMask) < ((i - hole) & _slotMask)) continue;
+        _slots[hole] = _slots[i];
+        hole = i;
+    }
+    _slots[hole] = EMPTY;
+}
+
+uint16_t BleDeviceTable::intern(const char *name, uint8_t length) {
+    if (length == 0) return BLE_NO_NAME;
+    uint32_t i = hashName(name, length) & _nameSlotMask;
+    for (; _nameSlots[i] != EMPTY; i = (i + 1) & _nameSlotMask) {
+        const char *interned = _names + _nameSlots[i];
+        if (strncmp(interned, name, length) == 0 && interned[length] == 0) return _nameSlots[i];
+    }
+
+    bool full = _namesUsed + length + 1 > _namesSize || (_nameCount + 1) * 2 > _nameSlotMask + 1;
+    if (full && _evicted != _evictedAtCompact) {
+        compactNames();
+        return intern(name, length);
+    }
+    // Every name in the pool is still used: new ones go unnamed until clear()
+    if (full) return BLE_NO_NAME;
+
+    uint16_t offset = _namesUsed;
+    memcpy(_names + offset, name, length);
+    _names[offset + length] = 0;
+    _namesUsed += length + 1;
+    _nameCount++;
+    _nameSlots[i] = offset;
+    return offset;
+}
+
+// Interns the names of the devices in the table again, in a new pool
+void BleDeviceTable::compactNames() {
+    _evictedAtCompact = _evicted;
+    char *old = _names;
+    _names = (char *)allocTable(_namesSize);
+    if (!_names) {
+        _names = old;
+        return;
+    }
+    memset(_nameSlots, 0xFF, (_nameSlotMask + 1) * sizeof(uint16_t));
+    _namesUsed = _nameCount = 0;
+    for (uint16_t i = 0; i < _size; i++) {
+        BleDevice &device = _devices[i];
+        if (device.name == BLE_NO_NAME) continue;
+        const char *name = old + device.name;
+        device.name = intern(name, strlen(name));
+    }
+    free(old);
+}
+
+void BleDeviceTable::update(const BleScanRecord &record, uint32_t now) {
+    if (!_devices) return;
+    uint64_t k = key(record.address, record.addressType);
+    uint32_t slot = slotOf(k);
+    uint16_t index = _slots[slot];
+
+    if (index == EMPTY) {
+        if (_size < _capacity) {
+            index = _size++;
+        } else {
+            // Full, the one gone quiet the longest makes room
+            index = 0;
+            for (uint16_t i = 1; i < _size; i++) {
+                if ((int32_t)(_devices[i].lastSeen - _devices[index].lastSeen) < 0) index = i;
+            }
+            removeSlot(slotOf(_devices[index].key));
+            slot = slotOf(k);
+            _evicted++;
+        }
+        BleDevice &device = _devices[index];
+        device.key = k;
+        device.firstSeen = now;
+        device.name = BLE_NO_NAME;
+        device.adverts = 0;
+        _slots[slot] = index;
+    }
+
+    BleDevice &device = _devices[index];
+    device.lastSeen = now;
+    device.rssi = record.rssi;
+    if (device.adverts < UINT16_MAX) device.adverts++;
+    // The name can come with the scan response only
+    if (device.name == BLE_NO_NAME) device.name = intern(record.name, record.nameLength);
+}
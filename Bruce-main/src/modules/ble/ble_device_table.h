@@ -0,0 +1,146 @@
+#ifndef __BLE_DEVICE_TABLE_H__
+#define __BLE_DEVICE_TABLE_H__
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BLE_NAME_MAX 30 // A name fits in one 31 byte advertisement
+#define BLE_NO_NAME 0xFFFF
+
+/*
+ * What the scan callback hands over: one fixed size record per advertisement.
+ * Lock-free single producer / single consumer ring, like PcapRing. The
+ * producer is the NimBLE host task, it only copies the record in or counts a
+ * drop when the UI hasn't caught up. The consumer is the UI task.
+ */
+struct BleScanRecord {
+    uint8_t address[6]; // As printed, most significant byte first
+    uint8_t addressType;
+    int8_t rssi;
+    uint8_t nameLength; // 0 when the advertisement carries no name
+    char name[BLE_NAME_MAX];
+};
+
+class BleScanQueue {
+public:
+    static const uint32_t CAPACITY = 64; // Power of two
+
+    // Producer side, never blocks
+    bool push(const BleScanRecord &record) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == CAPACITY) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _records[head & (CAPACITY - 1)] = record;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, false when it's empty
+    bool pop(BleScanRecord &record) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return false;
+        record = _records[tail & (CAPACITY - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Only while the producer is stopped
+    void reset() {
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+        _dropped.store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    BleScanRecord _records[CAPACITY];
+    std::atomic<uint32_t> _head{0}; // Only written by the producer
+    std::atomic<uint32_t> _tail{0}; // Only written by the consumer
+    std::atomic<uint32_t> _dropped{0};
+};
+
+/*
+ * Devices seen by a scan, one entry per address, updated in place.
+ *
+ * The entries are a fixed array; an open addressing index finds the entry of
+ * an address, so a device advertising again only updates its RSSI and last
+ * seen time. Names are interned in a fixed pool, devices with the same name
+ * share it. When the table is full the device not seen for the longest time
+ * makes room, so a continuous scan in a busy place uses the same memory as a
+ * short one; the name pool drops the names of evicted devices when it fills.
+ * Everything is allocated by begin(), in PSRAM when there is some.
+ * Only used by one task.
+ */
+struct BleDevice {
+    uint64_t key;       // Address and address type, see BleDeviceTable::key()
+    uint32_t firstSeen; // millis()
+    uint32_t lastSeen;
+    uint16_t name; // Offset in the name pool, BLE_NO_NAME
+    uint16_t adverts;
+    int8_t rssi;
+
+    void address(uint8_t out[6]) const {
+        for (int i = 0; i < 6; i++) out[i] = key >> (40 - 8 * i);
+    }
+    uint8_t addressType() const { return key >> 48; }
+};
+
+class BleDeviceTable {
+public:
+    BleDeviceTable() {}
+    ~BleDeviceTable() { end(); }
+    BleDeviceTable(const BleDeviceTable &) = delete;
+    BleDeviceTable &operator=(const BleDeviceTable &) = delete;
+
+    // capacity 0 picks one from the memory there is
+    bool begin(uint16_t capacity = 0);
+    void end();
+    void clear();
+
+    static uint64_t key(const uint8_t address[6], uint8_t addressType);
+
+    // Adds or updates the device of the record
+    void update(const BleScanRecord &record, uint32_t now);
+
+    uint16_t size() const { return _size; }
+    uint16_t capacity() const { return _capacity; }
+    uint32_t evicted() const { return _evicted; }
+    // Devices are kept in [0, size()), an index stays the same device until it gets evicted
+    const BleDevice &at(uint16_t index) const { return _devices[index]; }
+    // The entry of key, -1 if it isn't there
+    int find(uint64_t key) const;
+    // "" if the device has no name
+    const char *name(const BleDevice &device) const {
+        return device.name == BLE_NO_NAME ? "" : _names + device.name;
+    }
+
+private:
+    static const uint16_t EMPTY = 0xFFFF;
+
+    uint32_t slotOf(uint64_t key) const;
+    void removeSlot(uint32_t slot);
+    uint16_t intern(const char *name, uint8_t length);
+    void compactNames();
+
+    BleDevice *_devices = nullptr;
+    uint16_t *_slots = nullptr; // Index of the device, EMPTY
+    uint32_t _slotMask = 0;
+    uint16_t _capacity = 0;
+    uint16_t _size = 0;
+    uint32_t _evicted = 0;
+
+    char *_names = nullptr; // Null terminated names, back to back
+    uint16_t *_nameSlots = nullptr;
+    uint32_t _nameSlotMask = 0;
+    uint16_t _namesSize = 0;
+    uint16_t _namesUsed = 0;
+    uint16_t _nameCount = 0;
+    uint32_t _evictedAtCompact = 0;
+};
+
+#endif
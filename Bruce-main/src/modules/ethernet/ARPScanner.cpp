@@ -61,12 +61,22 @@ void toBytes(IPAddress ip, uint8_t *bytes) {
 }
 
 void ARPScanner::readArpTableETH(netif *iface) {
+    size_t first = hostslist_eth.size();
     for (uint32_t i = 0; i < ARP_TABLE_SIZE; ++i) {
         ip4_addr_t *ip_ret;
         eth_addr *eth_ret;
         if (etharp_get_entry(i, &ip_ret, &iface, &eth_ret)) { hostslist_eth.emplace_back(ip_ret, eth_ret); }
     }
     etharp_cleanup_netif(iface);
+
+    // Vendors of the new hosts in one pass over the table
+    size_t count = hostslist_eth.size() - first;
+    std::vector<uint8_t> macs(count * 6);
+    for (size_t i = 0; i < count; i++) stringToMAC(hostslist_eth[first + i].mac.c_str(), &macs[i * 6]);
+    std::vector<String> vendors;
+    if (count && getManufacturers(macs.data(), count, vendors)) {
+        for (size_t i = 0; i < count; i++) hostslist_eth[first + i].vendor = vendors[i];
+    }
 }
 
 #include "ARPSpoofer.h"
@@ -208,6 +218,7 @@ ScanHostMenu:
     for (auto host : hostslist_eth) {
         String result = host.ip.toString();
         if (host.ip == gateway) result += "(GTW)";
+        if (!host.vendor.isEmpty()) result += " " + host.vendor;
         options.push_back({result.c_str(), [=]() { afterScanOptions(host); }});
     }
     addOptionToMainMenu();
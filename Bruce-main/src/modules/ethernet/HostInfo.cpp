@@ -90,7 +90,7 @@ void HostInfo::setup(const Host &host) {
     tft.setCursor(8, 42);
     tft.print("Mac: " + host.mac);
     tft.setCursor(8, 54);
-    tft.print("Manufacturer: " + getManufacturer(host.mac));
+    tft.print("Manufacturer: " + (host.vendor.isEmpty() ? getManufacturer(host.mac) : host.vendor));
     tft.setCursor(8, 66);
     tft.print("Scanning Ports...(hold esc to cancel)");
     tft.setCursor(8, 78);
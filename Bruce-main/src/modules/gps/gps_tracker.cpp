@@ -17,7 +17,7 @@
 GPSTracker::GPSTracker() { setup(); }
 
 GPSTracker::~GPSTracker() {
-    add_final_file_data();
+    close_journal();
     if (gpsConnected) end();
     ioExpander.turnPinOnOff(IO_EXP_GPS, LOW);
 #ifdef USE_BOOST
@@ -153,83 +153,64 @@ void GPSTracker::create_filename() {
         gps.time.minute() % 100,
         gps.time.second() % 100
     );
-    filename = String(timestamp) + "_gps_tracker.gpx";
+    filename = String(timestamp) + "_gps_tracker.trk";
 }
 
-void GPSTracker::add_initial_file_data(File file) {
-    file.println("<?xml version=\"1.0\" encoding=\"ISO-8859-1\" standalone=\"yes\"?>");
-    file.println("<?xml-stylesheet type=\"text/xsl\" href=\"details.xsl\"?>");
-    file.println("<gpx");
-    file.println("  version=\"1.1\"");
-    file.println("  creator=\"Bruce Firmware\"");
-    file.println("  xmlns=\"http://www.topografix.com/GPX/1/1\"");
-    file.println("  xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"");
-    file.println(
-        "  xsi:schemaLocation=\"http://www.topografix.com/GPX/1/1 http://www.topografix.com/GPX/1/1/gpx.xsd\""
+uint32_t GPSTracker::fix_time() {
+    if (!gps.date.isValid() || !gps.time.isValid() || gps.date.year() < 2000) return 0;
+    return trackUnixTime(
+        gps.date.year(),
+        gps.date.month(),
+        gps.date.day(),
+        gps.time.hour(),
+        gps.time.minute(),
+        gps.time.second()
     );
-    file.println(">");
-    file.println("  <metadata>");
-    file.println("    <name>Bruce GPS Tracker</name>");
-    file.println("    <desc>GPS Tracker using Bruce Firmware</desc>");
-    file.println("    <link href=\"https://bruce.computer\">");
-    file.println("      <text>Bruce Website</text>");
-    file.println("    </link>");
-    file.println("  </metadata>");
-    file.println("  <trk>");
-    file.println("    <name>Bruce Route</name>");
-    file.println("    <desc>GPS route captured by Bruce firmware</desc>");
-    file.println("    <trkseg>");
 }
 
-void GPSTracker::add_final_file_data() {
+bool GPSTracker::open_journal() {
     FS *fs;
-    if (!getFsStorage(fs)) return;
-    if (filename == "" || !(*fs).exists("/BruceGPS/" + filename)) return;
+    if (!getFsStorage(fs)) {
+        padprintln("Storage setup error");
+        return false;
+    }
 
-    File file = (*fs).open("/BruceGPS/" + filename, FILE_APPEND);
+    if (filename == "") create_filename();
+    if (!(*fs).exists("/BruceGPS")) (*fs).mkdir("/BruceGPS");
 
-    if (!file) return;
-    file.println("    </trkseg>");
-    file.println("  </trk>");
-    file.println("</gpx>");
+    journalFile.begin(*fs, "/BruceGPS/" + filename);
+    journal.begin(fix_time());
+    return true;
+}
 
-    file.close();
+// Fixes still in the RAM block; the journal needs nothing else to be complete
+void GPSTracker::close_journal() {
+    if (journalFile.path() == "" || journal.pending() == 0) return;
+    journal.flush();
 }
 
 void GPSTracker::add_coord() {
-    FS *fs;
-    if (!getFsStorage(fs)) {
-        padprintln("Storage setup error");
+    if (journalFile.path() == "" && !open_journal()) {
         returnToMenu = true;
         return;
     }
 
-    if (filename == "") create_filename();
-
-    if (!(*fs).exists("/BruceGPS")) (*fs).mkdir("/BruceGPS");
-
-    bool is_new_file = false;
-    if (!(*fs).exists("/BruceGPS/" + filename)) is_new_file = true;
-    File file = (*fs).open("/BruceGPS/" + filename, is_new_file ? FILE_WRITE : FILE_APPEND);
-
-    if (!file) {
-        padprintln("Failed to open file for writing");
+    TrackPoint point = TrackPoint::make(
+        gps.location.lat(),
+        gps.location.lng(),
+        gps.altitude.meters(),
+        gps.hdop.hdop(),
+        gps.satellites.value(),
+        fix_time()
+    );
+    // Only a full block is written, one file write every TrackWriter::BLOCK_POINTS fixes
+    if (!journal.add(point)) {
+        padprintln("Failed to write the track file");
         returnToMenu = true;
         return;
     }
 
-    if (is_new_file) add_initial_file_data(file);
-
-    file.printf("      <trkpt lat=\"%f\" lon=\"%f\">\n", gps.location.lat(), gps.location.lng());
-    file.println("        <sym>Waypoint</sym>");
-    file.printf("        <ele>%f</ele>\n", gps.altitude.meters());
-    file.printf("        <hdop>%f</hdop>\n", gps.hdop.hdop());
-    file.printf("        <sat>%d</sat>\n", gps.satellites.value());
-    file.println("      </trkpt>");
-
     gpsCoordCount++;
 
-    file.close();
-
     padprintf(2, "Coord: %.6f, %.6f\n", gps.location.lat(), gps.location.lng());
 }
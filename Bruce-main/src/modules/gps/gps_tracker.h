@@ -10,6 +10,7 @@
 #define __GPS_TRACKER_H__
 
 #include <TinyGPS++.h>
+#include <TrackJournal.h>
 #include <globals.h>
 
 class GPSTracker {
@@ -36,6 +37,8 @@ private:
     TinyGPSPlus gps;
     HardwareSerial GPSserial = HardwareSerial(2);
     int gpsCoordCount = 0;
+    FileTrackSink journalFile;
+    TrackWriter journal = TrackWriter(journalFile);
 
     /////////////////////////////////////////////////////////////////////////////////////
     // Setup
@@ -54,8 +57,9 @@ private:
     /////////////////////////////////////////////////////////////////////////////////////
     void set_position(void);
     void add_coord(void);
-    void add_initial_file_data(File file);
-    void add_final_file_data(void);
+    bool open_journal(void);
+    void close_journal(void);
+    uint32_t fix_time(void);
     void create_filename(void);
 };
 
@@ -14,10 +14,14 @@
 #include "current_year.h"
 
 #define MAX_WAIT 5000
+#define CSV_BUFFER_SIZE 4096   // Rows kept in RAM, written in one go when full
+#define CSV_FLUSH_MS 15000     // Rows older than this are written (and the file flushed) anyway
+#define CSV_MAX_ROW 256        // MAC, 32 char SSID (quotes doubled), auth and GPS fields
 
 Wardriving::Wardriving() { setup(); }
 
 Wardriving::~Wardriving() {
+    close_file();
     if (gpsConnected) end();
     ioExpander.turnPinOnOff(IO_EXP_GPS, LOW);
 #ifdef USE_BOOST /// ENABLE 5V OUTPUT
@@ -67,6 +71,7 @@ bool Wardriving::begin_gps() {
 }
 
 void Wardriving::end() {
+    close_file();
     wifiDisconnect();
 
     GPSserial.end();
@@ -132,6 +137,15 @@ void Wardriving::display_banner() {
     if (wifiNetworkCount > 0) {
         padprintln("File: " + filename.substring(0, filename.length() - 4), 2);
         padprintln("Unique Networks Found: " + String(wifiNetworkCount), 2);
+        uint32_t elapsed = millis() - firstScanMs;
+        // Empty when the set couldn't allocate, networks are still counted then
+        uint32_t macs = registeredMACs.size();
+        padprintf(
+            2,
+            "Rate: %.2f/s  Mem: %uB/net\n",
+            elapsed ? wifiNetworkCount * 1000.0 / elapsed : 0.0,
+            macs ? (unsigned)(registeredMACs.memoryUsage() / macs) : 0u
+        );
         padprintf(2, "Distance: %.2fkm\n", distance / 1000);
     }
 
@@ -150,7 +164,7 @@ void Wardriving::dump_gps_data() {
     padprintf(2, "HDOP: %.2f\n", gps.hdop.hdop());
 }
 
-String Wardriving::auth_mode_to_string(wifi_auth_mode_t authMode) {
+const char *Wardriving::auth_mode_to_string(wifi_auth_mode_t authMode) {
     switch (authMode) {
         case WIFI_AUTH_OPEN: return "OPEN";
         case WIFI_AUTH_WEP: return "WEP";
@@ -195,75 +209,136 @@ void Wardriving::create_filename() {
     filename = String(timestamp) + "_wardriving.csv";
 }
 
-void Wardriving::append_to_file(int network_amount) {
+bool Wardriving::open_file() {
     FS *fs;
     if (!getFsStorage(fs)) {
         padprintln("Storage setup error");
-        returnToMenu = true;
-        return;
+        return false;
     }
 
     if (filename == "") create_filename();
 
     if (!(*fs).exists("/BruceWardriving")) (*fs).mkdir("/BruceWardriving");
 
-    bool is_new_file = false;
-    if (!(*fs).exists("/BruceWardriving/" + filename)) is_new_file = true;
-    File file = (*fs).open("/BruceWardriving/" + filename, is_new_file ? FILE_WRITE : FILE_APPEND);
+    bool is_new_file = !(*fs).exists("/BruceWardriving/" + filename);
+    csvFile = (*fs).open("/BruceWardriving/" + filename, is_new_file ? FILE_WRITE : FILE_APPEND);
+    if (!csvBuffer) csvBuffer = (char *)malloc(CSV_BUFFER_SIZE);
 
-    if (!file) {
+    if (!csvFile || !csvBuffer) {
         padprintln("Failed to open file for writing");
-        returnToMenu = true;
-        return;
+        if (csvFile) csvFile.close();
+        return false;
     }
 
     if (is_new_file) {
-        file.println(
+        csvFile.println(
             "WigleWifi-1.6,appRelease=v" + String(BRUCE_VERSION) + ",model=M5Stack GPS Unit,release=v" +
             String(BRUCE_VERSION) +
             ",device=ESP32 M5Stack,display=SPI TFT,board=ESP32 M5Stack,brand=Bruce,star=Sol,body=4,subBody=1"
         );
-        file.println(
+        csvFile.println(
             "MAC,SSID,AuthMode,FirstSeen,Channel,Frequency,RSSI,CurrentLatitude,CurrentLongitude,"
             "AltitudeMeters,AccuracyMeters,RCOIs,MfgrId,Type"
         );
+        csvFile.flush();
     }
+    csvUsed = 0;
+    csvFlushMs = millis();
+    return true;
+}
+
+// Writes the buffered rows when another one might not fit, when they're older
+// than CSV_FLUSH_MS or when forced, so the card sees a few big writes a minute
+void Wardriving::write_rows(bool force) {
+    if (!csvFile || csvUsed == 0) return;
+    bool stale = millis() - csvFlushMs >= CSV_FLUSH_MS;
+    if (!force && !stale && csvUsed + CSV_MAX_ROW <= CSV_BUFFER_SIZE) return;
+
+    if (csvFile.write((const uint8_t *)csvBuffer, csvUsed) != csvUsed) {
+        padprintln("Failed to write file");
+        returnToMenu = true;
+    }
+    if (force || stale) csvFile.flush();
+    csvUsed = 0;
+    csvFlushMs = millis();
+}
+
+void Wardriving::close_file() {
+    write_rows(true);
+    if (csvFile) csvFile.close();
+    free(csvBuffer);
+    csvBuffer = nullptr;
+}
+
+void Wardriving::append_to_file(int network_amount) {
+    if (!csvFile && !open_file()) {
+        returnToMenu = true;
+        return;
+    }
+    if (firstScanMs == 0) firstScanMs = millis();
+
+    // Same for every network of this scan
+    char scanFields[96];
+    snprintf(
+        scanFields,
+        sizeof(scanFields),
+        "%04d-%02d-%02d %02d:%02d:%02d",
+        gps.date.year(),
+        gps.date.month(),
+        gps.date.day(),
+        gps.time.hour(),
+        gps.time.minute(),
+        gps.time.second()
+    );
+    char gpsFields[96];
+    snprintf(
+        gpsFields,
+        sizeof(gpsFields),
+        "%f,%f,%f,%f",
+        gps.location.lat(),
+        gps.location.lng(),
+        gps.altitude.meters(),
+        gps.hdop.hdop() * 1.0
+    );
 
     for (int i = 0; i < network_amount; i++) {
-        String macAddress = WiFi.BSSIDstr(i);
+        wifi_ap_record_t *ap = (wifi_ap_record_t *)WiFi.getScanInfoByIndex(i);
+        if (!ap) continue;
 
         // Check if MAC was already found in this session
-        if (registeredMACs.find(macAddress) == registeredMACs.end()) {
-            registeredMACs.insert(macAddress); // Adds MAC to file
-            int32_t channel = WiFi.channel(i);
-
-            char buffer[512];
-            snprintf(
-                buffer,
-                sizeof(buffer),
-                "%s,\"%s\",[%s],%04d-%02d-%02d %02d:%02d:%02d,%d,%d,%d,%f,%f,%f,%f,,,WIFI\n",
-                macAddress.c_str(),
-                WiFi.SSID(i).c_str(),
-                auth_mode_to_string(WiFi.encryptionType(i)).c_str(),
-                gps.date.year(),
-                gps.date.month(),
-                gps.date.day(),
-                gps.time.hour(),
-                gps.time.minute(),
-                gps.time.second(),
-                channel,
-                channel != 14 ? 2407 + (channel * 5) : 2484,
-                WiFi.RSSI(i),
-                gps.location.lat(),
-                gps.location.lng(),
-                gps.altitude.meters(),
-                gps.hdop.hdop() * 1.0
-            );
-            file.print(buffer);
-
-            wifiNetworkCount++;
+        if (!registeredMACs.insert(ap->bssid)) continue;
+
+        // SSID quoted, with its quotes doubled
+        char ssid[2 * sizeof(ap->ssid) + 1];
+        size_t n = 0;
+        for (const uint8_t *c = ap->ssid; c < ap->ssid + sizeof(ap->ssid) && *c; c++) {
+            if (*c == '"') ssid[n++] = '"';
+            ssid[n++] = *c;
         }
-    }
+        ssid[n] = '\0';
+
+        write_rows(false); // Room for this row
+        int32_t channel = ap->primary;
+        csvUsed += snprintf(
+            csvBuffer + csvUsed,
+            CSV_BUFFER_SIZE - csvUsed,
+            "%02X:%02X:%02X:%02X:%02X:%02X,\"%s\",[%s],%s,%d,%d,%d,%s,,,WIFI\n",
+            ap->bssid[0],
+            ap->bssid[1],
+            ap->bssid[2],
+            ap->bssid[3],
+            ap->bssid[4],
+            ap->bssid[5],
+            ssid,
+            auth_mode_to_string(ap->authmode),
+            scanFields,
+            channel,
+            channel != 14 ? 2407 + (channel * 5) : 2484,
+            ap->rssi,
+            gpsFields
+        );
 
-    file.close();
+        wifiNetworkCount++;
+    }
+    write_rows(false);
 }
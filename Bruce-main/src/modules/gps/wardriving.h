@@ -9,10 +9,10 @@
 #ifndef __WAR_DRIVING_H__
 #define __WAR_DRIVING_H__
 
+#include <MacSet.h>
 #include <TinyGPS++.h>
 #include <esp_wifi_types.h>
 #include <globals.h>
-#include <set>
 
 class Wardriving {
 public:
@@ -37,8 +37,13 @@ private:
     String filename = "";
     TinyGPSPlus gps;
     HardwareSerial GPSserial = HardwareSerial(2); // Uses UART2 for GPS
-    std::set<String> registeredMACs;              // Store and track registered MAC
+    MacSet registeredMACs;                        // Store and track registered MAC
     int wifiNetworkCount = 0;                     // Counter fo wifi networks
+    uint32_t firstScanMs = 0;                     // For the networks/s rate
+    File csvFile;                                 // Open for the whole session
+    char *csvBuffer = nullptr;                    // Rows not written yet
+    size_t csvUsed = 0;
+    uint32_t csvFlushMs = 0;                      // Last time the rows were written
 
     /////////////////////////////////////////////////////////////////////////////////////
     // Setup
@@ -58,8 +63,11 @@ private:
     /////////////////////////////////////////////////////////////////////////////////////
     void set_position(void);
     void scan_networks(void);
-    String auth_mode_to_string(wifi_auth_mode_t authMode);
+    const char *auth_mode_to_string(wifi_auth_mode_t authMode);
     void append_to_file(int network_amount);
+    bool open_file(void);
+    void write_rows(bool force);
+    void close_file(void);
     void create_filename(void);
 };
 
@@ -6,6 +6,7 @@
 #include "core/settings.h"
 #include "core/type_convertion.h"
 #include <IRutils.h>
+#include <SignalFile.h>
 
 uint32_t swap32(uint32_t value) {
     return ((value & 0x000000FF) << 24) | ((value & 0x0000FF00) << 8) | ((value & 0x00FF0000) >> 8) |
@@ -15,13 +16,6 @@ uint32_t swap32(uint32_t value) {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Custom IR
 
-static std::vector<IRCode *> codes;
-
-void resetCodesArray() {
-    for (auto code : codes) { delete code; }
-    codes.clear();
-}
-
 static std::vector<IRCode *> recent_ircodes;
 
 void addToRecentCodes(IRCode *ircode) {
@@ -69,12 +63,34 @@ void selectRecentIrMenu() {
     return;
 }
 
+// A code starts at its "name:" line and runs until the next one
+static const char *const irRecordKeys[] = {"name", nullptr};
+
+static void readIrCode(SignalReader &reader, const SignalIndex &index, IRCode &code) {
+    bool first = true;
+    while (reader.next()) {
+        if (!first && index.isRecordStart(reader)) {
+            reader.unread();
+            break;
+        }
+        first = false;
+        if (reader.isComment()) continue;
+
+        const char *value = reader.value().str;
+        if (reader.is("name")) code.name = value;
+        else if (reader.is("type")) code.type = value;
+        else if (reader.is("protocol")) code.protocol = value;
+        else if (reader.is("address")) code.address = value;
+        else if (reader.is("command")) code.command = value;
+        else if (reader.is("frequency")) code.frequency = reader.value().toInt();
+        else if (reader.is("bits")) code.bits = reader.value().toInt();
+        else if (reader.is("data") || reader.is("value") || reader.is("state")) code.data = value;
+    }
+}
+
 bool txIrFile(FS *fs, String filepath) {
     // SPAM all codes of the file
 
-    int total_codes = 0;
-    String line;
-
     File databaseFile = fs->open(filepath, FILE_READ);
 
     pinMode(bruceConfig.irTx, OUTPUT);
@@ -88,107 +104,34 @@ bool txIrFile(FS *fs, String filepath) {
     }
     Serial.println("Opened database file.");
 
-    bool endingEarly = false;
-    int codes_sent = 0;
-    uint16_t frequency = 0;
-    String rawData = "";
-    String protocol = "";
-    String address = "";
-    String command = "";
-    String value = "";
-    uint8_t bits = 32;
-
-    databaseFile.seek(0); // comes back to first position
-
-    // count the number of codes to replay
-    while (databaseFile.available()) {
-        line = databaseFile.readStringUntil('\n');
-        if (line.startsWith("type:")) total_codes++;
+    FileSignalSource source(databaseFile);
+    SignalReader reader;
+    SignalIndex index(irRecordKeys);
+    if (!reader.begin(&source) || !openSignalIndex(*fs, filepath, databaseFile, reader, index)) {
+        databaseFile.close();
+        displayError("Fail to read file");
+        delay(2000);
+        return false;
     }
 
-    Serial.printf("\nStarted SPAM all codes with: %d codes", total_codes);
-    // comes back to first position, beggining of the file
-    databaseFile.seek(0);
-    while (databaseFile.available()) {
-        progressHandler(codes_sent, total_codes);
-        line = databaseFile.readStringUntil('\n');
-        if (line.endsWith("\r")) line.remove(line.length() - 1);
-
-        if (line.startsWith("type:")) {
-            codes_sent++;
-            String type = line.substring(5);
-            type.trim();
-            Serial.println("Type: " + type);
-            if (type == "raw") {
-                Serial.println("RAW code");
-                while (databaseFile.available()) {
-                    line = databaseFile.readStringUntil('\n');
-                    if (line.endsWith("\r")) line.remove(line.length() - 1);
-
-                    if (line.startsWith("frequency:")) {
-                        line = line.substring(10);
-                        line.trim();
-                        frequency = line.toInt();
-                        Serial.printf("Frequency: %d\n", frequency);
-                    } else if (line.startsWith("data:")) {
-                        rawData = line.substring(5);
-                        rawData.trim();
-                        Serial.println("RawData: " + rawData);
-                    } else if ((frequency != 0 && rawData != "") || line.startsWith("#")) {
-                        IRCode code;
-                        code.type = "raw";
-                        code.data = rawData;
-                        code.frequency = frequency;
-                        sendIRCommand(&code);
-
-                        rawData = "";
-                        frequency = 0;
-                        type = "";
-                        line = "";
-                        break;
-                    }
-                }
-            } else if (type == "parsed") {
-                Serial.println("PARSED");
-                while (databaseFile.available()) {
-                    line = databaseFile.readStringUntil('\n');
-                    if (line.endsWith("\r")) line.remove(line.length() - 1);
-
-                    if (line.startsWith("protocol:")) {
-                        protocol = line.substring(9);
-                        protocol.trim();
-                        Serial.println("Protocol: " + protocol);
-                    } else if (line.startsWith("address:")) {
-                        address = line.substring(8);
-                        address.trim();
-                        Serial.println("Address: " + address);
-                    } else if (line.startsWith("command:")) {
-                        command = line.substring(8);
-                        command.trim();
-                        Serial.println("Command: " + command);
-                    } else if (line.startsWith("value:") || line.startsWith("state:")) {
-                        value = line.substring(6);
-                        value.trim();
-                        Serial.println("Value: " + value);
-                    } else if (line.startsWith("bits:")) {
-                        bits = line.substring(strlen("bits:")).toInt();
-                        Serial.println("bits: " + bits);
-                    } else if (line.indexOf("#") != -1) { // TODO: also detect EOF
-                        IRCode code(protocol, address, command, value, bits);
-                        sendIRCommand(&code);
-
-                        protocol = "";
-                        address = "";
-                        command = "";
-                        value = "";
-                        bits = 32;
-                        type = "";
-                        line = "";
-                        break;
-                    }
-                }
-            }
+    bool endingEarly = false;
+    uint32_t total_codes = index.count();
+
+    Serial.printf("\nStarted SPAM all codes with: %lu codes", (unsigned long)total_codes);
+    for (uint32_t i = 0; i < total_codes; i++) {
+        progressHandler(i, total_codes);
+        if (!index.seek(reader, i)) {
+            // File changed without its size or date changing, next time it's rebuilt
+            Serial.println("IR index out of date");
+            fs->remove(filepath + ".idx");
+            break;
         }
+
+        IRCode code;
+        readIrCode(reader, index, code);
+        Serial.println("Type: " + code.type);
+        if (code.type.equalsIgnoreCase("raw") ? code.data != "" : code.protocol != "") sendIRCommand(&code);
+
         // if user is pushing (holding down) TRIGGER button, stop transmission early
         if (check(SelPress)) // Pause TV-B-Gone
         {
@@ -205,20 +148,20 @@ bool txIrFile(FS *fs, String filepath) {
             if (endingEarly) break; // Cancels  custom IR Spam
             displayTextLine("Running, Wait");
         }
-    } // end while file has lines to process
+    } // end for each code in the file
+    if (reader.skippedLines() > 0) {
+        Serial.printf("Skipped %lu lines too long to read\n", (unsigned long)reader.skippedLines());
+    }
     databaseFile.close();
     Serial.println("closed");
     Serial.println("EXTRA finished");
 
-    resetCodesArray();
     digitalWrite(bruceConfig.irTx, LED_OFF);
     return true;
 }
 
 void otherIRcodes() {
     checkIrTxPin();
-    resetCodesArray();
-    int total_codes = 0;
     String filepath;
     File databaseFile;
     FS *fs = NULL;
@@ -276,55 +219,33 @@ void otherIRcodes() {
     }
     Serial.println("Opened database file.");
 
+    FileSignalSource source(databaseFile);
+    SignalReader reader;
+    SignalIndex index(irRecordKeys);
+    if (!reader.begin(&source) || !openSignalIndex(*fs, filepath, databaseFile, reader, index)) {
+        databaseFile.close();
+        return;
+    }
+
     pinMode(bruceConfig.irTx, OUTPUT);
     // digitalWrite(bruceConfig.irTx, LED_ON);
 
-    // Mode to choose and send command by command limitted to 100 commands
-    String line;
-    String txt;
-    codes.push_back(new IRCode());
-    while (databaseFile.available() && total_codes < 100) {
-        line = databaseFile.readStringUntil('\n');
-        txt = line.substring(line.indexOf(":") + 1);
-        txt.trim();
-        if (line.startsWith("name:")) {
-            // in case that the separation between codes are not made by "#" line
-            if (codes[total_codes]->name != "") {
-                total_codes++;
-                codes.push_back(new IRCode());
-            }
-            // save signal name
-            codes[total_codes]->name = txt;
-            codes[total_codes]->filepath = txt + " " + filepath.substring(1 + filepath.lastIndexOf("/"));
-        }
-        if (line.startsWith("type:")) codes[total_codes]->type = txt;
-        if (line.startsWith("protocol:")) codes[total_codes]->protocol = txt;
-        if (line.startsWith("address:")) codes[total_codes]->address = txt;
-        if (line.startsWith("frequency:")) codes[total_codes]->frequency = txt.toInt();
-        if (line.startsWith("bits:")) codes[total_codes]->bits = txt.toInt();
-        if (line.startsWith("command:")) codes[total_codes]->command = txt;
-        if (line.startsWith("data:") || line.startsWith("value:") || line.startsWith("state:")) {
-            codes[total_codes]->data = txt;
-        }
-        // if there are a line with "#", and the code name isnt't "" (there are a signal saved), go to next
-        // signal
-        if (line.startsWith("#") && total_codes < codes.size() && codes[total_codes]->name != "") {
-            total_codes++;
-            codes.push_back(new IRCode());
-        }
-        // if(line.startsWith("duty_cycle:")) codes[total_codes]->duty_cycle = txt.toFloat();
-    }
+    // Only the names are kept, the file stays open and a code is read when it's chosen
+    String filename = filepath.substring(1 + filepath.lastIndexOf("/"));
     options = {};
-    for (auto code : codes) {
-        if (code->name != "") {
-            options.push_back({code->name.c_str(), [code]() {
-                                   sendIRCommand(code);
-                                   addToRecentCodes(code);
-                               }});
-        }
+    for (uint32_t i = 0; i < index.count(); i++) {
+        if (!index.seek(reader, i) || !reader.next()) break;
+        if (reader.value().empty()) continue;
+        options.push_back({reader.value().str, [&, i]() {
+                               IRCode code;
+                               if (!index.seek(reader, i)) return;
+                               readIrCode(reader, index, code);
+                               code.filepath = code.name + " " + filename;
+                               sendIRCommand(&code);
+                               addToRecentCodes(&code);
+                           }});
     }
     options.push_back({"Main Menu", [&]() { exit = true; }});
-    databaseFile.close();
 
  #ifdef USE_BOOST  ///DISABLE 5V OUTPUT
   PPM.disableOTG();
@@ -338,6 +259,7 @@ void otherIRcodes() {
         if (check(EscPress) || exit) break;
     }
     options.clear();
+    databaseFile.close();
 } // end of otherIRcodes
 
 // IR commands
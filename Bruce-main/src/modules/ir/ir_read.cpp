@@ -21,6 +21,33 @@
 #define IR_FREQUENCY 38000
 #define DUTY_CYCLE 0.330000
 
+#ifdef IR_RMT_CAPTURE
+// IRrecv's capture state, filled by its edge interrupt. decode() only reads from here and
+// has no public way to be handed a frame, so the RMT path stores its frames in it too.
+// It's a library internal: platformio.ini pins the version this was checked against.
+#if !defined(_IRREMOTEESP8266_VERSION_MAJOR) || _IRREMOTEESP8266_VERSION_MAJOR != 2 ||                \
+    _IRREMOTEESP8266_VERSION_MINOR != 8
+#error "Check decodeDurations() against IRrecv.cpp's decode() before changing the IRremoteESP8266 version"
+#endif
+namespace _IRrecv {
+extern volatile irparams_t params;
+}
+
+// Decodes a frame of durations in us as if IRrecv's interrupt had captured it.
+// count must leave room for the gap before the frame and the entry after it.
+static bool decodeDurations(
+    IRrecv &irrecv, const uint16_t *durations, uint16_t count, bool overflow, decode_results *results
+) {
+    volatile irparams_t &params = _IRrecv::params;
+    params.rawbuf[0] = IR_RMT_IDLE_US / kRawTick;
+    for (uint16_t i = 0; i < count; i++) params.rawbuf[i + 1] = durations[i] / kRawTick;
+    params.rawlen = count + 1;
+    params.overflow = overflow;
+    params.rcvstate = kStopState;
+    return irrecv.decode(results);
+}
+#endif
+
 String uint32ToString(uint32_t value) {
     char buffer[12] = {0}; // 8 hex digits + 3 spaces + 1 null terminator
     snprintf(
@@ -57,8 +84,6 @@ IrRead::IrRead(bool headless_mode, bool raw_mode) {
 bool quickloop = false;
 
 void IrRead::setup() {
-    irrecv.enableIRIn();
-    
    #ifdef USE_BOOST  ///ENABLE 5V OUTPUT
     PPM.enableOTG();
     #endif
@@ -71,6 +96,7 @@ void IrRead::setup() {
     if (count == 0) gsetIrRxPin(true); // Open dialog to choose irRx pin
 
     pinMode(bruceConfig.irRx, INPUT);
+    start_capture();
     if (headless) return;
     // else
     returnToMenu = true; // make sure menu is redrawn when quitting in any point
@@ -174,8 +200,84 @@ void IrRead::display_btn_options() {
     padprintln("Press [ESC]  to exit");
 }
 
+/////////////////////////////////////////////////////////////////////////////////////
+// Capture
+/////////////////////////////////////////////////////////////////////////////////////
+void IrRead::start_capture() {
+    // IRrecv's timer is set up either way: resume() and disableIRIn() use it
+    irrecv.enableIRIn();
+    useRmt = false;
+#ifdef IR_RMT_CAPTURE
+    if (bruceConfig.irRxRmt && rmtCapture.begin(bruceConfig.irRx)) {
+        irrecv.pause(); // No edge interrupts, the RMT has the pin
+        capture.resize(IR_RMT_MAX_DURATIONS);
+        clusters.clear();
+        rmtCapture.start();
+        useRmt = true;
+    } else if (bruceConfig.irRxRmt) {
+        log_e("RMT capture unavailable, using the interrupt");
+    }
+#endif
+}
+
+void IrRead::resume_capture() {
+#ifdef IR_RMT_CAPTURE
+    if (useRmt) {
+        clusters.clear();
+        rmtCapture.start();
+        return;
+    }
+#endif
+    irrecv.resume();
+}
+
+void IrRead::end_capture() {
+#ifdef IR_RMT_CAPTURE
+    rmtCapture.end();
+#endif
+    irrecv.disableIRIn();
+}
+
+bool IrRead::decode_signal() {
+    if (useRmt) return decode_rmt();
+    return irrecv.decode(&results);
+}
+
+// Groups the frames of a button press, then decodes the canonical one through IRrecv
+bool IrRead::decode_rmt() {
+#ifdef IR_RMT_CAPTURE
+    uint32_t now = millis();
+    uint16_t count;
+    while ((count = rmtCapture.read(capture.data(), capture.size())) > 0) {
+        if (clusters.captures() == 0) {
+            firstCapture = now;
+            captureOverflow = false;
+        }
+        lastCapture = now;
+        captureOverflow |= rmtCapture.overflow();
+        clusters.add(capture.data(), count);
+    }
+    if (clusters.captures() == 0) return false;
+    if (now - lastCapture < IR_PRESS_GAP_MS && now - firstCapture < IR_PRESS_MAX_MS) return false;
+
+    rmtCapture.stop();
+    // rawbuf[0] is the gap before the frame, and decode() clears the entry after the last one
+    uint16_t bufSize = irrecv.getBufSize();
+    count = clusters.canonical(capture.data(), std::min<uint16_t>(capture.size(), bufSize - 2));
+    clusters.clear();
+    if (count == 0) {
+        rmtCapture.start();
+        return false;
+    }
+
+    return decodeDurations(irrecv, capture.data(), count, captureOverflow, &results);
+#else
+    return false;
+#endif
+}
+
 void IrRead::read_signal() {
-    if (_read_signal || !irrecv.decode(&results)) return;
+    if (_read_signal || !decode_signal()) return;
 
     _read_signal = true;
 
@@ -197,7 +299,7 @@ void IrRead::read_signal() {
 
 void IrRead::discard_signal() {
     if (!_read_signal) return;
-    irrecv.resume();
+    resume_capture();
     begin();
 }
 
@@ -232,13 +334,15 @@ String IrRead::parse_raw_signal() {
     rawcode = resultToRawArray(&results);
     raw_data_len = getCorrectedRawLength(&results);
 
-    String signal_code = "";
-
-    for (uint16_t i = 0; i < raw_data_len; i++) { signal_code += String(rawcode[i]) + " "; }
+    // Formatted in one buffer rather than a String grown a number at a time
+    size_t size = raw_data_len * 6 + 1; // Up to "65535 " each
+    char *text = new char[size];
+    irFormatRaw(text, size, rawcode, raw_data_len);
+    String signal_code = text;
 
+    delete[] text;
     delete[] rawcode;
     rawcode = nullptr;
-    signal_code.trim();
 
     return signal_code;
 }
@@ -359,23 +463,24 @@ void IrRead::save_device() {
 
     delay(1000);
 
-    irrecv.resume();
+    resume_capture();
     begin();
 }
 
 String IrRead::loop_headless(int max_loops) {
 
-    while (!irrecv.decode(&results)) { // MEMO: default timeout is 15ms
+    while (!decode_signal()) { // MEMO: default timeout is 15ms
         max_loops -= 1;
         if (max_loops <= 0) {
             Serial.println("timeout");
+            end_capture();
             return ""; // nothing received
         }
         delay(1000);
         // delay(50);
     }
 
-    irrecv.disableIRIn();
+    end_capture();
 
     if (!raw && results.decode_type == decode_type_t::UNKNOWN) {
         Serial.println("# decoding failed, try raw mode");
@@ -6,8 +6,14 @@
  * @date 2024-07-17
  */
 
+#include "ir_rmt_capture.h"
 #include <IRrecv.h>
+#include <IrFrames.h>
 #include <globals.h>
+#include <vector>
+
+#define IR_PRESS_GAP_MS 300  // Captures closer than this are the same button press
+#define IR_PRESS_MAX_MS 3000 // A held button is decoded after this anyway
 
 class IrRead {
 public:
@@ -39,6 +45,17 @@ private:
     bool headless = false;
     bool raw = false;
 
+    // RMT capture, bruceConfig.irRxRmt
+    bool useRmt = false;
+#ifdef IR_RMT_CAPTURE
+    IrRmtCapture rmtCapture;
+#endif
+    IrFrameClusters clusters;
+    std::vector<uint16_t> capture;
+    bool captureOverflow = false;
+    uint32_t firstCapture = 0;
+    uint32_t lastCapture = 0;
+
     /////////////////////////////////////////////////////////////////////////////////////
     // Display functions
     /////////////////////////////////////////////////////////////////////////////////////
@@ -50,6 +67,11 @@ private:
     // Operations
     /////////////////////////////////////////////////////////////////////////////////////
     void begin();
+    void start_capture();
+    void resume_capture();
+    void end_capture();
+    bool decode_signal();
+    bool decode_rmt();
     void read_signal();
     void save_device();
     void save_signal();
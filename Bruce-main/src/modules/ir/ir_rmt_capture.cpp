@@ -0,0 +1,101 @@
+/**
+ * @file ir_rmt_capture.cpp
+ * @brief IR Rx capture with the RMT peripheral
+ */
+
+#include "ir_rmt_capture.h"
+
+#ifdef IR_RMT_CAPTURE
+
+bool IrRmtCapture::begin(int pin) {
+    end();
+    if (pin < 0) return false;
+
+    rmt_config_t config = RMT_DEFAULT_CONFIG_RX((gpio_num_t)pin, IR_RMT_CHANNEL);
+    config.clk_div = IR_RMT_CLK_DIV;
+    config.mem_block_num = IR_RMT_MEM_BLOCKS;
+    config.rx_config.filter_en = true;
+    config.rx_config.filter_ticks_thresh = IR_RMT_FILTER_APB_TICKS;
+    config.rx_config.idle_threshold = IR_RMT_IDLE_US / IR_RMT_TICK_US;
+    if (rmt_config(&config) != ESP_OK) return false;
+
+    // Room for a few frames of the longest kind, in case they aren't read right away
+    size_t ringSize = IR_RMT_MAX_DURATIONS / 2 * sizeof(rmt_item32_t) * 4;
+    esp_err_t err = rmt_driver_install(IR_RMT_CHANNEL, ringSize, 0);
+    if (err != ESP_OK) {
+        log_e("RMT install failed: %s", esp_err_to_name(err));
+        return false;
+    }
+    _installed = true;
+
+    rmt_get_ringbuf_handle(IR_RMT_CHANNEL, &_ring);
+    if (_ring == nullptr) {
+        end();
+        return false;
+    }
+    return true;
+}
+
+void IrRmtCapture::end() {
+    if (!_installed) return;
+    rmt_rx_stop(IR_RMT_CHANNEL);
+    rmt_driver_uninstall(IR_RMT_CHANNEL);
+    _installed = false;
+    _ring = nullptr;
+}
+
+void IrRmtCapture::start() {
+    if (!_installed) return;
+    // Frames received before the last stop are stale
+    size_t size = 0;
+    void *frame;
+    while ((frame = xRingbufferReceive(_ring, &size, 0)) != nullptr) vRingbufferReturnItem(_ring, frame);
+    rmt_rx_start(IR_RMT_CHANNEL, true);
+}
+
+void IrRmtCapture::stop() {
+    if (_installed) rmt_rx_stop(IR_RMT_CHANNEL);
+}
+
+uint16_t IrRmtCapture::read(uint16_t *durations, uint16_t max) {
+    _overflow = false;
+    if (!_installed) return 0;
+
+    size_t size = 0;
+    rmt_item32_t *items = (rmt_item32_t *)xRingbufferReceive(_ring, &size, 0);
+    if (items == nullptr) return 0;
+
+    // The first edge after idle starts a mark, whatever the receiver's polarity
+    uint32_t markLevel = items[0].level0;
+    uint16_t count = 0;
+    bool ended = false;
+    auto push = [&](uint32_t ticks, uint32_t level) {
+        if (ended) return;
+        if (ticks == 0) { // End of the frame, the line went idle
+            ended = true;
+            return;
+        }
+        bool mark = level == markLevel;
+        uint32_t us = ticks * IR_RMT_TICK_US;
+        if (count && ((count - 1) % 2 == 0) == mark) { // Same level as the last one, one long pulse
+            us += durations[count - 1];
+            durations[count - 1] = us > UINT16_MAX ? UINT16_MAX : us;
+            return;
+        }
+        if (count == max) {
+            _overflow = true;
+            ended = true;
+            return;
+        }
+        durations[count++] = us > UINT16_MAX ? UINT16_MAX : us;
+    };
+    for (size_t i = 0; i < size / sizeof(rmt_item32_t) && !ended; i++) {
+        push(items[i].duration0, items[i].level0);
+        push(items[i].duration1, items[i].level1);
+    }
+
+    vRingbufferReturnItem(_ring, items);
+    return count;
+}
+
+#endif
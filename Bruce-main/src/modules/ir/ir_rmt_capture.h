@@ -0,0 +1,70 @@
+/**
+ * @file ir_rmt_capture.h
+ * @brief IR Rx capture with the RMT peripheral
+ *
+ * The RMT timestamps every edge in hardware and hands over a whole frame
+ * once the line is idle, so a frame costs one interrupt instead of one per
+ * edge, and Wi-Fi or BLE interrupts can't delay or drop edges.
+ * Uses the legacy RMT driver, not available on IDF 5 cores.
+ */
+#ifndef __IR_RMT_CAPTURE_H__
+#define __IR_RMT_CAPTURE_H__
+
+#include <Arduino.h>
+#include <esp_idf_version.h>
+#include <soc/soc_caps.h>
+
+#if SOC_RMT_SUPPORTED && ESP_IDF_VERSION_MAJOR < 5
+#define IR_RMT_CAPTURE
+
+#include <driver/rmt.h>
+
+// Channels clear of the LED (0) and RF (6, 2 blocks) ones
+#if defined(CONFIG_IDF_TARGET_ESP32)
+#define IR_RMT_CHANNEL RMT_CHANNEL_2
+#define IR_RMT_MEM_BLOCKS 4
+#elif defined(CONFIG_IDF_TARGET_ESP32S3)
+#define IR_RMT_CHANNEL RMT_CHANNEL_4 // First Rx channel
+#define IR_RMT_MEM_BLOCKS 2
+#else
+#define IR_RMT_CHANNEL RMT_CHANNEL_2
+#define IR_RMT_MEM_BLOCKS 2
+#endif
+
+#if SOC_RMT_SUPPORT_RX_PINGPONG
+// The driver empties the channel memory while receiving, frames can be longer than it
+#define IR_RMT_MAX_DURATIONS 1024
+#else
+// Longer frames overflow the channel memory and are lost
+#define IR_RMT_MAX_DURATIONS (IR_RMT_MEM_BLOCKS * SOC_RMT_MEM_WORDS_PER_CHANNEL * 2)
+#endif
+
+#define IR_RMT_CLK_DIV 160          // 2 us ticks
+#define IR_RMT_TICK_US 2
+#define IR_RMT_IDLE_US 50000        // End of a frame, IRrecv's timeout in IR Read
+#define IR_RMT_FILTER_APB_TICKS 200 // Pulses under 2.5 us are noise
+
+class IrRmtCapture {
+public:
+    ~IrRmtCapture() { end(); }
+
+    bool begin(int pin);
+    void end();
+    // Receiving starts with a clean ring buffer
+    void start();
+    void stop();
+
+    // Next frame in us, marks and spaces from the first mark, 0 if none yet
+    uint16_t read(uint16_t *durations, uint16_t max);
+    // The last frame read had more durations than max
+    bool overflow() const { return _overflow; }
+
+private:
+    RingbufHandle_t _ring = nullptr;
+    bool _installed = false;
+    bool _overflow = false;
+};
+
+#endif
+
+#endif
@@ -11,34 +11,216 @@
 
 #if defined(HAS_NS4168_SPKR)
 
-bool playAudioFile(FS *fs, String filepath) {
-    if (!bruceConfig.soundEnabled) return false;
+#define AUDIO_RING_PSRAM (128 * 1024) // Power of two
+#define AUDIO_RING_RAM (16 * 1024)    // Power of two
+#define AUDIO_READ_CHUNK 4096         // Divides the ring sizes
+#define AUDIO_PREFILL_MS 1000         // Longest wait for the ring to fill before a track starts
+#define AUDIO_QUEUE_LENGTH 4
+#define AUDIO_PATH_SIZE 128
+#define AUDIO_IDLE_MS 5000            // Nothing queued for this long: free the ring and the tasks
+
+enum AudioFormat {
+    AUDIO_NONE,
+    AUDIO_WAV,
+    AUDIO_MP3,
+    AUDIO_AAC,
+    AUDIO_FLAC,
+    AUDIO_OPUS,
+    AUDIO_MOD,
+    AUDIO_RTTTL,
+};
+#define AUDIO_FORMATS (AUDIO_RTTTL + 1)
+
+struct AudioTrack {
+    FS *fs;
+    uint32_t seq;
+    char path[AUDIO_PATH_SIZE];
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Read-ahead ring
+/////////////////////////////////////////////////////////////////////////////////////
+// File source for the decoders, fed by the reader task. The reader only moves
+// head and the decoder only moves tail, so reads don't wait for each other;
+// the file itself is only touched with fileLock held.
+class AudioRingSource : public AudioFileSource {
+public:
+    bool allocate() {
+        if (_buffer) return true;
+        _capacity = psramFound() ? AUDIO_RING_PSRAM : AUDIO_RING_RAM;
+        _buffer = (uint8_t *)(psramFound() ? ps_malloc(_capacity) : malloc(_capacity));
+        if (!_fileLock) _fileLock = xSemaphoreCreateMutex();
+        return _buffer && _fileLock;
+    }
 
-    AudioFileSource *source = new AudioFileSourceFS(*fs, filepath.c_str());
-    if (!source) return false;
+    // With no track open: deletes the reader task, with the file lock held so it
+    // isn't stopped inside fill(), and frees the buffer until the next allocate()
+    void release(TaskHandle_t reader) {
+        xSemaphoreTake(_fileLock, portMAX_DELAY);
+        if (reader) vTaskDelete(reader);
+        free(_buffer);
+        _buffer = nullptr;
+        _capacity = 0;
+        _head = _tail = 0;
+        xSemaphoreGive(_fileLock);
+    }
 
-    AudioOutputI2S *audioout = new AudioOutputI2S(
-    ); // https://github.com/earlephilhower/ESP8266Audio/blob/master/src/AudioOutputI2S.cpp#L32
-    audioout->SetPinout(BCLK, WCLK, DOUT, MCLK);
-    
-    // set volume, derived from https://github.com/earlephilhower/ESP8266Audio/blob/master/examples/WebRadio/WebRadio.ino
-    audioout->SetGain(((float)bruceConfig.soundVolume) / 100.0);
-
-    AudioGenerator *generator = NULL;
-
-    // switch on extension
-    filepath.toLowerCase(); // case-insensitive match
-    if (filepath.endsWith(".txt") || filepath.endsWith(".rtttl")) generator = new AudioGeneratorRTTTL();
-    if (filepath.endsWith(".wav")) generator = new AudioGeneratorWAV();
-    if (filepath.endsWith(".mod")) generator = new AudioGeneratorMOD();
-    if (filepath.endsWith(".opus")) generator = new AudioGeneratorOpus();
-    if (filepath.endsWith(".aac")) generator = new AudioGeneratorAAC();
-    if (filepath.endsWith(".flac")) generator = new AudioGeneratorFLAC();
-    // OGG Vorbis is not supported https://github.com/earlephilhower/ESP8266Audio/issues/84
-    if (filepath.endsWith(".mp3")) {
-        generator = new AudioGeneratorMP3();
-        source = new AudioFileSourceID3(source);
+    // Takes over file, the reader starts filling from its beginning
+    void start(File file, TaskHandle_t reader, TaskHandle_t decoder) {
+        xSemaphoreTake(_fileLock, portMAX_DELAY);
+        _file = file;
+        _size = file.size();
+        _pos = 0;
+        _head = _tail = 0;
+        _eof = false;
+        _open = true;
+        _bytesRead = 0;
+        _minFill = UINT32_MAX;
+        _reader = reader;
+        _decoder = decoder;
+        xSemaphoreGive(_fileLock);
+        xTaskNotifyGive(_reader);
+    }
+
+    void finish() {
+        xSemaphoreTake(_fileLock, portMAX_DELAY);
+        _open = false;
+        if (_file) _file.close();
+        xSemaphoreGive(_fileLock);
+    }
+
+    // Reader task: reads chunks while there's room
+    void fill() {
+        xSemaphoreTake(_fileLock, portMAX_DELAY);
+        while (_open && !_eof) {
+            uint32_t used = _head - _tail;
+            if (_capacity - used < AUDIO_READ_CHUNK) break;
+            int got = _file.read(_buffer + (_head & (_capacity - 1)), AUDIO_READ_CHUNK);
+            if (got <= 0) {
+                _eof = true;
+            } else {
+                _head += got; // Only this task writes it, the decoder sees it once it's all there
+                _bytesRead += got;
+            }
+            xTaskNotifyGive(_decoder);
+        }
+        xSemaphoreGive(_fileLock);
     }
+
+    // Waits up to timeoutMs for the ring to fill
+    void prefill(uint32_t timeoutMs) {
+        uint32_t start = millis();
+        while (!_eof && _capacity - fill() >= AUDIO_READ_CHUNK && millis() - start < timeoutMs)
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(20));
+    }
+
+    uint32_t read(void *data, uint32_t len) override {
+        uint8_t *out = (uint8_t *)data;
+        uint32_t done = 0;
+        bool stalled = false;
+        while (done < len) {
+            uint32_t avail = _head - _tail;
+            if (avail < _minFill) _minFill = avail;
+            if (avail == 0) {
+                if (_eof || !_open) break;
+                if (!stalled) underruns++;
+                stalled = true;
+                xTaskNotifyGive(_reader);
+                ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(20));
+                continue;
+            }
+            uint32_t at = _tail & (_capacity - 1);
+            uint32_t n = len - done;
+            if (n > avail) n = avail;
+            if (n > _capacity - at) n = _capacity - at; // Up to the wrap, the rest on the next pass
+            memcpy(out + done, _buffer + at, n);
+            _tail += n;
+            _pos += n;
+            done += n;
+        }
+        if (_capacity - (_head - _tail) >= AUDIO_READ_CHUNK) xTaskNotifyGive(_reader);
+        return done;
+    }
+
+    bool seek(int32_t pos, int dir) override {
+        int64_t target = dir == SEEK_SET ? pos : dir == SEEK_CUR ? (int64_t)_pos + pos : (int64_t)_size + pos;
+        if (target < 0 || target > _size) return false;
+        // Ahead within what was read: skip to it
+        if (target >= _pos && target - _pos <= _head - _tail) {
+            _tail += target - _pos;
+            _pos = target;
+            return true;
+        }
+        xSemaphoreTake(_fileLock, portMAX_DELAY);
+        bool ok = _file.seek(target);
+        if (ok) {
+            _head = _tail = 0;
+            _pos = target;
+            _eof = false;
+        }
+        xSemaphoreGive(_fileLock);
+        xTaskNotifyGive(_reader);
+        return ok;
+    }
+
+    // The engine closes the file with finish(), once the decoder is done
+    bool close() override { return true; }
+    bool isOpen() override { return _open; }
+    uint32_t getSize() override { return _size; }
+    uint32_t getPos() override { return _pos; }
+
+    uint32_t capacity() const { return _capacity; }
+    uint32_t fill() const { return _head - _tail; }
+    uint32_t minFill() const { return _minFill == UINT32_MAX ? fill() : _minFill; }
+    uint32_t bytesRead() const { return _bytesRead; }
+
+    volatile uint32_t underruns = 0;
+
+private:
+    uint8_t *_buffer = nullptr;
+    uint32_t _capacity = 0;
+    volatile uint32_t _head = 0; // Bytes written since start() or the last seek
+    volatile uint32_t _tail = 0; // Bytes read
+    volatile bool _eof = false;
+    volatile bool _open = false;
+    uint32_t _pos = 0; // File position of _tail
+    uint32_t _size = 0;
+    uint32_t _bytesRead = 0;
+    uint32_t _minFill = UINT32_MAX;
+    File _file;
+    SemaphoreHandle_t _fileLock = nullptr;
+    TaskHandle_t _reader = nullptr;
+    TaskHandle_t _decoder = nullptr;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Engine
+/////////////////////////////////////////////////////////////////////////////////////
+static AudioRingSource ring;
+static AudioOutputI2S *output = nullptr;
+static AudioGenerator *generators[AUDIO_FORMATS] = {nullptr};
+static QueueHandle_t trackQueue = nullptr;
+static SemaphoreHandle_t outputLock = nullptr; // Held while something plays
+static SemaphoreHandle_t engineLock = nullptr; // Starting and ending the tasks
+static TaskHandle_t audioTask = nullptr;
+static TaskHandle_t readerTask = nullptr;
+static portMUX_TYPE seqMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t queuedSeq = 0;            // Last track queued
+static volatile uint32_t cutoff = 0;      // Tracks before this one are skipped or stopped
+static volatile uint32_t finishedSeq = 0; // Last track played or skipped
+static volatile bool playing = false;
+static uint32_t tracksPlayed = 0;
+
+static AudioFormat formatOf(String path) {
+    path.toLowerCase(); // case-insensitive match
+    if (path.endsWith(".txt") || path.endsWith(".rtttl")) return AUDIO_RTTTL;
+    if (path.endsWith(".wav")) return AUDIO_WAV;
+    if (path.endsWith(".mod")) return AUDIO_MOD;
+    if (path.endsWith(".opus")) return AUDIO_OPUS;
+    if (path.endsWith(".aac")) return AUDIO_AAC;
+    if (path.endsWith(".flac")) return AUDIO_FLAC;
+    // OGG Vorbis is not supported https://github.com/earlephilhower/ESP8266Audio/issues/84
+    if (path.endsWith(".mp3")) return AUDIO_MP3;
     /* 2FIX: compilation issues
     if(filepath.endsWith(".mid"))  {
       // need to load a soundfont
@@ -50,24 +232,222 @@ bool playAudioFile(FS *fs, String filepath) {
       midi->SetSoundfont(sf2);
       generator = midi;
     } */
-    if (generator && source && audioout) {
-        Serial.println("Start audio");
-        generator->begin(source, audioout);
+    return AUDIO_NONE;
+}
+
+// Created on first use and kept, begin() restarts them on the next track
+static AudioGenerator *generatorFor(AudioFormat format) {
+    if (generators[format]) return generators[format];
+    switch (format) {
+        case AUDIO_WAV: generators[format] = new AudioGeneratorWAV(); break;
+        case AUDIO_MP3: generators[format] = new AudioGeneratorMP3(); break;
+        case AUDIO_AAC: generators[format] = new AudioGeneratorAAC(); break;
+        case AUDIO_FLAC: generators[format] = new AudioGeneratorFLAC(); break;
+        case AUDIO_OPUS: generators[format] = new AudioGeneratorOpus(); break;
+        case AUDIO_MOD: generators[format] = new AudioGeneratorMOD(); break;
+        case AUDIO_RTTTL: generators[format] = new AudioGeneratorRTTTL(); break;
+        default: break;
+    }
+    return generators[format];
+}
+
+// https://github.com/earlephilhower/ESP8266Audio/blob/master/src/AudioOutputI2S.cpp#L32
+static AudioOutputI2S *sharedOutput() {
+    if (!output) {
+        output = new AudioOutputI2S();
+        output->SetPinout(BCLK, WCLK, DOUT, MCLK);
+    }
+    // set volume, derived from https://github.com/earlephilhower/ESP8266Audio/blob/master/examples/WebRadio/WebRadio.ino
+    output->SetGain(((float)bruceConfig.soundVolume) / 100.0);
+    return output;
+}
+
+static bool stopRequested(uint32_t seq) { return seq < cutoff; }
+
+static void markFinished(uint32_t seq) {
+    portENTER_CRITICAL(&seqMux);
+    if ((int32_t)(seq - finishedSeq) > 0) finishedSeq = seq;
+    portEXIT_CRITICAL(&seqMux);
+}
+
+static void playTrack(const AudioTrack &track) {
+    AudioFormat format = formatOf(track.path);
+    AudioGenerator *generator = generatorFor(format);
+    if (!generator) return;
+    File file = track.fs->open(track.path, FILE_READ);
+    if (!file) {
+        Serial.printf("Can't open %s\n", track.path);
+        return;
+    }
+
+    AudioFileSource *source;
+    AudioFileSourceFS *direct = nullptr;
+    AudioFileSourceID3 *id3 = nullptr;
+    if (format == AUDIO_MOD) {
+        // MOD seeks all over the file for its samples, a read-ahead wouldn't help
+        file.close();
+        source = direct = new AudioFileSourceFS(*track.fs, track.path);
+    } else {
+        ring.start(file, readerTask, audioTask);
+        ring.prefill(AUDIO_PREFILL_MS);
+        source = &ring;
+        if (format == AUDIO_MP3) source = id3 = new AudioFileSourceID3(&ring);
+    }
+
+    Serial.println("Start audio");
+    playing = true;
+    tracksPlayed++;
+    if (generator->begin(source, sharedOutput())) {
         while (generator->isRunning()) {
-            if (!generator->loop() || check(AnyKeyPress)) generator->stop();
+            if (stopRequested(track.seq) || !generator->loop()) generator->stop();
+            // The I2S DMA buffers hold a few ms, leave the CPU to the others meanwhile
+            vTaskDelay(1);
         }
-        audioout->stop();
-        source->close();
-        Serial.println("Stop audio");
+    }
+    output->stop();
+    playing = false;
+    Serial.println("Stop audio");
+
+    if (direct) {
+        direct->close();
+        delete direct;
+    } else {
+        delete id3;
+        ring.finish();
+    }
+}
 
-        delete generator;
-        delete source;
-        delete audioout;
+// Idle: gives the ring and both task stacks back, the next track starts them again.
+// False if a track was queued meanwhile.
+static bool audioEnd() {
+    xSemaphoreTake(engineLock, portMAX_DELAY);
+    bool idle = uxQueueMessagesWaiting(trackQueue) == 0;
+    if (idle) {
+        ring.release(readerTask);
+        readerTask = nullptr;
+        audioTask = nullptr;
+    }
+    xSemaphoreGive(engineLock);
+    return idle;
+}
+
+static void audioLoop(void *parameter) {
+    AudioTrack track;
+    for (;;) {
+        if (xQueueReceive(trackQueue, &track, pdMS_TO_TICKS(AUDIO_IDLE_MS)) != pdTRUE) {
+            if (audioEnd()) break;
+            continue;
+        }
+        if (!stopRequested(track.seq)) {
+            xSemaphoreTake(outputLock, portMAX_DELAY);
+            playTrack(track);
+            xSemaphoreGive(outputLock);
+        }
+        markFinished(track.seq);
+    }
+    vTaskDelete(NULL);
+}
+
+static void readerLoop(void *parameter) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(50));
+        ring.fill();
+    }
+}
+
+// Called with engineLock held
+static bool audioBegin() {
+    if (audioTask) return true;
+    if (!ring.allocate()) return false;
+    if (!trackQueue) trackQueue = xQueueCreate(AUDIO_QUEUE_LENGTH, sizeof(AudioTrack));
+    if (!outputLock) outputLock = xSemaphoreCreateMutex();
+    if (!trackQueue || !outputLock) return false;
+    if (!readerTask && xTaskCreate(readerLoop, "AudioReader", 4096, NULL, 3, &readerTask) != pdPASS) {
+        readerTask = nullptr;
+        return false;
+    }
+    // Above the loop task, so the UI doesn't starve the decoder
+    if (xTaskCreate(audioLoop, "Audio", 8192, NULL, 2, &audioTask) != pdPASS) {
+        audioTask = nullptr;
+        return false;
+    }
+    return true;
+}
+
+static bool enqueue(FS *fs, const String &path, bool replace) {
+    if (!bruceConfig.soundEnabled) return false;
+    if (formatOf(path) == AUDIO_NONE || path.length() >= AUDIO_PATH_SIZE) return false;
+    if (!engineLock) engineLock = xSemaphoreCreateMutex();
+    if (!engineLock) return false;
+
+    AudioTrack track;
+    track.fs = fs;
+    strncpy(track.path, path.c_str(), sizeof(track.path));
+    portENTER_CRITICAL(&seqMux);
+    track.seq = ++queuedSeq;
+    if (replace) cutoff = track.seq;
+    portEXIT_CRITICAL(&seqMux);
+
+    // Held until the track is queued, so an idle audio task can't end in between
+    xSemaphoreTake(engineLock, portMAX_DELAY);
+    bool queued = audioBegin();
+    if (queued) {
+        if (replace) xQueueReset(trackQueue);
+        queued = xQueueSend(trackQueue, &track, 0) == pdTRUE;
+    }
+    xSemaphoreGive(engineLock);
+    if (!queued) markFinished(track.seq); // Never going to play, don't look busy for it
+    return queued;
+}
+
+bool audioPlay(FS *fs, const String &path) { return enqueue(fs, path, true); }
 
-        return true;
+bool audioQueue(FS *fs, const String &path) { return enqueue(fs, path, false); }
+
+void audioStop() {
+    portENTER_CRITICAL(&seqMux);
+    cutoff = queuedSeq + 1;
+    portEXIT_CRITICAL(&seqMux);
+    if (trackQueue) xQueueReset(trackQueue);
+    markFinished(queuedSeq);
+}
+
+bool audioBusy() {
+    if (playing || finishedSeq != queuedSeq) return true;
+    return trackQueue && uxQueueMessagesWaiting(trackQueue) > 0;
+}
+
+AudioStats audioStats() {
+    AudioStats stats;
+    stats.playing = playing;
+    stats.queued = trackQueue ? uxQueueMessagesWaiting(trackQueue) : 0;
+    stats.underruns = ring.underruns;
+    stats.bufferSize = ring.capacity();
+    stats.bufferFill = playing ? ring.fill() : 0;
+    stats.minFill = playing ? ring.minFill() : 0;
+    stats.bytesRead = ring.bytesRead();
+    stats.tracks = tracksPlayed;
+    return stats;
+}
+
+// Stops the engine and takes the output, for the players that run on the caller's task
+static AudioOutputI2S *takeOutput() {
+    audioStop();
+    if (outputLock) xSemaphoreTake(outputLock, portMAX_DELAY);
+    return sharedOutput();
+}
+
+static void releaseOutput() {
+    if (outputLock) xSemaphoreGive(outputLock);
+}
+
+bool playAudioFile(FS *fs, String filepath) {
+    if (!audioPlay(fs, filepath)) return false;
+    while (audioBusy()) {
+        if (check(AnyKeyPress)) audioStop();
+        vTaskDelay(pdMS_TO_TICKS(20));
     }
-    // else
-    return false; // init error
+    return true;
 }
 
 bool playAudioRTTTLString(String song) {
@@ -79,31 +459,20 @@ bool playAudioRTTTLString(String song) {
     song.trim();
     if (song == "") return false;
 
-    AudioOutputI2S *audioout = new AudioOutputI2S();
-    audioout->SetPinout(BCLK, WCLK, DOUT, MCLK);
-
-    AudioGenerator *generator = new AudioGeneratorRTTTL();
-
-    AudioFileSource *source = new AudioFileSourcePROGMEM(song.c_str(), song.length());
+    AudioOutputI2S *audioout = takeOutput();
+    AudioGenerator *generator = generatorFor(AUDIO_RTTTL);
+    AudioFileSourcePROGMEM source(song.c_str(), song.length());
 
-    if (generator && source && audioout) {
-        Serial.println("Start audio");
-        generator->begin(source, audioout);
-        while (generator->isRunning()) {
-            if (!generator->loop() || check(AnyKeyPress)) generator->stop();
-        }
-        audioout->stop();
-        source->close();
-        Serial.println("Stop audio");
-
-        delete generator;
-        delete source;
-        delete audioout;
-
-        return true;
+    Serial.println("Start audio");
+    generator->begin(&source, audioout);
+    while (generator->isRunning()) {
+        if (!generator->loop() || check(AnyKeyPress)) generator->stop();
     }
-    // else
-    return false; // init error
+    audioout->stop();
+    source.close();
+    Serial.println("Stop audio");
+    releaseOutput();
+    return true;
 }
 
 bool tts(String text) {
@@ -112,21 +481,23 @@ bool tts(String text) {
     text.trim();
     if (text == "") return false;
 
-    AudioOutputI2S *audioout = new AudioOutputI2S();
-    audioout->SetPinout(BCLK, WCLK, DOUT, MCLK);
+    AudioOutputI2S *audioout = takeOutput();
 
     // https://github.com/earlephilhower/ESP8266SAM/blob/master/examples/Speak/Speak.ino
     audioout->begin();
     ESP8266SAM *sam = new ESP8266SAM;
     sam->Say(audioout, text.c_str());
     delete sam;
+    audioout->stop();
+    releaseOutput();
     return true;
 }
 
 bool isAudioFile(String filepath) {
 
     return filepath.endsWith(".opus") || filepath.endsWith(".rtttl") || filepath.endsWith(".wav") ||
-           filepath.endsWith(".mod") || filepath.endsWith(".mp3");
+           filepath.endsWith(".mod") || filepath.endsWith(".mp3") || filepath.endsWith(".aac") ||
+           filepath.endsWith(".flac");
 }
 
 void playTone(unsigned int frequency, unsigned long duration, short waveType) {
@@ -139,10 +510,9 @@ void playTone(unsigned int frequency, unsigned long duration, short waveType) {
 
     float hz = frequency;
 
-    AudioGeneratorWAV *wav;
+    AudioGenerator *wav;
     AudioFileSourceFunction *file;
-    AudioOutputI2S *out = new AudioOutputI2S();
-    out->SetPinout(BCLK, WCLK, DOUT, MCLK);
+    AudioOutputI2S *out = takeOutput();
 
     file = new AudioFileSourceFunction(duration / 1000.0); // , 1, 44100
     //
@@ -177,16 +547,16 @@ void playTone(unsigned int frequency, unsigned long duration, short waveType) {
     // param  : float (current time [sec] of the song)
     // return : float (the amplitude of sound which varies from -1.f to +1.f)
 
-    wav = new AudioGeneratorWAV();
+    wav = generatorFor(AUDIO_WAV);
     wav->begin(file, out);
 
     while (wav->isRunning()) {
         if (!wav->loop() || check(AnyKeyPress)) wav->stop();
     }
+    out->stop();
+    releaseOutput();
 
     delete file;
-    delete wav;
-    delete out;
 }
 
 #endif
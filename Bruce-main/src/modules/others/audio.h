@@ -1,11 +1,39 @@
-
 #include <SPIFFS.h>
 // Keep SPIFFS first
 
 #include <ESP8266Audio.h>
 #include <ESP8266SAM.h>
 
-bool playAudioFile(FS *fs, String filepath); // TODO: bool async arg -> play in a task?
+/**
+ * Audio files play on a task of their own. A second task reads the file
+ * ahead into a ring buffer (128KB in PSRAM, 16KB without it), so a slow SD
+ * read doesn't starve the decoder, and the caller isn't blocked for the
+ * whole track. The ring and both tasks are freed after 5s with nothing to
+ * play. The I2S output and the decoders are created once and reused.
+ */
+struct AudioStats {
+    bool playing;
+    uint8_t queued;      // Tracks waiting after the current one
+    uint32_t underruns;  // Times the decoder found the buffer empty, since boot
+    uint32_t bufferSize;
+    uint32_t bufferFill; // Bytes read ahead right now
+    uint32_t minFill;    // Lowest fill during the current track
+    uint32_t bytesRead;  // From the current track's file
+    uint32_t tracks;     // Played since boot
+};
+
+// Stops what's playing and plays path, without waiting for it
+bool audioPlay(FS *fs, const String &path);
+// Plays path after the current and queued tracks
+bool audioQueue(FS *fs, const String &path);
+// Stops playback and drops the queue
+void audioStop();
+// A track is playing or queued
+bool audioBusy();
+AudioStats audioStats();
+
+// Plays the file and waits for its end; a key press stops it
+bool playAudioFile(FS *fs, String filepath);
 
 bool playAudioRTTTLString(String song);
 
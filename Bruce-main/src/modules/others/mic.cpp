@@ -15,6 +15,14 @@ static int8_t *i2s_buffer = nullptr;
 static uint8_t *fftHistory = nullptr; // Linear buffer [WIDTH + 1][HEIGHT]
 static uint16_t posData = 0;
 
+// Spectrum view: the capture task fills one buffer while the FFT runs on the other
+static SpectrumEngine spectrum(FFT_SIZE);
+static int16_t *captureBuffer[2] = {nullptr, nullptr};
+static QueueHandle_t filledFrames = nullptr; // Buffers ready for the FFT
+static QueueHandle_t freeFrames = nullptr;   // Buffers ready for i2s_read
+static TaskHandle_t captureTaskHandle = nullptr;
+static volatile bool captureRunning = false;
+
 #ifndef PIN_CLK
 #define PIN_CLK I2S_PIN_NO_CHANGE
 #endif
@@ -92,7 +100,7 @@ bool InitI2SMicroPhone() {
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
         .dma_buf_count = 8,
-        .dma_buf_len = SPECTRUM_HEIGHT,
+        .dma_buf_len = 256,
     };
 
     i2s_pin_config_t pin_config = {
@@ -115,6 +123,46 @@ bool InitI2SMicroPhone() {
     return (err == ESP_OK);
 }
 
+void micCaptureTask(void *) {
+    uint8_t idx;
+    while (captureRunning) {
+        if (xQueueReceive(freeFrames, &idx, pdMS_TO_TICKS(100)) != pdTRUE) continue;
+        size_t bytesread = 0;
+        i2s_read(
+            I2S_NUM_0, (char *)captureBuffer[idx], FFT_SIZE * sizeof(int16_t), &bytesread, pdMS_TO_TICKS(200)
+        );
+        if (bytesread == FFT_SIZE * sizeof(int16_t)) xQueueSend(filledFrames, &idx, 0);
+        else xQueueSend(freeFrames, &idx, 0);
+    }
+    captureTaskHandle = nullptr;
+    vTaskDelete(NULL);
+}
+
+bool startMicCapture() {
+    filledFrames = xQueueCreate(2, sizeof(uint8_t));
+    freeFrames = xQueueCreate(2, sizeof(uint8_t));
+    if (!filledFrames || !freeFrames) return false;
+    for (uint8_t idx = 0; idx < 2; idx++) xQueueSend(freeFrames, &idx, 0);
+
+    captureRunning = true;
+    if (xTaskCreatePinnedToCore(micCaptureTask, "MicCapture", 2048, NULL, 2, &captureTaskHandle, 0) !=
+        pdPASS) {
+        captureRunning = false;
+        captureTaskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void stopMicCapture() {
+    captureRunning = false;
+    // The task finishes its current read and exits, give it up to 500ms
+    for (int i = 0; i < 50 && captureTaskHandle != nullptr; i++) delay(10);
+    if (filledFrames) vQueueDelete(filledFrames);
+    if (freeFrames) vQueueDelete(freeFrames);
+    filledFrames = freeFrames = nullptr;
+}
+
 void mic_test_one_task() {
     tft.fillScreen(TFT_BLACK);
 
@@ -128,6 +176,13 @@ void mic_test_one_task() {
         Serial.println("Error alloc drawing frameBuffer, exiting");
         return;
     }
+
+    // Waterfall colors, indexed by level
+    uint16_t palette[256];
+    for (int i = 0; i < 256; i++) {
+        palette[i] = rgb565(ImageData[i * 3 + 0], ImageData[i * 3 + 1], ImageData[i * 3 + 2]);
+    }
+
     tft.drawRect(
         tftWidth / 2 - SPECTRUM_WIDTH / 2 - 2,
         tftHeight / 2 - SPECTRUM_HEIGHT / 2 - 2,
@@ -135,52 +190,64 @@ void mic_test_one_task() {
         SPECTRUM_HEIGHT + 4,
         bruceConfig.priColor
     );
+    // Only show the frame rate where it doesn't cover the spectrum
+    bool showFps = tftHeight >= SPECTRUM_HEIGHT + 24;
+    tft.setTextSize(1);
+    tft.setTextColor(bruceConfig.priColor, bruceConfig.bgColor);
+    uint32_t lastFps = millis();
+
+    if (!startMicCapture()) {
+        stopMicCapture();
+        free(frameBuffer);
+        displayError("Fail to start capture", true);
+        return;
+    }
 
     while (1) {
-        fft_config_t *plan = fft_init(FFT_SIZE, FFT_REAL, FFT_FORWARD, NULL, NULL);
-        size_t bytesread;
-        i2s_read(I2S_NUM_0, (char *)i2s_buffer, FFT_SIZE * sizeof(int16_t), &bytesread, portMAX_DELAY);
-        int16_t *samples = (int16_t *)i2s_buffer;
-
-        for (int i = 0; i < FFT_SIZE; i++) { plan->input[i] = (float)samples[i] / 32768.0f; }
-
-        fft_execute(plan);
-
-        for (int i = 1; i < FFT_SIZE / 4 && i < SPECTRUM_HEIGHT; i++) {
-            float re = plan->output[2 * i];
-            float im = plan->output[2 * i + 1];
-            float mag = re * re + im * im;
-            if (mag > 1.0f) mag = 1.0f;
-            uint8_t value = map(mag * 2000, 0, 2000, 0, 255);
-            fftHistory[posData * SPECTRUM_HEIGHT + (SPECTRUM_HEIGHT - i)] = value;
-        }
-
-        posData = (posData + 1) % HISTORY_LEN;
-
-        fft_destroy(plan);
+        uint8_t idx;
+        if (xQueueReceive(filledFrames, &idx, pdMS_TO_TICKS(50)) == pdTRUE) {
+            spectrum.process(captureBuffer[idx]);
+            xQueueSend(freeFrames, &idx, 0);
+
+            uint8_t *column = &fftHistory[posData * SPECTRUM_HEIGHT];
+            for (int i = 1; i < FFT_SIZE / 4 && i < SPECTRUM_HEIGHT; i++) {
+                column[SPECTRUM_HEIGHT - i] = spectrum.level(i);
+            }
+            posData = (posData + 1) % HISTORY_LEN;
+            spectrum.countFrame(millis());
 
-        // Render
-        for (int y = 0; y < SPECTRUM_HEIGHT; y++) {
+            // Render, oldest column on the left
             for (int x = 0; x < SPECTRUM_WIDTH; x++) {
-                int index = (x + posData) % HISTORY_LEN;
-                uint8_t val = fftHistory[index * SPECTRUM_HEIGHT + y];
-                uint16_t color =
-                    rgb565(ImageData[val * 3 + 0], ImageData[val * 3 + 1], ImageData[val * 3 + 2]);
-                frameBuffer[y * SPECTRUM_WIDTH + x] = color;
+                int index = x + posData;
+                if (index >= HISTORY_LEN) index -= HISTORY_LEN;
+                const uint8_t *src = &fftHistory[index * SPECTRUM_HEIGHT];
+                uint16_t *dst = &frameBuffer[x];
+                for (int y = 0; y < SPECTRUM_HEIGHT; y++, dst += SPECTRUM_WIDTH) *dst = palette[src[y]];
             }
+
+            tft.pushImage(
+                tftWidth / 2 - SPECTRUM_WIDTH / 2,
+                tftHeight / 2 - SPECTRUM_HEIGHT / 2,
+                SPECTRUM_WIDTH,
+                SPECTRUM_HEIGHT,
+                frameBuffer
+            );
         }
 
-        tft.pushImage(
-            tftWidth / 2 - SPECTRUM_WIDTH / 2,
-            tftHeight / 2 - SPECTRUM_HEIGHT / 2,
-            SPECTRUM_WIDTH,
-            SPECTRUM_HEIGHT,
-            frameBuffer
-        );
+        if (millis() - lastFps >= 1000) {
+            lastFps = millis();
+            if (showFps) {
+                tft.drawString(String(spectrum.framesPerSecond(), 1) + " fps  ", 4, tftHeight - 10);
+            }
+        }
         wakeUpScreen();
         if (check(SelPress) || check(EscPress)) break;
     }
+    stopMicCapture();
     i2s_stop(I2S_NUM_0);
+    Serial.printf(
+        "Mic Spectrum: %lu frames, %.1f fps\n", (unsigned long)spectrum.frames(), spectrum.framesPerSecond()
+    );
     free(frameBuffer);
 }
 
@@ -206,25 +273,25 @@ void mic_test() {
     }
     Serial.println("Mic Spectrum start");
     InitI2SMicroPhone();
-    // Alloc buffers in PSRAM if available
-    if (psramFound()) {
-        i2s_buffer = (int8_t *)ps_malloc(FFT_SIZE * sizeof(int16_t));
-        fftHistory = (uint8_t *)ps_malloc(HISTORY_LEN * SPECTRUM_HEIGHT);
-    } else {
-        i2s_buffer = (int8_t *)malloc(FFT_SIZE * sizeof(int16_t));
-        fftHistory = (uint8_t *)malloc(HISTORY_LEN * SPECTRUM_HEIGHT);
-    }
-    if (!i2s_buffer || !fftHistory) {
+    // Alloc buffers in PSRAM if available, capture buffers are read by DMA so keep them internal
+    if (psramFound()) fftHistory = (uint8_t *)ps_malloc(HISTORY_LEN * SPECTRUM_HEIGHT);
+    else fftHistory = (uint8_t *)malloc(HISTORY_LEN * SPECTRUM_HEIGHT);
+    captureBuffer[0] = (int16_t *)malloc(FFT_SIZE * sizeof(int16_t));
+    captureBuffer[1] = (int16_t *)malloc(FFT_SIZE * sizeof(int16_t));
+    if (!fftHistory || !captureBuffer[0] || !captureBuffer[1] || !spectrum.begin()) {
         displayError("Fail to alloc buffers, exiting", true);
-        return;
+    } else {
+        memset(fftHistory, 0, HISTORY_LEN * SPECTRUM_HEIGHT);
+        posData = 0;
+        mic_test_one_task();
     }
 
-    memset(fftHistory, 0, HISTORY_LEN * SPECTRUM_HEIGHT);
-
-    mic_test_one_task();
-
-    free(i2s_buffer);
+    spectrum.end();
+    free(captureBuffer[0]);
+    free(captureBuffer[1]);
+    captureBuffer[0] = captureBuffer[1] = nullptr;
     free(fftHistory);
+    fftHistory = nullptr;
 
     delay(10);
     if (deinitMicroPhone()) Serial.println("Fail disabling I2S Driver");
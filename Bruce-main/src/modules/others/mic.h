@@ -37,7 +37,7 @@ void mic_function() {
 
 #include "core/display.h"
 #include "driver/i2s.h"
-#include <fft.h>
+#include <SpectrumEngine.h>
 #include <globals.h>
 
 /* Mic */
@@ -105,6 +105,18 @@ void brucegotchi_start() {
     registeredBeacons.clear();          // Clear the registeredBeacon array in case it has something
     vTaskDelay(300 / portTICK_RATE_MS); // Due to select button pressed to enter / quit this feature*
 
+    // Check where to save the Handshakes, before the sniffer starts
+    FS *Fs = &LittleFS;
+    isLittleFS = !setupSdCard();
+    if (!isLittleFS) Fs = &SD;
+    if (!Fs->exists("/BrucePCAP")) Fs->mkdir("/BrucePCAP");
+    if (!Fs->exists("/BrucePCAP/handshakes")) Fs->mkdir("/BrucePCAP/handshakes");
+    // Without it every frame would be dropped, no handshake saved
+    if (!pcapWriterBegin(*Fs)) {
+        displayError("Not enough memory for the pcap writer", true);
+        return;
+    }
+
     brucegotchi_setup(); // Starts the thing
     // Draw footer & header
     drawTopCanvas();
@@ -117,16 +129,6 @@ void brucegotchi_start() {
 #endif
     brucegotchi_update();
 
-    // Check where to save the Handshakes
-    if (setupSdCard()) {
-        isLittleFS = false;
-        if (!SD.exists("/BrucePCAP")) SD.mkdir("/BrucePCAP");
-        if (!SD.exists("/BrucePCAP/handshakes")) SD.mkdir("/BrucePCAP/handshakes");
-    } else {
-        if (!LittleFS.exists("/BrucePCAP")) LittleFS.mkdir("/BrucePCAP");
-        if (!LittleFS.exists("/BrucePCAP/handshakes")) LittleFS.mkdir("/BrucePCAP/handshakes");
-        isLittleFS = true;
-    }
     tmp = millis();
     // LET'S GOOOOO!!!
     while (true) {
@@ -206,5 +208,6 @@ void brucegotchi_start() {
     // Turn off WiFi
     esp_wifi_set_promiscuous(false);
     esp_wifi_set_promiscuous_rx_cb(nullptr);
+    pcapWriterEnd(); // saves the handshakes still queued
     wifiDisconnect();
 }
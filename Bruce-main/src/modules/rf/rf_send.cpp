@@ -2,6 +2,7 @@
 #include "core/type_convertion.h"
 #include "rf_utils.h"
 #include <RCSwitch.h>
+#include <SignalFile.h>
 
 void sendCustomRF() {
     // interactive menu part only
@@ -38,8 +39,6 @@ void sendCustomRF() {
 bool txSubFile(FS *fs, String filepath) {
     struct RfCodes selected_code;
     File databaseFile;
-    String line;
-    String txt;
     int sent = 0;
 
     if (!fs) return false;
@@ -55,35 +54,42 @@ bool txSubFile(FS *fs, String filepath) {
     Serial.println("Opened sub file.");
     selected_code.filepath = filepath.substring(1 + filepath.lastIndexOf("/"));
 
+    FileSignalSource source(databaseFile);
+    SignalReader reader;
+    if (!reader.begin(&source)) {
+        databaseFile.close();
+        displayError("Fail to read file", true);
+        return false;
+    }
+
     std::vector<int> bitList;
     std::vector<int> bitRawList;
     std::vector<uint64_t> keyList;
-    std::vector<String> rawDataList;
+    // RAW_Data lines can be several kB each, only where they are is kept and
+    // each one is read again when it's sent
+    std::vector<uint32_t> rawDataOffsets;
 
-    if (!databaseFile) Serial.println("Fail opening file");
     // Store the code(s) in the signal
-    while (databaseFile.available()) {
-        line = databaseFile.readStringUntil('\n');
-        txt = line.substring(line.indexOf(":") + 1);
-        if (txt.endsWith("\r")) txt.remove(txt.length() - 1);
-        txt.trim();
-        if (line.startsWith("Protocol:")) selected_code.protocol = txt;
-        if (line.startsWith("Preset:")) selected_code.preset = txt;
-        if (line.startsWith("Frequency:")) selected_code.frequency = txt.toInt();
-        if (line.startsWith("TE:")) selected_code.te = txt.toInt();
-        if (line.startsWith("Bit:")) bitList.push_back(txt.toInt()); // selected_code.Bit = txt.toInt();
-        if (line.startsWith("Bit_RAW:"))
-            bitRawList.push_back(txt.toInt()); // selected_code.BitRAW = txt.toInt();
-        if (line.startsWith("Key:"))
-            keyList.push_back(hexStringToDecimal(txt.c_str())
-            ); // selected_code.key = hexStringToDecimal(txt.c_str());
-        if (line.startsWith("RAW_Data:") || line.startsWith("Data_RAW:"))
-            rawDataList.push_back(txt); // selected_code.data = txt;
+    while (reader.next()) {
+        const SignalSpan &value = reader.value();
+        if (reader.is("Protocol")) selected_code.protocol = value.str;
+        else if (reader.is("Preset")) selected_code.preset = value.str;
+        else if (reader.is("Frequency")) selected_code.frequency = value.toInt();
+        else if (reader.is("TE")) selected_code.te = value.toInt();
+        else if (reader.is("Bit")) bitList.push_back(value.toInt());
+        else if (reader.is("Bit_RAW")) bitRawList.push_back(value.toInt());
+        else if (reader.is("Key")) keyList.push_back(hexStringToDecimal(value.str));
+        else if (reader.is("RAW_Data") || reader.is("Data_RAW")) {
+            rawDataOffsets.push_back(reader.lineOffset());
+        }
         if (check(EscPress)) break;
     }
-    int total = bitList.size() + bitRawList.size() + keyList.size() + rawDataList.size() > 0 ? 1 : 0;
+    // RAW_Data is one signal, whatever the number of lines it has
+    int total = bitList.size() + bitRawList.size() + keyList.size() + (rawDataOffsets.empty() ? 0 : 1);
     Serial.printf("Total signals found: %d\n", total);
-    databaseFile.close();
+    if (reader.skippedLines() > 0) {
+        Serial.printf("Skipped %lu lines too long to read\n", (unsigned long)reader.skippedLines());
+    }
 
     // If the signal is complete, send all of the code(s) that were found in it.
     // TODO: try to minimize the overhead between codes.
@@ -110,31 +116,20 @@ bool txSubFile(FS *fs, String filepath) {
             displayTextLine("Sent " + String(sent) + "/" + String(total));
         }
 
-        // RAS_Data is considered one long signal, doesn't matter the number of lines it has
-        if (rawDataList.size() > 0) sent++;
-        for (String rawData : rawDataList) {
-            selected_code.data = rawData;
+        if (rawDataOffsets.size() > 0) sent++;
+        for (uint32_t offset : rawDataOffsets) {
+            if (!reader.seek(offset) || !reader.next()) break;
+            selected_code.data = reader.value().str;
             sendRfCommand(selected_code);
-            // sent++;
             if (check(EscPress)) break;
-            // displayTextLine("Sent " + String(sent) + "/" + String(total));
         }
         addToRecentCodes(selected_code);
     }
+    databaseFile.close();
 
     Serial.printf("\nSent %d of %d signals\n", sent, total);
     displayTextLine("Sent " + String(sent) + "/" + String(total), true);
 
-    // Clear the vectors from memory
-    bitList.clear();
-    bitRawList.clear();
-    keyList.clear();
-    rawDataList.clear();
-    bitList.shrink_to_fit();
-    bitRawList.shrink_to_fit();
-    keyList.shrink_to_fit();
-    rawDataList.shrink_to_fit();
-
     delay(1000);
     deinitRfModule();
     return true;
@@ -142,8 +142,7 @@ bool initRfModule(String mode, float frequency) {
         // else
         // ELECHOUSE_cc1101.setRxBW(812.50);  // reset to default
         ELECHOUSE_cc1101.setRxBW(256);      // narrow band for better accuracy
-        ELECHOUSE_cc1101.setClb(1, 13, 15); // Calibration Offset
-        ELECHOUSE_cc1101.setClb(2, 16, 19); // Calibration Offset
+        for (const uint8_t *clb : RF_CLB) ELECHOUSE_cc1101.setClb(clb[0], clb[1], clb[2]);
         // set modulation mode. 0 = 2-FSK, 1 = GFSK, 2 = ASK/OOK, 3 = 4-FSK, 4 = MSK.
         ELECHOUSE_cc1101.setModulation(2);
         // Set the Data Rate in kBaud. Value from 0.02 to 1621.83. Default is 99.97 kBaud!
@@ -11,6 +11,12 @@
 #define RMT_1MS_TICKS (RMT_1US_TICKS * 1000)
 #define SIGNAL_STRENGTH_THRESHOLD 1500 // Adjust this threshold as needed
 
+// Calibration Offsets given to the driver's setClb(): range, start, end
+const uint8_t RF_CLB[][3] = {
+    {1, 13, 15},
+    {2, 16, 19}
+};
+
 extern const float subghz_frequency_list[57];
 extern const char *subghz_frequency_ranges[];
 extern const int range_limits[4][2];
@@ -1,9 +1,11 @@
 #include "rf_waterfall.h"
+#include <CC1101Sweep.h>
 #ifndef TFT_MOSI
 #define TFT_MOSI -1
 #endif
 float m_rf_waterfall_start_freq = 433.0;
 float m_rf_waterfall_end_freq = 435.0;
+uint8_t m_rf_waterfall_resolution = 1; // Screen pixels per sweep point
 
 void rf_waterfall() {
     if (bruceConfig.rfModule != CC1101_SPI_MODULE) {
@@ -23,6 +25,7 @@ select:
     options = {
         {"Start Freq.", [&]() { option = 1; }},
         {"End Freq.",   [&]() { option = 2; }},
+        {"Resolution",  [&]() { option = 5; }},
         {"Start",       [&]() { option = 3; }},
         {"Main Menu",   [&]() { option = 4; }},
     };
@@ -41,6 +44,9 @@ select:
     } else if (option == 2) {
         rf_waterfall_end_freq();
         goto select;
+    } else if (option == 5) {
+        rf_waterfall_resolution();
+        goto select;
     }
 }
 
@@ -68,18 +74,75 @@ void rf_waterfall_end_freq() {
     options.clear();
 }
 
+void rf_waterfall_resolution() {
+    // Fewer points per sweep, more sweeps per second
+    options = {
+        {"Fine (1px)",   [=]() { m_rf_waterfall_resolution = 1; }, m_rf_waterfall_resolution == 1},
+        {"Normal (2px)", [=]() { m_rf_waterfall_resolution = 2; }, m_rf_waterfall_resolution == 2},
+        {"Fast (4px)",   [=]() { m_rf_waterfall_resolution = 4; }, m_rf_waterfall_resolution == 4},
+    };
+    loopOptions(options);
+    options.clear();
+}
+
 uint16_t swapBytes(uint16_t c) { return (c >> 8) | (c << 8); }
 
+// Display color of each RSSI, -128..127 dBm, already byte swapped for pushImage
+static uint16_t rssiPalette[256];
+
+static void buildRssiPalette() {
+    static bool built = false;
+    if (built) return;
+    for (int i = 0; i < 256; i++) {
+        int rawLevel = map(i - 128, -100, -30, 0, 255);
+        int level = 255 - constrain(rawLevel, 0, 255);
+
+        uint8_t r = 0, g = 0, b = 0;
+        if (level <= 63) {
+            b = map(level, 0, 63, 64, 255);
+        } else if (level <= 127) {
+            g = map(level, 64, 127, 0, 255);
+            b = map(level, 64, 127, 255, 0);
+        } else if (level <= 191) {
+            r = map(level, 128, 191, 0, 255);
+            g = 255;
+        } else {
+            r = 255;
+            g = map(level, 192, 255, 255, 0);
+        }
+        rssiPalette[i] = swapBytes(tft.color565(r, g, b));
+    }
+    built = true;
+}
+
+// Paints the pixels of one sweep point in the waterfall line
+static void drawSweepPoint(const CC1101Sweep &sweep, uint16_t *line, uint16_t point, int rssi) {
+    uint16_t color = rssiPalette[constrain(rssi, -128, 127) + 128];
+    uint16_t x = point * sweep.pixelsPerPoint();
+    uint16_t end = x + sweep.pixelsPerPoint();
+    if (end > sweep.columns()) end = sweep.columns();
+    for (; x < end; x++) line[x] = color;
+}
+
 void rf_waterfall_run() {
     float f_start = m_rf_waterfall_start_freq;
     float f_end = m_rf_waterfall_end_freq;
     const int screen_width = tft.width();
     const int screen_height = tft.height();
     const int display_top = screen_height / 5;
-    float f_freq_step;
-
-    // Alloc framebuffer
-    uint16_t frameBuffer[screen_width] = {0};
+    // To make sure CC1101 shared with TFT works properly on T-Embed
+    const bool sharedBus = bruceConfigPins.CC1101_bus.mosi == TFT_MOSI;
+    const uint32_t settleUs = sharedBus ? 150 : 100; // T-Embed case, need more time to process
+
+    CC1101Sweep sweep;
+    for (const uint8_t *clb : RF_CLB) sweep.setClb(clb[0], clb[1], clb[2]);
+    uint16_t *lineBuffer = (uint16_t *)calloc(screen_width, sizeof(uint16_t));
+    if (!lineBuffer || !sweep.plan(f_start, f_end, screen_width, m_rf_waterfall_resolution)) {
+        free(lineBuffer);
+        displayError("Not enough memory", true);
+        return;
+    }
+    buildRssiPalette();
 
     int current_line = display_top;
     initRfModule("rx", f_start);
@@ -87,12 +150,11 @@ void rf_waterfall_run() {
     float max_freq = f_start;
     int max_rssi = -100;
     unsigned long lastMaxUpdate = millis();
+    unsigned long lastRateUpdate = millis();
 
     tft.fillRect(0, 0, screen_width, display_top, TFT_BLACK);
 
     int selected_item = 0;
-    bool exitting = false;
-    unsigned long exit_time = 0;
 
     while (1) {
         for (int i = 0; i < 4; i++) {
@@ -113,8 +175,6 @@ void rf_waterfall_run() {
             tft.print(String(f_freq, 1));
         }
 
-        f_freq_step = (f_end - f_start) / screen_width;
-
         float temp_max_freq = f_start;
         int temp_max_rssi = -100;
 
@@ -127,66 +187,38 @@ void rf_waterfall_run() {
         else if (range > 0.1) step = 0.01;
         else step = 0.001;
 
-        for (int i = 0; i < screen_width; ++i) {
-            float f_freq = f_start + i * f_freq_step;
-            setMHZ(f_freq);
-            // To make sure CC1101 shared with TFT works properly on T-Embed
-            if (bruceConfigPins.CC1101_bus.mosi == TFT_MOSI) {
-                tft.drawPixel(0, 0, 0);
-                delayMicroseconds(150); // T-Embed case, need more time to process
-            } else delayMicroseconds(100);
-
-            int i_rssi = ELECHOUSE_cc1101.getRssi();
-            // To make sure CC1101 shared with TFT works properly on T-Embed
-            if (bruceConfigPins.CC1101_bus.mosi == TFT_MOSI) tft.drawPixel(0, 0, 0);
-            if (i_rssi > temp_max_rssi) {
-                temp_max_rssi = i_rssi;
-                temp_max_freq = f_freq;
-            }
-
-            int rawLevel = map(i_rssi, -100, -30, 0, 255);
-            int level = 255 - constrain(rawLevel, 0, 255);
-
-            uint8_t r = 0, g = 0, b = 0;
-            if (level <= 63) {
-                b = map(level, 0, 63, 64, 255);
-            } else if (level <= 127) {
-                g = map(level, 64, 127, 0, 255);
-                b = map(level, 64, 127, 255, 0);
-            } else if (level <= 191) {
-                r = map(level, 128, 191, 0, 255);
-                g = 255;
+        // Retune, then paint the previous point while the RSSI of this one settles
+        int last_rssi = -100;
+        for (uint16_t i = 0; i < sweep.points(); ++i) {
+            const CC1101Sweep::Point &point = sweep.point(i);
+            if (sweep.sameBand(i)) {
+                ELECHOUSE_cc1101.SpiWriteBurstReg(CC1101_FREQ2, (byte *)point.freq, sizeof(point.freq));
+                // What the driver's calibration would write for this frequency
+                if (point.fsctrl0 != sweep.point(i - 1).fsctrl0) {
+                    ELECHOUSE_cc1101.SpiWriteReg(CC1101_FSCTRL0, point.fsctrl0);
+                }
             } else {
-                r = 255;
-                g = map(level, 192, 255, 255, 0);
+                setMHZ(point.mhz);
             }
+            uint32_t tunedAt = micros();
+            if (sharedBus) tft.drawPixel(0, 0, 0);
 
-            uint16_t color = tft.color565(r, g, b);
-            frameBuffer[i] = swapBytes(color);
-            if (check(SelPress)) {
-                selected_item++;
-                if (selected_item > 2) selected_item = 0;
-            }
+            if (i > 0) drawSweepPoint(sweep, lineBuffer, i - 1, last_rssi);
+            while (micros() - tunedAt < settleUs) {}
 
-            if (check(UpPress) || check(NextPress)) {
-                switch (selected_item) {
-                    case 0: f_start += step; break;
-                    case 1: f_end += step; break;
-                    case 2: return;
-                }
-                delay(100);
-            } else if (check(DownPress) || check(PrevPress)) {
-                switch (selected_item) {
-                    case 0: f_start -= step; break;
-                    case 1: f_end -= step; break;
-                    case 2: return;
-                }
-                if (EscPress) EscPress = false; // Reset for StickCs
-                delay(100);
+            int i_rssi = ELECHOUSE_cc1101.getRssi();
+            if (sharedBus) tft.drawPixel(0, 0, 0);
+            if (i_rssi > temp_max_rssi) {
+                temp_max_rssi = i_rssi;
+                temp_max_freq = point.mhz;
             }
+            last_rssi = i_rssi;
         }
+        drawSweepPoint(sweep, lineBuffer, sweep.points() - 1, last_rssi);
+        sweep.countSweep(millis());
+
         tft.drawPixel(0, 0, 0); // Cardputer Case, need to call something to the tft.
-        tft.pushImage(0, current_line, screen_width, 1, frameBuffer);
+        tft.pushImage(0, current_line, screen_width, 1, lineBuffer);
         tft.drawFastHLine(0, current_line + 1, screen_width, TFT_DARKGREY);
 
         if (millis() - lastMaxUpdate >= 5000) {
@@ -199,6 +231,13 @@ void rf_waterfall_run() {
             tft.printf("%d dBm @ %.3f", max_rssi, max_freq);
 
             lastMaxUpdate = millis();
+            lastRateUpdate = 0; // was just cleared
+        }
+        if (millis() - lastRateUpdate >= 1000) {
+            tft.setTextSize(1);
+            tft.setTextColor(TFT_DARKCYAN, TFT_BLACK);
+            tft.drawRightString(" " + String(sweep.sweepsPerSecond(), 1) + " sw/s", screen_width - 3, 10, 1);
+            lastRateUpdate = millis();
         }
 
         tft.setCursor(3, 20);
@@ -213,12 +252,46 @@ void rf_waterfall_run() {
             tft.print("EXIT");
         }
 
-        if (check(EscPress)) break;
+        if (check(SelPress)) {
+            selected_item++;
+            if (selected_item > 2) selected_item = 0;
+        }
+
+        bool exit = false;
+        bool retune = false;
+        float prev_start = f_start, prev_end = f_end;
+        if (check(UpPress) || check(NextPress)) {
+            switch (selected_item) {
+                case 0: f_start += step; break;
+                case 1: f_end += step; break;
+                case 2: exit = true; break;
+            }
+            retune = true;
+            delay(100);
+        } else if (check(DownPress) || check(PrevPress)) {
+            switch (selected_item) {
+                case 0: f_start -= step; break;
+                case 1: f_end -= step; break;
+                case 2: exit = true; break;
+            }
+            retune = true;
+            if (EscPress) EscPress = false; // Reset for StickCs
+            delay(100);
+        }
+        if (exit || check(EscPress)) break;
+        if (retune && !sweep.plan(f_start, f_end, screen_width, m_rf_waterfall_resolution)) {
+            // Moved out of the CC1101 range, keep the last span
+            f_start = prev_start;
+            f_end = prev_end;
+            sweep.plan(f_start, f_end, screen_width, m_rf_waterfall_resolution);
+        }
 
         current_line++;
         if (current_line >= screen_height) current_line = display_top;
     }
 
+    Serial.printf("Waterfall: %.1f sweeps/s, %u points\n", sweep.sweepsPerSecond(), sweep.points());
+    free(lineBuffer);
     returnToMenu = true;
     rmt_rx_stop(RMT_RX_CHANNEL);
     deinitRMT();
@@ -4,9 +4,11 @@
 
 void rf_waterfall_start_freq();
 void rf_waterfall_end_freq();
+void rf_waterfall_resolution();
 void rf_waterfall_run();
 
 extern float m_rf_waterfall_start_freq;
 extern float m_rf_waterfall_end_freq;
+extern uint8_t m_rf_waterfall_resolution;
 
 void rf_waterfall();
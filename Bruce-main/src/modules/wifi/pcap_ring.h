@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Lock-free single producer / single consumer ring of pcap records.
+ *
+ * The producer is the Wi-Fi promiscuous callback, which must never block, so
+ * it only copies the frame in (or counts a drop when there's no room). The
+ * consumer is the pcap writer task, which does all the file I/O.
+ * Records are stored contiguously, a padding record fills the end of the
+ * buffer when the next record doesn't fit, so the consumer can hand a record
+ * straight to File::write().
+ * No Arduino dependencies, the storage is provided by the caller.
+ */
+class PcapRing {
+public:
+    enum Kind : uint8_t {
+        PAD = 0,        // Unused space up to the end of the buffer
+        RAW,            // Goes to the raw capture file
+        HANDSHAKE_NEW,  // First frame of a new handshake file
+        HANDSHAKE,      // Appended to an existing handshake file
+    };
+
+    struct Record {
+        uint16_t size;   // Ring bytes taken, header included, multiple of 4
+        uint8_t kind;    // Kind
+        uint8_t channel; // Channel it was captured on
+        uint8_t ap[6];   // Access point, names the handshake file
+        uint16_t reserved;
+        // pcap record header, immediately followed by the frame
+        uint32_t tsSec;
+        uint32_t tsUsec;
+        uint32_t inclLen;
+        uint32_t origLen;
+
+        const uint8_t *pcap() const { return (const uint8_t *)&tsSec; }
+        size_t pcapSize() const { return 16 + inclLen; }
+        const uint8_t *frame() const { return (const uint8_t *)(this + 1); }
+    };
+    static_assert(sizeof(Record) == 28, "Record must stay packed and 4 byte aligned");
+
+    static const uint16_t MAX_FRAME = 4096; // 802.11 frames are well under this
+
+    // capacity must be a power of two, buffer 4 byte aligned
+    bool begin(uint8_t *buffer, uint32_t capacity) {
+        if (!buffer || capacity < 1024 || (capacity & (capacity - 1))) return false;
+        _buffer = buffer;
+        _capacity = capacity;
+        reset();
+        return true;
+    }
+
+    void end() {
+        _buffer = nullptr;
+        _capacity = 0;
+    }
+
+    void reset() {
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+        _captured.store(0, std::memory_order_relaxed);
+        _dropped.store(0, std::memory_order_relaxed);
+    }
+
+    // Producer side. Never blocks, returns false and counts a drop if it's full.
+    bool push(
+        Kind kind, const uint8_t *ap, uint8_t channel, uint32_t tsSec, uint32_t tsUsec, const uint8_t *frame,
+        uint16_t len
+    ) {
+        const uint32_t need = (sizeof(Record) + len + 3) & ~3U;
+        if (!_buffer || len > MAX_FRAME || need > _capacity / 2) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        const uint32_t tail = _tail.load(std::memory_order_acquire);
+        uint32_t pos = head & (_capacity - 1);
+        const uint32_t toEnd = _capacity - pos;
+        const uint32_t total = need + (toEnd < need ? toEnd : 0);
+        if (_capacity - (head - tail) < total) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (toEnd < need) {
+            Record *pad = (Record *)&_buffer[pos];
+            pad->size = toEnd;
+            pad->kind = PAD;
+            head += toEnd;
+            pos = 0;
+        }
+        Record *rec = (Record *)&_buffer[pos];
+        rec->size = need;
+        rec->kind = kind;
+        rec->channel = channel;
+        if (ap) memcpy(rec->ap, ap, sizeof(rec->ap));
+        else memset(rec->ap, 0, sizeof(rec->ap));
+        rec->reserved = 0;
+        rec->tsSec = tsSec;
+        rec->tsUsec = tsUsec;
+        rec->inclLen = len;
+        rec->origLen = len;
+        memcpy(rec + 1, frame, len);
+        _head.store(head + need, std::memory_order_release);
+        _captured.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer side. The oldest record, or nullptr if there's none.
+    const Record *peek() {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        const uint32_t head = _head.load(std::memory_order_acquire);
+        while (tail != head) {
+            const Record *rec = (const Record *)&_buffer[tail & (_capacity - 1)];
+            if (rec->kind != PAD) return rec;
+            tail += rec->size;
+            _tail.store(tail, std::memory_order_release);
+        }
+        return nullptr;
+    }
+
+    // Consumer side. Frees the record returned by peek().
+    void pop(const Record *rec) {
+        _tail.store(_tail.load(std::memory_order_relaxed) + rec->size, std::memory_order_release);
+    }
+
+    uint32_t capacity() const { return _capacity; }
+    uint32_t used() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+    uint32_t captured() const { return _captured.load(std::memory_order_relaxed); }
+    uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    uint8_t *_buffer = nullptr;
+    uint32_t _capacity = 0;
+    std::atomic<uint32_t> _head{0}; // Only written by the producer
+    std::atomic<uint32_t> _tail{0}; // Only written by the consumer
+    std::atomic<uint32_t> _captured{0};
+    std::atomic<uint32_t> _dropped{0};
+};
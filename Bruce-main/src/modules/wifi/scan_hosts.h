@@ -15,6 +15,7 @@ struct Host {
     Host(ip4_addr_t *ip, eth_addr *eth) : ip(ip->addr), mac(MAC(eth->addr)) {}
     IPAddress ip;
     String mac;
+    String vendor; // Filled by getManufacturers() when there's an offline table
 };
 
 #endif
@@ -33,6 +33,7 @@
 #include <SdFat.h>
 #endif
 #include "modules/wifi/wifi_atks.h" // to use deauth frames and cmds
+#include "pcap_ring.h"
 
 //===== SETTINGS =====//
 #define CHANNEL 1
@@ -43,6 +44,10 @@
 #define HOP_INTERVAL 214     // in ms (only necessary if channelHopping is true)
 #define DEAUTH_INTERVAL (15*1000)  //Send deauth packets every ms
 #define EAPOL_ONLY true
+#define PCAP_RING_PSRAM (256 * 1024) // capture ring size when there's PSRAM
+#define PCAP_RING_SRAM (32 * 1024)   // and when there isn't
+#define PCAP_BLOCK_SIZE 4096         // raw file writes end on these boundaries
+#define PCAP_HS_FILES 4              // handshake files kept open by the writer
 
 //===== Run-Time variables =====//
 unsigned long lastTime = 0;
@@ -65,6 +70,26 @@ std::set<BeaconList> registeredBeacons;
 std::set<String> SavedHS; // Saves the MAC of beacon HS detected in the session
 String filename = "/BrucePCAP/" + (String)FILENAME + ".pcap";
 
+// The promiscuous callback only copies frames into the ring, the writer task
+// drains it and does all the file I/O
+struct PcapHandshakeFile {
+    uint8_t ap[6];
+    File file;
+    uint32_t lastUse;
+};
+static PcapRing pcapRing;
+static uint8_t *pcapRingBuffer = nullptr;
+static uint8_t *pcapBlock = nullptr;
+static size_t pcapBlockUsed = 0;
+static uint32_t pcapFileSize = 0; // bytes already in the raw file
+static uint32_t pcapFlushed = 0;  // bytes written to all files
+static PcapHandshakeFile pcapHsFiles[PCAP_HS_FILES];
+static FS *pcapFs = nullptr;
+static TaskHandle_t pcapWriterHandle = nullptr;
+static SemaphoreHandle_t pcapFileMutex = nullptr;
+static volatile bool pcapWriterRunning = false;
+static volatile bool pcapStorageFull = false;
+
 //===== FUNCTIONS =====//
 
 // Thank you 7h30th3r0n3 for helping me solve this issue! and for sharing your EAPOL/Handshake sniffer
@@ -107,7 +132,7 @@ typedef struct pcaprec_hdr_s {
     uint32_t orig_len; /* longueur réelle du paquet */
 } pcaprec_hdr_t;
 
-void saveHandshake(const wifi_promiscuous_pkt_t *packet, bool beacon, FS &Fs) {
+void saveHandshake(const wifi_promiscuous_pkt_t *packet, bool beacon) {
     // Construire le nom du fichier en utilisant les adresses MAC de l'AP et du client
     const uint8_t *addr1 = packet->payload + 4;  // Adresse du destinataire (Adresse 1)
     const uint8_t *addr2 = packet->payload + 10; // Adresse de l'expéditeur (Adresse 2)
@@ -120,18 +145,6 @@ void saveHandshake(const wifi_promiscuous_pkt_t *packet, bool beacon, FS &Fs) {
         apAddr = addr2;
     }
 
-    char nomFichier[50];
-    sprintf(
-        nomFichier,
-        "/BrucePCAP/handshakes/HS_%02X%02X%02X%02X%02X%02X.pcap",
-        apAddr[0],
-        apAddr[1],
-        apAddr[2],
-        apAddr[3],
-        apAddr[4],
-        apAddr[5]
-    );
-
     // Vérifier si le fichier existe déjà
     bool fichierExiste = false;
 
@@ -141,40 +154,33 @@ void saveHandshake(const wifi_promiscuous_pkt_t *packet, bool beacon, FS &Fs) {
     // Si probe est true et que le fichier n'existe pas, ignorer l'enregistrement
     if (beacon && !fichierExiste) { return; }
 
-    // Ouvrir le fichier en mode ajout si existant sinon en mode écriture
-    File fichierPcap = Fs.open(
-        nomFichier, fichierExiste ? FILE_APPEND : FILE_WRITE
-    ); // if the file already exists in the new session, will overwrite it
-    if (!fichierPcap) {
-        Serial.println("Fail creating the EAPOL/Handshake PCAP file");
-        return;
-    }
-
-    if (!beacon && !fichierExiste) {
-        // Serial.println("New EAPOL/Handshake PCAP file, writing header");
-        SavedHS.insert(String((char *)apAddr, 6));
-        num_HS++;
-        writeHeader(fichierPcap);
-    }
-    if (beacon && fichierExiste) {
-        BeaconList ThisBeacon;
+    BeaconList ThisBeacon;
+    if (beacon) {
         memcpy(ThisBeacon.MAC, (char *)apAddr, 6);
         ThisBeacon.channel = ch;
         if (registeredBeacons.find(ThisBeacon) != registeredBeacons.end()) {
             return; // Beacon déjà enregistré pour ce BSSID
         }
-        registeredBeacons.insert(ThisBeacon); // Ajouter le BSSID à l'ensemble
     }
 
-    // Écrire l'en-tête du paquet et le paquet lui-même dans le fichier
-    pcaprec_hdr_t pcap_packet_header;
-    pcap_packet_header.ts_sec = packet->rx_ctrl.timestamp / 1000000;
-    pcap_packet_header.ts_usec = packet->rx_ctrl.timestamp % 1000000;
-    pcap_packet_header.incl_len = packet->rx_ctrl.sig_len;
-    pcap_packet_header.orig_len = packet->rx_ctrl.sig_len;
-    fichierPcap.write((const byte *)&pcap_packet_header, sizeof(pcaprec_hdr_t));
-    fichierPcap.write(packet->payload, packet->rx_ctrl.sig_len);
-    fichierPcap.close();
+    // The writer task creates the file (header included) or appends to it. Only count the
+    // handshake once the frame is queued, a dropped first frame must not leave a headerless file
+    if (!pcapRing.push(
+            fichierExiste ? PcapRing::HANDSHAKE : PcapRing::HANDSHAKE_NEW,
+            apAddr,
+            ch,
+            packet->rx_ctrl.timestamp / 1000000,
+            packet->rx_ctrl.timestamp % 1000000,
+            packet->payload,
+            packet->rx_ctrl.sig_len
+        ))
+        return;
+
+    if (!fichierExiste) {
+        SavedHS.insert(String((char *)apAddr, 6));
+        num_HS++;
+    }
+    if (beacon) registeredBeacons.insert(ThisBeacon); // Ajouter le BSSID à l'ensemble
 }
 
 void printAddress(const uint8_t *addr) {
@@ -189,50 +195,211 @@ void printAddress(const uint8_t *addr) {
 void newPacketSD(uint32_t ts_sec, uint32_t ts_usec, uint32_t len, uint8_t *buf, File pcap_file) {
     if (pcap_file) {
 
-        uint32_t orig_len = len;
-        uint32_t incl_len = len;
-        // if(incl_len > snaplen) incl_len = snaplen; /* safty check that the packet isn't too big (I ran into
-        // problems here) */
-
-        pcap_file.write((uint8_t *)&ts_sec, sizeof(ts_sec));
-        pcap_file.write((uint8_t *)&ts_usec, sizeof(ts_usec));
-        pcap_file.write((uint8_t *)&incl_len, sizeof(incl_len));
-        pcap_file.write((uint8_t *)&orig_len, sizeof(orig_len));
-
-        pcap_file.write(buf, incl_len);
+        pcaprec_hdr_t header = {ts_sec, ts_usec, len, len};
+        pcap_file.write((const uint8_t *)&header, sizeof(header));
+        pcap_file.write(buf, len);
     }
 }
 
+// pcap global header
+typedef struct pcap_hdr_s {
+    uint32_t magic_number;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t network;
+} pcap_hdr_t;
+
 bool writeHeader(File file) {
-    uint32_t magic_number = 0xa1b2c3d4;
-    uint16_t version_major = 2;
-    uint16_t version_minor = 4;
-    uint32_t thiszone = 0;
-    uint32_t sigfigs = 0;
-    uint32_t snaplen = 2500;
-    uint32_t network = 105;
+    // 802.11 frames, 2500 bytes snaplen
+    const pcap_hdr_t header = {0xa1b2c3d4, 2, 4, 0, 0, 2500, 105};
 
     if (file) {
-
-        file.write((uint8_t *)&magic_number, sizeof(magic_number));
-        file.write((uint8_t *)&version_major, sizeof(version_major));
-        file.write((uint8_t *)&version_minor, sizeof(version_minor));
-        file.write((uint8_t *)&thiszone, sizeof(thiszone));
-        file.write((uint8_t *)&sigfigs, sizeof(sigfigs));
-        file.write((uint8_t *)&snaplen, sizeof(snaplen));
-        file.write((uint8_t *)&network, sizeof(network));
-
+        file.write((const uint8_t *)&header, sizeof(header));
         return true;
     }
     return false;
 }
 
+//===== WRITER TASK =====//
+
+// Writes the buffered raw capture bytes
+static void pcapBlockWrite() {
+    if (pcapBlockUsed == 0) return;
+    size_t written = _pcap_file ? _pcap_file.write(pcapBlock, pcapBlockUsed) : 0;
+    pcapFileSize += written;
+    pcapFlushed += written;
+    if (written != pcapBlockUsed) pcapStorageFull = true;
+    pcapBlockUsed = 0;
+}
+
+// Buffers raw capture bytes, writing each time the file reaches a block boundary
+static void pcapBlockAppend(const uint8_t *data, size_t len) {
+    while (len > 0) {
+        size_t room = PCAP_BLOCK_SIZE - (pcapFileSize + pcapBlockUsed) % PCAP_BLOCK_SIZE;
+        size_t n = len < room ? len : room;
+        memcpy(pcapBlock + pcapBlockUsed, data, n);
+        pcapBlockUsed += n;
+        data += n;
+        len -= n;
+        if (n == room) pcapBlockWrite();
+    }
+}
+
+// Handshake file for this AP, kept open while it's one of the last PCAP_HS_FILES used
+static File *pcapHandshakeFile(const uint8_t *ap, bool create) {
+    PcapHandshakeFile *slot = nullptr;
+    for (auto &hs : pcapHsFiles) {
+        if (hs.file && memcmp(hs.ap, ap, 6) == 0) {
+            slot = &hs;
+            break;
+        }
+    }
+    if (slot && !create) {
+        slot->lastUse = millis();
+        return &slot->file;
+    }
+    if (!slot) {
+        slot = &pcapHsFiles[0];
+        for (auto &hs : pcapHsFiles) {
+            if (!hs.file) {
+                slot = &hs;
+                break;
+            }
+            if (hs.lastUse < slot->lastUse) slot = &hs;
+        }
+    }
+    if (slot->file) slot->file.close();
+
+    char nomFichier[50];
+    sprintf(
+        nomFichier,
+        "/BrucePCAP/handshakes/HS_%02X%02X%02X%02X%02X%02X.pcap",
+        ap[0],
+        ap[1],
+        ap[2],
+        ap[3],
+        ap[4],
+        ap[5]
+    );
+    // if the file already exists in the new session, will overwrite it
+    slot->file = pcapFs->open(nomFichier, create ? FILE_WRITE : FILE_APPEND);
+    if (!slot->file) {
+        Serial.println("Fail creating the EAPOL/Handshake PCAP file");
+        return nullptr;
+    }
+    if (create) writeHeader(slot->file);
+    memcpy(slot->ap, ap, 6);
+    slot->lastUse = millis();
+    return &slot->file;
+}
+
+static void pcapWriteRecord(const PcapRing::Record *rec) {
+    if (rec->kind == PcapRing::RAW) {
+        if (fileOpen) pcapBlockAppend(rec->pcap(), rec->pcapSize());
+        return;
+    }
+    File *file = pcapHandshakeFile(rec->ap, rec->kind == PcapRing::HANDSHAKE_NEW);
+    if (file) pcapFlushed += file->write(rec->pcap(), rec->pcapSize());
+}
+
+// Pushes everything to the card, called with pcapFileMutex held
+static void pcapFlushFiles() {
+    pcapBlockWrite();
+    if (_pcap_file) _pcap_file.flush();
+    for (auto &hs : pcapHsFiles)
+        if (hs.file) hs.file.flush();
+}
+
+static void pcapWriterTask(void *param) {
+    uint32_t lastFlush = millis();
+    uint32_t lastSizeCheck = 0;
+    bool running = true;
+    while (running) {
+        running = pcapWriterRunning; // one last pass to drain the ring once stopped
+        xSemaphoreTake(pcapFileMutex, portMAX_DELAY);
+        const PcapRing::Record *rec;
+        while ((rec = pcapRing.peek()) != nullptr) {
+            pcapWriteRecord(rec);
+            pcapRing.pop(rec);
+        }
+        if (!running || millis() - lastFlush > 1000) {
+            pcapFlushFiles();
+            lastFlush = millis();
+        }
+        xSemaphoreGive(pcapFileMutex);
+
+        // Used to be checked on every packet by the callback
+        if (isLittleFS && millis() - lastSizeCheck > 1000) {
+            lastSizeCheck = millis();
+            if (!checkLittleFsSizeNM()) pcapStorageFull = true;
+        }
+        if (running) vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+    pcapWriterHandle = nullptr;
+    vTaskDelete(NULL);
+}
+
+bool pcapWriterBegin(FS &Fs) {
+    if (pcapWriterHandle) return true;
+    pcapFs = &Fs;
+
+    uint32_t size = psramFound() ? PCAP_RING_PSRAM : PCAP_RING_SRAM;
+    while (!pcapRingBuffer && size >= 8192) {
+        pcapRingBuffer = (uint8_t *)(psramFound() ? ps_malloc(size) : malloc(size));
+        if (!pcapRingBuffer) size /= 2;
+    }
+    if (!pcapBlock) pcapBlock = (uint8_t *)malloc(PCAP_BLOCK_SIZE);
+    if (!pcapFileMutex) pcapFileMutex = xSemaphoreCreateMutex();
+    if (!pcapRingBuffer || !pcapBlock || !pcapFileMutex || !pcapRing.begin(pcapRingBuffer, size)) {
+        Serial.println("Not enough memory for the pcap writer");
+        pcapWriterEnd();
+        return false;
+    }
+
+    pcapBlockUsed = 0;
+    pcapFlushed = 0;
+    pcapStorageFull = false;
+    pcapWriterRunning = true;
+    if (xTaskCreatePinnedToCore(pcapWriterTask, "PcapWriter", 4096, NULL, 2, &pcapWriterHandle, 1) !=
+        pdPASS) {
+        pcapWriterRunning = false;
+        pcapWriterHandle = nullptr;
+        pcapWriterEnd();
+        return false;
+    }
+    return true;
+}
+
+// Call with the promiscuous callback already removed
+void pcapWriterEnd() {
+    pcapWriterRunning = false;
+    // The task drains the ring and flushes before leaving
+    for (int i = 0; i < 200 && pcapWriterHandle != nullptr; i++) vTaskDelay(10 / portTICK_PERIOD_MS);
+    if (pcapWriterHandle) return; // still busy with the card, keep its buffers
+
+    for (auto &hs : pcapHsFiles)
+        if (hs.file) hs.file.close();
+    fileOpen = false;
+    _pcap_file.close();
+    pcapRing.end();
+    free(pcapRingBuffer);
+    free(pcapBlock);
+    pcapRingBuffer = nullptr;
+    pcapBlock = nullptr;
+}
+
+uint32_t pcapCaptured() { return pcapRing.captured(); }
+uint32_t pcapDropped() { return pcapRing.dropped(); }
+uint32_t pcapBytesFlushed() { return pcapFlushed; }
+
 /* will be executed on every packet the ESP32 gets while beeing in promiscuous mode */
 // Sniffer callback
 void sniffer(void *buf, wifi_promiscuous_pkt_type_t type) {
-    // If using LittleFS to save .pcaps and there's no room for data, don't do anything whith new packets
-  
-    if (isLittleFS && !checkLittleFsSizeNM()) {
+    // If the writer task ran out of room for data, don't do anything whith new packets
+    if (pcapStorageFull) {
         returnToMenu = true;
         esp_wifi_set_promiscuous(false);
         return;
@@ -257,8 +424,7 @@ void sniffer(void *buf, wifi_promiscuous_pkt_type_t type) {
         // printAddress(receiverAddr);
         // Serial.print("Address MAC expedition: ");
         // printAddress(senderAddr);
-        if (isLittleFS) saveHandshake(pkt, false, LittleFS);
-        else saveHandshake(pkt, false, SD);
+        saveHandshake(pkt, false);
     }
 
     // Beacon frame
@@ -268,8 +434,7 @@ void sniffer(void *buf, wifi_promiscuous_pkt_type_t type) {
         
         pkt->rx_ctrl.sig_len -= 4; // cut off last 4 b
         // save the packet
-        if(isLittleFS) saveHandshake(pkt, true, LittleFS);
-	else           saveHandshake(pkt, true, SD);
+        saveHandshake(pkt, true);
 
 	//Save beacon to the list
 	BeaconList ThisBeacon;
@@ -294,9 +459,8 @@ void sniffer(void *buf, wifi_promiscuous_pkt_type_t type) {
             len -= 4; // Remove last 4 bytes (for checksum) or packet gets malformed 
                       // https://github.com/espressif/esp-idf/issues/886
         }
-        newPacketSD(
-            timestamp, microseconds, len, pkt->payload, _pcap_file
-		    ); // write packet to sd
+        // queue it for the writer task
+        pcapRing.push(PcapRing::RAW, nullptr, ch, timestamp, microseconds, pkt->payload, len);
     }
 }
 
@@ -332,6 +496,8 @@ void openFile(FS &Fs) {
     }
     if (!Fs.exists("/BrucePCAP/handshakes")) Fs.mkdir("/BrucePCAP/handshakes");
     _pcap_file = Fs.open(filename, FILE_WRITE);
+    pcapBlockUsed = 0;
+    pcapFileSize = sizeof(pcap_hdr_t);
     if (_pcap_file) {
         fileOpen = writeHeader(_pcap_file);
         // Serial.println("opened: " + filename);
@@ -341,6 +507,17 @@ void openFile(FS &Fs) {
     }
 }
 
+// Closes the raw file and starts the next one, without racing the writer task
+void pcapNewFile(FS &Fs) {
+    if (pcapFileMutex) xSemaphoreTake(pcapFileMutex, portMAX_DELAY);
+    pcapBlockWrite();
+    fileOpen = false;
+    _pcap_file.close();
+    c++;
+    openFile(Fs);
+    if (pcapFileMutex) xSemaphoreGive(pcapFileMutex);
+}
+
 //===== SETUP =====//
 void sniffer_setup() {
     FS *Fs;
@@ -359,6 +536,10 @@ void sniffer_setup() {
     } else Fs = &LittleFS; // if not, use the internal memory.
 
     openFile(*Fs);
+    if (!pcapWriterBegin(*Fs)) {
+        displayError("Not enough memory", true);
+        return;
+    }
     displayTextLine("Sniffing Started");
     tft.setTextSize(FP);
     tft.setCursor(80, 100);
@@ -445,7 +626,6 @@ void sniffer_setup() {
             }
             if (millis() - _tmp > 700) { // longpress detected to exit
                 returnToMenu = true;
-                _pcap_file.close();
                 break;
             }
 #endif
@@ -469,7 +649,6 @@ void sniffer_setup() {
     ) // T-Embed has a different btn for Escape, different from StickCs that uses Previous btn
         if (check(EscPress)) { // Apertar o botão power ou Esc
             returnToMenu = true;
-            _pcap_file.close();
             break;
         }
 #endif
@@ -478,17 +657,7 @@ void sniffer_setup() {
                 options = {
                     {"New File",
                      [=]() {
-                         if (_pcap_file) { // for the first run, only draws the screen, after that, changes
-                                           // files
-                             _pcap_file.flush(); // save file
-                             // Serial.println("==================");
-                             // Serial.println(filename + " saved!");
-                             // Serial.println("==================");
-                             fileOpen = false; // update flag
-                             _pcap_file.close();
-                             c++;           // add to filename
-                             openFile(*Fs); // open new file
-                         }
+                         if (fileOpen) pcapNewFile(*Fs); // saves the current file and opens the next one
                      }                                                                          },
                     {deauth ? "Disable deauth" : "Enable deauth",      [&]() { deauth = !deauth; }    },
                     {_only_HS ? "All packets" : "EAPOL/HS only", [=]() { _only_HS = !_only_HS; }},
@@ -534,6 +703,7 @@ void sniffer_setup() {
 	  padprintln("Run time " + String(runtime/60) + ":" + String(runtime%60));
 	  //padprintln("millis=" + String(millis()));
 	  padprintln("Beacons " + String(beacon_frames) + " tot. /" + String(registeredBeacons.size()) + " in mem.");
+	  padprintln("Saved " + String(pcapBytesFlushed() / 1024) + "kB, dropped " + String(pcapDropped()));
 
 	  // make a nice reverse video bar
 	  tft.setTextColor(bruceConfig.bgColor, bruceConfig.priColor);
@@ -546,12 +716,7 @@ void sniffer_setup() {
 	}
 
 	if (currentTime - lastTime > 100) tft.drawPixel(0, 0, 0);
-
-        if (fileOpen && currentTime - lastTime > 1000) {
-	  _pcap_file.flush();     // save file
-            lastTime = currentTime; // update time
-            
-        }
+        if (currentTime - lastTime > 1000) lastTime = currentTime; // files are flushed by the writer task
 
         if (deauth && (millis() - deauth_tmp) > DEAUTH_INTERVAL) {
 	  bool deauth_sent = false;
@@ -588,6 +753,7 @@ Exit:
     esp_wifi_set_promiscuous(false);
     esp_wifi_stop();
     esp_wifi_set_promiscuous_rx_cb(NULL);
+    pcapWriterEnd(); // saves what is still queued and closes the files
     esp_wifi_deinit();
     wifiDisconnect();
     vTaskDelay(1 / portTICK_RATE_MS);
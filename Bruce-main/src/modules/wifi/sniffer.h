@@ -39,3 +39,13 @@ bool writeHeader(File file);
 void sniffer_setup();
 
 void sniffer(void *buf, wifi_promiscuous_pkt_type_t type);
+
+// Writer task that saves what sniffer() captures, files are created on Fs
+bool pcapWriterBegin(FS &Fs);
+void pcapWriterEnd();
+void pcapNewFile(FS &Fs);
+
+// Frames queued and dropped by sniffer(), bytes written by the writer task
+uint32_t pcapCaptured();
+uint32_t pcapDropped();
+uint32_t pcapBytesFlushed();
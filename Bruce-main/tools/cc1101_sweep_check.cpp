@@ -0,0 +1,185 @@
+// Host check of the CC1101 waterfall's sweep plan (lib/CC1101Sweep) against the driver's setMHZ().
+//
+//   SRC="tools/cc1101_sweep_check.cpp lib/CC1101Sweep/CC1101Sweep.cpp"
+//   g++ -O2 -Ilib/CC1101Sweep $SRC -o cc1101_sweep_check
+//   ./cc1101_sweep_check
+//
+// Models the registers the waterfall touches on a CC1101 and sweeps a set of
+// spans two ways: calling setMHZ() on every point, as the waterfall used to,
+// and the way rf_waterfall_run() does now (setMHZ() when the band changes,
+// else a FREQ burst plus FSCTRL0 when it differs). After every point both
+// radios must have the same FSCTRL0, TEST0 and antenna, and the planned FREQ
+// word must match the driver's loop or be closer to the point's frequency.
+// The setMHZ() and Calibrate() models follow src/modules/rf/rf_utils.cpp and
+// SmartRC-CC1101-Driver-Lib, with the clb offsets initRfModule() sets.
+// Exits non-zero if a check fails.
+#include "CC1101Sweep.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const uint8_t CLB[][3] = {
+    {1, 13, 15},
+    {2, 16, 19}
+};
+
+// Arduino's map()
+static long arduinoMap(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+struct Radio {
+    uint32_t freq = 0;
+    int fsctrl0 = -1; // -1 never written
+    int test0 = -1;
+    int antenna = 200;
+    uint8_t clb[4][2] = {
+        {24, 28},
+        {31, 38},
+        {65, 76},
+        {77, 79}
+    };
+
+    // The driver's frequency loop
+    static uint32_t driverWord(float mhz) {
+        uint8_t freq2 = 0, freq1 = 0, freq0 = 0;
+        for (;;) {
+            if (mhz >= 26) {
+                mhz -= 26;
+                freq2++;
+            } else if (mhz >= 0.1015625) {
+                mhz -= 0.1015625;
+                freq1++;
+            } else if (mhz >= 0.00039675) {
+                mhz -= 0.00039675;
+                freq0++;
+            } else {
+                break;
+            }
+        }
+        return (uint32_t)freq2 << 16 | (uint32_t)freq1 << 8 | freq0;
+    }
+
+    void calibrate(float MHz) {
+        if (MHz >= 300 && MHz <= 348) {
+            fsctrl0 = arduinoMap(MHz, 300, 348, clb[0][0], clb[0][1]);
+            test0 = MHz < 322.88 ? 0x0B : 0x09;
+        } else if (MHz >= 378 && MHz <= 464) {
+            fsctrl0 = arduinoMap(MHz, 378, 464, clb[1][0], clb[1][1]);
+            test0 = MHz < 430.5 ? 0x0B : 0x09;
+        } else if (MHz >= 779 && MHz <= 899.99) {
+            fsctrl0 = arduinoMap(MHz, 779, 899, clb[2][0], clb[2][1]);
+            test0 = MHz < 861 ? 0x0B : 0x09;
+        } else if (MHz >= 900 && MHz <= 928) {
+            fsctrl0 = arduinoMap(MHz, 900, 928, clb[3][0], clb[3][1]);
+            test0 = 0x09;
+        }
+    }
+
+    // Bruce's setMHZ(), T-Embed antenna switch included
+    void setMHZ(float frequency) {
+        if (frequency <= 350 && antenna != 0) antenna = 0;
+        else if (frequency > 350 && frequency < 468 && antenna != 1) antenna = 1;
+        else if (frequency > 778 && antenna != 2) antenna = 2;
+        freq = driverWord(frequency);
+        calibrate(frequency);
+    }
+};
+
+static int failures = 0;
+
+static void sweepSpan(float start, float end, uint16_t columns, uint8_t pixelsPerPoint) {
+    CC1101Sweep sweep;
+    Radio before, now;
+    for (const uint8_t *clb : CLB) {
+        sweep.setClb(clb[0], clb[1], clb[2]);
+        before.clb[clb[0] - 1][0] = now.clb[clb[0] - 1][0] = clb[1];
+        before.clb[clb[0] - 1][1] = now.clb[clb[0] - 1][1] = clb[2];
+    }
+    if (!sweep.plan(start, end, columns, pixelsPerPoint)) {
+        printf("%7.2f-%7.2f MHz: no plan\n", start, end);
+        failures++;
+        return;
+    }
+
+    const double step = CC1101Sweep::XTAL_HZ / 65536.0 / 1000000.0;
+    uint16_t setMHZCalls = 0, fsctrl0Writes = 0, mismatches = 0, words = 0;
+    for (int pass = 0; pass < 2; pass++) { // The second sweep starts from where the first ended
+        for (uint16_t i = 0; i < sweep.points(); i++) {
+            const CC1101Sweep::Point &p = sweep.point(i);
+            before.setMHZ(p.mhz);
+            if (sweep.sameBand(i)) {
+                now.freq = (uint32_t)p.freq[0] << 16 | (uint32_t)p.freq[1] << 8 | p.freq[2];
+                if (p.fsctrl0 != sweep.point(i - 1).fsctrl0) {
+                    now.fsctrl0 = p.fsctrl0;
+                    fsctrl0Writes++;
+                }
+            } else {
+                now.setMHZ(p.mhz);
+                setMHZCalls++;
+            }
+
+            if (now.fsctrl0 != before.fsctrl0 || now.test0 != before.test0 || now.antenna != before.antenna) {
+                if (mismatches++ == 0) {
+                    printf(
+                        "  at %.4f MHz FSCTRL0 %d/%d TEST0 %d/%d antenna %d/%d (setMHZ/plan)\n",
+                        p.mhz,
+                        before.fsctrl0,
+                        now.fsctrl0,
+                        before.test0,
+                        now.test0,
+                        before.antenna,
+                        now.antenna
+                    );
+                }
+            }
+            // The planned word is the closest to p.mhz, the driver's loop may land a step off
+            double planned = fabs(now.freq * step - p.mhz), driver = fabs(before.freq * step - p.mhz);
+            uint32_t diff = now.freq > before.freq ? now.freq - before.freq : before.freq - now.freq;
+            if (diff > 1 || planned > driver + 1e-9) words++;
+        }
+    }
+    printf(
+        "%7.2f-%7.2f MHz, %3u px, %u px/point: %3u points, %3u setMHZ, %3u FSCTRL0 writes per 2 sweeps",
+        start,
+        end,
+        columns,
+        pixelsPerPoint,
+        sweep.points(),
+        setMHZCalls,
+        fsctrl0Writes
+    );
+    if (mismatches || words) {
+        printf(", %u register and %u FREQ mismatches FAIL\n", mismatches, words);
+        failures++;
+    } else {
+        printf(", ok\n");
+    }
+}
+
+int main() {
+    const float spans[][2] = {
+        {280.0f, 928.0f},
+        {300.0f, 350.0f},
+        {315.0f, 325.0f},
+        {340.0f, 390.0f},
+        {425.0f, 440.0f},
+        {433.0f, 434.8f},
+        {460.0f, 470.0f},
+        {770.0f, 790.0f},
+        {850.0f, 870.0f},
+        {868.0f, 868.6f},
+        {895.0f, 905.0f},
+        {899.5f, 900.5f},
+        {902.0f, 928.0f},
+    };
+    const uint16_t widths[] = {240, 320};
+    const uint8_t resolutions[] = {1, 2, 4};
+    for (const auto &span : spans) {
+        for (uint16_t width : widths) {
+            for (uint8_t px : resolutions) sweepSpan(span[0], span[1], width, px);
+        }
+    }
+    printf("%s\n", failures ? "FAILED" : "all spans match setMHZ()");
+    return failures ? 1 : 0;
+}
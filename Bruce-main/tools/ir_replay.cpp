@@ -0,0 +1,238 @@
+// Host replay of held IR button presses through the two IR Read capture paths.
+//
+//   IR=.pio/libdeps/<env>/IRremoteESP8266
+//   SRC="tools/ir_replay.cpp lib/IrFrames/IrFrames.cpp $IR/src/*.cpp"
+//   g++ -O2 -DUNIT_TEST -I$IR/src -I$IR/test -Ilib/IrFrames $SRC -o ir_replay
+//   ./ir_replay [trials] [load]
+//
+// Each press is a protocol frame with repeats, sent by IRremoteESP8266 into a
+// recorder, with the remote's own timing spread and per edge jitter. load is
+// the probability that an edge interrupt is held back by other interrupts
+// (Wi-Fi, BLE, flash writes), 0.05 by default.
+//
+// ISR:        IRrecv's GPIO interrupt timestamps every edge when it runs; an
+//             edge that comes before the interrupt of the previous one ran is
+//             lost. IR Read decodes the first capture.
+// RMT:        edges timestamped in hardware at 2 us, pulses under 2.5 us
+//             filtered out, captures split after 50 ms idle like IRrecv.
+//             "first" decodes the first capture, "clustered" the canonical
+//             capture of the press from IrFrameClusters.
+//
+// Prints the decode success rate of each path, the interrupts each takes per
+// press, and the host time of the clustering.
+#include "IRrecv.h"
+#include "IRsend.h"
+#include "IrFrames.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+static const uint32_t GAP_US = 50000; // IR Read's IRrecv timeout, and the RMT idle threshold
+static const uint32_t FILTER_US = 2;  // RMT glitch filter, pulses up to this are dropped
+static const uint16_t BUFFER = 1024;  // Durations a capture can hold
+static const uint16_t RMT_MAX = 512;  // ESP32, 4 RMT memory blocks
+
+// Marks and spaces IRsend produces, mark first
+class Recorder : public IRsend {
+public:
+    std::vector<uint32_t> durations;
+
+    Recorder() : IRsend(0) {}
+    uint16_t mark(uint16_t usec) override {
+        push(usec, true);
+        return 1;
+    }
+    void space(uint32_t usec) override { push(usec, false); }
+    void _delayMicroseconds(uint32_t) override {}
+
+private:
+    void push(uint32_t usec, bool mark) {
+        if (usec == 0 || (durations.empty() && !mark)) return;
+        bool markNext = durations.size() % 2 == 0;
+        if (mark == markNext) durations.push_back(usec);
+        else durations.back() += usec;
+    }
+};
+
+struct Protocol {
+    const char *name;
+    std::function<void(IRsend &, uint16_t repeats)> send;
+};
+
+static const Protocol PROTOCOLS[] = {
+    {"NEC",        [](IRsend &s, uint16_t r) { s.sendNEC(0x20DF10EF, 32, r); }               },
+    {"Samsung",    [](IRsend &s, uint16_t r) { s.sendSAMSUNG(0xE0E040BF, 32, r); }           },
+    {"Sony12",     [](IRsend &s, uint16_t r) { s.sendSony(0xA90, 12, r + 2); }               },
+    {"RC5",        [](IRsend &s, uint16_t r) { s.sendRC5(s.encodeRC5(0x00, 0x0C), 12, r); } },
+    {"RC6",        [](IRsend &s, uint16_t r) { s.sendRC6(0x1000C, 20, r); }                  },
+    {"Panasonic",  [](IRsend &s, uint16_t r) { s.sendPanasonic64(0x40040100BCBD, 48, r); }   },
+    {"LG",         [](IRsend &s, uint16_t r) { s.sendLG(0x8808440, 28, r); }                },
+    {"JVC",        [](IRsend &s, uint16_t r) { s.sendJVC(0xC5E8, 16, r); }                   },
+};
+
+struct Decoded {
+    bool ok = false;
+    decode_type_t type = UNKNOWN;
+    uint64_t value = 0;
+    uint16_t bits = 0;
+};
+
+// durations in us, as IRrecv would have stored them
+static Decoded decode(IRrecv &irrecv, const std::vector<uint32_t> &durations) {
+    static uint16_t rawbuf[BUFFER + 1];
+    Decoded d;
+    if (durations.empty() || durations.size() > BUFFER) return d;
+    rawbuf[0] = GAP_US / kRawTick;
+    for (size_t i = 0; i < durations.size(); i++) {
+        uint32_t ticks = durations[i] / kRawTick;
+        rawbuf[i + 1] = ticks > UINT16_MAX ? UINT16_MAX : ticks;
+    }
+    decode_results results;
+    results.rawbuf = rawbuf;
+    results.rawlen = durations.size() + 1;
+    results.overflow = false;
+    if (!irrecv.decode(&results)) return d;
+    d.ok = results.decode_type != UNKNOWN;
+    d.type = results.decode_type;
+    d.value = results.value;
+    d.bits = results.bits;
+    return d;
+}
+
+static bool same(const Decoded &a, const Decoded &b) {
+    return a.ok && b.ok && a.type == b.type && a.value == b.value && a.bits == b.bits;
+}
+
+// Captures split where nothing happened for GAP_US, from edge times
+static std::vector<std::vector<uint32_t>> split(const std::vector<uint64_t> &edges, uint32_t tick) {
+    std::vector<std::vector<uint32_t>> captures;
+    std::vector<uint32_t> current;
+    for (size_t i = 1; i < edges.size(); i++) {
+        uint64_t d = edges[i] - edges[i - 1];
+        if (d >= GAP_US) {
+            captures.push_back(current);
+            current.clear();
+            continue;
+        }
+        current.push_back(d / tick * tick);
+    }
+    if (!current.empty() || edges.size() > 0) captures.push_back(current);
+    return captures;
+}
+
+int main(int argc, char **argv) {
+    int trials = argc > 1 ? atoi(argv[1]) : 500;
+    double load = argc > 2 ? atof(argv[2]) : 0.05;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    IRrecv irrecv(0, BUFFER, GAP_US / 1000);
+    IrFrameClusters clusters;
+
+    printf("%d presses per protocol, held for 1-5 repeats, load %.2f\n\n", trials, load);
+    printf("%-10s %8s %8s %10s %9s %9s\n", "", "ISR", "RMT", "RMT", "ISR", "RMT");
+    printf(
+        "%-10s %8s %8s %10s %9s %9s\n", "protocol", "decoded", "first", "clustered", "irq/press", "irq/press"
+    );
+
+    double clusterSeconds = 0;
+    long clusterPresses = 0;
+    for (const Protocol &protocol : PROTOCOLS) {
+        Recorder clean;
+        protocol.send(clean, 0);
+        if (clean.durations.size() % 2 == 0) clean.durations.pop_back(); // The silence after it
+        Decoded expected = decode(irrecv, clean.durations);
+        if (!expected.ok) {
+            printf("%-10s doesn't decode without noise, skipped\n", protocol.name);
+            continue;
+        }
+
+        int isrOk = 0, firstOk = 0, clusteredOk = 0;
+        long isrIrqs = 0, rmtIrqs = 0;
+        for (int t = 0; t < trials; t++) {
+            Recorder press;
+            protocol.send(press, 1 + rng() % 5);
+
+            // The remote's clock is a few % off, and the receiver adds jitter to each edge
+            double skew = 1 + (uniform(rng) - 0.5) * 0.06;
+            std::vector<uint64_t> edges{0};
+            for (uint32_t d : press.durations) {
+                double jitter = (uniform(rng) - 0.5) * 20;
+                edges.push_back(edges.back() + std::max(1.0, d * skew + jitter));
+            }
+            edges.pop_back(); // The last space is the silence after the press
+            // Ambient light glitches, a pulse of a couple of us in some spaces
+            std::vector<uint64_t> withGlitches;
+            for (size_t i = 0; i < edges.size(); i++) {
+                withGlitches.push_back(edges[i]);
+                if (i % 2 == 1 && i + 1 < edges.size() && uniform(rng) < load / 5) {
+                    uint64_t at = (edges[i] + edges[i + 1]) / 2;
+                    withGlitches.push_back(at);
+                    withGlitches.push_back(at + 1);
+                }
+            }
+
+            // ISR: every edge interrupts when it gets to run
+            std::vector<uint64_t> seen;
+            uint64_t lastRun = 0;
+            for (uint64_t edge : withGlitches) {
+                if (!seen.empty() && edge <= lastRun) continue; // Merged with the pending interrupt
+                double latency = 1 + uniform(rng) * 2;
+                if (uniform(rng) < load) latency += 20 + uniform(rng) * 180;
+                lastRun = edge + latency;
+                seen.push_back(lastRun);
+            }
+            auto isrCaptures = split(seen, kRawTick);
+            isrIrqs += seen.size() + isrCaptures.size(); // Edges, and the timeout timer
+            if (same(decode(irrecv, isrCaptures[0]), expected)) isrOk++;
+
+            // RMT: hardware timestamps, glitches filtered out
+            std::vector<uint64_t> filtered;
+            for (size_t i = 0; i < withGlitches.size(); i++) {
+                if (i + 1 < withGlitches.size() && withGlitches[i + 1] - withGlitches[i] <= FILTER_US) {
+                    i++;
+                    continue;
+                }
+                filtered.push_back(withGlitches[i]);
+            }
+            auto rmtCaptures = split(filtered, kRawTick);
+            rmtIrqs += rmtCaptures.size(); // One at the end of each capture
+            if (rmtCaptures[0].size() <= RMT_MAX && same(decode(irrecv, rmtCaptures[0]), expected)) firstOk++;
+
+            auto start = std::chrono::steady_clock::now();
+            clusters.clear();
+            std::vector<uint16_t> capture;
+            for (auto &c : rmtCaptures) {
+                if (c.size() > RMT_MAX) continue;
+                capture.assign(c.begin(), c.end());
+                clusters.add(capture.data(), capture.size());
+            }
+            static uint16_t canonical[BUFFER];
+            uint16_t n = clusters.canonical(canonical, BUFFER);
+            clusterSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            clusterPresses++;
+            if (same(decode(irrecv, {canonical, canonical + n}), expected)) clusteredOk++;
+        }
+        printf(
+            "%-10s %7.1f%% %7.1f%% %9.1f%% %9.1f %9.1f\n",
+            protocol.name,
+            100.0 * isrOk / trials,
+            100.0 * firstOk / trials,
+            100.0 * clusteredOk / trials,
+            (double)isrIrqs / trials,
+            (double)rmtIrqs / trials
+        );
+    }
+    printf("\nclustering: %.1f us per press on this host\n", clusterSeconds * 1e6 / clusterPresses);
+
+    // The raw text IR Read saves
+    Recorder nec;
+    nec.sendNEC(0x20DF10EF);
+    std::vector<uint16_t> durations(nec.durations.begin(), nec.durations.end());
+    char text[16];
+    irFormatRaw(text, sizeof(text), durations.data(), durations.size());
+    printf("raw, cut to %zu bytes: \"%s\"\n", sizeof(text), text);
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Host benchmark of the offline vendor lookup (lib/OuiTable), on a table from oui_pack.py.
+//
+//   g++ -O2 -Ilib/OuiTable tools/oui_bench.cpp lib/OuiTable/OuiTable.cpp -o oui_bench
+//   ./oui_bench oui.bin
+//
+// Prints lookups/s with the table in memory (as a mapped flash partition) and
+// read through a callback (as a file on SD), for single and batched lookups.
+// First checks that begin() turns down the table cut short and with a section
+// or the pool moved past its end, exits non-zero if it doesn't.
+#include "OuiTable.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static bool readFile(void *context, uint32_t offset, uint8_t *out, uint32_t len) {
+    FILE *f = (FILE *)context;
+    return fseek(f, offset, SEEK_SET) == 0 && fread(out, 1, len, f) == len;
+}
+
+// begin() must refuse every damaged copy of the table
+static int checkHeader(const std::vector<uint8_t> &data) {
+    int failures = 0;
+    auto expectRejected = [&](const char *what, std::vector<uint8_t> copy, size_t size) {
+        OuiTable table;
+        if (table.begin(copy.data(), size)) {
+            printf("accepted a table with %s\n", what);
+            failures++;
+        }
+    };
+    auto withU32 = [&](size_t at, uint32_t value) {
+        std::vector<uint8_t> copy(data);
+        for (int i = 0; i < 4; i++) copy[at + i] = value >> (8 * i);
+        return copy;
+    };
+    expectRejected("its last byte cut", data, data.size() - 1);
+    expectRejected("no room for the header", data, 20);
+    for (int s = 0; s < 3; s++) {
+        expectRejected("a count too big", withU32(4 + 4 * s, 0x10000000), data.size());
+        expectRejected("a section past the end", withU32(16 + 4 * s, data.size()), data.size());
+        expectRejected("a section in the header", withU32(16 + 4 * s, 0), data.size());
+    }
+    expectRejected("the pool past the end", withU32(28, data.size()), data.size());
+    expectRejected("a pool too big", withU32(32, 0xFFFFFFF0), data.size());
+    return failures;
+}
+
+static void run(const char *label, OuiTable &table, const std::vector<uint8_t> &macs, bool batch) {
+    size_t count = macs.size() / 6;
+    char name[OUI_NAME_MAX];
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    OuiTable::Hint hint;
+    for (size_t i = 0; i < count; i++) {
+        if (table.lookup(&macs[i * 6], name, sizeof(name), batch ? &hint : nullptr)) found++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%-28s %8.0f lookups/s  (%zu of %zu found)\n", label, count / seconds, found, count);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s oui.bin [lookups]\n", argv[0]);
+        return 1;
+    }
+    FILE *f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) data.insert(data.end(), buffer, buffer + n);
+
+    OuiTable memory;
+    if (!memory.begin(data.data(), data.size())) {
+        fprintf(stderr, "%s: not an OUI table\n", argv[1]);
+        return 1;
+    }
+    OuiTable file;
+    file.begin(readFile, f, data.size());
+    printf("%u prefixes, %zu bytes\n", memory.count(), data.size());
+    if (checkHeader(data)) return 1;
+
+    // Universally administered unicast MACs, about half of them registered
+    size_t count = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1000000;
+    std::mt19937 rng(1);
+    std::vector<uint8_t> macs(count * 6);
+    uint32_t mal = data[4] | (data[5] << 8) | (data[6] << 16) | (data[7] << 24);
+    uint32_t malOffset = data[16] | (data[17] << 8) | (data[18] << 16) | (data[19] << 24);
+    for (size_t i = 0; i < count; i++) {
+        uint8_t *mac = &macs[i * 6];
+        for (int b = 0; b < 6; b++) mac[b] = rng();
+        if (mal && (i & 1)) memcpy(mac, &data[malOffset + (rng() % mal) * 6], 3);
+        mac[0] &= 0xFC;
+    }
+    run("memory, one by one", memory, macs, false);
+    std::vector<uint8_t> few(macs.begin(), macs.begin() + std::min(count, (size_t)20000) * 6);
+    run("file, one by one", file, few, false);
+
+    // Batches are looked up in ascending order
+    std::vector<std::array<uint8_t, 6>> sorted(count);
+    for (size_t i = 0; i < count; i++) memcpy(sorted[i].data(), &macs[i * 6], 6);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<uint8_t> ordered(count * 6);
+    for (size_t i = 0; i < count; i++) memcpy(&ordered[i * 6], sorted[i].data(), 6);
+    run("memory, sorted batch", memory, ordered, true);
+
+    fclose(f);
+    return 0;
+}
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Packs the IEEE MAC registries into the table lib/OuiTable reads.
+
+    oui_pack.py --download -o oui.bin
+    oui_pack.py oui.csv mam.csv oui36.csv -o oui.bin
+
+Copy oui.bin to the root of the SD card or LittleFS, or flash it to a data
+partition labelled "oui" for memory mapped lookups:
+
+    parttool.py write_partition --partition-name oui --input oui.bin
+
+The CSVs are the IEEE ones (Registry,Assignment,Organization Name,...), from
+https://standards-oui.ieee.org/ (oui/oui.csv, oui28/mam.csv, oui36/oui36.csv).
+"""
+import argparse
+import csv
+import io
+import struct
+import sys
+import urllib.request
+
+REGISTRIES = {
+    "https://standards-oui.ieee.org/oui/oui.csv": "MA-L",
+    "https://standards-oui.ieee.org/oui28/mam.csv": "MA-M",
+    "https://standards-oui.ieee.org/oui36/oui36.csv": "MA-S",
+}
+SECTIONS = {6: 0, 7: 1, 9: 2}  # hex digits of the assignment -> section
+PREFIX_BYTES = (3, 4, 5)
+HEADER = struct.Struct("<4s3I3I2I")
+NAME_MAX = 47  # OUI_NAME_MAX in OuiTable.h, minus the terminator
+
+
+def download(url):
+    request = urllib.request.Request(url, headers={"User-Agent": "Mozilla/5.0"})
+    with urllib.request.urlopen(request) as response:
+        return response.read().decode("utf-8", errors="replace")
+
+
+def read_rows(text):
+    for row in csv.DictReader(io.StringIO(text)):
+        assignment = (row.get("Assignment") or "").strip().upper()
+        name = " ".join((row.get("Organization Name") or "").split())
+        if len(assignment) in SECTIONS and name:
+            yield assignment, name
+
+
+def pack(rows, name_max):
+    sections = ({}, {}, {})
+    for assignment, name in rows:
+        # Cut on a character boundary
+        name = name.encode()[:name_max].decode(errors="ignore").encode()
+        sections[SECTIONS[len(assignment)]][int(assignment, 16)] = name
+
+    pool = bytearray()
+    offsets = {}
+    records = []
+    for index, section in enumerate(sections):
+        data = bytearray()
+        for prefix in sorted(section):
+            name = section[prefix]
+            if name not in offsets:
+                offsets[name] = len(pool)
+                pool += name + b"\0"
+            data += prefix.to_bytes(PREFIX_BYTES[index], "big")
+            data += offsets[name].to_bytes(3, "little")
+        records.append(bytes(data))
+    if len(pool) >= 1 << 24:
+        sys.exit("vendor pool over 16 MB")
+
+    counts = [len(s) for s in sections]
+    offset = HEADER.size
+    section_offsets = []
+    for data in records:
+        section_offsets.append(offset)
+        offset += len(data)
+    header = HEADER.pack(b"OUI1", *counts, *section_offsets, offset, len(pool))
+    return header + b"".join(records) + bytes(pool), counts, len(offsets)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("csv", nargs="*", help="IEEE registry CSVs")
+    parser.add_argument("--download", action="store_true", help="fetch the registries from the IEEE")
+    parser.add_argument("--name-max", type=int, default=NAME_MAX, help="cut vendor names to this many bytes")
+    parser.add_argument("-o", "--output", default="oui.bin")
+    args = parser.parse_args()
+
+    texts = []
+    if args.download:
+        texts += [download(url) for url in REGISTRIES]
+    for path in args.csv:
+        with open(path, encoding="utf-8", errors="replace") as f:
+            texts.append(f.read())
+    if not texts:
+        parser.error("give registry CSVs or --download")
+
+    rows = [row for text in texts for row in read_rows(text)]
+    table, counts, names = pack(rows, min(args.name_max, NAME_MAX))
+    with open(args.output, "wb") as f:
+        f.write(table)
+    print(
+        f"{args.output}: {counts[0]} MA-L, {counts[1]} MA-M, {counts[2]} MA-S prefixes, "
+        f"{names} vendors, {len(table)} bytes"
+    )
+
+
+if __name__ == "__main__":
+    main()
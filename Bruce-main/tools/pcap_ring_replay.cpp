@@ -0,0 +1,175 @@
+// Host replay of captured frames through the sniffer's pcap ring (src/modules/wifi/pcap_ring.h).
+//
+//   g++ -O2 -pthread -Isrc/modules/wifi tools/pcap_ring_replay.cpp -o pcap_ring_replay
+//   ./pcap_ring_replay [capture.pcap] [ring bytes] [frames]
+//
+// A producer thread pushes the frames of capture.pcap (or random frames of
+// 24-2346 bytes) as the promiscuous callback would. A consumer thread drains
+// the ring into 4 KiB blocks that end on block boundaries, like the sniffer's
+// writer task, into a pcap in memory. That pcap is then parsed back: every
+// frame the ring accepted must be there once, in order and byte for byte,
+// and accepted + dropped must be the frames pushed. Exits non-zero otherwise.
+#include "pcap_ring.h"
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+static const size_t BLOCK_SIZE = 4096;
+
+struct Frame {
+    uint32_t tsSec;
+    uint32_t tsUsec;
+    std::vector<uint8_t> data;
+};
+
+static bool readPcap(const char *path, std::vector<Frame> &frames) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t header[24];
+    bool ok = fread(header, 1, sizeof(header), f) == sizeof(header);
+    uint32_t rec[4];
+    while (ok && fread(rec, 1, sizeof(rec), f) == sizeof(rec)) {
+        Frame frame{rec[0], rec[1], std::vector<uint8_t>(rec[2])};
+        if (rec[2] > PcapRing::MAX_FRAME || fread(frame.data.data(), 1, rec[2], f) != rec[2]) break;
+        frames.push_back(std::move(frame));
+    }
+    fclose(f);
+    return ok;
+}
+
+// The sniffer's raw file writer: buffers bytes and writes whole blocks
+class BlockWriter {
+public:
+    std::vector<uint8_t> file;
+    size_t writes = 0;
+
+    void append(const uint8_t *data, size_t len) {
+        while (len > 0) {
+            size_t room = BLOCK_SIZE - (file.size() + _used) % BLOCK_SIZE;
+            size_t n = len < room ? len : room;
+            memcpy(_block + _used, data, n);
+            _used += n;
+            data += n;
+            len -= n;
+            if (n == room) write();
+        }
+    }
+    void write() {
+        if (_used == 0) return;
+        file.insert(file.end(), _block, _block + _used);
+        writes++;
+        _used = 0;
+    }
+
+private:
+    uint8_t _block[BLOCK_SIZE];
+    size_t _used = 0;
+};
+
+int main(int argc, char **argv) {
+    std::vector<Frame> frames;
+    if (argc > 1 && argv[1][0] && !readPcap(argv[1], frames)) {
+        fprintf(stderr, "%s: not a pcap file\n", argv[1]);
+        return 1;
+    }
+    uint32_t capacity = argc > 2 ? strtoul(argv[2], nullptr, 10) : 32768;
+    size_t count = argc > 3 ? strtoul(argv[3], nullptr, 10) : 200000;
+    if (frames.empty()) {
+        std::mt19937 rng(1);
+        for (size_t i = 0; i < count; i++) {
+            Frame frame{(uint32_t)(i / 1000), (uint32_t)(i % 1000) * 1000, {}};
+            frame.data.resize(24 + rng() % 2323);
+            for (auto &b : frame.data) b = rng();
+            frames.push_back(std::move(frame));
+        }
+    }
+
+    std::vector<uint32_t> storage(capacity / 4); // 4 byte aligned
+    PcapRing ring;
+    if (!ring.begin((uint8_t *)storage.data(), capacity)) {
+        fprintf(stderr, "ring bytes must be a power of two, 1024 or more\n");
+        return 1;
+    }
+
+    std::vector<bool> accepted(frames.size());
+    std::atomic<bool> producing{true};
+    BlockWriter writer;
+    // Version 2.4, snaplen 65535, 802.11 link type
+    const uint8_t header[24] = {
+        0xD4, 0xC3, 0xB2, 0xA1, 2, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF, 0, 0, 105, 0, 0, 0
+    };
+    writer.append(header, sizeof(header));
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&] {
+        for (;;) {
+            bool last = !producing.load();
+            const PcapRing::Record *rec;
+            while ((rec = ring.peek()) != nullptr) {
+                writer.append(rec->pcap(), rec->pcapSize());
+                ring.pop(rec);
+            }
+            if (last) break;
+            std::this_thread::yield();
+        }
+        writer.write();
+    });
+    std::thread producer([&] {
+        for (size_t i = 0; i < frames.size(); i++) {
+            const Frame &f = frames[i];
+            accepted[i] =
+                ring.push(PcapRing::RAW, nullptr, 1, f.tsSec, f.tsUsec, f.data.data(), f.data.size());
+            // Frames arrive in bursts, with gaps the consumer can catch up in
+            if (i % 64 == 63) std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        producing = false;
+    });
+    producer.join();
+    consumer.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Parse the output back and compare it with the accepted frames
+    int failures = 0;
+    const std::vector<uint8_t> &out = writer.file;
+    size_t pos = sizeof(header), i = 0, found = 0;
+    while (pos + 16 <= out.size()) {
+        uint32_t rec[4];
+        memcpy(rec, &out[pos], sizeof(rec));
+        pos += 16;
+        while (i < frames.size() && !accepted[i]) i++;
+        if (i == frames.size() || pos + rec[2] > out.size()) {
+            failures++;
+            break;
+        }
+        const Frame &f = frames[i++];
+        if (rec[0] != f.tsSec || rec[1] != f.tsUsec || rec[2] != f.data.size() || rec[3] != f.data.size() ||
+            memcmp(&out[pos], f.data.data(), rec[2]) != 0) {
+            failures++;
+        }
+        pos += rec[2];
+        found++;
+    }
+    if (pos != out.size()) failures++;
+    size_t acceptedCount = 0;
+    for (bool a : accepted) acceptedCount += a;
+
+    printf("%zu frames through a %u byte ring in %.2f s\n", frames.size(), capacity, seconds);
+    printf("captured %u, dropped %u, in the pcap %zu\n", ring.captured(), ring.dropped(), found);
+    printf(
+        "%zu bytes in %zu writes, %.0f bytes per write\n",
+        out.size(),
+        writer.writes,
+        (double)out.size() / writer.writes
+    );
+    if (ring.captured() + ring.dropped() != frames.size() || ring.captured() != acceptedCount ||
+        found != acceptedCount) {
+        failures++;
+    }
+    printf("%s\n", failures ? "FAILED" : "all frames intact and in order");
+    return failures ? 1 : 0;
+}
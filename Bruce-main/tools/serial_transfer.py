@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""Host side of Bruce's binary serial file transfer (src/core/serial_commands/serial_transfer.h).
+
+    serial_transfer.py -p /dev/ttyACM0 put local.bin /path/on/device.bin [--resume]
+    serial_transfer.py -p /dev/ttyACM0 get /path/on/device.bin local.bin [--resume]
+
+Prints the sustained throughput at the end. Needs pyserial.
+"""
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+
+import serial
+
+SYNC = b"\xa5\x5a"
+ACK_FORMAT = "<HBB2I"  # TransferAck: base, flags, reserved, bitmap of the next 63 chunks
+ACK_COMPLETE = 1
+ACK_CRC_OK = 2
+TIMEOUT = 5.0
+
+
+class Link:
+    def __init__(self, port):
+        self.port = port
+        self.buffer = bytearray()
+
+    def send(self, kind, seq=0, payload=b""):
+        header = struct.pack("<cHH", kind, seq & 0xFFFF, len(payload))
+        crc = zlib.crc32(header + payload)
+        self.port.write(SYNC + header + payload + struct.pack("<I", crc))
+
+    def poll(self):
+        """Next valid frame as (type, seq, payload), None if there's none yet."""
+        waiting = self.port.in_waiting
+        self.buffer += self.port.read(waiting if waiting else 1)
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                del self.buffer[:-1]
+                return None
+            del self.buffer[:start]
+            if len(self.buffer) < 7:
+                return None
+            kind, seq, length = struct.unpack_from("<cHH", self.buffer, 2)
+            if length > 4096:
+                del self.buffer[:1]
+                continue
+            end = 7 + length + 4
+            if len(self.buffer) < end:
+                return None
+            frame = bytes(self.buffer[:end])
+            (crc,) = struct.unpack_from("<I", frame, 7 + length)
+            if zlib.crc32(frame[2 : 7 + length]) != crc:
+                del self.buffer[:1]
+                continue
+            del self.buffer[:end]
+            return kind, seq, frame[7 : 7 + length]
+
+    def wait(self, kinds, timeout=TIMEOUT):
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            frame = self.poll()
+            if frame is None:
+                continue
+            if frame[0] == b"X":
+                raise RuntimeError("device aborted: " + frame[2].decode(errors="replace"))
+            if frame[0] in kinds:
+                return frame
+        raise TimeoutError("no answer from the device")
+
+    def start(self, command):
+        self.port.reset_input_buffer()
+        self.port.write(command.encode() + b"\n")
+        _, _, payload = self.wait((b"S",))
+        return struct.unpack("<IIHH", payload)
+
+
+def put(link, local, remote, resume):
+    size = os.path.getsize(local)
+    flags = " -resume" if resume else ""
+    _, offset, chunk, window = link.start(f"storage write {remote} {size} -binary{flags}")
+    window = max(window, 1)
+    total = size - offset
+    chunks = (total + chunk - 1) // chunk
+
+    with open(local, "rb") as f:
+        f.seek(offset)
+        data = f.read()
+    crc = zlib.crc32(data)
+
+    # Go-back-N: the device only keeps chunks in order
+    base = sent = 0
+    sent_at = rewound_at = progress = time.monotonic()
+    rto = 0.2
+    while base < chunks:
+        while sent < chunks and sent - base < window:
+            link.send(b"D", sent, data[sent * chunk : (sent + 1) * chunk])
+            sent += 1
+            sent_at = time.monotonic()
+        frame = link.poll()
+        now = time.monotonic()
+        if frame and frame[0] == b"X":
+            raise RuntimeError("device aborted: " + frame[2].decode(errors="replace"))
+        if frame and frame[0] == b"A":
+            ack_base = struct.unpack(ACK_FORMAT, frame[2])[0]
+            acked = base + ((ack_base - base) & 0xFFFF)
+            if base < acked <= sent:
+                base = acked
+                progress = now
+            elif acked == base and sent > base and now - rewound_at > rto:
+                # The device dropped what followed a lost chunk. The frames
+                # still on the way get dropped too, one rewind is enough.
+                sent = base
+                rewound_at = now
+        if sent > base and now - sent_at > rto:
+            sent = base
+            rewound_at = now
+        if now - progress > TIMEOUT:
+            raise TimeoutError("transfer stalled")
+
+    for _ in range(10):
+        link.send(b"E", 0, struct.pack("<I", crc))
+        try:
+            _, _, payload = link.wait((b"A",), 1.0)
+        except TimeoutError:
+            continue
+        flags = struct.unpack(ACK_FORMAT, payload)[1]
+        if flags & ACK_COMPLETE:
+            if not flags & ACK_CRC_OK:
+                raise RuntimeError("CRC mismatch")
+            return total
+    raise TimeoutError("no answer to the end of the transfer")
+
+
+def get(link, remote, local, resume):
+    offset = os.path.getsize(local) if resume and os.path.exists(local) else 0
+    size, offset, chunk, _ = link.start(f"storage read {remote} {offset} -binary")
+    total = size - offset
+    chunks = (total + chunk - 1) // chunk
+
+    # Takes chunks out of order and reports them, the device resends the holes
+    have = {}
+    base = 0
+    crc = 0
+    last_ack = time.monotonic()
+    unacked = 0
+    with open(local, "r+b" if offset else "wb") as f:
+        f.seek(offset)
+        f.truncate()
+        while True:
+            kind, seq, payload = link.wait((b"D", b"E"))
+            if kind == b"D":
+                index = base + ((seq - base) & 0xFFFF)
+                if base <= index < base + 64 and index < chunks and index not in have:
+                    have[index] = payload
+                while base in have:
+                    block = have.pop(base)
+                    f.write(block)
+                    crc = zlib.crc32(block, crc)
+                    base += 1
+                unacked += 1
+            now = time.monotonic()
+            done = base >= chunks
+            if kind == b"E" or unacked >= 8 or now - last_ack > 0.01:
+                bits = 0
+                for i in range(63):
+                    if base + 1 + i in have:
+                        bits |= 1 << i
+                flags = ACK_COMPLETE if done else 0
+                if kind == b"E" and done:
+                    (expected,) = struct.unpack("<I", payload)
+                    flags |= ACK_CRC_OK if expected == crc else 0
+                link.send(b"A", 0, struct.pack(ACK_FORMAT, base & 0xFFFF, flags, 0, bits & 0xFFFFFFFF, bits >> 32))
+                unacked = 0
+                last_ack = now
+                if kind == b"E" and done:
+                    if not flags & ACK_CRC_OK:
+                        raise RuntimeError("CRC mismatch")
+                    return total
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-p", "--port", required=True)
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    parser.add_argument("--resume", action="store_true", help="continue an interrupted transfer")
+    parser.add_argument("direction", choices=("put", "get"))
+    parser.add_argument("source")
+    parser.add_argument("destination")
+    args = parser.parse_args()
+
+    with serial.Serial(args.port, args.baud, timeout=0.05) as port:
+        link = Link(port)
+        started = time.monotonic()
+        try:
+            if args.direction == "put":
+                total = put(link, args.source, args.destination, args.resume)
+            else:
+                total = get(link, args.source, args.destination, args.resume)
+        except (RuntimeError, TimeoutError) as error:
+            link.send(b"X", 0, str(error).encode())
+            sys.exit(f"Transfer failed: {error}")
+        elapsed = time.monotonic() - started
+
+    print(f"{total} bytes in {elapsed:.2f}s, {total / elapsed / 1024:.1f} kB/s at {args.baud} baud")
+
+
+if __name__ == "__main__":
+    main()
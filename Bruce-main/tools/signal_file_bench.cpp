@@ -0,0 +1,194 @@
+// Host benchmark of the .ir database parsing (lib/SignalFile) against the line by line String parsing
+// IR's "send from file" used before it.
+//
+//   SRC="tools/signal_file_bench.cpp lib/SignalFile/SignalFile.cpp"
+//   g++ -O2 -std=c++17 -Ilib/SignalFile $SRC -o signal_file_bench
+//   ./signal_file_bench [sd_files/infrared] [rounds]
+//
+// Every .ir file under the directory is read into memory first, so only the
+// parsing is timed. The old way reads each line into a String, counts the
+// codes in a first pass and copies every field out with substring() and trim()
+// in a second one (std::string stands in for Arduino's String, it allocates
+// the same way). The new way builds the SignalIndex in one pass and reads each
+// code by seeking to it. Both must find the same codes with the same fields,
+// exits non-zero if they don't.
+#include "SignalFile.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct Code {
+    std::string name, type, protocol, address, command, data;
+    long frequency = 0;
+    long bits = 0;
+
+    bool operator==(const Code &o) const {
+        return name == o.name && type == o.type && protocol == o.protocol && address == o.address &&
+               command == o.command && data == o.data && frequency == o.frequency && bits == o.bits;
+    }
+};
+
+class MemorySource : public SignalSource {
+public:
+    explicit MemorySource(const std::string &data) : _data(data) {}
+    size_t read(uint8_t *buffer, size_t size) override {
+        size_t n = _data.size() - _pos < size ? _data.size() - _pos : size;
+        memcpy(buffer, _data.data() + _pos, n);
+        _pos += n;
+        return n;
+    }
+    bool seek(uint32_t offset) override {
+        if (offset > _data.size()) return false;
+        _pos = offset;
+        return true;
+    }
+
+private:
+    const std::string &_data;
+    size_t _pos = 0;
+};
+
+// String's readStringUntil('\n') / trim() / substring()
+static bool readLine(const std::string &data, size_t &pos, std::string &line) {
+    if (pos >= data.size()) return false;
+    size_t end = data.find('\n', pos);
+    if (end == std::string::npos) end = data.size();
+    line = data.substr(pos, end - pos);
+    pos = end + 1;
+    return true;
+}
+
+static std::string trimmed(const std::string &s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return "";
+    return s.substr(b, s.find_last_not_of(" \t\r\n") - b + 1);
+}
+
+static bool startsWith(const std::string &s, const char *prefix) { return s.rfind(prefix, 0) == 0; }
+
+static void parseOld(const std::string &data, std::vector<Code> &codes) {
+    std::string line;
+    size_t pos = 0, total = 0;
+    while (readLine(data, pos, line)) {
+        if (startsWith(line, "name:")) total++;
+    }
+    codes.reserve(codes.size() + total);
+
+    pos = 0;
+    Code *code = nullptr;
+    while (readLine(data, pos, line)) {
+        if (startsWith(line, "#")) continue;
+        std::string txt = trimmed(line.substr(line.find(':') + 1));
+        if (startsWith(line, "name:")) {
+            codes.emplace_back();
+            code = &codes.back();
+            code->name = txt;
+        }
+        if (!code) continue;
+        if (startsWith(line, "type:")) code->type = txt;
+        else if (startsWith(line, "protocol:")) code->protocol = txt;
+        else if (startsWith(line, "address:")) code->address = txt;
+        else if (startsWith(line, "command:")) code->command = txt;
+        else if (startsWith(line, "frequency:")) code->frequency = strtol(txt.c_str(), nullptr, 10);
+        else if (startsWith(line, "bits:")) code->bits = strtol(txt.c_str(), nullptr, 10);
+        else if (startsWith(line, "data:") || startsWith(line, "value:") || startsWith(line, "state:")) {
+            code->data = txt;
+        }
+    }
+}
+
+static const char *const irRecordKeys[] = {"name", nullptr};
+
+// Same as readIrCode() in src/modules/ir/custom_ir.cpp
+static void readCode(SignalReader &reader, const SignalIndex &index, Code &code) {
+    bool first = true;
+    while (reader.next()) {
+        if (!first && index.isRecordStart(reader)) {
+            reader.unread();
+            break;
+        }
+        first = false;
+        if (reader.isComment()) continue;
+
+        const char *value = reader.value().str;
+        if (reader.is("name")) code.name = value;
+        else if (reader.is("type")) code.type = value;
+        else if (reader.is("protocol")) code.protocol = value;
+        else if (reader.is("address")) code.address = value;
+        else if (reader.is("command")) code.command = value;
+        else if (reader.is("frequency")) code.frequency = reader.value().toInt();
+        else if (reader.is("bits")) code.bits = reader.value().toInt();
+        else if (reader.is("data") || reader.is("value") || reader.is("state")) code.data = value;
+    }
+}
+
+static bool parseNew(const std::string &data, std::vector<Code> &codes) {
+    MemorySource source(data);
+    SignalReader reader;
+    SignalIndex index(irRecordKeys);
+    if (!reader.begin(&source) || !index.build(reader, data.size(), 0)) return false;
+    for (uint32_t i = 0; i < index.count(); i++) {
+        if (!index.seek(reader, i)) return false;
+        codes.emplace_back();
+        readCode(reader, index, codes.back());
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    std::string root = argc > 1 ? argv[1] : "sd_files/infrared";
+    int rounds = argc > 2 ? atoi(argv[2]) : 20;
+    if (rounds < 1) rounds = 1;
+
+    std::vector<std::string> files;
+    size_t bytes = 0;
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(root, ec)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".ir") continue;
+        std::ifstream in(entry.path(), std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        files.push_back(ss.str());
+        bytes += files.back().size();
+    }
+    if (files.empty()) {
+        fprintf(stderr, "no .ir files under %s\n", root.c_str());
+        return 1;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    double oldMs = 1e30, newMs = 1e30;
+    std::vector<Code> oldCodes, newCodes;
+    int failures = 0;
+    for (int r = 0; r < rounds; r++) {
+        oldCodes.clear();
+        newCodes.clear();
+        auto t0 = Clock::now();
+        for (const std::string &f : files) parseOld(f, oldCodes);
+        auto t1 = Clock::now();
+        for (const std::string &f : files) failures += !parseNew(f, newCodes);
+        auto t2 = Clock::now();
+        oldMs = std::min(oldMs, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        newMs = std::min(newMs, std::chrono::duration<double, std::milli>(t2 - t1).count());
+    }
+
+    size_t mismatched = 0;
+    if (oldCodes.size() != newCodes.size()) failures++;
+    for (size_t i = 0; i < oldCodes.size() && i < newCodes.size(); i++) {
+        if (!(oldCodes[i] == newCodes[i])) mismatched++;
+    }
+    if (mismatched) failures++;
+
+    printf("%zu files, %zu bytes, best of %d rounds\n", files.size(), bytes, rounds);
+    printf("String parsing:    %8.2f ms, %zu codes\n", oldMs, oldCodes.size());
+    printf("SignalFile:        %8.2f ms, %zu codes\n", newMs, newCodes.size());
+    if (mismatched) printf("%zu codes differ\n", mismatched);
+    printf("%s\n", failures ? "FAILED" : "same codes found");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+// Host check of the mic spectrum FFT (lib/SpectrumEngine) with synthetic input.
+//
+//   SRC="tools/spectrum_check.cpp lib/SpectrumEngine/SpectrumEngine.cpp"
+//   g++ -O2 -Ilib/SpectrumEngine $SRC -o spectrum_check
+//   ./spectrum_check
+//
+// Full scale sines centred on a bin must peak in that bin at 0 dB, with the
+// bins outside the Hann window's main lobe (more than 2 bins away) far below
+// it. Silence must map to level 0, and a sine between two bins must peak in
+// one of them. Prints each case and exits non-zero if one fails.
+#include "SpectrumEngine.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const uint16_t FFT_SIZE = 1024;
+static const float SIDE_LOBE_MAX_DB = -80.0f;
+
+static int failures = 0;
+
+static void expect(bool ok, const char *what) {
+    printf("  %-4s %s\n", ok ? "ok" : "FAIL", what);
+    if (!ok) failures++;
+}
+
+static void sine(std::vector<int16_t> &out, float cycles, float amplitude) {
+    for (size_t i = 0; i < out.size(); i++) {
+        out[i] = (int16_t)lrintf(amplitude * sinf(2.0f * (float)M_PI * cycles * i / out.size()));
+    }
+}
+
+int main() {
+    SpectrumEngine engine(FFT_SIZE);
+    if (!engine.begin()) {
+        fprintf(stderr, "begin() failed\n");
+        return 1;
+    }
+    engine.setRange(-90.0f, 0.0f);
+    std::vector<int16_t> samples(FFT_SIZE);
+    char what[128];
+
+    const uint16_t bins[] = {5, 64, 100, 257, 400, 500};
+    for (uint16_t bin : bins) {
+        sine(samples, bin, 32767.0f);
+        engine.process(samples.data());
+        float worst = -1000.0f;
+        for (uint16_t b = 1; b < engine.bins(); b++) {
+            if (abs((int)b - (int)bin) > 2) worst = fmaxf(worst, engine.powerDb(b));
+        }
+        printf(
+            "sine at bin %u: peak %u, %.2f dB, outside the main lobe %.1f dB\n",
+            bin,
+            engine.peakBin(),
+            engine.powerDb(bin),
+            worst
+        );
+        snprintf(what, sizeof(what), "peak in bin %u", bin);
+        expect(engine.peakBin() == bin, what);
+        expect(fabsf(engine.powerDb(bin)) < 0.1f, "full scale reads 0 dB");
+        snprintf(what, sizeof(what), "other bins below %.0f dB", SIDE_LOBE_MAX_DB);
+        expect(worst < SIDE_LOBE_MAX_DB, what);
+        // A hair under 1.0 after rounding, and the log2 table is piecewise linear
+        expect(engine.level(bin) >= 254, "top level at the peak");
+    }
+
+    sine(samples, 100.5f, 32767.0f);
+    engine.process(samples.data());
+    printf("sine at bin 100.5: peak %u, %.2f dB\n", engine.peakBin(), engine.powerDb(engine.peakBin()));
+    expect(engine.peakBin() == 100 || engine.peakBin() == 101, "peak in bin 100 or 101");
+    expect(engine.powerDb(engine.peakBin()) > -2.0f, "within the Hann scalloping loss");
+
+    sine(samples, 64, 327.67f);
+    engine.process(samples.data());
+    printf("sine at bin 64, -40 dBFS: %.2f dB, level %u\n", engine.powerDb(64), engine.level(64));
+    expect(fabsf(engine.powerDb(64) + 40.0f) < 0.2f, "reads -40 dB");
+
+    std::fill(samples.begin(), samples.end(), 0);
+    engine.process(samples.data());
+    bool silent = true;
+    for (uint16_t b = 0; b < engine.bins(); b++) silent &= engine.level(b) == 0;
+    printf("silence\n");
+    expect(silent, "every bin at level 0");
+
+    printf("%s\n", failures ? "FAILED" : "all passed");
+    return failures ? 1 : 0;
+}
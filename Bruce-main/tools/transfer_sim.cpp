@@ -0,0 +1,155 @@
+// Host simulation of the ESP-NOW file transfer protocol (src/core/connect/file_transfer.*) on a lossy link.
+//
+//   g++ -O2 -Isrc/core/connect tools/transfer_sim.cpp src/core/connect/file_transfer.cpp -o transfer_sim
+//   ./transfer_sim
+//
+// A TransferSender and a TransferReceiver talk over a simulated link with
+// random loss in both directions and per frame latency jitter, which reorders
+// frames. The receiver acks like FileSharing does (every 8 chunks or 10 ms).
+// Each run must finish with the file byte for byte and its CRC matching, and
+// without stalling for the 5 s FileSharing gives up after. Prints the
+// retransmissions, and the spurious ones: a chunk resent while the receiver
+// already had it or a copy of it was still on its way.
+// Exits non-zero if a run fails.
+#include "file_transfer.h"
+#include <deque>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static const uint16_t CHUNK_SIZE = 200;
+static const uint32_t ACK_EVERY = 8;      // ESP_TRANSFER_ACK_EVERY
+static const uint32_t ACK_DELAY_MS = 10;  // ESP_TRANSFER_ACK_DELAY
+static const uint32_t TIMEOUT_MS = 5000;  // ESP_TRANSFER_TIMEOUT
+static const uint32_t BASE_LATENCY_MS = 2; // Airtime of a 250 byte frame at 1 Mbps
+
+struct Frame {
+    uint32_t arrival;
+    bool ack;
+    uint16_t seq;
+    uint32_t chunk;
+    TransferAck ackData;
+};
+
+struct Result {
+    bool ok;
+    uint32_t ms;
+    uint32_t sent;
+    uint32_t retransmits;
+    uint32_t spurious;
+};
+
+static Result run(uint32_t chunks, double loss, uint32_t jitterMs, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    auto latency = [&] { return BASE_LATENCY_MS + (jitterMs ? rng() % (jitterMs + 1) : 0); };
+
+    uint32_t total = chunks * CHUNK_SIZE - CHUNK_SIZE / 3; // Last chunk short
+    std::vector<uint8_t> source(total), received(total);
+    for (auto &b : source) b = rng();
+    uint32_t sourceCrc = transferCrc32(0, source.data(), total);
+
+    TransferSender sender;
+    TransferReceiver receiver;
+    sender.begin(total, CHUNK_SIZE, 0);
+    receiver.begin(total, CHUNK_SIZE);
+
+    std::deque<Frame> toReceiver, toSender; // Kept sorted by arrival
+    auto post = [](std::deque<Frame> &link, const Frame &f) {
+        auto it = link.end();
+        while (it != link.begin() && (it - 1)->arrival > f.arrival) it--;
+        link.insert(it, f);
+    };
+    std::vector<uint8_t> have(sender.chunks());
+    std::vector<uint16_t> alive(sender.chunks()); // Copies on their way that won't be lost
+
+    Result result{};
+    uint32_t unacked = 0, lastAck = 0;
+    for (uint32_t now = 0;; now++) {
+        // Receiver side
+        while (!toReceiver.empty() && toReceiver.front().arrival <= now) {
+            Frame f = toReceiver.front();
+            toReceiver.pop_front();
+            alive[f.chunk]--;
+            uint32_t chunk;
+            if (receiver.accept(f.seq, chunk)) {
+                uint32_t offset = receiver.chunkOffset(chunk);
+                uint32_t len = total - offset < CHUNK_SIZE ? total - offset : CHUNK_SIZE;
+                memcpy(&received[offset], &source[offset], len);
+                have[chunk] = 1;
+            }
+            unacked++;
+        }
+        if (unacked >= ACK_EVERY || (unacked > 0 && now - lastAck >= ACK_DELAY_MS)) {
+            Frame f{(uint32_t)(now + latency()), true, 0, 0, {}};
+            receiver.fillAck(f.ackData);
+            if (uniform(rng) >= loss) post(toSender, f);
+            unacked = 0;
+            lastAck = now;
+        }
+
+        // Sender side, one frame a ms
+        while (!toSender.empty() && toSender.front().arrival <= now) {
+            sender.onAck(toSender.front().ackData, now);
+            toSender.pop_front();
+        }
+        if (sender.allAcked() && receiver.complete()) {
+            result.ok = memcmp(source.data(), received.data(), total) == 0 &&
+                        transferCrc32(0, received.data(), total) == sourceCrc;
+            result.ms = now;
+            break;
+        }
+        if (sender.stalled(now, TIMEOUT_MS)) {
+            result.ms = now;
+            break;
+        }
+        uint32_t retransmits = sender.retransmits();
+        uint32_t chunk;
+        if (sender.next(now, chunk)) {
+            if (sender.retransmits() != retransmits && (have[chunk] || alive[chunk] > 0)) result.spurious++;
+            if (uniform(rng) >= loss) {
+                post(toReceiver, Frame{(uint32_t)(now + latency()), false, (uint16_t)chunk, chunk, {}});
+                alive[chunk]++;
+            }
+        }
+    }
+    result.sent = sender.sent();
+    result.retransmits = sender.retransmits();
+    return result;
+}
+
+int main() {
+    int failures = 0;
+    printf(
+        "%8s %6s %7s  %-6s %8s %9s %8s %8s\n", "chunks", "loss", "jitter", "", "s", "sent", "resent", "spurious"
+    );
+    struct Case {
+        uint32_t chunks;
+        double loss;
+        uint32_t jitter;
+    };
+    std::vector<Case> cases;
+    for (double loss : {0.0, 0.05, 0.2, 0.4})
+        for (uint32_t jitter : {0u, 5u, 20u}) cases.push_back({2000, loss, jitter});
+    cases.push_back({70000, 0.1, 5}); // Past 65536, sequence numbers wrap
+
+    uint32_t seed = 1;
+    for (const Case &c : cases) {
+        Result r = run(c.chunks, c.loss, c.jitter, seed++);
+        printf(
+            "%8u %5.0f%% %5ums  %-6s %8.1f %9u %8u %8u\n",
+            c.chunks,
+            c.loss * 100,
+            c.jitter,
+            r.ok ? "ok" : "FAIL",
+            r.ms / 1000.0,
+            r.sent,
+            r.retransmits,
+            r.spurious
+        );
+        if (!r.ok) failures++;
+    }
+    printf("%s\n", failures ? "FAILED" : "every file arrived intact");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Response time and heap use of the WebUI menu and file list endpoints.
+
+    web_bench.py 172.0.0.1 --user admin --password bruce -n 50 --folder / --fs SD
+
+Requests /cm "nav" (the menu JSON, alternating next/prev so the menu ends
+where it started) and /listfiles, and prints the time to the last byte and
+the body size of each. The free heap, the lowest free heap and the largest
+free block from /systeminfo are read before and after each run, so a build
+that builds the bodies in memory can be compared with one that streams them.
+"""
+import argparse
+import base64
+import json
+import statistics
+import time
+import urllib.parse
+import urllib.request
+
+
+class Device:
+    def __init__(self, host, user, password):
+        self.base = f"http://{host}"
+        token = base64.b64encode(f"{user}:{password}".encode()).decode()
+        self.headers = {"Authorization": f"Basic {token}"}
+
+    def request(self, path, params=None, post=False):
+        data = None
+        url = self.base + path
+        if params and post:
+            data = urllib.parse.urlencode(params).encode()
+        elif params:
+            url += "?" + urllib.parse.urlencode(params)
+        request = urllib.request.Request(url, data=data, headers=self.headers)
+        start = time.perf_counter()
+        with urllib.request.urlopen(request, timeout=10) as response:
+            body = response.read()
+        return time.perf_counter() - start, body
+
+    def heap(self):
+        _, body = self.request("/systeminfo")
+        return json.loads(body)["heap"]
+
+
+def run(device, label, requests):
+    before = device.heap()
+    times = []
+    size = 0
+    for request in requests:
+        elapsed, body = request()
+        times.append(elapsed * 1000)
+        size = len(body)
+    after = device.heap()
+    times.sort()
+    print(
+        f"{label:10} {len(times)} requests, {size} bytes: "
+        f"median {statistics.median(times):.1f} ms, p95 {times[int(len(times) * 0.95) - 1]:.1f} ms"
+    )
+    print(
+        f"{'':10} heap free {after['free'] - before['free']:+d}, "
+        f"lowest {after['min'] - before['min']:+d}, largest block {after['largest'] - before['largest']:+d}"
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host")
+    parser.add_argument("--user", default="admin")
+    parser.add_argument("--password", default="bruce")
+    parser.add_argument("-n", "--count", type=int, default=50)
+    parser.add_argument("--folder", default="/")
+    parser.add_argument("--fs", default="SD", choices=["SD", "LittleFS"])
+    args = parser.parse_args()
+
+    device = Device(args.host, args.user, args.password)
+    nav = [
+        (lambda d=direction: device.request("/cm", {"cmnd": f"nav {d}"}, post=True))
+        for _ in range(args.count // 2)
+        for direction in ("next", "prev")
+    ]
+    files = [
+        (lambda: device.request("/listfiles", {"folder": args.folder, "fs": args.fs}))
+        for _ in range(args.count)
+    ]
+    run(device, "menu", nav)
+    run(device, "listfiles", files)
+
+
+if __name__ == "__main__":
+    main()
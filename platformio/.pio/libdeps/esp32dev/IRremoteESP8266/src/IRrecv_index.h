@@ -0,0 +1,147 @@
+/// @file
+/// @brief The header marks `IRrecv::decode()`'s dispatch index is built from.
+/// @note Each protocol's `ir_*.cpp` file checks its entries against its own
+///   `k*HdrMark` constants with `IR_DECODE_INDEX_CHECK()`, so changing a
+///   constant without updating the table fails the build.
+
+#ifndef IRRECV_INDEX_H_
+#define IRRECV_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "IRremoteESP8266.h"
+
+#if ENABLE_DECODE_INDEX
+namespace _IRrecv {
+/// A leading (header) mark, in uSeconds, a protocol's decoder insists on.
+struct DecodeIndexEntry {
+  decode_type_t protocol;
+  uint16_t hdrmark;
+};
+
+/// Used by `IRrecv::buildDecodeIndex()` to work out which decoders are worth
+/// trying for a given message.
+/// @note A protocol can have several entries if its decoder accepts more than
+///   one header mark. Protocols without an entry (e.g. no header, an optional
+///   header, or decoders that ignore `offset`) are always tried.
+/// @note Values are repeated here as most of the constants are private to the
+///   protocol's `ir_*.cpp` file. That file checks them at compile time.
+constexpr DecodeIndexEntry kDecodeIndexTable[] = {
+  {AIRTON, 6630},          // kAirtonHdrMark
+  {AIWA_RC_T501, 8960},    // kNecHdrMark (via decodeNEC())
+  {AMCOR, 8200},           // kAmcorHdrMark
+  {ARGO, 6400},            // kArgoHdrMark
+  {ARRIS, 2560},           // kArrisHdrMark
+  {BOSCH144, 4366},        // kBoschHdrMark
+  {BOSE, 1100},            // kBoseHdrMark
+  {CARRIER_AC, 8532},      // kCarrierAcHdrMark
+  {CARRIER_AC40, 8402},    // kCarrierAc40HdrMark
+  {CARRIER_AC64, 8940},    // kCarrierAc64HdrMark
+  {CARRIER_AC84, 5850},    // kCarrierAc84HdrMark
+  {CARRIER_AC128, 4600},   // kCarrierAc128HdrMark
+  {COOLIX, 4692},          // kCoolixHdrMark
+  {COOLIX48, 4692},        // kCoolixHdrMark
+  {CORONA_AC, 3500},       // kCoronaAcHdrMark
+  {DAIKIN2, 10024},        // kDaikin2LeaderMark
+  {DAIKIN64, 9800},        // kDaikin64LdrMark
+  {DAIKIN128, 9800},       // kDaikin128LeaderMark
+  {DAIKIN160, 5000},       // kDaikin160HdrMark
+  {DAIKIN176, 5070},       // kDaikin176HdrMark
+  {DAIKIN200, 4920},       // kDaikin200HdrMark
+  {DAIKIN216, 3440},       // kDaikin216HdrMark
+  {DELONGHI_AC, 8984},     // kDelonghiAcHdrMark
+  {DISH, 400},             // kDishHdrMark
+  {DOSHISHA, 3412},        // kDoshishaHdrMark
+  {ECOCLIM, 5730},         // kEcoclimHdrMark
+  {ELECTRA_AC, 9166},      // kElectraAcHdrMark
+  {EPSON, 8960},           // kNecHdrMark
+  {FUJITSU_AC, 3324},      // kFujitsuAcHdrMark
+  {GICABLE, 9000},         // kGicableHdrMark
+  {GOODWEATHER, 6820},     // kGoodweatherHdrMark
+  {GREE, 9000},            // kGreeHdrMark
+  {HAIER_AC, 3000},        // kHaierAcHdr
+  {HAIER_AC_YRW02, 3000},  // kHaierAcHdr (via decodeHaierAC())
+  {HAIER_AC160, 3000},     // kHaierAcHdr (via decodeHaierAC())
+  {HAIER_AC176, 3000},     // kHaierAcHdr (via decodeHaierAC())
+  {HITACHI_AC, 3300},      // kHitachiAcHdrMark
+  {HITACHI_AC1, 3400},     // kHitachiAc1HdrMark
+  {HITACHI_AC2, 3300},     // kHitachiAcHdrMark
+  {HITACHI_AC3, 3400},     // kHitachiAc3HdrMark
+  {HITACHI_AC264, 3300},   // kHitachiAcHdrMark
+  {HITACHI_AC296, 3300},   // kHitachiAcHdrMark
+  {HITACHI_AC344, 3300},   // kHitachiAcHdrMark
+  {HITACHI_AC424, 29784},  // kHitachiAc424LdrMark
+  {INAX, 9000},            // kInaxHdrMark
+  {KELON, 9000},           // kKelonHdrMark
+  {KELON168, 9000},        // kKelonHdrMark
+  {KELVINATOR, 9010},      // kKelvinatorHdrMark
+  {LG, 8500},              // kLgHdrMark
+  {LG, 3200},              // kLg2HdrMark
+  {LG, 4500},              // kLg32HdrMark
+  {METZ, 880},             // kMetzHdrMark
+  {MIDEA, 4480},           // kMideaHdrMark
+  {MIDEA24, 8960},         // kNecHdrMark
+  {MILESTAG2, 2400},       // kMilesTag2HdrMark
+  {MIRAGE, 8360},          // kMirageHdrMark
+  {MITSUBISHI_AC, 3400},   // kMitsubishiAcHdrMark
+  {MITSUBISHI_HEAVY_152, 3140},  // kMitsubishiHeavyHdrMark
+  {MITSUBISHI2, 8400},     // kMitsubishi2HdrMark
+  {MITSUBISHI112, 3450},   // kMitsubishi112HdrMark
+  {MITSUBISHI112, 3000},   // kTcl112AcHdrMark
+  {MITSUBISHI136, 3324},   // kMitsubishi136HdrMark
+  {NEC, 8960},             // kNecHdrMark
+  {NEOCLIMA, 6112},        // kNeoclimaHdrMark
+  {NIKAI, 4000},           // kNikaiHdrMark
+  {PANASONIC, 3456},       // kPanasonicHdrMark
+  {PANASONIC_AC, 3456},    // kPanasonicHdrMark
+  {PANASONIC_AC32, 3543},  // kPanasonicAc32HdrMark
+  {PIONEER, 8506},         // kPioneerHdrMark
+  {RC6, 2664},             // kRc6HdrMark
+  {RCMM, 416},             // kRcmmHdrMark
+  {RHOSS, 3042},           // kRhossHdrMark
+  {SAMSUNG, 4480},         // kSamsungHdrMark
+  {SAMSUNG36, 4515},       // kSamsung36HdrMark
+  {SANYO_AC, 8500},        // kSanyoAcHdrMark
+  {SANYO_AC88, 5400},      // kSanyoAc88HdrMark
+  {SANYO_AC152, 3300},     // kSanyoAc152HdrMark
+  {SANYO_LC7461, 8960},    // kNecHdrMark (via decodeNEC())
+  {SHARP_AC, 3800},        // kSharpAcHdrMark
+  {SONY, 2400},            // kSonyHdrMark
+  {TCL96AC, 1056},         // kTcl96AcHdrMark
+  {TECHNIBEL_AC, 8836},    // kTechnibelAcHdrMark
+  {TECO, 9000},            // kTecoHdrMark
+  {TEKNOPOINT, 3600},      // kTeknopointHdrMark
+  {TOSHIBA_AC, 4400},      // kToshibaAcHdrMark
+  {TOTO, 6197},            // kTotoHdrMark
+  {TRANSCOLD, 5944},       // kTranscoldHdrMark
+  {TROTEC, 5952},          // kTrotecHdrMark
+  {TROTEC_3550, 12000},    // kTrotec3550HdrMark
+  {TRUMA, 20200},          // kTrumaLdrMark
+  {VESTEL_AC, 3110},       // kVestelAcHdrMark
+  {WHIRLPOOL_AC, 8950},    // kWhirlpoolAcHdrMark
+  {WOWWEE, 6684},          // kWowweeHdrMark
+  {YORK, 4887},            // kYorkHdrMark
+  {ZEPEAL, 2330},          // kZepealHdrMark
+};
+constexpr size_t kDecodeIndexTableSize =
+    sizeof(kDecodeIndexTable) / sizeof(kDecodeIndexTable[0]);
+
+/// Is there a `kDecodeIndexTable` entry for this protocol and header mark?
+constexpr bool decodeIndexHas(const decode_type_t protocol,
+                              const uint16_t hdrmark, const size_t i = 0) {
+  return i < kDecodeIndexTableSize &&
+      ((kDecodeIndexTable[i].protocol == protocol &&
+        kDecodeIndexTable[i].hdrmark == hdrmark) ||
+       decodeIndexHas(protocol, hdrmark, i + 1));
+}
+}  // namespace _IRrecv
+
+/// Fails the build if `hdrmark` isn't `protocol`'s entry in the index table.
+#define IR_DECODE_INDEX_CHECK(protocol, hdrmark) \
+  static_assert(_IRrecv::decodeIndexHas(decode_type_t::protocol, hdrmark), \
+                #hdrmark " isn't in kDecodeIndexTable for " #protocol)
+#else  // ENABLE_DECODE_INDEX
+#define IR_DECODE_INDEX_CHECK(protocol, hdrmark)
+#endif  // ENABLE_DECODE_INDEX
+
+#endif  // IRRECV_INDEX_H_
@@ -9,6 +9,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 const uint16_t kAirtonHdrMark = 6630;
 const uint16_t kAirtonBitMark = 400;
@@ -360,3 +361,6 @@ String IRAirtonAc::toString(void) const {
   result += addBoolToString(getSleep(), kSleepStr);
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(AIRTON, kAirtonHdrMark);
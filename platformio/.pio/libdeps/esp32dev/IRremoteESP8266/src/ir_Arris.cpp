@@ -2,6 +2,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 /// @file
 /// @brief Arris "Manchester code" based protocol.
@@ -121,3 +122,6 @@ bool IRrecv::decodeArris(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_ARRIS
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(ARRIS, kArrisHdrMark);
@@ -5,6 +5,7 @@
 /// @see https://github.com/crankyoldgit/IRremoteESP8266/issues/1787
 
 #include "ir_Bosch.h"
+#include "IRrecv_index.h"
 
 #if SEND_BOSCH144
 /// Send a Bosch 144-bit / 18-byte message (96-bit message are also possible)
@@ -329,3 +330,6 @@ bool IRrecv::decodeBosch144(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_BOSCH144
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(BOSCH144, kBoschHdrMark);
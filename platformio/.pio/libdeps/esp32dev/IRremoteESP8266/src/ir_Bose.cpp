@@ -11,6 +11,7 @@
 
 #include "IRrecv.h"
 #include "IRsend.h"
+#include "IRrecv_index.h"
 
 const uint16_t kBoseHdrMark = 1100;
 const uint16_t kBoseHdrSpace = 1350;
@@ -67,3 +68,6 @@ bool IRrecv::decodeBose(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_BOSE
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(BOSE, kBoseHdrMark);
@@ -12,6 +12,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 using irutils::addBoolToString;
 using irutils::addIntToString;
@@ -745,3 +746,10 @@ bool IRrecv::decodeCarrierAC84(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_CARRIER_AC84
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(CARRIER_AC, kCarrierAcHdrMark);
+IR_DECODE_INDEX_CHECK(CARRIER_AC40, kCarrierAc40HdrMark);
+IR_DECODE_INDEX_CHECK(CARRIER_AC64, kCarrierAc64HdrMark);
+IR_DECODE_INDEX_CHECK(CARRIER_AC84, kCarrierAc84HdrMark);
+IR_DECODE_INDEX_CHECK(CARRIER_AC128, kCarrierAc128HdrMark);
@@ -8,6 +8,7 @@
 #include "IRtext.h"
 #include "IRutils.h"
 #include <algorithm>
+#include "IRrecv_index.h"
 
 using irutils::addBoolToString;
 using irutils::addModeToString;
@@ -468,3 +469,6 @@ String IRDelonghiAc::toString(void) const {
                              kOffTimerStr);
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(DELONGHI_AC, kDelonghiAcHdrMark);
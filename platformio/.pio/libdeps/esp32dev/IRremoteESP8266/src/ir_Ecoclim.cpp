@@ -12,6 +12,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint8_t  kEcoclimSections = 3;
@@ -422,3 +423,6 @@ String IREcoclimAc::toString(void) const {
   result += addIntToString(_.DipConfig, kTypeStr);
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(ECOCLIM, kEcoclimHdrMark);
@@ -13,6 +13,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kElectraAcHdrMark = 9166;
@@ -455,3 +456,6 @@ bool IRrecv::decodeElectraAC(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_ELECTRA_AC
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(ELECTRA_AC, kElectraAcHdrMark);
@@ -14,6 +14,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kGicableHdrMark = 9000;
@@ -93,3 +94,6 @@ bool IRrecv::decodeGICable(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_GICABLE
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(GICABLE, kGicableHdrMark);
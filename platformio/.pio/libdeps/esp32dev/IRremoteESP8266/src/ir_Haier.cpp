@@ -19,6 +19,7 @@
 #include "IRremoteESP8266.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kHaierAcHdr = 3000;
@@ -2167,3 +2168,9 @@ String IRHaierAC160::toString(void) const {
   return result;
 }
 // End of IRHaierAC160 class.
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(HAIER_AC, kHaierAcHdr);
+IR_DECODE_INDEX_CHECK(HAIER_AC_YRW02, kHaierAcHdr);
+IR_DECODE_INDEX_CHECK(HAIER_AC160, kHaierAcHdr);
+IR_DECODE_INDEX_CHECK(HAIER_AC176, kHaierAcHdr);
@@ -20,6 +20,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kHitachiAcHdrMark = 3300;
@@ -1994,3 +1995,13 @@ bool IRrecv::decodeHitachiAc296(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_HITACHI_AC296
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(HITACHI_AC, kHitachiAcHdrMark);
+IR_DECODE_INDEX_CHECK(HITACHI_AC1, kHitachiAc1HdrMark);
+IR_DECODE_INDEX_CHECK(HITACHI_AC2, kHitachiAcHdrMark);
+IR_DECODE_INDEX_CHECK(HITACHI_AC3, kHitachiAc3HdrMark);
+IR_DECODE_INDEX_CHECK(HITACHI_AC264, kHitachiAcHdrMark);
+IR_DECODE_INDEX_CHECK(HITACHI_AC296, kHitachiAcHdrMark);
+IR_DECODE_INDEX_CHECK(HITACHI_AC344, kHitachiAcHdrMark);
+IR_DECODE_INDEX_CHECK(HITACHI_AC424, kHitachiAc424LdrMark);
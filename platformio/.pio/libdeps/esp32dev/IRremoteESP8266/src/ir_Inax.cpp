@@ -11,6 +11,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kInaxTick = 500;
@@ -71,3 +72,6 @@ bool IRrecv::decodeInax(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_INAX
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(INAX, kInaxHdrMark);
@@ -21,6 +21,7 @@
 #include "IRsend.h"
 #include "IRutils.h"
 #include "IRtext.h"
+#include "IRrecv_index.h"
 
 
 using irutils::addBoolToString;
@@ -549,3 +550,7 @@ bool IRrecv::decodeKelon168(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_KELON168
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(KELON, kKelonHdrMark);
+IR_DECODE_INDEX_CHECK(KELON168, kKelonHdrMark);
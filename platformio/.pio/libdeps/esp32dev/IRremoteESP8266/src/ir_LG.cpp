@@ -16,6 +16,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 using irutils::addBoolToString;
 using irutils::addModeToString;
@@ -860,3 +861,8 @@ String IRLgAc::toString(void) const {
 bool IRLgAc::isValidLgAc(void) const {
   return validChecksum(_.raw) && (_.Sign == kLgAcSignature);
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(LG, kLgHdrMark);
+IR_DECODE_INDEX_CHECK(LG, kLg2HdrMark);
+IR_DECODE_INDEX_CHECK(LG, kLg32HdrMark);
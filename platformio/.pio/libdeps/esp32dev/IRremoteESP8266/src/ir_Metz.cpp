@@ -12,6 +12,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants.
 const uint16_t kMetzHdrMark = 880;    ///< uSeconds.
@@ -99,3 +100,6 @@ bool IRrecv::decodeMetz(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_METZ
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(METZ, kMetzHdrMark);
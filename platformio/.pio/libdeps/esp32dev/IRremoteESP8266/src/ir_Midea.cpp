@@ -17,6 +17,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kMideaTick = 80;
@@ -884,3 +885,6 @@ bool IRrecv::decodeMidea24(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_MIDEA24
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(MIDEA, kMideaHdrMark);
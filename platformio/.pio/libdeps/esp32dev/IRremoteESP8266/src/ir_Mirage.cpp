@@ -15,6 +15,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 using irutils::addBoolToString;
 using irutils::addFanToString;
@@ -851,3 +852,6 @@ String IRMirageAc::toString(void) const {
   return result;
 }
 #endif  // DECODE_MIRAGE
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(MIRAGE, kMirageHdrMark);
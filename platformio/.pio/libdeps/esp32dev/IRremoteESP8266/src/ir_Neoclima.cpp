@@ -15,6 +15,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kNeoclimaHdrMark = 6112;
@@ -606,3 +607,6 @@ bool IRrecv::decodeNeoclima(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_NEOCLIMA
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(NEOCLIMA, kNeoclimaHdrMark);
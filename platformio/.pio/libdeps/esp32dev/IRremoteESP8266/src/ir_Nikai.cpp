@@ -12,6 +12,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kNikaiTick = 500;
@@ -72,3 +73,6 @@ bool IRrecv::decodeNikai(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_NIKAI
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(NIKAI, kNikaiHdrMark);
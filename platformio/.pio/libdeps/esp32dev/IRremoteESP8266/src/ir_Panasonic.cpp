@@ -22,6 +22,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 /// @see http://www.remotecentral.com/cgi-bin/mboard/rc-pronto/thread.cgi?26152
@@ -1348,3 +1349,8 @@ stdAc::state_t IRPanasonicAc32::toCommon(const stdAc::state_t *prev) const {
   result.clock = -1;
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(PANASONIC, kPanasonicHdrMark);
+IR_DECODE_INDEX_CHECK(PANASONIC_AC, kPanasonicHdrMark);
+IR_DECODE_INDEX_CHECK(PANASONIC_AC32, kPanasonicAc32HdrMark);
@@ -22,6 +22,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 // Ref: https://github.com/crankyoldgit/IRremoteESP8266/issues/1220
@@ -141,3 +142,6 @@ bool IRrecv::decodePioneer(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_PIONEER
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(PIONEER, kPioneerHdrMark);
@@ -23,6 +23,7 @@
 #include "IRsend.h"
 #include "IRtimer.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 // RC-5/RC-5X
@@ -452,3 +453,6 @@ bool IRrecv::decodeRC6(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_RC6
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(RC6, kRc6HdrMark);
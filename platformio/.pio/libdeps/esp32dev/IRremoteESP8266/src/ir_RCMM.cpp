@@ -12,6 +12,7 @@
 #include "IRsend.h"
 #include "IRtimer.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kRcmmTick = 28;  // Technically it would be 27.777*
@@ -162,3 +163,6 @@ bool IRrecv::decodeRCMM(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_RCMM
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(RCMM, kRcmmHdrMark);
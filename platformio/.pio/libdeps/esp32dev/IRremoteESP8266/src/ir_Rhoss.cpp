@@ -10,6 +10,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 const uint16_t kRhossHdrMark = 3042;
 const uint16_t kRhossHdrSpace = 4248;
@@ -362,3 +363,6 @@ String IRRhossAc::toString(void) const {
   result += addBoolToString(getSwing(), kSwingVStr);
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(RHOSS, kRhossHdrMark);
@@ -19,6 +19,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kSamsungTick = 560;
@@ -994,3 +995,7 @@ bool IRrecv::decodeSamsungAC(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_SAMSUNG_AC
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(SAMSUNG, kSamsungHdrMark);
+IR_DECODE_INDEX_CHECK(SAMSUNG36, kSamsung36HdrMark);
@@ -22,6 +22,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 using irutils::addBoolToString;
 using irutils::addFanToString;
@@ -1044,3 +1045,8 @@ bool IRrecv::decodeSanyoAc152(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_SANYO_AC152
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(SANYO_AC, kSanyoAcHdrMark);
+IR_DECODE_INDEX_CHECK(SANYO_AC88, kSanyoAc88HdrMark);
+IR_DECODE_INDEX_CHECK(SANYO_AC152, kSanyoAc152HdrMark);
@@ -11,6 +11,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kTotoHdrMark = 6197;
@@ -129,3 +130,6 @@ bool IRrecv::decodeToto(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_TOTO
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(TOTO, kTotoHdrMark);
@@ -15,6 +15,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 
@@ -498,3 +499,6 @@ bool IRrecv::decodeTranscold(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_TRANSCOLD
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(TRANSCOLD, kTranscoldHdrMark);
@@ -15,6 +15,7 @@
 #include "IRremoteESP8266.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kTrotecHdrMark = 5952;
@@ -640,3 +641,7 @@ String IRTrotec3550::toString(void) const {
                              kTimerStr);
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(TROTEC, kTrotecHdrMark);
+IR_DECODE_INDEX_CHECK(TROTEC_3550, kTrotec3550HdrMark);
@@ -13,6 +13,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 using irutils::addBoolToString;
 using irutils::addFanToString;
@@ -338,3 +339,6 @@ String IRTrumaAc::toString(void) const {
   result += addBoolToString(getQuiet(), kQuietStr);
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(TRUMA, kTrumaLdrMark);
@@ -16,6 +16,7 @@
 #include "IRtext.h"
 #include "IRutils.h"
 #include "ir_Haier.h"
+#include "IRrecv_index.h"
 
 // Ref:
 //   None. Totally reverse engineered.
@@ -570,3 +571,6 @@ bool IRrecv::decodeVestelAc(decode_results* results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_VESTEL_AC
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(VESTEL_AC, kVestelAcHdrMark);
@@ -33,6 +33,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kWowweeHdrMark   = 6684;
@@ -89,3 +90,6 @@ bool IRrecv::decodeWowwee(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_WOWWEE
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(WOWWEE, kWowweeHdrMark);
@@ -20,6 +20,7 @@
 #endif
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 
 using irutils::addBoolToString;
@@ -355,3 +356,6 @@ String IRYorkAc::toString(void) const {
 
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(YORK, kYorkHdrMark);
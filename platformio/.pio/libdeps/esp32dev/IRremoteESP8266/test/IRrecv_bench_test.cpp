@@ -0,0 +1,153 @@
+#include <string.h>
+#include <chrono>  // NOLINT(build/c++11)
+#include <iostream>
+#include "IRrecv.h"
+#include "IRrecv_test.h"
+#include "IRremoteESP8266.h"
+#include "IRsend.h"
+#include "IRsend_test.h"
+#include "decode_corpus.h"
+#include "gtest/gtest.h"
+
+// Tests & a benchmark for the IRrecv::decode() header mark index, using every
+// raw capture from the protocol unit tests. (See decode_corpus.awk)
+
+const uint16_t kNrCorpus = sizeof(kDecodeCorpus) / sizeof(kDecodeCorpus[0]);
+
+// Make the receiver try every enabled decoder (i.e. How it was before the
+// index), or go back to using the index.
+// Note: Only one IRrecv object can exist at a time, as they share `params`.
+void tryAllDecoders(IRrecv *irrecv, const bool all = true) {
+#if ENABLE_DECODE_INDEX
+  if (all) {
+    memset(irrecv->_decode_index, 0xFF, sizeof(irrecv->_decode_index));
+    irrecv->_decode_index_tolerance = irrecv->getTolerance();
+  } else {
+    irrecv->_decode_index_tolerance = kUseDefTol;  // Force a rebuild.
+  }
+#endif  // ENABLE_DECODE_INDEX
+}
+
+// Load a corpus entry into the capture buffer & decode it.
+bool decodeCorpus(IRsendTest *irsend, IRrecv *irrecv, const uint16_t index,
+                  const uint8_t max_skip = 0) {
+  irsend->reset();
+  irsend->sendRaw(kDecodeCorpus[index].data, kDecodeCorpus[index].length, 38);
+  irsend->makeDecodeResult();
+  return irrecv->decode(&irsend->capture, NULL, max_skip);
+}
+
+// Decode the entire corpus `rounds` times, & return the decodes per second.
+double decodesPerSecond(IRsendTest *irsend, IRrecv *irrecv,
+                        const uint16_t rounds) {
+  // Prepare the captures outside of the timed section.
+  static decode_results captures[kNrCorpus];
+  static uint16_t rawbufs[kNrCorpus][RAW_BUF];
+  for (uint16_t i = 0; i < kNrCorpus; i++) {
+    decodeCorpus(irsend, irrecv, i);
+    captures[i] = irsend->capture;
+    memcpy(rawbufs[i], irsend->rawbuf, sizeof(rawbufs[i]));
+    captures[i].rawbuf = rawbufs[i];
+  }
+  uint32_t decoded = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint16_t r = 0; r < rounds; r++)
+    for (uint16_t i = 0; i < kNrCorpus; i++)
+      if (irrecv->decode(&captures[i])) decoded++;
+  auto finish = std::chrono::steady_clock::now();
+  EXPECT_LT(0, decoded);
+  const double secs = std::chrono::duration<double>(finish - start).count();
+  return (rounds * kNrCorpus) / secs;
+}
+
+TEST(TestDecodeIndex, Corpus) {
+  EXPECT_LT(100, kNrCorpus);
+}
+
+TEST(TestDecodeIndex, SameResultsAsTryingEveryDecoder) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+
+  for (uint8_t max_skip = 0; max_skip <= 2; max_skip++) {
+    for (uint16_t i = 0; i < kNrCorpus; i++) {
+      SCOPED_TRACE(i);
+      tryAllDecoders(&irrecv);
+      const bool expected = decodeCorpus(&irsend, &irrecv, i, max_skip);
+      const decode_results want = irsend.capture;
+      tryAllDecoders(&irrecv, false);
+      EXPECT_EQ(expected, decodeCorpus(&irsend, &irrecv, i, max_skip));
+      EXPECT_EQ(want.decode_type, irsend.capture.decode_type);
+      EXPECT_EQ(want.bits, irsend.capture.bits);
+      EXPECT_EQ(want.repeat, irsend.capture.repeat);
+      EXPECT_STATE_EQ(want.state, irsend.capture.state, kStateSizeMax * 8);
+    }
+  }
+}
+
+TEST(TestDecodeIndex, ChangingToleranceRebuildsTheIndex) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+  bool success[kNrCorpus];
+  decode_type_t type[kNrCorpus];
+  uint16_t bits[kNrCorpus];
+
+  decodeCorpus(&irsend, &irrecv, 0);  // Build the index for the default.
+  const uint8_t tolerances[] = {0, 5, 40, 60, 100};
+  for (uint8_t tolerance : tolerances) {
+    SCOPED_TRACE(tolerance);
+    irrecv.setTolerance(tolerance);
+    // The index is rebuilt on the first decode after changing the tolerance.
+    for (uint16_t i = 0; i < kNrCorpus; i++) {
+      success[i] = decodeCorpus(&irsend, &irrecv, i);
+      type[i] = irsend.capture.decode_type;
+      bits[i] = irsend.capture.bits;
+    }
+#if ENABLE_DECODE_INDEX
+    EXPECT_EQ(tolerance, irrecv._decode_index_tolerance);
+#endif  // ENABLE_DECODE_INDEX
+    tryAllDecoders(&irrecv);
+    for (uint16_t i = 0; i < kNrCorpus; i++) {
+      SCOPED_TRACE(i);
+      EXPECT_EQ(success[i], decodeCorpus(&irsend, &irrecv, i));
+      EXPECT_EQ(type[i], irsend.capture.decode_type);
+      EXPECT_EQ(bits[i], irsend.capture.bits);
+    }
+    tryAllDecoders(&irrecv, false);
+    decodeCorpus(&irsend, &irrecv, 0);
+  }
+}
+
+// Average nr. of protocols decode() will try per corpus message.
+double candidatesPerMessage(IRsendTest *irsend, IRrecv *irrecv) {
+  uint32_t total = 0;
+  for (uint16_t i = 0; i < kNrCorpus; i++) {
+    decodeCorpus(irsend, irrecv, i);
+    irrecv->selectDecodeCandidates(&irsend->capture, kStartOffset);
+    for (uint16_t protocol = UNUSED + 1; protocol <= kLastDecodeType;
+         protocol++)
+      if (irrecv->isDecodeCandidate((decode_type_t)protocol)) total++;
+  }
+  return (double)total / kNrCorpus;
+}
+
+TEST(TestDecodeIndex, Benchmark) {
+  IRsendTest irsend(0);
+  IRrecv irrecv(1);
+  irsend.begin();
+
+  const uint16_t kRounds = 20;
+  tryAllDecoders(&irrecv);
+  const double before = decodesPerSecond(&irsend, &irrecv, kRounds);
+  const double tried_before = candidatesPerMessage(&irsend, &irrecv);
+  tryAllDecoders(&irrecv, false);
+  const double after = decodesPerSecond(&irsend, &irrecv, kRounds);
+  const double tried_after = candidatesPerMessage(&irsend, &irrecv);
+  std::cout << "Decoding " << kNrCorpus << " raw captures x " << kRounds
+            << " rounds:" << std::endl
+            << "  Every decoder: " << before << " decodes/sec, "
+            << tried_before << " protocols tried per message" << std::endl
+            << "  Indexed:       " << after << " decodes/sec, "
+            << tried_after << " protocols tried per message" << std::endl;
+}
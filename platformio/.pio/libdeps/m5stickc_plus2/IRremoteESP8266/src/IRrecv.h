@@ -48,6 +48,19 @@ const uint8_t kTimeoutMs = 15;  // In MilliSeconds.
 #define TIMEOUT_MS kTimeoutMs   // For legacy documentation.
 const uint16_t kMaxTimeoutMs = kRawTick * (UINT16_MAX / MS_TO_USEC(1));
 
+#if ENABLE_DECODE_INDEX
+// Decode index. See `IRrecv::buildDecodeIndex()` for details.
+const uint8_t kDecodeIndexClassShift = 8;  // Classes are 256us wide.
+const uint8_t kDecodeIndexClasses = 64;  // Last one is ~16ms & everything over.
+// Nr. of uint64_t words needed to hold a bit for every protocol.
+const uint8_t kDecodeIndexWords = (kLastDecodeType + 64) / 64;
+// Minimum base & extra percentage tolerance used when indexing header marks.
+// These are deliberately wider than any decoder uses so we never exclude a
+// protocol that could have matched.
+const uint8_t kDecodeIndexMinTolerance = 40;
+const uint8_t kDecodeIndexExtraTolerance = 15;
+#endif  // ENABLE_DECODE_INDEX
+
 // Use FNV hash algorithm: http://isthe.com/chongo/tech/comp/fnv/#FNV-param
 const uint32_t kFnvPrime32 = 16777619UL;
 const uint32_t kFnvBasis32 = 2166136261UL;
@@ -170,11 +183,23 @@ class IRrecv {
 #if DECODE_HASH
   uint16_t _unknown_threshold;
 #endif
+#if ENABLE_DECODE_INDEX
+  // Per header mark class, a bit per protocol that could possibly match.
+  uint64_t _decode_index[kDecodeIndexClasses][kDecodeIndexWords];
+  uint8_t _decode_index_tolerance;  // The `_tolerance` the index was built for.
+  const uint64_t *_decode_candidates;  // Protocols worth trying at the moment.
+#endif  // ENABLE_DECODE_INDEX
 #ifdef UNIT_TEST
   volatile irparams_t *_getParamsPtr(void);
 #endif  // UNIT_TEST
   // These are called by decode
   uint8_t _validTolerance(const uint8_t percentage);
+#if ENABLE_DECODE_INDEX
+  void buildDecodeIndex(void);
+#endif  // ENABLE_DECODE_INDEX
+  void selectDecodeCandidates(const decode_results *results,
+                              const uint16_t offset);
+  bool isDecodeCandidate(const decode_type_t protocol);
   void copyIrParams(volatile irparams_t *src, irparams_t *dst);
   uint16_t compare(const uint16_t oldval, const uint16_t newval);
   uint32_t ticksLow(const uint32_t usecs,
@@ -1004,6 +1004,19 @@
 #define ENABLE_NOISE_FILTER_OPTION true
 #endif  // ENABLE_NOISE_FILTER_OPTION
 
+// Use a header-mark index to skip protocol decoders that can't possibly match
+// a captured message, rather than trying every enabled decoder in turn.
+// i.e. A message starting with a ~9ms mark won't be offered to protocols that
+//      require a ~3ms header mark, and vice versa.
+// Note: This only ever skips decoders that would fail anyway, so decoding
+//       results are identical with it on or off. It costs roughly 1KB of RAM
+//       per `IRrecv` instance. Disable it if you are _really_ tight on RAM.
+//
+// See: `IRrecv::buildDecodeIndex()` in IRrecv.cpp for more info.
+#ifndef ENABLE_DECODE_INDEX
+#define ENABLE_DECODE_INDEX true
+#endif  // ENABLE_DECODE_INDEX
+
 /// Enumerator for defining and numbering of supported IR protocol.
 /// @note Always add to the end of the list and should never remove entries
 ///  or change order. Projects may save the type number for later usage
@@ -12,6 +12,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kAmcorHdrMark = 8200;
@@ -352,3 +353,6 @@ String IRAmcorAc::toString(void) const {
   result += addBoolToString(getMax(), kMaxStr);
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(AMCOR, kAmcorHdrMark);
@@ -18,6 +18,7 @@
 #include "IRremoteESP8266.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 // using SPACE modulation. MARK is always const 400u
@@ -1820,3 +1821,6 @@ bool IRArgoAC_WREM3::isValidWrem3Message(const uint8_t state[],
 // force template instantiation
 template class IRArgoACBase<ArgoProtocol>;
 template class IRArgoACBase<ArgoProtocolWREM3>;
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(ARGO, kArgoHdrMark);
@@ -14,6 +14,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 // Pulse parms are *50-100 for the Mark and *50+100 for the space
@@ -758,3 +759,7 @@ bool IRrecv::decodeCoolix48(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_COOLIX48
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(COOLIX, kCoolixHdrMark);
+IR_DECODE_INDEX_CHECK(COOLIX48, kCoolixHdrMark);
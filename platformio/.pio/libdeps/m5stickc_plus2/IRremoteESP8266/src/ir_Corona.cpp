@@ -13,6 +13,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 using irutils::addBoolToString;
 using irutils::addLabeledString;
@@ -573,3 +574,6 @@ stdAc::state_t IRCoronaAc::toCommon() const {
   result.clock = -1;
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(CORONA_AC, kCoronaAcHdrMark);
@@ -37,6 +37,7 @@
 #endif
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 using irutils::addBoolToString;
 using irutils::addDayToString;
@@ -3924,3 +3925,12 @@ bool IRrecv::decodeDaikin312(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_DAIKIN312
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(DAIKIN2, kDaikin2LeaderMark);
+IR_DECODE_INDEX_CHECK(DAIKIN64, kDaikin64LdrMark);
+IR_DECODE_INDEX_CHECK(DAIKIN128, kDaikin128LeaderMark);
+IR_DECODE_INDEX_CHECK(DAIKIN160, kDaikin160HdrMark);
+IR_DECODE_INDEX_CHECK(DAIKIN176, kDaikin176HdrMark);
+IR_DECODE_INDEX_CHECK(DAIKIN200, kDaikin200HdrMark);
+IR_DECODE_INDEX_CHECK(DAIKIN216, kDaikin216HdrMark);
@@ -13,6 +13,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 
 // Constants
@@ -101,3 +102,6 @@ bool IRrecv::decodeDISH(decode_results *results, uint16_t offset,
   return true;
 }
 #endif
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(DISH, kDishHdrMark);
@@ -12,6 +12,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 
 const uint16_t kDoshishaHdrMark = 3412;
@@ -122,3 +123,6 @@ bool IRrecv::decodeDoshisha(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_DOSHISHA
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(DOSHISHA, kDoshishaHdrMark);
@@ -19,6 +19,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Ref:
 // These values are based on averages of measurements
@@ -1098,3 +1099,6 @@ bool IRrecv::decodeFujitsuAC(decode_results* results, uint16_t offset,
   return true;  // All good.
 }
 #endif  // DECODE_FUJITSU_AC
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(FUJITSU_AC, kFujitsuAcHdrMark);
@@ -14,6 +14,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 using irutils::addBoolToString;
 using irutils::addIntToString;
@@ -497,3 +498,6 @@ bool IRrecv::decodeGoodweather(decode_results* results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_GOODWEATHER
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(GOODWEATHER, kGoodweatherHdrMark);
@@ -18,6 +18,7 @@
 #include "IRtext.h"
 #include "IRutils.h"
 #include "ir_Kelvinator.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kGreeHdrMark = 9000;
@@ -748,3 +749,6 @@ bool IRrecv::decodeGree(decode_results* results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_GREE
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(GREE, kGreeHdrMark);
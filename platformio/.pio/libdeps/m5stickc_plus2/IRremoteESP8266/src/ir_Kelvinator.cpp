@@ -25,6 +25,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kKelvinatorTick = 85;
@@ -579,3 +580,6 @@ bool IRrecv::decodeKelvinator(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_KELVINATOR
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(KELVINATOR, kKelvinatorHdrMark);
@@ -17,6 +17,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 // Shot packets have this bit as `0`
@@ -111,3 +112,6 @@ bool IRrecv::decodeMilestag2(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_MILESTAG2
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(MILESTAG2, kMilesTag2HdrMark);
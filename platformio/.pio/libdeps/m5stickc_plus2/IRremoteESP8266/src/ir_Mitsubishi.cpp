@@ -29,6 +29,7 @@
 #include "IRtext.h"
 #include "IRutils.h"
 #include "ir_Tcl.h"
+#include "IRrecv_index.h"
 
 // Constants
 // Mitsubishi TV
@@ -1725,3 +1726,9 @@ String IRMitsubishi112::toString(void) const {
   result += addBoolToString(getQuiet(), kQuietStr);
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(MITSUBISHI_AC, kMitsubishiAcHdrMark);
+IR_DECODE_INDEX_CHECK(MITSUBISHI2, kMitsubishi2HdrMark);
+IR_DECODE_INDEX_CHECK(MITSUBISHI112, kMitsubishi112HdrMark);
+IR_DECODE_INDEX_CHECK(MITSUBISHI136, kMitsubishi136HdrMark);
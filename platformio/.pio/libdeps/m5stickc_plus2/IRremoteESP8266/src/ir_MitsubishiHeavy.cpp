@@ -18,6 +18,7 @@
 #include "IRutils.h"
 #ifndef ARDUINO
 #include <string>
+#include "IRrecv_index.h"
 #endif
 
 // Constants
@@ -1048,3 +1049,6 @@ bool IRrecv::decodeMitsubishiHeavy(decode_results* results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_MITSUBISHIHEAVY
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(MITSUBISHI_HEAVY_152, kMitsubishiHeavyHdrMark);
@@ -13,6 +13,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // This protocol is used by a lot of other protocols, hence the long list.
 #if (SEND_NEC || SEND_SHERWOOD || SEND_AIWA_RC_T501 || SEND_SANYO || \
@@ -138,3 +139,10 @@ bool IRrecv::decodeNEC(decode_results *results, uint16_t offset,
 }
 #endif  // (DECODE_NEC || DECODE_SHERWOOD || DECODE_AIWA_RC_T501 ||
         // DECODE_SANYO)
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(AIWA_RC_T501, kNecHdrMark);
+IR_DECODE_INDEX_CHECK(EPSON, kNecHdrMark);
+IR_DECODE_INDEX_CHECK(MIDEA24, kNecHdrMark);
+IR_DECODE_INDEX_CHECK(NEC, kNecHdrMark);
+IR_DECODE_INDEX_CHECK(SANYO_LC7461, kNecHdrMark);
@@ -21,6 +21,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 // period time = 1/38000Hz = 26.316 microseconds.
@@ -974,3 +975,6 @@ bool IRrecv::decodeSharpAc(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_SHARP_AC
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(SHARP_AC, kSharpAcHdrMark);
@@ -17,6 +17,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 
 // Constants
@@ -190,3 +191,6 @@ bool IRrecv::decodeSony(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_SONY
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(SONY, kSonyHdrMark);
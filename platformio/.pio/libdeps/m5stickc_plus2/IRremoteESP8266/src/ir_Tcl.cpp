@@ -12,6 +12,7 @@
 #include "IRremoteESP8266.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint8_t kTcl112AcTimerResolution = 20;  // Minutes
@@ -614,3 +615,7 @@ bool IRrecv::decodeTcl96Ac(decode_results* results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_TCL96AC
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(MITSUBISHI112, kTcl112AcHdrMark);
+IR_DECODE_INDEX_CHECK(TCL96AC, kTcl96AcHdrMark);
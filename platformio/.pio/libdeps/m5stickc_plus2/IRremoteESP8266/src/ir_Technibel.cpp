@@ -9,6 +9,7 @@
 #include "IRtext.h"
 #include "IRutils.h"
 #include <algorithm>
+#include "IRrecv_index.h"
 
 using irutils::addBoolToString;
 using irutils::addModeToString;
@@ -406,3 +407,6 @@ String IRTechnibelAc::toString(void) const {
                              kTimerStr);
   return result;
 }
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(TECHNIBEL_AC, kTechnibelAcHdrMark);
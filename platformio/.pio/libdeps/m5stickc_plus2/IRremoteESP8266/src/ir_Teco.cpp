@@ -10,6 +10,7 @@
 #include "IRutils.h"
 #ifndef ARDUINO
 #include <string>
+#include "IRrecv_index.h"
 #endif
 
 // Constants
@@ -373,3 +374,6 @@ bool IRrecv::decodeTeco(decode_results* results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_TECO
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(TECO, kTecoHdrMark);
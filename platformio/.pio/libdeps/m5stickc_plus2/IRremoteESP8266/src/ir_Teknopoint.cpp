@@ -11,6 +11,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Protocol timings
 const uint16_t kTeknopointHdrMark = 3600;
@@ -79,3 +80,6 @@ bool IRrecv::decodeTeknopoint(decode_results *results, uint16_t offset,
 // It doesn't exist, it is instead part of the `IRTcl112Ac` class.
 // i.e. use `IRTcl112Ac::setModel(tcl_ac_remote_model_t::GZ055BE1);` for
 // Teknopoint A/Cs.
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(TEKNOPOINT, kTeknopointHdrMark);
@@ -18,6 +18,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 
@@ -539,3 +540,6 @@ bool IRrecv::decodeToshibaAC(decode_results* results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_TOSHIBA_AC
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(TOSHIBA_AC, kToshibaAcHdrMark);
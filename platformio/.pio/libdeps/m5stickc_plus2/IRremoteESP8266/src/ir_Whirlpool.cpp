@@ -19,6 +19,7 @@
 #include "IRsend.h"
 #include "IRtext.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 const uint16_t kWhirlpoolAcHdrMark = 8950;
@@ -655,3 +656,6 @@ bool IRrecv::decodeWhirlpoolAC(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // WHIRLPOOL_AC
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(WHIRLPOOL_AC, kWhirlpoolAcHdrMark);
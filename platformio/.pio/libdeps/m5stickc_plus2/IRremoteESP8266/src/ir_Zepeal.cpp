@@ -13,6 +13,7 @@
 #include "IRrecv.h"
 #include "IRsend.h"
 #include "IRutils.h"
+#include "IRrecv_index.h"
 
 // Constants
 
@@ -92,3 +93,6 @@ bool IRrecv::decodeZepeal(decode_results *results, uint16_t offset,
   return true;
 }
 #endif  // DECODE_ZEPEAL
+
+// Header marks `IRrecv::decode()` dispatches on. See IRrecv_index.h.
+IR_DECODE_INDEX_CHECK(ZEPEAL, kZepealHdrMark);
@@ -0,0 +1,39 @@
+# Collect every raw capture (`uint16_t raw*[] = {...};`) from the protocol
+# unit tests into a single table, for use by IRrecv_bench_test.cpp.
+#
+# Usage: awk -f decode_corpus.awk ir_*_test.cpp > decode_corpus.h
+
+BEGIN {
+  print "// Generated by decode_corpus.awk. DO NOT EDIT."
+  print "#ifndef TEST_DECODE_CORPUS_H_"
+  print "#define TEST_DECODE_CORPUS_H_"
+  print ""
+  print "#include <stdint.h>"
+  print ""
+  count = 0
+  inarray = 0
+}
+
+/^[ \t]*(const )?uint16_t raw[A-Za-z0-9_]*\[[A-Za-z0-9_ ]*\] = \{/ && !inarray {
+  sub(/^.*= \{/, "const uint16_t kCorpus" count "[] = {  // " FILENAME "\n")
+  count++
+  inarray = 1
+}
+
+inarray {
+  print
+  if ($0 ~ /\};/) inarray = 0
+}
+
+END {
+  print ""
+  print "const struct {"
+  print "  const uint16_t *data;"
+  print "  uint16_t length;"
+  print "} kDecodeCorpus[] = {"
+  for (i = 0; i < count; i++)
+    printf("  {kCorpus%d, sizeof(kCorpus%d) / sizeof(kCorpus%d[0])},\n", i, i, i)
+  print "};"
+  print ""
+  print "#endif  // TEST_DECODE_CORPUS_H_"
+}
@@ -0,0 +1,34 @@
+from typing import TYPE_CHECKING, Any
+
+if TYPE_CHECKING:
+    Import: Any = None
+    env: Any = {}
+
+import gzip
+import shutil
+from os import makedirs, walk
+from os.path import join, relpath
+
+Import("env")  # type: ignore
+
+# The LittleFS image is built from a copy of data/ where the web files are
+# gzipped, so they take less flash and the server sends them as they are.
+GZIP_EXTENSIONS = (".html", ".css", ".js")
+
+src_dir = env.subst("$PROJECT_DATA_DIR")
+dst_dir = join(env.subst("$BUILD_DIR"), "data")
+
+shutil.rmtree(dst_dir, ignore_errors=True)
+for root, _, files in walk(src_dir):
+    out_root = join(dst_dir, relpath(root, src_dir))
+    makedirs(out_root, exist_ok=True)
+    for name in files:
+        src = join(root, name)
+        if name.endswith(GZIP_EXTENSIONS):
+            with open(src, "rb") as f_in, open(join(out_root, name + ".gz"), "wb") as f_out:
+                # mtime=0 keeps the image the same when nothing changed
+                f_out.write(gzip.compress(f_in.read(), 9, mtime=0))
+        else:
+            shutil.copy2(src, join(out_root, name))
+
+env.Replace(PROJECT_DATA_DIR=dst_dir)
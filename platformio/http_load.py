@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""Load test for the device HTTP server, run from the host.
+
+    python3 http_load.py 192.168.4.1 /api/status -c 4 -n 500
+
+Each worker keeps one connection open and reuses it while the server allows
+it. Prints requests/sec and latency percentiles.
+"""
+import argparse
+import http.client
+import threading
+import time
+
+
+def worker(host, port, path, count, latencies, errors, lock):
+    conn = None
+    for _ in range(count):
+        start = time.perf_counter()
+        try:
+            if conn is None:
+                conn = http.client.HTTPConnection(host, port, timeout=5)
+            conn.request("GET", path)
+            response = conn.getresponse()
+            response.read()
+            if response.status != 200:
+                raise http.client.HTTPException(response.status)
+            if response.will_close:
+                conn.close()
+                conn = None
+        except (OSError, http.client.HTTPException):
+            if conn:
+                conn.close()
+            conn = None
+            with lock:
+                errors[0] += 1
+            continue
+        elapsed = time.perf_counter() - start
+        with lock:
+            latencies.append(elapsed)
+    if conn:
+        conn.close()
+
+
+def percentile(values, p):
+    index = min(len(values) - 1, int(round(p / 100 * (len(values) - 1))))
+    return values[index]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("host")
+    parser.add_argument("path", nargs="?", default="/api/status")
+    parser.add_argument("-p", "--port", type=int, default=80)
+    parser.add_argument("-c", "--connections", type=int, default=4)
+    parser.add_argument("-n", "--requests", type=int, default=200, help="per connection")
+    args = parser.parse_args()
+
+    latencies, errors, lock = [], [0], threading.Lock()
+    threads = [
+        threading.Thread(
+            target=worker, args=(args.host, args.port, args.path, args.requests, latencies, errors, lock)
+        )
+        for _ in range(args.connections)
+    ]
+    start = time.perf_counter()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    elapsed = time.perf_counter() - start
+
+    if not latencies:
+        print("No successful requests, %d errors" % errors[0])
+        return 1
+    latencies.sort()
+    print("%d requests, %d errors in %.2f s" % (len(latencies), errors[0], elapsed))
+    print("%.1f requests/sec" % (len(latencies) / elapsed))
+    for p in (50, 90, 99):
+        print("p%d %.1f ms" % (p, percentile(latencies, p) * 1000))
+    print("max %.1f ms" % (latencies[-1] * 1000))
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+
+// Largest JSON body a POST handler accepts
+#define HTTP_MAX_JSON_BODY 1024
+
+// The one HTTP server (port 80) every module adds its routes to. Requests are
+// handled in the AsyncTCP task as they arrive, not from the module loop.
+inline AsyncWebServer& httpServer() {
+	static AsyncWebServer server(80);
+	return server;
+}
+
+// ArduinoJson allocator for request handlers. Small blocks (the variant pools
+// and short strings a response needs) come from a static pool and are reused
+// by the next request; bigger ones fall back to the heap.
+// A variant pool is ARDUINOJSON_POOL_CAPACITY slots of 8 bytes on 32 bit
+// targets, 1024 bytes with ArduinoJson 7's default of 128. platformio.ini
+// sets a capacity that makes one pool fill one block.
+class JsonPool : public ArduinoJson::Allocator {
+public:
+	static const size_t BLOCK_SIZE = 256;
+	static const size_t BLOCKS = 16;
+	static const size_t SLOT_SIZE = 8; // sizeof(VariantData) with 32 bit pointers
+	static_assert(ARDUINOJSON_POOL_CAPACITY * SLOT_SIZE <= BLOCK_SIZE, "variant pools wouldn't fit the blocks");
+
+	static JsonPool& instance() {
+		static JsonPool pool;
+		return pool;
+	}
+
+	void* allocate(size_t size) override {
+		if (size <= BLOCK_SIZE) {
+			portENTER_CRITICAL(&lock);
+			for (size_t i = 0; i < BLOCKS; i++) {
+				if (used & (1u << i)) continue;
+				used |= 1u << i;
+				portEXIT_CRITICAL(&lock);
+				return blocks[i];
+			}
+			portEXIT_CRITICAL(&lock);
+		}
+		return malloc(size);
+	}
+
+	void deallocate(void* ptr) override {
+		int i = blockOf(ptr);
+		if (i < 0) { free(ptr); return; }
+		portENTER_CRITICAL(&lock);
+		used &= ~(1u << i);
+		portEXIT_CRITICAL(&lock);
+	}
+
+	void* reallocate(void* ptr, size_t newSize) override {
+		if (!ptr) return allocate(newSize);
+		if (blockOf(ptr) < 0) return realloc(ptr, newSize);
+		if (newSize <= BLOCK_SIZE) return ptr;
+		void* bigger = malloc(newSize);
+		if (!bigger) return nullptr;
+		memcpy(bigger, ptr, BLOCK_SIZE);
+		deallocate(ptr);
+		return bigger;
+	}
+
+private:
+	JsonPool() = default;
+
+	int blockOf(void* ptr) const {
+		uint8_t* p = (uint8_t*)ptr;
+		if (p < blocks[0] || p >= blocks[BLOCKS - 1] + BLOCK_SIZE) return -1;
+		return (p - blocks[0]) / BLOCK_SIZE;
+	}
+
+	alignas(8) uint8_t blocks[BLOCKS][BLOCK_SIZE];
+	uint32_t used = 0;
+	portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
+
+// Serializes doc straight into the response, without an intermediate String
+inline void sendJson(AsyncWebServerRequest* request, int code, const JsonDocument& doc) {
+	AsyncResponseStream* response = request->beginResponseStream("application/json");
+	response->setCode(code);
+	serializeJson(doc, *response);
+	request->send(response);
+}
+
+// Body handler for JSON POST routes: collects the body NUL terminated in
+// request->_tempObject (freed with the request). Bodies over
+// HTTP_MAX_JSON_BODY are dropped, so the handler sees no body.
+inline void collectJsonBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+	if (total > HTTP_MAX_JSON_BODY) return;
+	if (index == 0 && !request->_tempObject) request->_tempObject = calloc(1, total + 1);
+	char* body = (char*)request->_tempObject;
+	if (body && index + len <= total) memcpy(body + index, data, len);
+}
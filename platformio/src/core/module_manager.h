@@ -1,6 +1,35 @@
 #pragma once
 
+#include <Arduino.h>
 #include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+// When and where a module's loop() runs
+struct ModuleSchedule {
+	// Only notify() runs loop()
+	static const uint32_t EVENTS_ONLY = UINT32_MAX;
+
+	uint32_t intervalMs;
+	int8_t core;         // -1: the Arduino loop task, else a task of its own pinned to this core
+	uint8_t priority;    // of that task
+	uint16_t stackSize;  // of that task, in bytes
+
+	ModuleSchedule(uint32_t intervalMs = 50, int8_t core = -1, uint8_t priority = 1, uint16_t stackSize = 4096)
+		: intervalMs(intervalMs), core(core), priority(priority), stackSize(stackSize) {}
+};
+
+struct ModuleStats {
+	uint32_t loops = 0;
+	uint32_t events = 0;  // loops run by notify()
+	uint32_t maxUs = 0;
+	uint64_t totalUs = 0;
+
+	uint32_t avgUs() const { return loops ? (uint32_t)(totalUs / loops) : 0; }
+};
 
 class IModule {
 public:
@@ -8,28 +37,161 @@ public:
 	virtual const char* getName() const = 0;
 	virtual void setup() = 0;
 	virtual void loop() = 0;
+	// Polled every 50 ms unless the module asks otherwise
+	virtual ModuleSchedule schedule() const { return ModuleSchedule(); }
 };
 
+// Runs each module when its interval is due or when it was notified, and
+// sleeps in between instead of polling everything at a fixed rate.
 class ModuleManager {
 public:
 	void registerModule(IModule* module) {
-		modules.push_back(module);
+		Entry entry;
+		entry.module = module;
+		entries.push_back(entry);
 	}
 
+	// Call once, after every module was registered
 	void setupAll() {
-		for (IModule* module : modules) {
-			module->setup();
+		loopTask = xTaskGetCurrentTaskHandle();
+		for (Entry& entry : entries) {
+			entry.module->setup();
+			entry.schedule = entry.module->schedule();
+			entry.nextRun = millis();
+		}
+		for (Entry& entry : entries) {
+			if (entry.schedule.core < 0) continue;
+			BaseType_t ok = xTaskCreatePinnedToCore(moduleTask, entry.module->getName(), entry.schedule.stackSize,
+				&entry, entry.schedule.priority, &entry.task, entry.schedule.core);
+			if (ok != pdPASS) {
+				Serial.printf("[modules] no task for %s, running it in loop()\n", entry.module->getName());
+				entry.schedule.core = -1;
+				entry.task = nullptr;
+			}
 		}
 	}
 
+	// Runs the modules that are due, then blocks until the next one is or
+	// until a notification arrives. Meant to be the whole Arduino loop().
+	void run() {
+		uint32_t waitMs = runDue();
+		ulTaskNotifyTake(pdTRUE, waitMs == ModuleSchedule::EVENTS_ONLY ? portMAX_DELAY : pdMS_TO_TICKS(waitMs));
+	}
+
+	// Runs every module in the loop task once, due or not
 	void loopAll() {
-		for (IModule* module : modules) {
-			module->loop();
+		for (Entry& entry : entries) {
+			if (!entry.task) runEntry(entry);
 		}
 	}
 
+	// Makes the module's loop() run as soon as possible
+	void notify(IModule* module) {
+		Entry* entry = find(module);
+		if (!entry) return;
+		entry->pending = true;
+		xTaskNotifyGive(entry->task ? entry->task : loopTask);
+	}
+
+	void notifyFromISR(IModule* module) {
+		Entry* entry = find(module);
+		if (!entry) return;
+		entry->pending = true;
+		BaseType_t woken = pdFALSE;
+		vTaskNotifyGiveFromISR(entry->task ? entry->task : loopTask, &woken);
+		if (woken) portYIELD_FROM_ISR();
+	}
+
+	// Lets the chip light sleep whenever every task is blocked. Only possible
+	// with an IDF built with power management and tickless idle; otherwise the
+	// idle task just waits for the next interrupt.
+	bool enableLightSleep() {
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+#if ESP_IDF_VERSION_MAJOR >= 5
+		esp_pm_config_t pm;
+#else
+		esp_pm_config_esp32_t pm;
+#endif
+		pm.max_freq_mhz = getCpuFrequencyMhz();
+		pm.min_freq_mhz = 40;
+		pm.light_sleep_enable = true;
+		return esp_pm_configure(&pm) == ESP_OK;
+#else
+		return false;
+#endif
+	}
+
+	size_t count() const { return entries.size(); }
+	const IModule* module(size_t i) const { return entries[i].module; }
+	const ModuleSchedule& scheduleOf(size_t i) const { return entries[i].schedule; }
+	// Updated by the task running the module, so it may be one loop behind
+	ModuleStats stats(size_t i) const { return entries[i].stats; }
+
 private:
-	std::vector<IModule*> modules;
-};
+	struct Entry {
+		IModule* module = nullptr;
+		ModuleSchedule schedule;
+		ModuleStats stats;
+		uint32_t nextRun = 0;
+		volatile bool pending = false;
+		TaskHandle_t task = nullptr;
+	};
+
+	Entry* find(IModule* module) {
+		for (Entry& entry : entries) {
+			if (entry.module == module) return &entry;
+		}
+		return nullptr;
+	}
+
+	static void runEntry(Entry& entry) {
+		uint32_t start = micros();
+		entry.module->loop();
+		uint32_t us = micros() - start;
+		entry.stats.loops++;
+		entry.stats.totalUs += us;
+		if (us > entry.stats.maxUs) entry.stats.maxUs = us;
+	}
+
+	// Runs entry if it's due or notified, returns the ms until it's due again
+	static uint32_t step(Entry& entry) {
+		bool event = entry.pending;
+		bool timed = entry.schedule.intervalMs != ModuleSchedule::EVENTS_ONLY;
+		bool due = timed && (int32_t)(millis() - entry.nextRun) >= 0;
+		if (event || due) {
+			entry.pending = false;
+			if (event) entry.stats.events++;
+			runEntry(entry);
+		}
+		uint32_t now = millis();
+		if (due) {
+			entry.nextRun += entry.schedule.intervalMs;
+			// A late loop doesn't make the next ones run back to back
+			if ((int32_t)(now - entry.nextRun) >= 0) entry.nextRun = now + entry.schedule.intervalMs;
+		}
+		if (!timed) return ModuleSchedule::EVENTS_ONLY;
+		int32_t left = (int32_t)(entry.nextRun - now);
+		return left > 0 ? left : 0;
+	}
+
+	uint32_t runDue() {
+		uint32_t waitMs = ModuleSchedule::EVENTS_ONLY;
+		for (Entry& entry : entries) {
+			if (entry.task) continue;
+			uint32_t left = step(entry);
+			if (left < waitMs) waitMs = left;
+		}
+		return waitMs;
+	}
 
+	static void moduleTask(void* arg) {
+		Entry& entry = *(Entry*)arg;
+		for (;;) {
+			uint32_t waitMs = step(entry);
+			ulTaskNotifyTake(pdTRUE, waitMs == ModuleSchedule::EVENTS_ONLY ? portMAX_DELAY : pdMS_TO_TICKS(waitMs));
+		}
+	}
 
+	std::vector<Entry> entries;
+	TaskHandle_t loopTask = nullptr;
+};
@@ -2,6 +2,7 @@
 
 #include "core/board_config.h"
 #include "core/module_manager.h"
+#include "core/http_server.h"
 #include "modules/wifi_module.h"
 #include "modules/storage_module.h"
 #include "modules/wifi_manager_module.h"
@@ -33,7 +34,7 @@ static ModuleManager moduleManager;
 static StorageModule storage;
 static SafeModeModule safeMode;
 static WifiManagerModule wifiManager(storage);
-static RestApiModule restApi(storage);
+static RestApiModule restApi(storage, moduleManager);
 static OtaModule ota(storage);
 static DisplayModule display;
 static ImuModule imu;
@@ -107,11 +108,12 @@ void setup() {
 	// pentestWebInterface.setVulnScanner(&vulnScanner);
 	
 	moduleManager.setupAll();
+	httpServer().begin();
+	if (!moduleManager.enableLightSleep()) Serial.println("Light sleep unavailable, idling in WAITI");
 }
 
 void loop() {
-	moduleManager.loopAll();
-	delay(50);
+	moduleManager.run();
 }
 
 
@@ -12,6 +12,7 @@ public:
 		digitalWrite(BoardM5StickC2::BUZZER_PIN, LOW);
 	}
 	void loop() override {}
+	ModuleSchedule schedule() const override { return ModuleSchedule(ModuleSchedule::EVENTS_ONLY); }
 	void beep(uint16_t ms = 100) {
 		digitalWrite(BoardM5StickC2::BUZZER_PIN, HIGH);
 		delay(ms);
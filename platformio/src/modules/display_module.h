@@ -25,6 +25,8 @@ public:
 		M5.update();
 #endif
 	}
+	// Button polling
+	ModuleSchedule schedule() const override { return ModuleSchedule(20); }
 };
 
 
@@ -20,13 +20,10 @@ public:
 		M5.Imu.getAccelData(&ax, &ay, &az);
 		M5.Imu.getGyroData(&gx, &gy, &gz);
 		// Simple periodic log
-		static unsigned long last = 0;
-		if (millis() - last > 500) {
-			last = millis();
-			Serial.printf("IMU A:%.2f,%.2f,%.2f G:%.2f,%.2f,%.2f\n", ax, ay, az, gx, gy, gz);
-		}
+		Serial.printf("IMU A:%.2f,%.2f,%.2f G:%.2f,%.2f,%.2f\n", ax, ay, az, gx, gy, gz);
 #endif
 	}
+	ModuleSchedule schedule() const override { return ModuleSchedule(500); }
 };
 
 
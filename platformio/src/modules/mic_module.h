@@ -12,6 +12,7 @@ public:
 	void loop() override {
 		// Placeholder: compute simple level and log/bargraph serial
 	}
+	ModuleSchedule schedule() const override { return ModuleSchedule(ModuleSchedule::EVENTS_ONLY); }
 };
 
 
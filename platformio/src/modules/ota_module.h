@@ -15,6 +15,11 @@ public:
 		ArduinoOTA.begin();
 	}
 	void loop() override { ArduinoOTA.handle(); }
+	// Own task on core 0, so an upload doesn't stall the modules in loop()
+	ModuleSchedule schedule() const override {
+		if (storage.apiToken.length() == 0) return ModuleSchedule(ModuleSchedule::EVENTS_ONLY);
+		return ModuleSchedule(20, 0, 1, 8192);
+	}
 private:
 	StorageModule& storage;
 };
@@ -1,60 +1,77 @@
 #pragma once
 
 #include <Arduino.h>
-#include <WebServer.h>
+#include <WiFi.h>
 #include <ArduinoJson.h>
 #include "core/module_manager.h"
+#include "core/http_server.h"
 #include "modules/storage_module.h"
 
 class RestApiModule : public IModule {
 public:
-	RestApiModule(StorageModule& storage) : storage(storage), server(8080) {}
+	RestApiModule(StorageModule& storage, ModuleManager& modules) : storage(storage), modules(modules) {}
 	const char* getName() const override { return "rest_api"; }
 	void setup() override {
-		server.on("/api/status", HTTP_GET, [this]() { onStatus(); });
-		server.on("/api/config", HTTP_GET, [this]() { onConfigGet(); });
-		server.on("/api/config", HTTP_POST, [this]() { onConfigPost(); });
-		server.begin();
+		AsyncWebServer& server = httpServer();
+		server.on("/api/status", HTTP_GET, [this](AsyncWebServerRequest* request) { onStatus(request); });
+		server.on("/api/config", HTTP_GET, [this](AsyncWebServerRequest* request) { onConfigGet(request); });
+		server.on("/api/config", HTTP_POST, [this](AsyncWebServerRequest* request) { onConfigPost(request); },
+			nullptr, collectJsonBody);
 	}
-	void loop() override { server.handleClient(); }
+	void loop() override {}
+	// Requests are served by httpServer()
+	ModuleSchedule schedule() const override { return ModuleSchedule(ModuleSchedule::EVENTS_ONLY); }
 
 private:
-	bool isAuthorized() {
-		String token = server.hasHeader("X-API-Token") ? server.header("X-API-Token") : "";
-		return storage.apiToken.length() > 0 && token == storage.apiToken;
+	bool isAuthorized(AsyncWebServerRequest* request) {
+		const AsyncWebHeader* token = request->getHeader("X-API-Token");
+		return storage.apiToken.length() > 0 && token && token->value() == storage.apiToken;
 	}
 
-	void onStatus() {
-		DynamicJsonDocument doc(512);
+	void onStatus(AsyncWebServerRequest* request) {
+		JsonDocument doc(&JsonPool::instance());
 		doc["board"] = EAGLE_BOARD_NAME;
 		doc["ip"] = WiFi.isConnected() ? WiFi.localIP().toString() : String("");
-		String out; serializeJson(doc, out);
-		server.send(200, "application/json", out);
+		doc["uptime_ms"] = millis();
+		doc["free_heap"] = ESP.getFreeHeap();
+		JsonArray list = doc["modules"].to<JsonArray>();
+		for (size_t i = 0; i < modules.count(); i++) {
+			const ModuleSchedule& schedule = modules.scheduleOf(i);
+			ModuleStats stats = modules.stats(i);
+			JsonObject m = list.add<JsonObject>();
+			m["name"] = modules.module(i)->getName();
+			if (schedule.intervalMs == ModuleSchedule::EVENTS_ONLY) m["interval_ms"] = nullptr;
+			else m["interval_ms"] = schedule.intervalMs;
+			m["core"] = schedule.core;
+			m["loops"] = stats.loops;
+			m["events"] = stats.events;
+			m["avg_us"] = stats.avgUs();
+			m["max_us"] = stats.maxUs;
+		}
+		sendJson(request, 200, doc);
 	}
 
-	void onConfigGet() {
-		if (!isAuthorized()) { server.send(403, "text/plain", "Forbidden"); return; }
-		DynamicJsonDocument doc(512);
+	void onConfigGet(AsyncWebServerRequest* request) {
+		if (!isAuthorized(request)) { request->send(403, "text/plain", "Forbidden"); return; }
+		JsonDocument doc(&JsonPool::instance());
 		doc["wifi_ssid"] = storage.wifiSsid;
-		String out; serializeJson(doc, out);
-		server.send(200, "application/json", out);
+		sendJson(request, 200, doc);
 	}
 
-	void onConfigPost() {
-		if (!isAuthorized()) { server.send(403, "text/plain", "Forbidden"); return; }
-		if (!server.hasArg("plain")) { server.send(400, "text/plain", "Bad Request"); return; }
-		DynamicJsonDocument doc(512);
-		auto err = deserializeJson(doc, server.arg("plain"));
-		if (err) { server.send(400, "text/plain", "Invalid JSON"); return; }
+	void onConfigPost(AsyncWebServerRequest* request) {
+		if (!isAuthorized(request)) { request->send(403, "text/plain", "Forbidden"); return; }
+		const char* body = (const char*)request->_tempObject;
+		if (!body) { request->send(400, "text/plain", "Bad Request"); return; }
+		JsonDocument doc(&JsonPool::instance());
+		auto err = deserializeJson(doc, body);
+		if (err) { request->send(400, "text/plain", "Invalid JSON"); return; }
 		String ssid = doc["wifi_ssid"].as<String>();
 		String pass = doc["wifi_pass"].as<String>();
 		String token = doc["api_token"].as<String>();
 		bool ok = storage.saveConfig(ssid, pass, token);
-		server.send(ok ? 200 : 500, "text/plain", ok ? "OK" : "ERROR");
+		request->send(ok ? 200 : 500, "text/plain", ok ? "OK" : "ERROR");
 	}
 
 	StorageModule& storage;
-	WebServer server;
+	ModuleManager& modules;
 };
-
-
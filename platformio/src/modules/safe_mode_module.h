@@ -20,6 +20,7 @@ public:
 #endif
 	}
 	void loop() override {}
+	ModuleSchedule schedule() const override { return ModuleSchedule(ModuleSchedule::EVENTS_ONLY); }
 	bool isSafe() const { return safe; }
 private:
 	bool safe;
@@ -17,6 +17,7 @@ public:
 		ran = true;
 	}
 	void loop() override {}
+	ModuleSchedule schedule() const override { return ModuleSchedule(ModuleSchedule::EVENTS_ONLY); }
 private:
 	BuzzerModule& buzzer;
 	bool ran;
@@ -14,6 +14,7 @@ public:
 		configLoaded = loadConfig();
 	}
 	void loop() override {}
+	ModuleSchedule schedule() const override { return ModuleSchedule(ModuleSchedule::EVENTS_ONLY); }
 
 	bool loadConfig() {
 		File f = LittleFS.open("/config.json", "r");
@@ -0,0 +1,188 @@
+#include "utility_modules.h"
+#include "core/board_config.h"
+#include <driver/i2s.h>
+
+// PDM microphone wiring (M5StickC Plus 2: SPM1423, CLK on G0, DATA on G34)
+#ifndef MIC_CLK_PIN
+#define MIC_CLK_PIN 0
+#endif
+#ifndef MIC_PIN
+#define MIC_PIN 34
+#endif
+#ifndef MIC_SAMPLE_RATE
+#define MIC_SAMPLE_RATE 44100
+#endif
+
+// ===== Microphone Spectrum Module =====
+
+MicrophoneSpectrumModule::MicrophoneSpectrumModule() : spectrum(FRAME_SIZE) {
+    isInitialized = false;
+    isRecording = false;
+    micPin = MIC_PIN;
+    sampleRate = MIC_SAMPLE_RATE;
+    sampleCount = 0;
+    frames[0] = nullptr;
+    frames[1] = nullptr;
+    filledFrames = nullptr;
+    freeFrames = nullptr;
+    captureTask = nullptr;
+    captureRunning = false;
+    lastUpdate = 0;
+}
+
+MicrophoneSpectrumModule::~MicrophoneSpectrumModule() {
+    stopRecording();
+    if (isInitialized) i2s_driver_uninstall(I2S_NUM_0);
+    spectrum.end();
+    free(frames[0]);
+    free(frames[1]);
+    if (filledFrames) vQueueDelete(filledFrames);
+    if (freeFrames) vQueueDelete(freeFrames);
+}
+
+void MicrophoneSpectrumModule::setup() {
+#if HAS_MICROPHONE
+    if (initialize(micPin)) {
+        Serial.println("Microphone Spectrum Module initialized");
+    } else {
+        Serial.println("Microphone Spectrum Module: init failed");
+    }
+#else
+    Serial.println("Microphone Spectrum Module: no microphone on this board");
+#endif
+}
+
+void MicrophoneSpectrumModule::loop() {
+    if (!isRecording) return;
+
+    // Never block the module loop, the capture task keeps the next frame coming
+    uint8_t idx;
+    while (xQueueReceive(filledFrames, &idx, 0) == pdTRUE) {
+        spectrum.process(frames[idx]);
+        xQueueSend(freeFrames, &idx, 0);
+        sampleCount += FRAME_SIZE;
+        lastUpdate = millis();
+        spectrum.countFrame(lastUpdate);
+    }
+}
+
+bool MicrophoneSpectrumModule::initialize(uint8_t pin) {
+    if (isInitialized) return true;
+    micPin = pin;
+
+    if (!spectrum.begin()) return false;
+    for (int i = 0; i < 2; i++) {
+        if (!frames[i]) frames[i] = (int16_t*)malloc(FRAME_SIZE * sizeof(int16_t));
+        if (!frames[i]) return false;
+    }
+    if (!filledFrames) filledFrames = xQueueCreate(2, sizeof(uint8_t));
+    if (!freeFrames) freeFrames = xQueueCreate(2, sizeof(uint8_t));
+    if (!filledFrames || !freeFrames) return false;
+
+    i2s_config_t i2sConfig = {
+        .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_PDM),
+        .sample_rate = sampleRate,
+        .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+        .channel_format = I2S_CHANNEL_FMT_ALL_RIGHT,
+        .communication_format = I2S_COMM_FORMAT_STAND_I2S,
+        .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
+        .dma_buf_count = 8,
+        .dma_buf_len = 256,
+    };
+    i2s_pin_config_t pinConfig = {
+        .bck_io_num = I2S_PIN_NO_CHANGE,
+        .ws_io_num = MIC_CLK_PIN,
+        .data_out_num = I2S_PIN_NO_CHANGE,
+        .data_in_num = micPin,
+    };
+
+    esp_err_t err = i2s_driver_install(I2S_NUM_0, &i2sConfig, 0, NULL);
+    if (err != ESP_OK) return false;
+    err = i2s_set_pin(I2S_NUM_0, &pinConfig);
+    if (err == ESP_OK) err = i2s_set_clk(I2S_NUM_0, sampleRate, I2S_BITS_PER_SAMPLE_16BIT, I2S_CHANNEL_MONO);
+    if (err != ESP_OK) {
+        i2s_driver_uninstall(I2S_NUM_0);
+        return false;
+    }
+    i2s_stop(I2S_NUM_0);
+
+    isInitialized = true;
+    return true;
+}
+
+void MicrophoneSpectrumModule::captureTaskEntry(void* param) {
+    static_cast<MicrophoneSpectrumModule*>(param)->captureLoop();
+}
+
+void MicrophoneSpectrumModule::captureLoop() {
+    uint8_t idx;
+    while (captureRunning) {
+        if (xQueueReceive(freeFrames, &idx, pdMS_TO_TICKS(100)) != pdTRUE) continue;
+        size_t bytesRead = 0;
+        i2s_read(I2S_NUM_0, frames[idx], FRAME_SIZE * sizeof(int16_t), &bytesRead, pdMS_TO_TICKS(200));
+        if (bytesRead == FRAME_SIZE * sizeof(int16_t)) {
+            xQueueSend(filledFrames, &idx, 0);
+        } else {
+            xQueueSend(freeFrames, &idx, 0);
+        }
+    }
+    captureTask = nullptr;
+    vTaskDelete(NULL);
+}
+
+bool MicrophoneSpectrumModule::startRecording() {
+    if (!isInitialized) return false;
+    if (isRecording) return true;
+
+    xQueueReset(filledFrames);
+    xQueueReset(freeFrames);
+    for (uint8_t idx = 0; idx < 2; idx++) xQueueSend(freeFrames, &idx, 0);
+
+    i2s_start(I2S_NUM_0);
+    captureRunning = true;
+    if (xTaskCreatePinnedToCore(captureTaskEntry, "MicCapture", 2048, this, 2, &captureTask, 0) != pdPASS) {
+        captureRunning = false;
+        captureTask = nullptr;
+        i2s_stop(I2S_NUM_0);
+        return false;
+    }
+    isRecording = true;
+    Serial.println("Microphone Spectrum: capture started");
+    return true;
+}
+
+bool MicrophoneSpectrumModule::stopRecording() {
+    if (!isRecording) return true;
+    captureRunning = false;
+    // The task finishes its current read and exits
+    for (int i = 0; i < 50 && captureTask != nullptr; i++) delay(10);
+    i2s_stop(I2S_NUM_0);
+    isRecording = false;
+    Serial.println("Microphone Spectrum: capture stopped");
+    return captureTask == nullptr;
+}
+
+std::vector<float> MicrophoneSpectrumModule::getSpectrumData() {
+    if (!spectrum.ready()) return std::vector<float>();
+    return std::vector<float>(spectrum.power(), spectrum.power() + spectrum.bins());
+}
+
+void MicrophoneSpectrumModule::clearSpectrumData() {
+    spectrum.reset();
+    sampleCount = 0;
+}
+
+String MicrophoneSpectrumModule::getSpectrumInfo() {
+    String info = "Microphone Spectrum:\n";
+    info += "Initialized: " + String(isInitialized ? "Yes" : "No") + "\n";
+    info += "Recording: " + String(isRecording ? "Yes" : "No") + "\n";
+    info += "Sample Rate: " + String(sampleRate) + " Hz\n";
+    info += "Samples: " + String(sampleCount) + "\n";
+    info += "Frames: " + String(spectrum.frames()) + " (" + String(spectrum.framesPerSecond(), 1) + " fps)\n";
+    if (spectrum.ready() && spectrum.frames() > 0) {
+        uint16_t peak = spectrum.peakBin();
+        info += "Peak: " + String(spectrum.binFrequency(peak, sampleRate), 0) + " Hz (" +
+                String(spectrum.powerDb(peak), 1) + " dB)\n";
+    }
+    return info;
+}
@@ -3,19 +3,34 @@
 #include <Arduino.h>
 #include <vector>
 #include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <SpectrumEngine.h>
 #include "core/module_manager.h"
 
 // Microphone Spectrum Module
+// Captures PDM mic frames on a background task (double buffered) and runs
+// them through a persistent SpectrumEngine from loop().
 class MicrophoneSpectrumModule : public IModule {
 private:
+    static const uint16_t FRAME_SIZE = 1024;
+
     bool isInitialized;
     bool isRecording;
     uint8_t micPin;
     uint32_t sampleRate;
     uint32_t sampleCount;
-    std::vector<int16_t> audioBuffer;
-    std::vector<float> spectrumData;
+    SpectrumEngine spectrum;
+    int16_t* frames[2];
+    QueueHandle_t filledFrames;
+    QueueHandle_t freeFrames;
+    TaskHandle_t captureTask;
+    volatile bool captureRunning;
     uint32_t lastUpdate;
+
+    static void captureTaskEntry(void* param);
+    void captureLoop();
     
 public:
     MicrophoneSpectrumModule();
@@ -29,7 +44,9 @@ public:
     bool startRecording();
     bool stopRecording();
     bool isRecordingActive() { return isRecording; }
-    std::vector<float> getSpectrumData() { return spectrumData; }
+    std::vector<float> getSpectrumData();
+    const SpectrumEngine& getSpectrum() const { return spectrum; }
+    float getFramesPerSecond() const { return spectrum.framesPerSecond(); }
     void clearSpectrumData();
     String getSpectrumInfo();
 };
@@ -125,7 +142,7 @@ public:
 class RTCModule : public IModule {
 private:
     bool isInitialized;
-    bool isNTPEnabled;
+    bool ntpEnabled;
     String ntpServer;
     int32_t timezoneOffset;
     uint32_t lastSync;
@@ -142,7 +159,7 @@ public:
     bool initialize();
     bool enableNTP(String server = "pool.ntp.org");
     bool disableNTP();
-    bool isNTPEnabled() { return isNTPEnabled; }
+    bool isNTPEnabled() { return ntpEnabled; }
     String getCurrentTime();
     String getCurrentDate();
     uint32_t getUnixTime();
@@ -157,7 +174,7 @@ public:
 class WebUIModule : public IModule {
 private:
     bool isInitialized;
-    bool isServerActive;
+    bool serverActive;
     String serverIP;
     uint16_t serverPort;
     String serverPath;
@@ -173,7 +190,7 @@ public:
     bool initialize();
     bool startServer(uint16_t port = 80);
     bool stopServer();
-    bool isServerActive() { return isServerActive; }
+    bool isServerActive() { return serverActive; }
     String getServerURL();
     String getServerIP() { return serverIP; }
     uint16_t getServerPort() { return serverPort; }
@@ -2,14 +2,14 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WebServer.h>
 #include <LittleFS.h>
 #include "core/module_manager.h"
+#include "core/http_server.h"
 #include "modules/storage_module.h"
 
 class WifiManagerModule : public IModule {
 public:
-	WifiManagerModule(StorageModule& storage) : storage(storage), server(80), apMode(false) {}
+	WifiManagerModule(StorageModule& storage) : storage(storage), apMode(false) {}
 	const char* getName() const override { return "wifi_manager"; }
 	void setup() override {
 		if (storage.configLoaded && storage.wifiSsid.length()) {
@@ -23,9 +23,9 @@ public:
 		}
 		setupPortal();
 	}
-	void loop() override {
-		server.handleClient();
-	}
+	void loop() override {}
+	// Requests are served by httpServer()
+	ModuleSchedule schedule() const override { return ModuleSchedule(ModuleSchedule::EVENTS_ONLY); }
 
 private:
 	bool waitForConnect(unsigned long timeoutMs) {
@@ -44,41 +44,38 @@ private:
 	}
 
 	void setupPortal() {
-		server.on("/", [this]() {
-			String html = "<html><body><h3>EAGLE WiFi Manager</h3><form method='POST' action='/save'>SSID:<input name=ssid><br>PASS:<input name=pass><br>TOKEN:<input name=token><br><button>Save</button></form></body></html>";
-			server.send(200, "text/html", html);
-		});
-		// Serve Mini UI under /ui and /ui/index.html from LittleFS
-		server.on("/ui", [this]() {
-			serveFile("/index.html", "text/html");
-		});
-		server.on("/ui/index.html", [this]() {
-			serveFile("/index.html", "text/html");
+		AsyncWebServer& server = httpServer();
+		server.on("/", HTTP_GET, [](AsyncWebServerRequest* request) {
+			request->send(200, "text/html", "<html><body><h3>EAGLE WiFi Manager</h3><form method='POST' action='/save'>SSID:<input name=ssid><br>PASS:<input name=pass><br>TOKEN:<input name=token><br><button>Save</button></form></body></html>");
 		});
-		server.on("/save", HTTP_POST, [this]() {
-			String ssid = server.arg("ssid");
-			String pass = server.arg("pass");
-			String token = server.arg("token");
+		// Mini UI, also answers /ui/index.html
+		server.on("/ui", HTTP_GET, [](AsyncWebServerRequest* request) { serveIndex(request); });
+		server.on("/save", HTTP_POST, [this](AsyncWebServerRequest* request) {
+			String ssid = request->arg("ssid");
+			String pass = request->arg("pass");
+			String token = request->arg("token");
 			storage.saveConfig(ssid, pass, token);
-			server.send(200, "text/plain", "Saved. Rebooting...");
-			delay(500);
-			ESP.restart();
+			// Restart once the reply went out, the handler can't wait for it
+			request->onDisconnect([]() { ESP.restart(); });
+			request->send(200, "text/plain", "Saved. Rebooting...");
 		});
-		server.begin();
 	}
 
-	void serveFile(const char* path, const char* contentType) {
-		if (!LittleFS.exists(path)) {
-			server.send(404, "text/plain", "Not Found");
+	// The gzipped copy of /index.html when the image has one, sent as is
+	static void serveIndex(AsyncWebServerRequest* request) {
+		bool gzipped = LittleFS.exists("/index.html.gz");
+		if (!gzipped && !LittleFS.exists("/index.html")) {
+			request->send(404, "text/plain", "Not Found");
 			return;
 		}
-		File f = LittleFS.open(path, "r");
-		server.streamFile(f, contentType);
-		f.close();
+		AsyncWebServerResponse* response =
+			request->beginResponse(LittleFS, gzipped ? "/index.html.gz" : "/index.html", "text/html");
+		if (gzipped) response->addHeader("Content-Encoding", "gzip");
+		response->addHeader("Cache-Control", "max-age=600");
+		request->send(response);
 	}
 
 	StorageModule& storage;
-	WebServer server;
 	bool apMode;
 };
 
@@ -13,6 +13,7 @@ public:
 	void loop() override {
 		// placeholder
 	}
+	ModuleSchedule schedule() const override { return ModuleSchedule(ModuleSchedule::EVENTS_ONLY); }
 };
 
 